@@ -0,0 +1,56 @@
+#!/bin/bash
+# UCI protocol checks for the headless engine: commands sent while a search
+# runs must not block the input thread, and quit must end the process.
+# Usage: scripts/test_uci_protocol.sh [path to gambit-engine]
+
+ENGINE="${1:-build/bin/gambit-engine}"
+LIMIT=10
+FAILED=0
+
+if [ ! -x "$ENGINE" ]; then
+    echo "Engine not found: $ENGINE (run make engine first)"
+    exit 1
+fi
+
+# run_case <name> <expected bestmove count> <commands...>
+# each command is sent after a short pause so the search is running
+run_case() {
+    local name="$1"
+    local expected="$2"
+    shift 2
+
+    local output
+    output=$(for cmd in "$@"; do echo "$cmd"; sleep 0.3; done | timeout "$LIMIT" "$ENGINE" 2>&1)
+    local status=$?
+
+    local moves
+    moves=$(echo "$output" | grep -c "^bestmove")
+
+    if [ $status -eq 124 ]; then
+        echo "FAIL $name: engine still running after ${LIMIT}s"
+        FAILED=1
+    elif [ $status -ne 0 ]; then
+        echo "FAIL $name: exit status $status"
+        FAILED=1
+    elif [ "$moves" -ne "$expected" ]; then
+        echo "FAIL $name: $moves bestmove lines, expected $expected"
+        FAILED=1
+    else
+        echo "ok   $name"
+    fi
+}
+
+run_case "position stops go infinite" 1 \
+    "uci" "go infinite" "position startpos moves e2e4" "quit"
+run_case "go stops go infinite" 2 \
+    "uci" "go infinite" "go depth 3" "quit"
+run_case "ucinewgame stops go infinite" 1 \
+    "uci" "go infinite" "ucinewgame" "isready" "quit"
+run_case "setoption refused while searching" 1 \
+    "uci" "go infinite" "setoption name Hash value 16" "stop" "quit"
+run_case "stop then quit" 1 \
+    "uci" "position startpos" "go infinite" "stop" "quit"
+run_case "end of input stops the search" 1 \
+    "uci" "go infinite"
+
+exit $FAILED
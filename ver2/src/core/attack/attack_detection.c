@@ -9,8 +9,16 @@
  * - Castling rights verification
  * - King safety evaluation
  * 
- * Uses efficient sliding piece attack generation with direction vectors
- * and precomputed knight/king attack patterns.
+ * Uses the precomputed attack tables (bitboards_attacks.c): the attack
+ * set of each piece kind is taken from the target square and ANDed with
+ * the attacking side's bitboard for that kind, with magic lookups for
+ * sliders.
+ *
+ * Also provides Static Exchange Evaluation (Attack_SEE): the material
+ * outcome of the capture sequence on a square when both sides always
+ * recapture with their least valuable attacker. Attackers are lifted
+ * from a scratch occupancy bitboard and the slider lookups repeated, so
+ * x-ray attackers behind them join the exchange.
  * 
  * @author Gambit Chess Team
  * @date February 2026
@@ -19,88 +27,152 @@
 #include "stdio.h"
 #include "types_definitions.h"
 
-const int KnDir[8] = { -8, -19,	-21, -12, 8, 19, 21, 12 };
-const int RkDir[4] = { -1, -10,	1, 10 };
-const int BiDir[4] = { -9, -11, 11, 9 };
-const int KiDir[8] = { -1, -10,	1, 10, -9, -11, 11, 9 };
+#define SEE_MAX_DEPTH 32
 
-int Attack_IsSquareAttacked(const int squareIndex, const int side, const ChessBoard *board) {
+static inline int SquareAttacked(const int squareIndex, const int side, const ChessBoard *board) {
 
-	int piece,index,t_sq,direction;
+	int sq64;
+	int base;
+	U64 occupied;
 	
 	ASSERT(SqOnBoard(squareIndex));
 	ASSERT(SideValid(side));
 	ASSERT(Board_Check(board));
+
+	sq64 = SQUARE_120_TO_64(squareIndex);
+	base = side == COLOR_TYPE_WHITE ? PIECE_TYPE_WHITE_PAWN : PIECE_TYPE_BLACK_PAWN;
+	occupied = board->occupied[COLOR_TYPE_BOTH];
 	
-	// pawns
-	if(side == COLOR_TYPE_WHITE) {
-		if(board->pieces[squareIndex-11] == PIECE_TYPE_WHITE_PAWN || board->pieces[squareIndex-9] == PIECE_TYPE_WHITE_PAWN) {
-			return BOOL_TYPE_TRUE;
-		}
-	} else {
-		if(board->pieces[squareIndex+11] == PIECE_TYPE_BLACK_PAWN || board->pieces[squareIndex+9] == PIECE_TYPE_BLACK_PAWN) {
-			return BOOL_TYPE_TRUE;
-		}	
+	// pawns: a pawn of side attacks sq64 if sq64's opposite-colour pawn
+	// attack set contains it
+	if(g_pawnAttacks[side^1][sq64] & board->pieceBB[base + PIECE_KIND_PAWN]) {
+		return BOOL_TYPE_TRUE;
 	}
 	
 	// knights
-	for(index = 0; index < 8; ++index) {		
-		piece = board->pieces[squareIndex + KnDir[index]];
-		ASSERT(PceValidEmptyOffbrd(piece));
-		if(piece != OFFBOARD && PIECE_IS_KNIGHT(piece) && g_pieceCol[piece]==side) {
-			return BOOL_TYPE_TRUE;
-		}
+	if(g_knightAttacks[sq64] & board->pieceBB[base + PIECE_KIND_KNIGHT]) {
+		return BOOL_TYPE_TRUE;
 	}
 	
 	// rooks, queens
-	for(index = 0; index < 4; ++index) {		
-		direction = RkDir[index];
-		t_sq = squareIndex + direction;
-		ASSERT(SqIs120(t_sq));
-		piece = board->pieces[t_sq];
-		ASSERT(PceValidEmptyOffbrd(piece));
-		while(piece != OFFBOARD) {
-			if(piece != EMPTY) {
-				if(PIECE_IS_ROOK_QUEEN(piece) && g_pieceCol[piece] == side) {
-					return BOOL_TYPE_TRUE;
-				}
-				break;
-			}
-			t_sq += direction;
-			ASSERT(SqIs120(t_sq));
-			piece = board->pieces[t_sq];
-		}
+	if(ROOK_ATTACKS(sq64, occupied) & (board->pieceBB[base + PIECE_KIND_ROOK] | board->pieceBB[base + PIECE_KIND_QUEEN])) {
+		return BOOL_TYPE_TRUE;
 	}
 	
 	// bishops, queens
-	for(index = 0; index < 4; ++index) {		
-		direction = BiDir[index];
-		t_sq = squareIndex + direction;
-		ASSERT(SqIs120(t_sq));
-		piece = board->pieces[t_sq];
-		ASSERT(PceValidEmptyOffbrd(piece));
-		while(piece != OFFBOARD) {
-			if(piece != EMPTY) {
-				if(PIECE_IS_BISHOP_QUEEN(piece) && g_pieceCol[piece] == side) {
-					return BOOL_TYPE_TRUE;
-				}
-				break;
-			}
-			t_sq += direction;
-			ASSERT(SqIs120(t_sq));
-			piece = board->pieces[t_sq];
-		}
+	if(BISHOP_ATTACKS(sq64, occupied) & (board->pieceBB[base + PIECE_KIND_BISHOP] | board->pieceBB[base + PIECE_KIND_QUEEN])) {
+		return BOOL_TYPE_TRUE;
 	}
 	
 	// kings
-	for(index = 0; index < 8; ++index) {		
-		piece = board->pieces[squareIndex + KiDir[index]];
-		ASSERT(PceValidEmptyOffbrd(piece));
-		if(piece != OFFBOARD && PIECE_IS_KING(piece) && g_pieceCol[piece]==side) {
-			return BOOL_TYPE_TRUE;
-		}
+	if(g_kingAttacks[sq64] & board->pieceBB[base + PIECE_KIND_KING]) {
+		return BOOL_TYPE_TRUE;
 	}
 	
 	return BOOL_TYPE_FALSE;
 	
-}
\ No newline at end of file
+}
+
+int Attack_IsSquareAttacked(const int squareIndex, const int side, const ChessBoard *board) {
+	int attacked;
+	PROFILE_BEGIN(PROFILE_SQUARE_ATTACKED);
+	attacked = SquareAttacked(squareIndex, side, board);
+	PROFILE_END(PROFILE_SQUARE_ATTACKED);
+	return attacked;
+}
+
+// every piece of either colour attacking sq64 through the given occupancy
+static U64 AttackersTo(const ChessBoard *board, const int sq64, const U64 occupied) {
+
+	const U64 *bb = board->pieceBB;
+
+	return (g_pawnAttacks[COLOR_TYPE_BLACK][sq64] & bb[PIECE_TYPE_WHITE_PAWN])
+		| (g_pawnAttacks[COLOR_TYPE_WHITE][sq64] & bb[PIECE_TYPE_BLACK_PAWN])
+		| (g_knightAttacks[sq64] & (bb[PIECE_TYPE_WHITE_KNIGHT] | bb[PIECE_TYPE_BLACK_KNIGHT]))
+		| (g_kingAttacks[sq64] & (bb[PIECE_TYPE_WHITE_KING] | bb[PIECE_TYPE_BLACK_KING]))
+		| (BISHOP_ATTACKS(sq64, occupied) & (bb[PIECE_TYPE_WHITE_BISHOP] | bb[PIECE_TYPE_BLACK_BISHOP]
+			| bb[PIECE_TYPE_WHITE_QUEEN] | bb[PIECE_TYPE_BLACK_QUEEN]))
+		| (ROOK_ATTACKS(sq64, occupied) & (bb[PIECE_TYPE_WHITE_ROOK] | bb[PIECE_TYPE_BLACK_ROOK]
+			| bb[PIECE_TYPE_WHITE_QUEEN] | bb[PIECE_TYPE_BLACK_QUEEN]));
+}
+
+int Attack_SEE(const ChessBoard *board, const int move) {
+
+	const U64 *bb = board->pieceBB;
+	int gain[SEE_MAX_DEPTH];
+	int from = MOVE_GET_FROM_SQUARE(move);
+	int to = MOVE_GET_TO_SQUARE(move);
+	int promoted = MOVE_GET_PROMOTED(move);
+	int side = board->side;
+	int to64 = SQUARE_120_TO_64(to);
+	int depth = 0;
+	int onSquare = 0;
+	int piece = EMPTY;
+	int base = 0;
+	U64 occupied = 0ULL;
+	U64 attackers = 0ULL;
+	U64 candidates = 0ULL;
+	U64 diagonal = bb[PIECE_TYPE_WHITE_BISHOP] | bb[PIECE_TYPE_BLACK_BISHOP] | bb[PIECE_TYPE_WHITE_QUEEN] | bb[PIECE_TYPE_BLACK_QUEEN];
+	U64 straight = bb[PIECE_TYPE_WHITE_ROOK] | bb[PIECE_TYPE_BLACK_ROOK] | bb[PIECE_TYPE_WHITE_QUEEN] | bb[PIECE_TYPE_BLACK_QUEEN];
+
+	ASSERT(SqOnBoard(from));
+	ASSERT(SqOnBoard(to));
+	ASSERT(PieceValid(board->pieces[from]));
+
+	occupied = board->occupied[COLOR_TYPE_BOTH] ^ (1ULL << SQUARE_120_TO_64(from));
+
+	if(move & MFLAGEP) {
+		gain[0] = g_pieceVal[PIECE_TYPE_WHITE_PAWN];
+		occupied ^= 1ULL << SQUARE_120_TO_64(side == COLOR_TYPE_WHITE ? to-10 : to+10);
+	} else {
+		gain[0] = g_pieceVal[MOVE_GET_CAPTURED(move)];
+	}
+
+	// value of the piece now standing on the target square
+	onSquare = g_pieceVal[board->pieces[from]];
+	if(promoted != EMPTY) {
+		gain[0] += g_pieceVal[promoted] - g_pieceVal[PIECE_TYPE_WHITE_PAWN];
+		onSquare = g_pieceVal[promoted];
+	}
+	attackers = AttackersTo(board, to64, occupied) & occupied;
+	side ^= 1;
+
+	while(depth < SEE_MAX_DEPTH - 1) {
+		// least valuable attacker of side
+		base = side == COLOR_TYPE_WHITE ? PIECE_TYPE_WHITE_PAWN : PIECE_TYPE_BLACK_PAWN;
+		candidates = 0ULL;
+		for(piece = base; piece <= base + PIECE_KIND_KING; ++piece) {
+			candidates = attackers & bb[piece];
+			if(candidates) {
+				break;
+			}
+		}
+		if(!candidates) {
+			break;
+		}
+		depth++;
+		gain[depth] = onSquare - gain[depth-1];
+		onSquare = g_pieceVal[piece];
+
+		// lifting the attacker may uncover an x-ray slider behind it
+		occupied ^= candidates & (0ULL - candidates);
+		if(PIECE_IS_BISHOP_QUEEN(piece) || g_piecePawn[piece]) {
+			attackers |= BISHOP_ATTACKS(to64, occupied) & diagonal;
+		}
+		if(PIECE_IS_ROOK_QUEEN(piece)) {
+			attackers |= ROOK_ATTACKS(to64, occupied) & straight;
+		}
+		attackers &= occupied;
+		side ^= 1;
+	}
+
+	// either side may stop recapturing when it does not pay
+	while(depth > 0) {
+		if(gain[depth] > -gain[depth-1]) {
+			gain[depth-1] = -gain[depth];
+		}
+		depth--;
+	}
+
+	return gain[0];
+}
@@ -0,0 +1,239 @@
+/**
+ * @file bitboards_attacks.c
+ * @brief Precomputed attack bitboards and magic slider lookups
+ *
+ * Builds, once at start-up:
+ * - Knight and king attack sets for every square
+ * - Pawn capture sets for both colours
+ * - Bishop and rook attack tables indexed by "fancy" magic bitboards
+ *   (or by PEXT when built with -DUSE_PEXT on BMI2 hardware)
+ * - Between and line masks for every aligned square pair, used for pin
+ *   rays and check blocking by the legal move generator
+ *
+ * A slider lookup masks the occupancy down to the relevant blocker
+ * squares, turns it into a table index with one multiply and shift (or
+ * one PEXT), and reads the attack set, replacing square-by-square ray
+ * walks over the mailbox.
+ *
+ * Magic numbers are searched offline with a fixed-seed generator (this
+ * file built with -DGENERATE_TABLES into types_generator, see make
+ * tables) and stored in types_tables.c, so start-up only fills the slider
+ * tables, one store per blocker subset.
+ *
+ * All squares here are 64-square indices (A1 = 0, H8 = 63).
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "types_definitions.h"
+
+#define BISHOP_TABLE_SIZE 5248
+#define ROOK_TABLE_SIZE 102400
+
+U64 g_knightAttacks[64];
+U64 g_kingAttacks[64];
+U64 g_pawnAttacks[2][64];
+
+U64 g_betweenMask[64][64];
+U64 g_lineMask[64][64];
+
+SliderMagic g_bishopMagics[64];
+SliderMagic g_rookMagics[64];
+
+static U64 BishopTable[BISHOP_TABLE_SIZE];
+static U64 RookTable[ROOK_TABLE_SIZE];
+
+static const int BishopDeltas[4][2] = { {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+static const int RookDeltas[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+
+#if !defined(USE_PEXT) && defined(GENERATE_TABLES)
+static U64 MagicSeed = 0x9E3779B97F4A7C15ULL;
+
+// xorshift64*, fixed seed keeps the tables reproducible
+static U64 MagicRandom() {
+	MagicSeed ^= MagicSeed >> 12;
+	MagicSeed ^= MagicSeed << 25;
+	MagicSeed ^= MagicSeed >> 27;
+	return MagicSeed * 2685821657736338717ULL;
+}
+
+// candidates with few bits set make good magics
+static U64 MagicCandidate() {
+	return MagicRandom() & MagicRandom() & MagicRandom();
+}
+#endif
+
+static U64 SquareBit(const int file, const int rank) {
+	if(file < 0 || file > 7 || rank < 0 || rank > 7) {
+		return 0ULL;
+	}
+	return 1ULL << (rank * 8 + file);
+}
+
+// reference attacks by walking the rays, blockers included
+static U64 SlidingAttacks(const int sq64, const U64 occupied, const int deltas[4][2]) {
+
+	U64 attacks = 0ULL;
+	U64 bit = 0ULL;
+	int index = 0;
+	int file = 0;
+	int rank = 0;
+
+	for(index = 0; index < 4; ++index) {
+		file = sq64 % 8 + deltas[index][0];
+		rank = sq64 / 8 + deltas[index][1];
+		while((bit = SquareBit(file, rank)) != 0ULL) {
+			attacks |= bit;
+			if(occupied & bit) {
+				break;
+			}
+			file += deltas[index][0];
+			rank += deltas[index][1];
+		}
+	}
+	return attacks;
+}
+
+// blocker squares that matter: the rays without their board edge squares
+static U64 RelevantMask(const int sq64, const int deltas[4][2]) {
+
+	U64 mask = 0ULL;
+	int index = 0;
+	int file = 0;
+	int rank = 0;
+
+	for(index = 0; index < 4; ++index) {
+		file = sq64 % 8 + deltas[index][0];
+		rank = sq64 / 8 + deltas[index][1];
+		while(SquareBit(file + deltas[index][0], rank + deltas[index][1]) != 0ULL) {
+			mask |= SquareBit(file, rank);
+			file += deltas[index][0];
+			rank += deltas[index][1];
+		}
+	}
+	return mask;
+}
+
+static void InitSliderMagics(SliderMagic *magics, U64 *table, const int deltas[4][2], const U64 *numbers) {
+
+	static U64 reference[4096];
+	int sq64 = 0;
+	int size = 0;
+	int bits = 0;
+	U64 subset = 0ULL;
+	U64 *attacks = table;
+#if !defined(USE_PEXT) && defined(GENERATE_TABLES)
+	static U64 occupancy[4096];
+	static int epoch[4096];
+	int attempt = 0;
+	int index = 0;
+
+	memset(epoch, 0, sizeof(epoch));
+#endif
+
+	for(sq64 = 0; sq64 < 64; ++sq64) {
+		SliderMagic *magic = &magics[sq64];
+
+		magic->mask = RelevantMask(sq64, deltas);
+		bits = BITBOARD_COUNT(magic->mask);
+		magic->shift = 64 - bits;
+		magic->magic = numbers[sq64];
+		magic->attacks = attacks;
+
+		// enumerate every blocker subset (carry-rippler)
+		size = 0;
+		subset = 0ULL;
+		do {
+			reference[size] = SlidingAttacks(sq64, subset, deltas);
+#ifdef USE_PEXT
+			magic->attacks[_pext_u64(subset, magic->mask)] = reference[size];
+#elif defined(GENERATE_TABLES)
+			occupancy[size] = subset;
+#else
+			ASSERT(magic->attacks[MAGIC_INDEX(*magic, subset)] == 0ULL || magic->attacks[MAGIC_INDEX(*magic, subset)] == reference[size]);
+			magic->attacks[MAGIC_INDEX(*magic, subset)] = reference[size];
+#endif
+			size++;
+			subset = (subset - magic->mask) & magic->mask;
+		} while(subset);
+
+#if !defined(USE_PEXT) && defined(GENERATE_TABLES)
+		// try candidates until every subset maps to a slot holding its own
+		// attack set (constructive collisions are fine)
+		for(index = 0; index < size; ) {
+			magic->magic = 0ULL;
+			while(BITBOARD_COUNT((magic->mask * magic->magic) >> 56) < 6) {
+				magic->magic = MagicCandidate();
+			}
+			attempt++;
+			for(index = 0; index < size; ++index) {
+				int slot = (int)(((occupancy[index] & magic->mask) * magic->magic) >> magic->shift);
+				if(epoch[slot] < attempt) {
+					epoch[slot] = attempt;
+					magic->attacks[slot] = reference[index];
+				} else if(magic->attacks[slot] != reference[index]) {
+					break;
+				}
+			}
+		}
+#endif
+		attacks += size;
+	}
+}
+
+// squares strictly between and full line through every aligned pair
+static void InitLineMasks(const int deltas[4][2]) {
+
+	int from = 0;
+	int to = 0;
+	U64 fromAttacks = 0ULL;
+
+	for(from = 0; from < 64; ++from) {
+		fromAttacks = SlidingAttacks(from, 0ULL, deltas);
+		for(to = 0; to < 64; ++to) {
+			if(!(fromAttacks & (1ULL << to))) {
+				continue;
+			}
+			g_betweenMask[from][to] = SlidingAttacks(from, 1ULL << to, deltas) & SlidingAttacks(to, 1ULL << from, deltas);
+			g_lineMask[from][to] = (fromAttacks & SlidingAttacks(to, 0ULL, deltas)) | (1ULL << from) | (1ULL << to);
+		}
+	}
+}
+
+void Init_AttackTables() {
+
+	int sq64 = 0;
+	int file = 0;
+	int rank = 0;
+
+	memset(g_betweenMask, 0, sizeof(g_betweenMask));
+	memset(g_lineMask, 0, sizeof(g_lineMask));
+
+	for(sq64 = 0; sq64 < 64; ++sq64) {
+		file = sq64 % 8;
+		rank = sq64 / 8;
+
+		g_knightAttacks[sq64] = SquareBit(file+1,rank+2) | SquareBit(file+2,rank+1) | SquareBit(file+2,rank-1) | SquareBit(file+1,rank-2)
+			| SquareBit(file-1,rank-2) | SquareBit(file-2,rank-1) | SquareBit(file-2,rank+1) | SquareBit(file-1,rank+2);
+
+		g_kingAttacks[sq64] = SquareBit(file-1,rank-1) | SquareBit(file,rank-1) | SquareBit(file+1,rank-1) | SquareBit(file-1,rank)
+			| SquareBit(file+1,rank) | SquareBit(file-1,rank+1) | SquareBit(file,rank+1) | SquareBit(file+1,rank+1);
+
+		g_pawnAttacks[COLOR_TYPE_WHITE][sq64] = SquareBit(file-1,rank+1) | SquareBit(file+1,rank+1);
+		g_pawnAttacks[COLOR_TYPE_BLACK][sq64] = SquareBit(file-1,rank-1) | SquareBit(file+1,rank-1);
+	}
+
+#ifdef GENERATE_TABLES
+	static const U64 noMagics[64];
+	InitSliderMagics(g_bishopMagics, BishopTable, BishopDeltas, noMagics);
+	InitSliderMagics(g_rookMagics, RookTable, RookDeltas, noMagics);
+#else
+	InitSliderMagics(g_bishopMagics, BishopTable, BishopDeltas, g_bishopMagicNumbers);
+	InitSliderMagics(g_rookMagics, RookTable, RookDeltas, g_rookMagicNumbers);
+#endif
+	InitLineMasks(BishopDeltas);
+	InitLineMasks(RookDeltas);
+}
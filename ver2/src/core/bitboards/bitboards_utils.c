@@ -6,6 +6,10 @@
  * - Printing bitboards for debugging
  * - Bit counting (population count)
  * - Bit scanning (finding and removing set bits)
+ *
+ * These are the portable implementations behind BITBOARD_COUNT and
+ * BITBOARD_POP; the POPCNT/BMI build variants replace them with
+ * intrinsics in types_definitions.h.
  * 
  * Bitboards are 64-bit integers where each bit represents a square
  * on the chess board. They enable efficient bulk operations on sets
@@ -32,10 +36,12 @@ int Bitboard_PopBit(U64 *bb) {
   return BitTable[(fold * 0x783a9b23) >> 26];
 }
 
+// branch-free SWAR count, constant time on any 64-bit CPU
 int Bitboard_CountBits(U64 b) {
-  int r;
-  for(r = 0; b; r++, b &= b - 1);
-  return r;
+  b = b - ((b >> 1) & 0x5555555555555555ULL);
+  b = (b & 0x3333333333333333ULL) + ((b >> 2) & 0x3333333333333333ULL);
+  b = (b + (b >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (int)((b * 0x0101010101010101ULL) >> 56);
 }
 
 void Bitboard_Print(U64 bb) {
@@ -11,6 +11,8 @@
  * - Castling rights
  * - En passant square
  * 
+ * A second key over the pawns alone indexes the pawn structure cache.
+ * 
  * This allows fast position lookup in the transposition table and
  * efficient detection of threefold repetition.
  * 
@@ -54,3 +56,23 @@ U64 Board_GeneratePositionKey(const ChessBoard *board) {
 	return finalKey;
 }
 
+U64 Board_GeneratePawnKey(const ChessBoard *board) {
+
+	U64 finalKey = 0;
+	U64 pawns = 0ULL;
+	int sq64 = 0;
+
+	pawns = board->pawns[COLOR_TYPE_WHITE];
+	while(pawns) {
+		sq64 = BITBOARD_POP(&pawns);
+		finalKey ^= g_pieceKeys[PIECE_TYPE_WHITE_PAWN][SQUARE_64_TO_120(sq64)];
+	}
+
+	pawns = board->pawns[COLOR_TYPE_BLACK];
+	while(pawns) {
+		sq64 = BITBOARD_POP(&pawns);
+		finalKey ^= g_pieceKeys[PIECE_TYPE_BLACK_PAWN][SQUARE_64_TO_120(sq64)];
+	}
+
+	return finalKey;
+}
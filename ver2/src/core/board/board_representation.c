@@ -4,6 +4,8 @@
  * 
  * Handles the chess board state including:
  * - Board initialization and reset
+ * - Allocation of the out-of-line game history and search tables, and
+ *   cheap position copies for search threads (Board_Copy)
  * - FEN string parsing
  * - Board validation and consistency checking
  * - Material and piece list updates
@@ -11,7 +13,7 @@
  * 
  * The board uses a hybrid representation:
  * - 120-square mailbox array for fast piece lookup
- * - Bitboards for efficient pawn operations
+ * - Pawn, per-piece and occupancy bitboards (attack lookups, set-wise terms)
  * - Piece lists for fast iteration over pieces
  * 
  * @author Gambit Chess Team
@@ -19,6 +21,8 @@
  */
 
 #include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
 #include "types_definitions.h"
 
 int PceListOk(const ChessBoard *board) {
@@ -47,10 +51,14 @@ int Board_Check(const ChessBoard *board) {
 	int t_majPce[2] = { 0, 0};
 	int t_minPce[2] = { 0, 0};
 	int t_material[2] = { 0, 0};
+	int t_pstMg[2] = { 0, 0};
+	int t_pstEg[2] = { 0, 0};
 
 	int sq64,t_piece,t_pce_num,sq120,colour,pcount;
 
 	U64 t_pawns[3] = {0ULL, 0ULL, 0ULL};
+	U64 t_occupied[2] = {0ULL, 0ULL};
+	U64 t_bb = 0ULL;
 
 	t_pawns[COLOR_TYPE_WHITE] = board->pawns[COLOR_TYPE_WHITE];
 	t_pawns[COLOR_TYPE_BLACK] = board->pawns[COLOR_TYPE_BLACK];
@@ -75,6 +83,8 @@ int Board_Check(const ChessBoard *board) {
 		if( PieceMaj[t_piece] == BOOL_TYPE_TRUE) t_majPce[colour]++;
 
 		t_material[colour] += g_pieceVal[t_piece];
+		t_pstMg[colour] += g_pstMg[t_piece][sq120];
+		t_pstEg[colour] += g_pstEg[t_piece][sq120];
 	}
 
 	for(t_piece = PIECE_TYPE_WHITE_PAWN; t_piece <= PIECE_TYPE_BLACK_KING; ++t_piece) {
@@ -105,13 +115,33 @@ int Board_Check(const ChessBoard *board) {
 		ASSERT( (board->pieces[SQUARE_64_TO_120(sq64)] == PIECE_TYPE_BLACK_PAWN) || (board->pieces[SQUARE_64_TO_120(sq64)] == PIECE_TYPE_WHITE_PAWN) );
 	}
 
+	// check piece and occupancy bitboards against the mailbox
+	for(t_piece = PIECE_TYPE_WHITE_PAWN; t_piece <= PIECE_TYPE_BLACK_KING; ++t_piece) {
+		ASSERT(BITBOARD_COUNT(board->pieceBB[t_piece]) == board->pieceCount[t_piece]);
+		t_bb = board->pieceBB[t_piece];
+		while(t_bb) {
+			sq64 = BITBOARD_POP(&t_bb);
+			ASSERT(board->pieces[SQUARE_64_TO_120(sq64)] == t_piece);
+		}
+		t_occupied[g_pieceCol[t_piece]] |= board->pieceBB[t_piece];
+	}
+	ASSERT(board->pieceBB[EMPTY] == 0ULL);
+	ASSERT(t_occupied[COLOR_TYPE_WHITE] == board->occupied[COLOR_TYPE_WHITE]);
+	ASSERT(t_occupied[COLOR_TYPE_BLACK] == board->occupied[COLOR_TYPE_BLACK]);
+	ASSERT((t_occupied[COLOR_TYPE_WHITE] | t_occupied[COLOR_TYPE_BLACK]) == board->occupied[COLOR_TYPE_BOTH]);
+	ASSERT(board->pieceBB[PIECE_TYPE_WHITE_PAWN] == board->pawns[COLOR_TYPE_WHITE]);
+	ASSERT(board->pieceBB[PIECE_TYPE_BLACK_PAWN] == board->pawns[COLOR_TYPE_BLACK]);
+
 	ASSERT(t_material[COLOR_TYPE_WHITE]==board->material[COLOR_TYPE_WHITE] && t_material[COLOR_TYPE_BLACK]==board->material[COLOR_TYPE_BLACK]);
+	ASSERT(t_pstMg[COLOR_TYPE_WHITE]==board->pstMg[COLOR_TYPE_WHITE] && t_pstMg[COLOR_TYPE_BLACK]==board->pstMg[COLOR_TYPE_BLACK]);
+	ASSERT(t_pstEg[COLOR_TYPE_WHITE]==board->pstEg[COLOR_TYPE_WHITE] && t_pstEg[COLOR_TYPE_BLACK]==board->pstEg[COLOR_TYPE_BLACK]);
 	ASSERT(t_minPce[COLOR_TYPE_WHITE]==board->minPce[COLOR_TYPE_WHITE] && t_minPce[COLOR_TYPE_BLACK]==board->minPce[COLOR_TYPE_BLACK]);
 	ASSERT(t_majPce[COLOR_TYPE_WHITE]==board->majPce[COLOR_TYPE_WHITE] && t_majPce[COLOR_TYPE_BLACK]==board->majPce[COLOR_TYPE_BLACK]);
 	ASSERT(t_bigPce[COLOR_TYPE_WHITE]==board->bigPce[COLOR_TYPE_WHITE] && t_bigPce[COLOR_TYPE_BLACK]==board->bigPce[COLOR_TYPE_BLACK]);
 
 	ASSERT(board->side==COLOR_TYPE_WHITE || board->side==COLOR_TYPE_BLACK);
 	ASSERT(Board_GeneratePositionKey(board)==board->posKey);
+	ASSERT(Board_GeneratePawnKey(board)==board->pawnKey);
 
 	ASSERT(board->enPas==NO_SQ || ( g_ranksBoard[board->enPas]==RANK_TYPE_6 && board->side == COLOR_TYPE_WHITE)
 		 || ( g_ranksBoard[board->enPas]==RANK_TYPE_3 && board->side == COLOR_TYPE_BLACK));
@@ -143,6 +173,12 @@ void Board_UpdateListsMaterial(ChessBoard *board) {
 		    if( PieceMaj[piece] == BOOL_TYPE_TRUE) board->majPce[colour]++;
 
 			board->material[colour] += g_pieceVal[piece];
+			board->pstMg[colour] += g_pstMg[piece][squareIndex];
+			board->pstEg[colour] += g_pstEg[piece][squareIndex];
+
+			BITBOARD_SET_BIT(board->pieceBB[piece],SQUARE_120_TO_64(squareIndex));
+			BITBOARD_SET_BIT(board->occupied[colour],SQUARE_120_TO_64(squareIndex));
+			BITBOARD_SET_BIT(board->occupied[COLOR_TYPE_BOTH],SQUARE_120_TO_64(squareIndex));
 
 			ASSERT(board->pieceCount[piece] < 10 && board->pieceCount[piece] >= 0);
 
@@ -260,15 +296,63 @@ int Board_ParseFromFEN(char *fen, ChessBoard *board) {
 		ASSERT(rank>=RANK_TYPE_1 && rank <= RANK_TYPE_8);
 
 		board->enPas = FILE_RANK_TO_SQUARE(file,rank);
+
+		// dropped when no pawn can take, matching Move_Make
+		if(!EP_CAPTURABLE(board, board->side == COLOR_TYPE_WHITE ? board->enPas - 10 : board->enPas + 10, board->side)) {
+			board->enPas = NO_SQ;
+		}
     }
 
 	board->posKey = Board_GeneratePositionKey(board);
 
 	Board_UpdateListsMaterial(board);
+	board->pawnKey = Board_GeneratePawnKey(board);
 
 	return 0;
 }
 
+void Board_Init(ChessBoard *board) {
+
+	board->history = (UndoMove *) calloc(CHESS_MAX_GAME_MOVES, sizeof(UndoMove));
+	board->tables = (SearchTables *) calloc(1, sizeof(SearchTables));
+	board->HashTable = NULL;
+	board->accumulator = NULL;
+
+	if(board->history == NULL || board->tables == NULL) {
+		printf("Board Allocation Failed\n");
+		exit(1);
+	}
+	Evaluate_ClearPawnHash(&board->tables->pawnHash);
+}
+
+void Board_Free(ChessBoard *board) {
+
+	free(board->history);
+	free(board->tables);
+	board->history = NULL;
+	board->tables = NULL;
+}
+
+void Board_Copy(ChessBoard *dest, const ChessBoard *src) {
+
+	UndoMove *history = dest->history;
+	SearchTables *tables = dest->tables;
+	int first = src->hisPly - src->fiftyMove;
+
+	ASSERT(history != NULL && tables != NULL);
+
+	*dest = *src;
+	dest->history = history;
+	dest->tables = tables;
+	// the source's accumulator lives in its own tables
+	dest->accumulator = NULL;
+
+	// older entries are never read: repetitions stop at the last
+	// irreversible move and a copy is never unwound past its root
+	if(first < 0) first = 0;
+	memcpy(&history[first], &src->history[first], (size_t)(src->hisPly - first) * sizeof(UndoMove));
+}
+
 void Board_Reset(ChessBoard *board) {
 
 	int index = 0;
@@ -286,10 +370,17 @@ void Board_Reset(ChessBoard *board) {
 		board->majPce[index] = 0;
 		board->minPce[index] = 0;
 		board->material[index] = 0;
+		board->pstMg[index] = 0;
+		board->pstEg[index] = 0;
 	}
 
 	for(index = 0; index < 3; ++index) {
 		board->pawns[index] = 0ULL;
+		board->occupied[index] = 0ULL;
+	}
+
+	for(index = 0; index < 13; ++index) {
+		board->pieceBB[index] = 0ULL;
 	}
 
 	for(index = 0; index < 13; ++index) {
@@ -304,18 +395,13 @@ void Board_Reset(ChessBoard *board) {
 
 	board->ply = 0;
 	board->hisPly = 0;
+	memset(board->repetitionFilter, 0, sizeof(board->repetitionFilter));
 
 	board->castlePerm = 0;
 
 	board->posKey = 0ULL;
-	
-	// Initialize captured pieces tracking
-	board->capturedWhiteCount = 0;
-	board->capturedBlackCount = 0;
-	for(index = 0; index < 16; ++index) {
-		board->capturedWhite[index] = EMPTY;
-		board->capturedBlack[index] = EMPTY;
-	}
+	board->pawnKey = 0ULL;
+	board->accumulator = NULL;
 
 }
 void Board_Print(const ChessBoard *board) {
@@ -389,6 +475,7 @@ void Board_Mirror(ChessBoard *board) {
     board->posKey = Board_GeneratePositionKey(board);
 
 	Board_UpdateListsMaterial(board);
+	board->pawnKey = Board_GeneratePawnKey(board);
 
     ASSERT(Board_Check(board));
 }
@@ -8,6 +8,7 @@
  * - Side values
  * - File and rank indices
  * - Move lists
+ * - FEN strings from files, before Board_ParseFromFEN sees them
  * 
  * Also includes debugging functions:
  * - Evaluation symmetry testing
@@ -47,6 +48,42 @@ int MoveListOk(const MoveList *list,  const ChessBoard *board) {
 	return BOOL_TYPE_TRUE;
 }
 
+int Board_IsValidFen(const char *fen) {
+
+	int ranks = 1;
+	int squares = 0;
+	int kings[2] = { 0, 0 };
+	const char *ptr = fen;
+
+	for(; *ptr != ' ' && *ptr != '\0'; ++ptr) {
+		if(*ptr == '/') {
+			if(squares != 8) return BOOL_TYPE_FALSE;
+			ranks++;
+			squares = 0;
+		} else if(*ptr >= '1' && *ptr <= '8') {
+			squares += *ptr - '0';
+		} else if(strchr("pnbrqkPNBRQK", *ptr) != NULL) {
+			squares++;
+			if(*ptr == 'K') kings[0]++;
+			if(*ptr == 'k') kings[1]++;
+		} else {
+			return BOOL_TYPE_FALSE;
+		}
+	}
+	if(ranks != 8 || squares != 8 || kings[0] != 1 || kings[1] != 1) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	if(ptr[0] != ' ' || (ptr[1] != 'w' && ptr[1] != 'b') || ptr[2] != ' ') {
+		return BOOL_TYPE_FALSE;
+	}
+	for(ptr += 3; *ptr != ' '; ++ptr) {
+		if(*ptr == '\0' || strchr("KQkq-", *ptr) == NULL) return BOOL_TYPE_FALSE;
+	}
+	ptr++;
+	return ptr[0] == '-' || (ptr[0] >= 'a' && ptr[0] <= 'h' && (ptr[1] == '3' || ptr[1] == '6'));
+}
+
 int SqIs120(const int squareIndex) {
 	return (squareIndex>=0 && squareIndex<120);
 }
@@ -81,7 +118,6 @@ void DebugAnalysisTest(ChessBoard *board, SearchInfo *info) {
     char lineIn [1024];
 
 	info->depth = CHESS_MAX_SEARCH_DEPTH;
-	info->timeset = BOOL_TYPE_TRUE;
 	int time = 1140000;
 
 
@@ -91,7 +127,7 @@ void DebugAnalysisTest(ChessBoard *board, SearchInfo *info) {
     }  else {
         while(fgets (lineIn , 1024 , file) != NULL) {
 			info->starttime = Misc_GetTimeMs();
-			info->stoptime = info->starttime + time;
+			Time_Allocate(info, -1, 0, 0, time);
 			HashTable_Clear(board->HashTable);
             Board_ParseFromFEN(lineIn, board);
             printf("\n%s\n",lineIn);
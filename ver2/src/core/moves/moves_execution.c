@@ -8,13 +8,18 @@
  * - En passant captures
  * - Pawn promotions
  * - Null moves (for null move pruning)
+ * - Child position key computation (for TT prefetching)
  * 
  * Key functions maintain board consistency by:
- * - Updating piece arrays and bitboards
+ * - Updating piece arrays and bitboards (pawns, per-piece and occupancy)
  * - Maintaining piece lists
- * - Updating material counts
- * - Recalculating hash keys
- * - Validating move legality (no self-check)
+ * - Updating material counts and piece-square sums
+ * - Updating the NNUE accumulator, pushed per ply on make and popped
+ *   on take without replaying the undo
+ * - Recalculating hash keys (position and pawn-only)
+ * - Counting history keys in the repetition filter
+ * - Validating move legality (no self-check); Move_MakeLegal skips the
+ *   test for moves the legal generator already vetted
  * 
  * @author Gambit Chess Team
  * @date February 2026
@@ -59,9 +64,17 @@ static void ClearPiece(const int squareIndex, ChessBoard *board) {
 	ASSERT(SideValid(color));
 	
     HASH_PCE(piece,squareIndex);
+	if(board->accumulator != NULL) {
+		Nnue_RemovePiece(board->accumulator, piece, squareIndex);
+	}
 	
 	board->pieces[squareIndex] = EMPTY;
     board->material[color] -= g_pieceVal[piece];
+	board->pstMg[color] -= g_pstMg[piece][squareIndex];
+	board->pstEg[color] -= g_pstEg[piece][squareIndex];
+	BITBOARD_CLEAR_BIT(board->pieceBB[piece],SQUARE_120_TO_64(squareIndex));
+	BITBOARD_CLEAR_BIT(board->occupied[color],SQUARE_120_TO_64(squareIndex));
+	BITBOARD_CLEAR_BIT(board->occupied[COLOR_TYPE_BOTH],SQUARE_120_TO_64(squareIndex));
 	
 	if(PieceBig[piece]) {
 			board->bigPce[color]--;
@@ -73,6 +86,7 @@ static void ClearPiece(const int squareIndex, ChessBoard *board) {
 	} else {
 		BITBOARD_CLEAR_BIT(board->pawns[color],SQUARE_120_TO_64(squareIndex));
 		BITBOARD_CLEAR_BIT(board->pawns[COLOR_TYPE_BOTH],SQUARE_120_TO_64(squareIndex));
+		board->pawnKey ^= g_pieceKeys[piece][squareIndex];
 	}
 	
 	for(index = 0; index < board->pieceCount[piece]; ++index) {
@@ -101,8 +115,14 @@ static void AddPiece(const int squareIndex, ChessBoard *board, const int piece)
 	ASSERT(SideValid(color));
 
     HASH_PCE(piece,squareIndex);
+	if(board->accumulator != NULL) {
+		Nnue_AddPiece(board->accumulator, piece, squareIndex);
+	}
 	
 	board->pieces[squareIndex] = piece;
+	BITBOARD_SET_BIT(board->pieceBB[piece],SQUARE_120_TO_64(squareIndex));
+	BITBOARD_SET_BIT(board->occupied[color],SQUARE_120_TO_64(squareIndex));
+	BITBOARD_SET_BIT(board->occupied[COLOR_TYPE_BOTH],SQUARE_120_TO_64(squareIndex));
 
     if(PieceBig[piece]) {
 			board->bigPce[color]++;
@@ -114,9 +134,12 @@ static void AddPiece(const int squareIndex, ChessBoard *board, const int piece)
 	} else {
 		BITBOARD_SET_BIT(board->pawns[color],SQUARE_120_TO_64(squareIndex));
 		BITBOARD_SET_BIT(board->pawns[COLOR_TYPE_BOTH],SQUARE_120_TO_64(squareIndex));
+		board->pawnKey ^= g_pieceKeys[piece][squareIndex];
 	}
 	
 	board->material[color] += g_pieceVal[piece];
+	board->pstMg[color] += g_pstMg[piece][squareIndex];
+	board->pstEg[color] += g_pstEg[piece][squareIndex];
 	board->pList[piece][board->pieceCount[piece]++] = squareIndex;
 	
 }
@@ -141,12 +164,27 @@ static void MovePiece(const int from, const int to, ChessBoard *board) {
 	
 	HASH_PCE(piece,to);
 	board->pieces[to] = piece;
+
+	if(board->accumulator != NULL) {
+		Nnue_MovePiece(board->accumulator, piece, from, to);
+	}
+
+	BITBOARD_CLEAR_BIT(board->pieceBB[piece],SQUARE_120_TO_64(from));
+	BITBOARD_SET_BIT(board->pieceBB[piece],SQUARE_120_TO_64(to));
+	BITBOARD_CLEAR_BIT(board->occupied[color],SQUARE_120_TO_64(from));
+	BITBOARD_CLEAR_BIT(board->occupied[COLOR_TYPE_BOTH],SQUARE_120_TO_64(from));
+	BITBOARD_SET_BIT(board->occupied[color],SQUARE_120_TO_64(to));
+	BITBOARD_SET_BIT(board->occupied[COLOR_TYPE_BOTH],SQUARE_120_TO_64(to));
+
+	board->pstMg[color] += g_pstMg[piece][to] - g_pstMg[piece][from];
+	board->pstEg[color] += g_pstEg[piece][to] - g_pstEg[piece][from];
 	
 	if(!PieceBig[piece]) {
 		BITBOARD_CLEAR_BIT(board->pawns[color],SQUARE_120_TO_64(from));
 		BITBOARD_CLEAR_BIT(board->pawns[COLOR_TYPE_BOTH],SQUARE_120_TO_64(from));
 		BITBOARD_SET_BIT(board->pawns[color],SQUARE_120_TO_64(to));
 		BITBOARD_SET_BIT(board->pawns[COLOR_TYPE_BOTH],SQUARE_120_TO_64(to));		
+		board->pawnKey ^= g_pieceKeys[piece][from] ^ g_pieceKeys[piece][to];
 	}    
 	
 	for(index = 0; index < board->pieceCount[piece]; ++index) {
@@ -161,7 +199,57 @@ static void MovePiece(const int from, const int to, ChessBoard *board) {
 	ASSERT(t_PieceNum);
 }
 
-int Move_Make(ChessBoard *board, int move) {
+U64 Move_ChildKey(const ChessBoard *board, const int move) {
+
+	int from = MOVE_GET_FROM_SQUARE(move);
+	int to = MOVE_GET_TO_SQUARE(move);
+	int piece = board->pieces[from];
+	int captured = MOVE_GET_CAPTURED(move);
+	int promotedPiece = MOVE_GET_PROMOTED(move);
+	int castlePerm = board->castlePerm & CastlePerm[from] & CastlePerm[to];
+	U64 key = board->posKey ^ g_sideKey;
+
+	ASSERT(SqOnBoard(from));
+	ASSERT(SqOnBoard(to));
+	ASSERT(PieceValid(piece));
+
+	if(board->enPas != NO_SQ) key ^= g_pieceKeys[EMPTY][board->enPas];
+	key ^= g_castleKeys[board->castlePerm] ^ g_castleKeys[castlePerm];
+
+	if(move & MFLAGEP) {
+		if(board->side == COLOR_TYPE_WHITE) {
+			key ^= g_pieceKeys[PIECE_TYPE_BLACK_PAWN][to-10];
+		} else {
+			key ^= g_pieceKeys[PIECE_TYPE_WHITE_PAWN][to+10];
+		}
+	} else if(move & MFLAGCA) {
+		int rook = board->side == COLOR_TYPE_WHITE ? PIECE_TYPE_WHITE_ROOK : PIECE_TYPE_BLACK_ROOK;
+		switch(to) {
+			case C1: key ^= g_pieceKeys[rook][A1] ^ g_pieceKeys[rook][D1]; break;
+			case C8: key ^= g_pieceKeys[rook][A8] ^ g_pieceKeys[rook][D8]; break;
+			case G1: key ^= g_pieceKeys[rook][H1] ^ g_pieceKeys[rook][F1]; break;
+			case G8: key ^= g_pieceKeys[rook][H8] ^ g_pieceKeys[rook][F8]; break;
+			default: ASSERT(BOOL_TYPE_FALSE); break;
+		}
+	}
+
+	if(captured != EMPTY) {
+		key ^= g_pieceKeys[captured][to];
+	}
+
+	if((move & MFLAGPS) && EP_CAPTURABLE(board, to, board->side ^ 1)) {
+		key ^= g_pieceKeys[EMPTY][board->side == COLOR_TYPE_WHITE ? from+10 : from-10];
+	}
+
+	key ^= g_pieceKeys[piece][from];
+	key ^= g_pieceKeys[promotedPiece != EMPTY ? promotedPiece : piece][to];
+
+	return key;
+}
+
+// shared by Move_Make and Move_MakeLegal; checkLegal is a compile-time
+// constant at both call sites
+static inline int MakeMove(ChessBoard *board, int move, const int checkLegal) {
 
 	ASSERT(Board_Check(board));
 	
@@ -177,6 +265,13 @@ int Move_Make(ChessBoard *board, int move) {
 	ASSERT(board->ply >= 0 && board->ply < CHESS_MAX_SEARCH_DEPTH);
 	
 	board->history[board->hisPly].posKey = board->posKey;
+	board->repetitionFilter[REPETITION_INDEX(board->posKey)]++;
+	if(board->accumulator != NULL) {
+		Nnue_Push(board);
+	}
+#ifdef DEBUG
+	U64 childKey = Move_ChildKey(board, move);
+#endif
 	
 	if(move & MFLAGEP) {
         if(side == COLOR_TYPE_WHITE) {
@@ -223,19 +318,6 @@ int Move_Make(ChessBoard *board, int move) {
         ASSERT(PieceValid(captured));
         ClearPiece(to, board);
         board->fiftyMove = 0;
-        
-        // Track captured piece
-        if(captured >= PIECE_TYPE_WHITE_PAWN && captured <= PIECE_TYPE_WHITE_KING) {
-            // White piece captured
-            if(board->capturedWhiteCount < 16) {
-                board->capturedWhite[board->capturedWhiteCount++] = captured;
-            }
-        } else if(captured >= PIECE_TYPE_BLACK_PAWN && captured <= PIECE_TYPE_BLACK_KING) {
-            // Black piece captured
-            if(board->capturedBlackCount < 16) {
-                board->capturedBlack[board->capturedBlackCount++] = captured;
-            }
-        }
     }
 	
 	board->hisPly++;
@@ -246,7 +328,9 @@ int Move_Make(ChessBoard *board, int move) {
 	
 	if(g_piecePawn[board->pieces[from]]) {
         board->fiftyMove = 0;
-        if(move & MFLAGPS) {
+        // as in Polyglot keys, the square is only set when an enemy pawn
+        // stands ready to take, so posKey is the Polyglot key
+        if((move & MFLAGPS) && EP_CAPTURABLE(board, to, side ^ 1)) {
             if(side==COLOR_TYPE_WHITE) {
                 board->enPas=from+10;
                 ASSERT(g_ranksBoard[board->enPas]==RANK_TYPE_3);
@@ -275,20 +359,42 @@ int Move_Make(ChessBoard *board, int move) {
     HASH_SIDE;
 
     ASSERT(Board_Check(board));
+	ASSERT(board->posKey == childKey);
 	
 		
-	if(Attack_IsSquareAttacked(board->KingSq[side],board->side,board))  {
+	if(checkLegal && Attack_IsSquareAttacked(board->KingSq[side],board->side,board))  {
         Move_Take(board);
         return BOOL_TYPE_FALSE;
     }
+	ASSERT(!Attack_IsSquareAttacked(board->KingSq[side],board->side,board));
 	
 	return BOOL_TYPE_TRUE;
 	
 }
 
+int Move_Make(ChessBoard *board, int move) {
+	int legal;
+	PROFILE_BEGIN(PROFILE_MAKE_MOVE);
+	legal = MakeMove(board, move, BOOL_TYPE_TRUE);
+	PROFILE_END(PROFILE_MAKE_MOVE);
+	return legal;
+}
+
+void Move_MakeLegal(ChessBoard *board, int move) {
+	PROFILE_BEGIN(PROFILE_MAKE_MOVE);
+	MakeMove(board, move, BOOL_TYPE_FALSE);
+	PROFILE_END(PROFILE_MAKE_MOVE);
+}
+
 void Move_Take(ChessBoard *board) {
 	
 	ASSERT(Board_Check(board));
+	PROFILE_BEGIN(PROFILE_TAKE_MOVE);
+
+	// the parent's accumulator is intact one entry down, so the piece
+	// helpers below must not touch either
+	NnueAccumulator *accumulator = board->accumulator;
+	board->accumulator = NULL;
 	
 	board->hisPly--;
     board->ply--;
@@ -299,6 +405,8 @@ void Move_Take(ChessBoard *board) {
     int move = board->history[board->hisPly].move;
     int from = MOVE_GET_FROM_SQUARE(move);
     int to = MOVE_GET_TO_SQUARE(move);	
+
+	board->repetitionFilter[REPETITION_INDEX(board->history[board->hisPly].posKey)]--;
 	
 	ASSERT(SqOnBoard(from));
     ASSERT(SqOnBoard(to));
@@ -342,19 +450,6 @@ void Move_Take(ChessBoard *board) {
     if(captured != EMPTY) {
         ASSERT(PieceValid(captured));
         AddPiece(to, board, captured);
-        
-        // Remove from captured pieces list
-        if(captured >= PIECE_TYPE_WHITE_PAWN && captured <= PIECE_TYPE_WHITE_KING) {
-            // White piece was captured, remove it from list
-            if(board->capturedWhiteCount > 0) {
-                board->capturedWhiteCount--;
-            }
-        } else if(captured >= PIECE_TYPE_BLACK_PAWN && captured <= PIECE_TYPE_BLACK_KING) {
-            // Black piece was captured, remove it from list
-            if(board->capturedBlackCount > 0) {
-                board->capturedBlackCount--;
-            }
-        }
     }
 	
 	if(MOVE_GET_PROMOTED(move) != EMPTY)   {
@@ -362,6 +457,11 @@ void Move_Take(ChessBoard *board) {
         ClearPiece(from, board);
         AddPiece(from, board, (g_pieceCol[MOVE_GET_PROMOTED(move)] == COLOR_TYPE_WHITE ? PIECE_TYPE_WHITE_PAWN : PIECE_TYPE_BLACK_PAWN));
     }
+
+	if(accumulator != NULL && accumulator > board->tables->accumulators) {
+		board->accumulator = accumulator - 1;
+	}
+	PROFILE_END(PROFILE_TAKE_MOVE);
 	
     ASSERT(Board_Check(board));
 
@@ -375,6 +475,7 @@ void MakeNullMove(ChessBoard *board) {
 
     board->ply++;
     board->history[board->hisPly].posKey = board->posKey;
+    board->repetitionFilter[REPETITION_INDEX(board->posKey)]++;
 
     if(board->enPas != NO_SQ) HASH_EP;
 
@@ -401,6 +502,8 @@ void TakeNullMove(ChessBoard *board) {
     board->hisPly--;
     board->ply--;
 
+    board->repetitionFilter[REPETITION_INDEX(board->history[board->hisPly].posKey)]--;
+
     if(board->enPas != NO_SQ) HASH_EP;
 
     board->castlePerm = board->history[board->hisPly].castlePerm;
@@ -5,17 +5,21 @@
  * Generates all pseudo-legal moves for a given position.
  * Includes specialized generation for:
  * - Pawn moves (including double pushes, promotions, en passant)
- * - Knight moves
- * - Sliding piece moves (bishops, rooks, queens)
- * - King moves (including castling)
+ * - Knight, sliding piece (bishops, rooks, queens) and king moves, read
+ *   from the attack tables and split into captures and quiets with the
+ *   occupancy bitboards
+ * - Castling
  * 
  * Also implements:
- * - Capture-only move generation (for quiescence search)
+ * - Capture-only and quiet-only generation (for the staged move picker)
  * - Move ordering using MVV-LVA (Most Valuable Victim - Least Valuable Attacker)
- * - Move validation
+ * - Move validation (MoveExists, the cheap Move_IsPseudoLegal and the
+ *   bitboard king-safety test behind Move_IsLegal)
  * 
- * Note: Generated moves are pseudo-legal and must be validated
- * with Move_Make() to ensure they don't leave the king in check.
+ * Move_GenerateAll and friends produce pseudo-legal moves that must be
+ * validated with Move_Make(). The Move_GenerateLegal variants compute
+ * checkers and pins once per position and emit only legal moves, which
+ * can be played with Move_MakeLegal().
  * 
  * @author Gambit Chess Team
  * @date February 2026
@@ -29,36 +33,12 @@
 #define MOVE(f,t,ca,pro,fl) ( (f) | ((t) << 7) | ( (ca) << 14 ) | ( (pro) << 20 ) | (fl))
 #define SQOFFBOARD(squareIndex) (g_filesBoard[(squareIndex)]==OFFBOARD)
 
-const int LoopSlidePce[8] = {
- PIECE_TYPE_WHITE_BISHOP, PIECE_TYPE_WHITE_ROOK, PIECE_TYPE_WHITE_QUEEN, 0, PIECE_TYPE_BLACK_BISHOP, PIECE_TYPE_BLACK_ROOK, PIECE_TYPE_BLACK_QUEEN, 0
+const int LoopPieceType[12] = {
+ PIECE_TYPE_WHITE_KNIGHT, PIECE_TYPE_WHITE_BISHOP, PIECE_TYPE_WHITE_ROOK, PIECE_TYPE_WHITE_QUEEN, PIECE_TYPE_WHITE_KING, 0,
+ PIECE_TYPE_BLACK_KNIGHT, PIECE_TYPE_BLACK_BISHOP, PIECE_TYPE_BLACK_ROOK, PIECE_TYPE_BLACK_QUEEN, PIECE_TYPE_BLACK_KING, 0
 };
 
-const int LoopNonSlidePce[6] = {
- PIECE_TYPE_WHITE_KNIGHT, PIECE_TYPE_WHITE_KING, 0, PIECE_TYPE_BLACK_KNIGHT, PIECE_TYPE_BLACK_KING, 0
-};
-
-const int LoopSlideIndex[2] = { 0, 4 };
-const int LoopNonSlideIndex[2] = { 0, 3 };
-
-const int PceDir[13][8] = {
-	{ 0, 0, 0, 0, 0, 0, 0 },
-	{ 0, 0, 0, 0, 0, 0, 0 },
-	{ -8, -19,	-21, -12, 8, 19, 21, 12 },
-	{ -9, -11, 11, 9, 0, 0, 0, 0 },
-	{ -1, -10,	1, 10, 0, 0, 0, 0 },
-	{ -1, -10,	1, 10, -9, -11, 11, 9 },
-	{ -1, -10,	1, 10, -9, -11, 11, 9 },
-	{ 0, 0, 0, 0, 0, 0, 0 },
-	{ -8, -19,	-21, -12, 8, 19, 21, 12 },
-	{ -9, -11, 11, 9, 0, 0, 0, 0 },
-	{ -1, -10,	1, 10, 0, 0, 0, 0 },
-	{ -1, -10,	1, 10, -9, -11, 11, 9 },
-	{ -1, -10,	1, 10, -9, -11, 11, 9 }
-};
-
-const int NumDir[13] = {
- 0, 0, 8, 4, 4, 8, 8, 0, 8, 4, 4, 8, 8
-};
+const int LoopPieceIndex[2] = { 0, 6 };
 
 /*
 PV Move
@@ -67,31 +47,28 @@ Killers
 HistoryScore
 
 */
-const int VictimScore[13] = { 0, 100, 200, 300, 400, 500, 600, 100, 200, 300, 400, 500, 600 };
-static int MvvLvaScores[13][13];
-
-void Init_MvvLva() {
-	int Attacker;
-	int Victim;
-	for(Attacker = PIECE_TYPE_WHITE_PAWN; Attacker <= PIECE_TYPE_BLACK_KING; ++Attacker) {
-		for(Victim = PIECE_TYPE_WHITE_PAWN; Victim <= PIECE_TYPE_BLACK_KING; ++Victim) {
-			MvvLvaScores[Victim][Attacker] = VictimScore[Victim] + 6 - ( VictimScore[Attacker] / 100);
-		}
+// attack set of a knight, bishop, rook, queen or king on sq64
+static inline U64 PieceAttacks(const int piece, const int sq64, const U64 occupied) {
+
+	if(PIECE_IS_KNIGHT(piece)) {
+		return g_knightAttacks[sq64];
+	}
+	if(PIECE_IS_KING(piece)) {
+		return g_kingAttacks[sq64];
+	}
+	if(PIECE_IS_ROOK_QUEEN(piece)) {
+		return PIECE_IS_BISHOP_QUEEN(piece) ? QUEEN_ATTACKS(sq64, occupied) : ROOK_ATTACKS(sq64, occupied);
 	}
+	return BISHOP_ATTACKS(sq64, occupied);
 }
 
 int MoveExists(ChessBoard *board, const int move) {
 
 	MoveList list[1];
-    Move_GenerateAll(board,list);
+    Move_GenerateLegal(board,list);
 
     int MoveNum = 0;
 	for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {
-
-        if ( !Move_Make(board,list->moves[MoveNum].move))  {
-            continue;
-        }
-        Move_Take(board);
 		if(list->moves[MoveNum].move == move) {
 			return BOOL_TYPE_TRUE;
 		}
@@ -99,6 +76,152 @@ int MoveExists(ChessBoard *board, const int move) {
 	return BOOL_TYPE_FALSE;
 }
 
+static int PawnMoveIsPseudoLegal(const ChessBoard *board, const int from, const int to, const int move) {
+
+	int side = board->side;
+	int forward = (side == COLOR_TYPE_WHITE) ? 10 : -10;
+	int startRank = (side == COLOR_TYPE_WHITE) ? RANK_TYPE_2 : RANK_TYPE_7;
+	int lastRank = (side == COLOR_TYPE_WHITE) ? RANK_TYPE_8 : RANK_TYPE_1;
+	int captured = MOVE_GET_CAPTURED(move);
+	int promoted = MOVE_GET_PROMOTED(move);
+
+	if(move & MFLAGCA) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	// promotions must happen exactly on the last rank
+	if((g_ranksBoard[to] == lastRank) != (promoted != EMPTY)) {
+		return BOOL_TYPE_FALSE;
+	}
+	if(promoted != EMPTY && (g_pieceCol[promoted] != side || g_piecePawn[promoted] || PIECE_IS_KING(promoted))) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	if(to == from + forward - 1 || to == from + forward + 1) {
+		if(move & MFLAGEP) {
+			return to == board->enPas;
+		}
+		return captured != EMPTY && g_pieceCol[captured] == (side ^ 1);
+	}
+
+	if((move & MFLAGEP) || captured != EMPTY) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	if(to == from + forward) {
+		return board->pieces[to] == EMPTY && !(move & MFLAGPS);
+	}
+
+	if(to == from + 2 * forward) {
+		return (move & MFLAGPS) && g_ranksBoard[from] == startRank
+			&& board->pieces[from + forward] == EMPTY && board->pieces[to] == EMPTY;
+	}
+
+	return BOOL_TYPE_FALSE;
+}
+
+static int CastleIsPseudoLegal(const ChessBoard *board, const int from, const int to) {
+
+	if(board->side == COLOR_TYPE_WHITE) {
+		if(from != E1) return BOOL_TYPE_FALSE;
+		if(to == G1) {
+			return (board->castlePerm & CASTLE_TYPE_WKCA) && board->pieces[F1] == EMPTY && board->pieces[G1] == EMPTY
+				&& !Attack_IsSquareAttacked(E1,COLOR_TYPE_BLACK,board) && !Attack_IsSquareAttacked(F1,COLOR_TYPE_BLACK,board);
+		}
+		if(to == C1) {
+			return (board->castlePerm & CASTLE_TYPE_WQCA) && board->pieces[D1] == EMPTY && board->pieces[C1] == EMPTY && board->pieces[B1] == EMPTY
+				&& !Attack_IsSquareAttacked(E1,COLOR_TYPE_BLACK,board) && !Attack_IsSquareAttacked(D1,COLOR_TYPE_BLACK,board);
+		}
+	} else {
+		if(from != E8) return BOOL_TYPE_FALSE;
+		if(to == G8) {
+			return (board->castlePerm & CASTLE_TYPE_BKCA) && board->pieces[F8] == EMPTY && board->pieces[G8] == EMPTY
+				&& !Attack_IsSquareAttacked(E8,COLOR_TYPE_WHITE,board) && !Attack_IsSquareAttacked(F8,COLOR_TYPE_WHITE,board);
+		}
+		if(to == C8) {
+			return (board->castlePerm & CASTLE_TYPE_BQCA) && board->pieces[D8] == EMPTY && board->pieces[C8] == EMPTY && board->pieces[B8] == EMPTY
+				&& !Attack_IsSquareAttacked(E8,COLOR_TYPE_WHITE,board) && !Attack_IsSquareAttacked(D8,COLOR_TYPE_WHITE,board);
+		}
+	}
+	return BOOL_TYPE_FALSE;
+}
+
+int Move_IsPseudoLegal(const ChessBoard *board, const int move) {
+
+	ASSERT(Board_Check(board));
+
+	if(move == NOMOVE) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	int from = MOVE_GET_FROM_SQUARE(move);
+	int to = MOVE_GET_TO_SQUARE(move);
+
+	if(!SqIs120(from) || !SqIs120(to) || SQOFFBOARD(from) || SQOFFBOARD(to)) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	int piece = board->pieces[from];
+
+	if(piece == EMPTY || g_pieceCol[piece] != board->side) {
+		return BOOL_TYPE_FALSE;
+	}
+	if(board->pieces[to] != MOVE_GET_CAPTURED(move)) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	if(g_piecePawn[piece]) {
+		return PawnMoveIsPseudoLegal(board, from, to, move);
+	}
+
+	if(move & (MFLAGEP | MFLAGPS | MFLAGPROM)) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	if(move & MFLAGCA) {
+		return PIECE_IS_KING(piece) && CastleIsPseudoLegal(board, from, to);
+	}
+
+	if(MOVE_GET_CAPTURED(move) != EMPTY && g_pieceCol[MOVE_GET_CAPTURED(move)] != (board->side ^ 1)) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	return (PieceAttacks(piece, SQUARE_120_TO_64(from), board->occupied[COLOR_TYPE_BOTH]) >> SQUARE_120_TO_64(to)) & 1ULL;
+}
+
+// true if the side to move's king is not attacked once the pseudo-legal
+// move is played, tested on bitboards without touching the board
+static int KingSafeAfter(const ChessBoard *board, const int move) {
+
+	int side = board->side;
+	int base = side == COLOR_TYPE_WHITE ? PIECE_TYPE_BLACK_PAWN : PIECE_TYPE_WHITE_PAWN;
+	int from64 = SQUARE_120_TO_64(MOVE_GET_FROM_SQUARE(move));
+	int to64 = SQUARE_120_TO_64(MOVE_GET_TO_SQUARE(move));
+	int king64 = PIECE_IS_KING(board->pieces[MOVE_GET_FROM_SQUARE(move)]) ? to64 : SQUARE_120_TO_64(board->KingSq[side]);
+	const U64 *bb = board->pieceBB;
+	U64 removed = 1ULL << to64;
+	U64 occupied = board->occupied[COLOR_TYPE_BOTH];
+	U64 attackers = 0ULL;
+
+	if(move & MFLAGEP) {
+		removed = 1ULL << (side == COLOR_TYPE_WHITE ? to64 - 8 : to64 + 8);
+		occupied ^= removed;
+	}
+	occupied = (occupied ^ (1ULL << from64)) | (1ULL << to64);
+
+	attackers = (g_pawnAttacks[side][king64] & bb[base + PIECE_KIND_PAWN])
+		| (g_knightAttacks[king64] & bb[base + PIECE_KIND_KNIGHT])
+		| (g_kingAttacks[king64] & bb[base + PIECE_KIND_KING])
+		| (BISHOP_ATTACKS(king64, occupied) & (bb[base + PIECE_KIND_BISHOP] | bb[base + PIECE_KIND_QUEEN]))
+		| (ROOK_ATTACKS(king64, occupied) & (bb[base + PIECE_KIND_ROOK] | bb[base + PIECE_KIND_QUEEN]));
+
+	return !(attackers & ~removed);
+}
+
+int Move_IsLegal(const ChessBoard *board, const int move) {
+	return Move_IsPseudoLegal(board, move) && KingSafeAfter(board, move);
+}
+
 static void AddQuietMove( const ChessBoard *board, int move, MoveList *list ) {
 
 	ASSERT(SqOnBoard(MOVE_GET_FROM_SQUARE(move)));
@@ -106,15 +229,10 @@ static void AddQuietMove( const ChessBoard *board, int move, MoveList *list ) {
 	ASSERT(Board_Check(board));
 	ASSERT(board->ply >=0 && board->ply < CHESS_MAX_SEARCH_DEPTH);
 
+	// killers are handed out by the picker's own stage, so quiets are
+	// ordered by history alone
 	list->moves[list->count].move = move;
-
-	if(board->searchKillers[0][board->ply] == move) {
-		list->moves[list->count].score = 900000;
-	} else if(board->searchKillers[1][board->ply] == move) {
-		list->moves[list->count].score = 800000;
-	} else {
-		list->moves[list->count].score = board->searchHistory[board->pieces[MOVE_GET_FROM_SQUARE(move)]][MOVE_GET_TO_SQUARE(move)];
-	}
+	list->moves[list->count].score = board->tables->searchHistory[board->pieces[MOVE_GET_FROM_SQUARE(move)]][SQUARE_120_TO_64(MOVE_GET_TO_SQUARE(move))];
 	list->count++;
 }
 
@@ -126,7 +244,7 @@ static void AddCaptureMove( const ChessBoard *board, int move, MoveList *list )
 	ASSERT(Board_Check(board));
 
 	list->moves[list->count].move = move;
-	list->moves[list->count].score = MvvLvaScores[MOVE_GET_CAPTURED(move)][board->pieces[MOVE_GET_FROM_SQUARE(move)]] + 1000000;
+	list->moves[list->count].score = g_mvvLvaScores[MOVE_GET_CAPTURED(move)][board->pieces[MOVE_GET_FROM_SQUARE(move)]] + 1000000;
 	list->count++;
 }
 
@@ -208,7 +326,15 @@ static void AddBlackPawnMove( const ChessBoard *board, const int from, const int
 	}
 }
 
-void Move_GenerateAll(const ChessBoard *board, MoveList *list) {
+// destination test for the legal generator: inside the check evasion
+// target and, for a pinned piece, on its pin ray
+#define LEGAL_TO(from,to) (!legal || ((evasion & g_bitSetMask[SQUARE_120_TO_64(to)]) \
+	&& (!(pinned & g_bitSetMask[SQUARE_120_TO_64(from)]) || (g_lineMask[king64][SQUARE_120_TO_64(from)] & g_bitSetMask[SQUARE_120_TO_64(to)]))))
+
+// shared generator for the full, capture-only and quiet-only lists,
+// pseudo-legal or legal; the flags are compile-time constants at every
+// call site so each wrapper gets its own branch-free copy
+static inline void GenerateMoves(const ChessBoard *board, MoveList *list, const int captures, const int quiets, const int legal) {
 
 	ASSERT(Board_Check(board));
 
@@ -218,9 +344,49 @@ void Move_GenerateAll(const ChessBoard *board, MoveList *list) {
 	int side = board->side;
 	int squareIndex = 0; int t_sq = 0;
 	int pieceCount = 0;
-	int direction = 0;
-	int index = 0;
 	int pceIndex = 0;
+	U64 attacks = 0ULL;
+	U64 targets = 0ULL;
+	U64 evasion = ~0ULL;
+	U64 pinned = 0ULL;
+	U64 checkers = 0ULL;
+	U64 snipers = 0ULL;
+	U64 blockers = 0ULL;
+	int king64 = SQUARE_120_TO_64(board->KingSq[side]);
+
+	if(legal) {
+		int base = side == COLOR_TYPE_WHITE ? PIECE_TYPE_BLACK_PAWN : PIECE_TYPE_WHITE_PAWN;
+		const U64 *bb = board->pieceBB;
+		U64 diagonal = bb[base + PIECE_KIND_BISHOP] | bb[base + PIECE_KIND_QUEEN];
+		U64 straight = bb[base + PIECE_KIND_ROOK] | bb[base + PIECE_KIND_QUEEN];
+
+		checkers = (g_pawnAttacks[side][king64] & bb[base + PIECE_KIND_PAWN])
+			| (g_knightAttacks[king64] & bb[base + PIECE_KIND_KNIGHT]);
+
+		// enemy sliders seeing the king through own pieces: with nothing
+		// in between they give check, with one own piece it is pinned
+		snipers = (BISHOP_ATTACKS(king64, board->occupied[side ^ 1]) & diagonal)
+			| (ROOK_ATTACKS(king64, board->occupied[side ^ 1]) & straight);
+		while(snipers) {
+			int sniper = BITBOARD_POP(&snipers);
+			blockers = g_betweenMask[king64][sniper] & board->occupied[COLOR_TYPE_BOTH];
+			if(!blockers) {
+				checkers |= g_bitSetMask[sniper];
+			} else if(!(blockers & (blockers - 1)) && (blockers & board->occupied[side])) {
+				pinned |= blockers;
+			}
+		}
+
+		if(checkers) {
+			// double check leaves only king moves (tested separately)
+			if(checkers & (checkers - 1)) {
+				evasion = 0ULL;
+			} else {
+				evasion = checkers;
+				evasion |= g_betweenMask[king64][BITBOARD_POP(&checkers)];
+			}
+		}
+	}
 
 	if(side == COLOR_TYPE_WHITE) {
 
@@ -228,41 +394,45 @@ void Move_GenerateAll(const ChessBoard *board, MoveList *list) {
 			squareIndex = board->pList[PIECE_TYPE_WHITE_PAWN][pieceCount];
 			ASSERT(SqOnBoard(squareIndex));
 
-			if(board->pieces[squareIndex + 10] == EMPTY) {
-				AddWhitePawnMove(board, squareIndex, squareIndex+10, list);
-				if(g_ranksBoard[squareIndex] == RANK_TYPE_2 && board->pieces[squareIndex + 20] == EMPTY) {
+			if(quiets && board->pieces[squareIndex + 10] == EMPTY) {
+				if(LEGAL_TO(squareIndex, squareIndex+10)) {
+					AddWhitePawnMove(board, squareIndex, squareIndex+10, list);
+				}
+				if(g_ranksBoard[squareIndex] == RANK_TYPE_2 && board->pieces[squareIndex + 20] == EMPTY && LEGAL_TO(squareIndex, squareIndex+20)) {
 					AddQuietMove(board, MOVE(squareIndex,(squareIndex+20),EMPTY,EMPTY,MFLAGPS),list);
 				}
 			}
 
-			if(!SQOFFBOARD(squareIndex + 9) && g_pieceCol[board->pieces[squareIndex + 9]] == COLOR_TYPE_BLACK) {
+			if(captures && !SQOFFBOARD(squareIndex + 9) && g_pieceCol[board->pieces[squareIndex + 9]] == COLOR_TYPE_BLACK && LEGAL_TO(squareIndex, squareIndex+9)) {
 				AddWhitePawnCapMove(board, squareIndex, squareIndex+9, board->pieces[squareIndex + 9], list);
 			}
-			if(!SQOFFBOARD(squareIndex + 11) && g_pieceCol[board->pieces[squareIndex + 11]] == COLOR_TYPE_BLACK) {
+			if(captures && !SQOFFBOARD(squareIndex + 11) && g_pieceCol[board->pieces[squareIndex + 11]] == COLOR_TYPE_BLACK && LEGAL_TO(squareIndex, squareIndex+11)) {
 				AddWhitePawnCapMove(board, squareIndex, squareIndex+11, board->pieces[squareIndex + 11], list);
 			}
 
-			if(board->enPas != NO_SQ) {
-				if(squareIndex + 9 == board->enPas) {
+			if(captures && board->enPas != NO_SQ) {
+				if(squareIndex + 9 == board->enPas && (!legal || KingSafeAfter(board, MOVE(squareIndex,squareIndex + 9,EMPTY,EMPTY,MFLAGEP)))) {
 					AddEnPassantMove(board, MOVE(squareIndex,squareIndex + 9,EMPTY,EMPTY,MFLAGEP), list);
 				}
-				if(squareIndex + 11 == board->enPas) {
+				if(squareIndex + 11 == board->enPas && (!legal || KingSafeAfter(board, MOVE(squareIndex,squareIndex + 11,EMPTY,EMPTY,MFLAGEP)))) {
 					AddEnPassantMove(board, MOVE(squareIndex,squareIndex + 11,EMPTY,EMPTY,MFLAGEP), list);
 				}
 			}
 		}
 
-		if(board->castlePerm & CASTLE_TYPE_WKCA) {
+		if(quiets && (board->castlePerm & CASTLE_TYPE_WKCA)) {
 			if(board->pieces[F1] == EMPTY && board->pieces[G1] == EMPTY) {
-				if(!Attack_IsSquareAttacked(E1,COLOR_TYPE_BLACK,board) && !Attack_IsSquareAttacked(F1,COLOR_TYPE_BLACK,board) ) {
+				if(!Attack_IsSquareAttacked(E1,COLOR_TYPE_BLACK,board) && !Attack_IsSquareAttacked(F1,COLOR_TYPE_BLACK,board)
+					&& (!legal || !Attack_IsSquareAttacked(G1,COLOR_TYPE_BLACK,board)) ) {
 					AddQuietMove(board, MOVE(E1, G1, EMPTY, EMPTY, MFLAGCA), list);
 				}
 			}
 		}
 
-		if(board->castlePerm & CASTLE_TYPE_WQCA) {
+		if(quiets && (board->castlePerm & CASTLE_TYPE_WQCA)) {
 			if(board->pieces[D1] == EMPTY && board->pieces[C1] == EMPTY && board->pieces[B1] == EMPTY) {
-				if(!Attack_IsSquareAttacked(E1,COLOR_TYPE_BLACK,board) && !Attack_IsSquareAttacked(D1,COLOR_TYPE_BLACK,board) ) {
+				if(!Attack_IsSquareAttacked(E1,COLOR_TYPE_BLACK,board) && !Attack_IsSquareAttacked(D1,COLOR_TYPE_BLACK,board)
+					&& (!legal || !Attack_IsSquareAttacked(C1,COLOR_TYPE_BLACK,board)) ) {
 					AddQuietMove(board, MOVE(E1, C1, EMPTY, EMPTY, MFLAGCA), list);
 				}
 			}
@@ -274,51 +444,55 @@ void Move_GenerateAll(const ChessBoard *board, MoveList *list) {
 			squareIndex = board->pList[PIECE_TYPE_BLACK_PAWN][pieceCount];
 			ASSERT(SqOnBoard(squareIndex));
 
-			if(board->pieces[squareIndex - 10] == EMPTY) {
-				AddBlackPawnMove(board, squareIndex, squareIndex-10, list);
-				if(g_ranksBoard[squareIndex] == RANK_TYPE_7 && board->pieces[squareIndex - 20] == EMPTY) {
+			if(quiets && board->pieces[squareIndex - 10] == EMPTY) {
+				if(LEGAL_TO(squareIndex, squareIndex-10)) {
+					AddBlackPawnMove(board, squareIndex, squareIndex-10, list);
+				}
+				if(g_ranksBoard[squareIndex] == RANK_TYPE_7 && board->pieces[squareIndex - 20] == EMPTY && LEGAL_TO(squareIndex, squareIndex-20)) {
 					AddQuietMove(board, MOVE(squareIndex,(squareIndex-20),EMPTY,EMPTY,MFLAGPS),list);
 				}
 			}
 
-			if(!SQOFFBOARD(squareIndex - 9) && g_pieceCol[board->pieces[squareIndex - 9]] == COLOR_TYPE_WHITE) {
+			if(captures && !SQOFFBOARD(squareIndex - 9) && g_pieceCol[board->pieces[squareIndex - 9]] == COLOR_TYPE_WHITE && LEGAL_TO(squareIndex, squareIndex-9)) {
 				AddBlackPawnCapMove(board, squareIndex, squareIndex-9, board->pieces[squareIndex - 9], list);
 			}
 
-			if(!SQOFFBOARD(squareIndex - 11) && g_pieceCol[board->pieces[squareIndex - 11]] == COLOR_TYPE_WHITE) {
+			if(captures && !SQOFFBOARD(squareIndex - 11) && g_pieceCol[board->pieces[squareIndex - 11]] == COLOR_TYPE_WHITE && LEGAL_TO(squareIndex, squareIndex-11)) {
 				AddBlackPawnCapMove(board, squareIndex, squareIndex-11, board->pieces[squareIndex - 11], list);
 			}
-			if(board->enPas != NO_SQ) {
-				if(squareIndex - 9 == board->enPas) {
+			if(captures && board->enPas != NO_SQ) {
+				if(squareIndex - 9 == board->enPas && (!legal || KingSafeAfter(board, MOVE(squareIndex,squareIndex - 9,EMPTY,EMPTY,MFLAGEP)))) {
 					AddEnPassantMove(board, MOVE(squareIndex,squareIndex - 9,EMPTY,EMPTY,MFLAGEP), list);
 				}
-				if(squareIndex - 11 == board->enPas) {
+				if(squareIndex - 11 == board->enPas && (!legal || KingSafeAfter(board, MOVE(squareIndex,squareIndex - 11,EMPTY,EMPTY,MFLAGEP)))) {
 					AddEnPassantMove(board, MOVE(squareIndex,squareIndex - 11,EMPTY,EMPTY,MFLAGEP), list);
 				}
 			}
 		}
 
 		// castling
-		if(board->castlePerm &  CASTLE_TYPE_BKCA) {
+		if(quiets && (board->castlePerm &  CASTLE_TYPE_BKCA)) {
 			if(board->pieces[F8] == EMPTY && board->pieces[G8] == EMPTY) {
-				if(!Attack_IsSquareAttacked(E8,COLOR_TYPE_WHITE,board) && !Attack_IsSquareAttacked(F8,COLOR_TYPE_WHITE,board) ) {
+				if(!Attack_IsSquareAttacked(E8,COLOR_TYPE_WHITE,board) && !Attack_IsSquareAttacked(F8,COLOR_TYPE_WHITE,board)
+					&& (!legal || !Attack_IsSquareAttacked(G8,COLOR_TYPE_WHITE,board)) ) {
 					AddQuietMove(board, MOVE(E8, G8, EMPTY, EMPTY, MFLAGCA), list);
 				}
 			}
 		}
 
-		if(board->castlePerm &  CASTLE_TYPE_BQCA) {
+		if(quiets && (board->castlePerm &  CASTLE_TYPE_BQCA)) {
 			if(board->pieces[D8] == EMPTY && board->pieces[C8] == EMPTY && board->pieces[B8] == EMPTY) {
-				if(!Attack_IsSquareAttacked(E8,COLOR_TYPE_WHITE,board) && !Attack_IsSquareAttacked(D8,COLOR_TYPE_WHITE,board) ) {
+				if(!Attack_IsSquareAttacked(E8,COLOR_TYPE_WHITE,board) && !Attack_IsSquareAttacked(D8,COLOR_TYPE_WHITE,board)
+					&& (!legal || !Attack_IsSquareAttacked(C8,COLOR_TYPE_WHITE,board)) ) {
 					AddQuietMove(board, MOVE(E8, C8, EMPTY, EMPTY, MFLAGCA), list);
 				}
 			}
 		}
 	}
 
-	/* Loop for slide pieces */
-	pceIndex = LoopSlideIndex[side];
-	piece = LoopSlidePce[pceIndex++];
+	/* Loop for knights, sliders and king */
+	pceIndex = LoopPieceIndex[side];
+	piece = LoopPieceType[pceIndex++];
 	while( piece != 0) {
 		ASSERT(PieceValid(piece));
 
@@ -326,187 +500,84 @@ void Move_GenerateAll(const ChessBoard *board, MoveList *list) {
 			squareIndex = board->pList[piece][pieceCount];
 			ASSERT(SqOnBoard(squareIndex));
 
-			for(index = 0; index < NumDir[piece]; ++index) {
-				direction = PceDir[piece][index];
-				t_sq = squareIndex + direction;
+			attacks = PieceAttacks(piece, SQUARE_120_TO_64(squareIndex), board->occupied[COLOR_TYPE_BOTH]);
 
-				while(!SQOFFBOARD(t_sq)) {
-					// COLOR_TYPE_BLACK ^ 1 == COLOR_TYPE_WHITE       COLOR_TYPE_WHITE ^ 1 == COLOR_TYPE_BLACK
-					if(board->pieces[t_sq] != EMPTY) {
-						if( g_pieceCol[board->pieces[t_sq]] == (side ^ 1)) {
-							AddCaptureMove(board, MOVE(squareIndex, t_sq, board->pieces[t_sq], EMPTY, 0), list);
+			if(legal) {
+				if(PIECE_IS_KING(piece)) {
+					// keep only the squares the king can step to safely
+					targets = attacks & ~board->occupied[side];
+					while(targets) {
+						t_sq = BITBOARD_POP(&targets);
+						if(!KingSafeAfter(board, MOVE(squareIndex, SQUARE_64_TO_120(t_sq), EMPTY, EMPTY, 0))) {
+							attacks &= g_bitClearMask[t_sq];
 						}
-						break;
 					}
-					AddQuietMove(board, MOVE(squareIndex, t_sq, EMPTY, EMPTY, 0), list);
-					t_sq += direction;
+				} else {
+					attacks &= evasion;
+					if(pinned & g_bitSetMask[SQUARE_120_TO_64(squareIndex)]) {
+						attacks &= g_lineMask[king64][SQUARE_120_TO_64(squareIndex)];
+					}
 				}
 			}
-		}
-
-		piece = LoopSlidePce[pceIndex++];
-	}
-
-	/* Loop for non slide */
-	pceIndex = LoopNonSlideIndex[side];
-	piece = LoopNonSlidePce[pceIndex++];
-
-	while( piece != 0) {
-		ASSERT(PieceValid(piece));
-
-		for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-			squareIndex = board->pList[piece][pieceCount];
-			ASSERT(SqOnBoard(squareIndex));
 
-			for(index = 0; index < NumDir[piece]; ++index) {
-				direction = PceDir[piece][index];
-				t_sq = squareIndex + direction;
-
-				if(SQOFFBOARD(t_sq)) {
-					continue;
+			if(captures) {
+				targets = attacks & board->occupied[side ^ 1];
+				while(targets) {
+					t_sq = SQUARE_64_TO_120(BITBOARD_POP(&targets));
+					AddCaptureMove(board, MOVE(squareIndex, t_sq, board->pieces[t_sq], EMPTY, 0), list);
 				}
-
-				// COLOR_TYPE_BLACK ^ 1 == COLOR_TYPE_WHITE       COLOR_TYPE_WHITE ^ 1 == COLOR_TYPE_BLACK
-				if(board->pieces[t_sq] != EMPTY) {
-					if( g_pieceCol[board->pieces[t_sq]] == (side ^ 1)) {
-						AddCaptureMove(board, MOVE(squareIndex, t_sq, board->pieces[t_sq], EMPTY, 0), list);
-					}
-					continue;
+			}
+			if(quiets) {
+				targets = attacks & ~board->occupied[COLOR_TYPE_BOTH];
+				while(targets) {
+					t_sq = SQUARE_64_TO_120(BITBOARD_POP(&targets));
+					AddQuietMove(board, MOVE(squareIndex, t_sq, EMPTY, EMPTY, 0), list);
 				}
-				AddQuietMove(board, MOVE(squareIndex, t_sq, EMPTY, EMPTY, 0), list);
 			}
 		}
 
-		piece = LoopNonSlidePce[pceIndex++];
+		piece = LoopPieceType[pceIndex++];
 	}
 
     ASSERT(MoveListOk(list,board));
 }
 
+#undef LEGAL_TO
 
-void GenerateAllCaps(const ChessBoard *board, MoveList *list) {
-
-	ASSERT(Board_Check(board));
-
-	list->count = 0;
-
-	int piece = EMPTY;
-	int side = board->side;
-	int squareIndex = 0; int t_sq = 0;
-	int pieceCount = 0;
-	int direction = 0;
-	int index = 0;
-	int pceIndex = 0;
-
-	if(side == COLOR_TYPE_WHITE) {
-
-		for(pieceCount = 0; pieceCount < board->pieceCount[PIECE_TYPE_WHITE_PAWN]; ++pieceCount) {
-			squareIndex = board->pList[PIECE_TYPE_WHITE_PAWN][pieceCount];
-			ASSERT(SqOnBoard(squareIndex));
-
-			if(!SQOFFBOARD(squareIndex + 9) && g_pieceCol[board->pieces[squareIndex + 9]] == COLOR_TYPE_BLACK) {
-				AddWhitePawnCapMove(board, squareIndex, squareIndex+9, board->pieces[squareIndex + 9], list);
-			}
-			if(!SQOFFBOARD(squareIndex + 11) && g_pieceCol[board->pieces[squareIndex + 11]] == COLOR_TYPE_BLACK) {
-				AddWhitePawnCapMove(board, squareIndex, squareIndex+11, board->pieces[squareIndex + 11], list);
-			}
-
-			if(board->enPas != NO_SQ) {
-				if(squareIndex + 9 == board->enPas) {
-					AddEnPassantMove(board, MOVE(squareIndex,squareIndex + 9,EMPTY,EMPTY,MFLAGEP), list);
-				}
-				if(squareIndex + 11 == board->enPas) {
-					AddEnPassantMove(board, MOVE(squareIndex,squareIndex + 11,EMPTY,EMPTY,MFLAGEP), list);
-				}
-			}
-		}
-
-	} else {
-
-		for(pieceCount = 0; pieceCount < board->pieceCount[PIECE_TYPE_BLACK_PAWN]; ++pieceCount) {
-			squareIndex = board->pList[PIECE_TYPE_BLACK_PAWN][pieceCount];
-			ASSERT(SqOnBoard(squareIndex));
-
-			if(!SQOFFBOARD(squareIndex - 9) && g_pieceCol[board->pieces[squareIndex - 9]] == COLOR_TYPE_WHITE) {
-				AddBlackPawnCapMove(board, squareIndex, squareIndex-9, board->pieces[squareIndex - 9], list);
-			}
-
-			if(!SQOFFBOARD(squareIndex - 11) && g_pieceCol[board->pieces[squareIndex - 11]] == COLOR_TYPE_WHITE) {
-				AddBlackPawnCapMove(board, squareIndex, squareIndex-11, board->pieces[squareIndex - 11], list);
-			}
-			if(board->enPas != NO_SQ) {
-				if(squareIndex - 9 == board->enPas) {
-					AddEnPassantMove(board, MOVE(squareIndex,squareIndex - 9,EMPTY,EMPTY,MFLAGEP), list);
-				}
-				if(squareIndex - 11 == board->enPas) {
-					AddEnPassantMove(board, MOVE(squareIndex,squareIndex - 11,EMPTY,EMPTY,MFLAGEP), list);
-				}
-			}
-		}
-	}
-
-	/* Loop for slide pieces */
-	pceIndex = LoopSlideIndex[side];
-	piece = LoopSlidePce[pceIndex++];
-	while( piece != 0) {
-		ASSERT(PieceValid(piece));
-
-		for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-			squareIndex = board->pList[piece][pieceCount];
-			ASSERT(SqOnBoard(squareIndex));
-
-			for(index = 0; index < NumDir[piece]; ++index) {
-				direction = PceDir[piece][index];
-				t_sq = squareIndex + direction;
-
-				while(!SQOFFBOARD(t_sq)) {
-					// COLOR_TYPE_BLACK ^ 1 == COLOR_TYPE_WHITE       COLOR_TYPE_WHITE ^ 1 == COLOR_TYPE_BLACK
-					if(board->pieces[t_sq] != EMPTY) {
-						if( g_pieceCol[board->pieces[t_sq]] == (side ^ 1)) {
-							AddCaptureMove(board, MOVE(squareIndex, t_sq, board->pieces[t_sq], EMPTY, 0), list);
-						}
-						break;
-					}
-					t_sq += direction;
-				}
-			}
-		}
-
-		piece = LoopSlidePce[pceIndex++];
-	}
-
-	/* Loop for non slide */
-	pceIndex = LoopNonSlideIndex[side];
-	piece = LoopNonSlidePce[pceIndex++];
-
-	while( piece != 0) {
-		ASSERT(PieceValid(piece));
+void Move_GenerateAll(const ChessBoard *board, MoveList *list) {
+	PROFILE_BEGIN(PROFILE_GENERATE_ALL);
+	GenerateMoves(board, list, BOOL_TYPE_TRUE, BOOL_TYPE_TRUE, BOOL_TYPE_FALSE);
+	PROFILE_END(PROFILE_GENERATE_ALL);
+}
 
-		for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-			squareIndex = board->pList[piece][pieceCount];
-			ASSERT(SqOnBoard(squareIndex));
+void GenerateAllCaps(const ChessBoard *board, MoveList *list) {
+	PROFILE_BEGIN(PROFILE_GENERATE_CAPTURES);
+	GenerateMoves(board, list, BOOL_TYPE_TRUE, BOOL_TYPE_FALSE, BOOL_TYPE_FALSE);
+	PROFILE_END(PROFILE_GENERATE_CAPTURES);
+}
 
-			for(index = 0; index < NumDir[piece]; ++index) {
-				direction = PceDir[piece][index];
-				t_sq = squareIndex + direction;
+void Move_GenerateQuiets(const ChessBoard *board, MoveList *list) {
+	PROFILE_BEGIN(PROFILE_GENERATE_QUIETS);
+	GenerateMoves(board, list, BOOL_TYPE_FALSE, BOOL_TYPE_TRUE, BOOL_TYPE_FALSE);
+	PROFILE_END(PROFILE_GENERATE_QUIETS);
+}
 
-				if(SQOFFBOARD(t_sq)) {
-					continue;
-				}
+void Move_GenerateLegal(const ChessBoard *board, MoveList *list) {
+	PROFILE_BEGIN(PROFILE_GENERATE_ALL);
+	GenerateMoves(board, list, BOOL_TYPE_TRUE, BOOL_TYPE_TRUE, BOOL_TYPE_TRUE);
+	PROFILE_END(PROFILE_GENERATE_ALL);
+}
 
-				// COLOR_TYPE_BLACK ^ 1 == COLOR_TYPE_WHITE       COLOR_TYPE_WHITE ^ 1 == COLOR_TYPE_BLACK
-				if(board->pieces[t_sq] != EMPTY) {
-					if( g_pieceCol[board->pieces[t_sq]] == (side ^ 1)) {
-						AddCaptureMove(board, MOVE(squareIndex, t_sq, board->pieces[t_sq], EMPTY, 0), list);
-					}
-					continue;
-				}
-			}
-		}
+void Move_GenerateLegalCaptures(const ChessBoard *board, MoveList *list) {
+	PROFILE_BEGIN(PROFILE_GENERATE_CAPTURES);
+	GenerateMoves(board, list, BOOL_TYPE_TRUE, BOOL_TYPE_FALSE, BOOL_TYPE_TRUE);
+	PROFILE_END(PROFILE_GENERATE_CAPTURES);
+}
 
-		piece = LoopNonSlidePce[pceIndex++];
-	}
-    ASSERT(MoveListOk(list,board));
+void Move_GenerateLegalQuiets(const ChessBoard *board, MoveList *list) {
+	PROFILE_BEGIN(PROFILE_GENERATE_QUIETS);
+	GenerateMoves(board, list, BOOL_TYPE_FALSE, BOOL_TYPE_TRUE, BOOL_TYPE_TRUE);
+	PROFILE_END(PROFILE_GENERATE_QUIETS);
 }
 
 
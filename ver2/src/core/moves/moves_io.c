@@ -4,8 +4,10 @@
  * 
  * Provides functions for:
  * - Converting moves to algebraic notation (e2e4, e7e8q)
+ * - Converting moves to standard algebraic notation (Nf3, exd5, e8=Q+) for PGN
  * - Parsing algebraic notation to internal move representation
  * - Converting square indices to algebraic notation (e4, a1)
+ * - Packing moves to / unpacking moves from their 16-bit form
  * - Printing move lists
  * 
  * These functions are used by:
@@ -46,6 +48,12 @@ char *PrMove(const int move) {
 
 	int promoted = MOVE_GET_PROMOTED(move);
 
+	// UCI null move, e.g. "bestmove 0000" without a legal move
+	if(move == NOMOVE) {
+		sprintf(MvStr, "0000");
+		return MvStr;
+	}
+
 	if(promoted) {
 		char pchar = 'q';
 		if(PIECE_IS_KNIGHT(promoted)) {
@@ -106,6 +114,132 @@ int Move_Parse(char *ptrChar, ChessBoard *board) {
     return NOMOVE;
 }
 
+// promotion index (bits 12-13 of a packed move) for each promoted piece
+static const int PackedPromotionIndex[13] = { 0, 0, 0, 1, 2, 3, 0, 0, 0, 1, 2, 3, 0 };
+
+static const int PackedPromotionPiece[2][4] = {
+	{ PIECE_TYPE_WHITE_KNIGHT, PIECE_TYPE_WHITE_BISHOP, PIECE_TYPE_WHITE_ROOK, PIECE_TYPE_WHITE_QUEEN },
+	{ PIECE_TYPE_BLACK_KNIGHT, PIECE_TYPE_BLACK_BISHOP, PIECE_TYPE_BLACK_ROOK, PIECE_TYPE_BLACK_QUEEN }
+};
+
+PackedMove Move_Pack(const int move) {
+
+	int type = PACKED_MOVE_NORMAL;
+	int promotionIndex = 0;
+
+	if(move == NOMOVE) {
+		return 0;
+	}
+
+	if(MOVE_GET_PROMOTED(move) != EMPTY) {
+		type = PACKED_MOVE_PROMOTION;
+		promotionIndex = PackedPromotionIndex[MOVE_GET_PROMOTED(move)];
+	} else if(move & MFLAGEP) {
+		type = PACKED_MOVE_ENPASSANT;
+	} else if(move & MFLAGCA) {
+		type = PACKED_MOVE_CASTLE;
+	}
+
+	return (PackedMove)(SQUARE_120_TO_64(MOVE_GET_FROM_SQUARE(move))
+		| (SQUARE_120_TO_64(MOVE_GET_TO_SQUARE(move)) << 6)
+		| (promotionIndex << 12)
+		| (type << 14));
+}
+
+int Move_Unpack(const ChessBoard *board, const PackedMove packed) {
+
+	if(packed == 0) {
+		return NOMOVE;
+	}
+
+	int from = SQUARE_64_TO_120(packed & 0x3F);
+	int to = SQUARE_64_TO_120((packed >> 6) & 0x3F);
+	int type = (packed >> 14) & 3;
+	int piece = board->pieces[from];
+	int move = from | (to << 7);
+
+	if(piece == EMPTY || g_pieceCol[piece] != board->side) {
+		return NOMOVE;
+	}
+
+	switch(type) {
+		case PACKED_MOVE_PROMOTION:
+			move |= (board->pieces[to] << 14) | (PackedPromotionPiece[board->side][(packed >> 12) & 3] << 20);
+			break;
+		case PACKED_MOVE_ENPASSANT:
+			move |= MFLAGEP;
+			break;
+		case PACKED_MOVE_CASTLE:
+			move |= MFLAGCA;
+			break;
+		default:
+			move |= board->pieces[to] << 14;
+			if(g_piecePawn[piece] && (to - from == 20 || from - to == 20)) {
+				move |= MFLAGPS;
+			}
+			break;
+	}
+
+	return move;
+}
+
+// piece letters of SAN, by piece type without colour
+static const char SanPiece[13] = { ' ', 'P', 'N', 'B', 'R', 'Q', 'K', 'P', 'N', 'B', 'R', 'Q', 'K' };
+
+void Move_ToSan(ChessBoard *board, const int move, char *san) {
+
+	MoveList list[1];
+	int from = MOVE_GET_FROM_SQUARE(move);
+	int to = MOVE_GET_TO_SQUARE(move);
+	int piece = board->pieces[from];
+	int promoted = MOVE_GET_PROMOTED(move);
+	int capture = (move & MFLAGCAP) != 0;
+	int ambiguous = BOOL_TYPE_FALSE;
+	int sameFile = BOOL_TYPE_FALSE;
+	int sameRank = BOOL_TYPE_FALSE;
+	int index = 0;
+	char *out = san;
+
+	if(move & MFLAGCA) {
+		out += sprintf(out, "%s", to > from ? "O-O" : "O-O-O");
+	} else {
+		if(g_piecePawn[piece]) {
+			if(capture) *out++ = 'a' + g_filesBoard[from];
+		} else {
+			// another piece of the same kind reaching the same square needs
+			// the file, else the rank, else both of the mover's square
+			Move_GenerateLegal(board, list);
+			for(index = 0; index < list->count; ++index) {
+				int other = MOVE_GET_FROM_SQUARE(list->moves[index].move);
+				if(other != from && MOVE_GET_TO_SQUARE(list->moves[index].move) == to && board->pieces[other] == piece) {
+					ambiguous = BOOL_TYPE_TRUE;
+					if(g_filesBoard[other] == g_filesBoard[from]) sameFile = BOOL_TYPE_TRUE;
+					if(g_ranksBoard[other] == g_ranksBoard[from]) sameRank = BOOL_TYPE_TRUE;
+				}
+			}
+			*out++ = SanPiece[piece];
+			if(ambiguous && (!sameFile || sameRank)) *out++ = 'a' + g_filesBoard[from];
+			if(ambiguous && sameFile) *out++ = '1' + g_ranksBoard[from];
+		}
+		if(capture) *out++ = 'x';
+		*out++ = 'a' + g_filesBoard[to];
+		*out++ = '1' + g_ranksBoard[to];
+		if(promoted != EMPTY) {
+			*out++ = '=';
+			*out++ = SanPiece[promoted];
+		}
+	}
+
+	if(Move_Make(board, move)) {
+		if(Attack_IsSquareAttacked(board->KingSq[board->side], board->side ^ 1, board)) {
+			Move_GenerateLegal(board, list);
+			*out++ = list->count == 0 ? '#' : '+';
+		}
+		Move_Take(board);
+	}
+	*out = '\0';
+}
+
 void PrintMoveList(const MoveList *list) {
 	int index = 0;
 	int score = 0;
@@ -23,6 +23,9 @@
 
 #include "stdlib.h"
 #include "stdio.h"
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
 
 // #define DEBUG   // Enable for debugging assertions and extra checks
 
@@ -31,7 +34,26 @@
  * ===========================================================================
  */
 
-#define CHESS_MAX_HASH 1024  // Maximum hash table size in MB
+#define CHESS_MAX_HASH 65536 // Maximum hash table size in MB (64 GB)
+#define CHESS_MAX_THREADS 64 // Maximum number of search threads (Lazy SMP)
+#define PERFT_SUITE_DEFAULT_DEPTH 6 // Deepest EPD perft depth run unless a limit is given
+#define EVAL_CACHE_DEFAULT_MB 4 // Evaluation cache size unless set with the EvalCache option
+#define EVAL_CACHE_MAX_MB 1024  // Largest evaluation cache the option accepts
+#define PAWN_HASH_ENTRIES 16384 // Pawn hash entries per search thread (power of two)
+#define LAZY_EVAL_MARGIN 200 // Default LazyMargin: cheap eval this far outside the window decides alone
+#define MOVE_OVERHEAD_DEFAULT 30 // Default MoveOverhead: ms kept back from every time budget
+#define CURRMOVE_REPORT_MS 3000 // Search time after which UCI info reports the root move being searched
+#define HASHFULL_SAMPLE_BUCKETS 125 // Buckets (of HASH_BUCKET_SIZE entries) sampled for UCI hashfull
+#define BENCH_DEFAULT_DEPTH 10 // Depth of the bench command unless one is given
+#define ANALYSE_DEFAULT_DEPTH 12 // Depth of the analyse command unless a limit is given
+#define ANALYSE_LINE 1024 // Longest EPD/FEN line read by analyse and coordinator
+#define ANALYSE_ID 128    // Longest EPD "id" kept for the results
+#define CLUSTER_DEFAULT_PORT 7699 // TCP port of the analysis coordinator unless --port is given
+#define NNUE_DEFAULT_FILE "gambit.nnue" // Network loaded at startup unless EvalFile names another
+#define NNUE_INPUTS 768 // Network inputs: 12 pieces x 64 squares, per perspective
+#define NNUE_HIDDEN 256 // Accumulator width per perspective (multiple of 16)
+#define REPETITION_FILTER_SIZE 1024 // Slots in the game history key filter (power of two)
+#define REPETITION_INDEX(key) ((int)((key) >> 54) & (REPETITION_FILTER_SIZE - 1))
 
 /**
  * ASSERT macro for debugging
@@ -57,6 +79,121 @@ exit(1);}
  */
 typedef unsigned long long U64;
 
+// storage class of per-thread globals
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+/**
+ * Hot-path profiler (make PROFILE=1)
+ * - PROFILE_BEGIN/PROFILE_END bracket one of the points below and count
+ *   calls and timer ticks in thread-local counters; nested (recursive)
+ *   entries are counted as calls but timed once, so times are inclusive
+ * - The timer is RDTSC on x86 with GCC/clang, a monotonic nanosecond
+ *   clock elsewhere
+ * - PROFILE_FLUSH adds the calling thread's counters to the totals,
+ *   PROFILE_REPORT prints the totals as a table and clears them
+ * - Without PROFILE every macro expands to nothing
+ */
+enum {
+	PROFILE_GENERATE_ALL,
+	PROFILE_GENERATE_CAPTURES,
+	PROFILE_GENERATE_QUIETS,
+	PROFILE_MAKE_MOVE,
+	PROFILE_TAKE_MOVE,
+	PROFILE_SQUARE_ATTACKED,
+	PROFILE_EVALUATE,
+	PROFILE_PROBE_HASH,
+	PROFILE_QUIESCENCE,
+	PROFILE_POINT_COUNT
+};
+
+#ifdef PROFILE
+#define PROFILE_THREAD_LOCAL THREAD_LOCAL
+
+/**
+ * @struct ProfileCounter
+ * @brief Calls and time of one profile point in one thread
+ * @field calls - Times the point was entered
+ * @field ticks - Timer ticks spent inside (outermost entries only)
+ * @field start - Timer value at the outermost entry
+ * @field nest - Entries not yet left
+ */
+typedef struct {
+	U64 calls;
+	U64 ticks;
+	U64 start;
+	int nest;
+} ProfileCounter;
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PROFILE_TICK_UNIT "cycles"
+static inline U64 Profile_Clock() {
+	return __builtin_ia32_rdtsc();
+}
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define PROFILE_TICK_UNIT "cycles"
+static inline U64 Profile_Clock() {
+	return __rdtsc();
+}
+#else
+#include <time.h>
+#define PROFILE_TICK_UNIT "ns"
+static inline U64 Profile_Clock() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (U64)t.tv_sec * 1000000000ULL + (U64)t.tv_nsec;
+}
+#endif
+
+extern PROFILE_THREAD_LOCAL ProfileCounter g_profileCounters[PROFILE_POINT_COUNT];
+extern void Profile_Flush();
+extern void Profile_Report();
+
+static inline void Profile_Begin(const int point) {
+	ProfileCounter *counter = &g_profileCounters[point];
+	counter->calls++;
+	if(counter->nest++ == 0) {
+		counter->start = Profile_Clock();
+	}
+}
+
+static inline void Profile_End(const int point) {
+	ProfileCounter *counter = &g_profileCounters[point];
+	if(--counter->nest == 0) {
+		counter->ticks += Profile_Clock() - counter->start;
+	}
+}
+
+#define PROFILE_BEGIN(point) Profile_Begin(point)
+#define PROFILE_END(point) Profile_End(point)
+#define PROFILE_FLUSH() Profile_Flush()
+#define PROFILE_REPORT() Profile_Report()
+#else
+#define PROFILE_BEGIN(point)
+#define PROFILE_END(point)
+#define PROFILE_FLUSH()
+#define PROFILE_REPORT()
+#endif
+
+/**
+ * @struct SliderMagic
+ * @brief Magic bitboard lookup data for one square and slider type
+ * @field mask - Relevant blocker squares (rays without edge squares)
+ * @field magic - Multiplier mapping blocker subsets to table slots
+ * @field attacks - This square's slice of the shared attack table
+ * @field shift - 64 minus the number of mask bits
+ */
+typedef struct {
+	U64 mask;
+	U64 magic;
+	U64 *attacks;
+	int shift;
+} SliderMagic;
+
 #define NAME "Gambit 1.1"  // Engine name and version
 
 /**
@@ -74,6 +211,20 @@ typedef unsigned long long U64;
 
 #define CHESS_INFINITE 30000           // Infinite score for search bounds
 #define CHESS_IS_MATE (CHESS_INFINITE - CHESS_MAX_SEARCH_DEPTH)  // Score threshold for mate detection
+#define CHESS_TB_WIN (CHESS_IS_MATE - 1)   // Tablebase win at the root, minus the ply it was found at
+
+/**
+ * Syzygy tablebases (tablebase_syzygy.c)
+ * - TB_MAX_PIECES: Largest tables looked for (kings included)
+ * - TB_WDL_*: Tb_ProbeWdl results for the side to move; cursed wins and
+ *   blessed losses are decided by the fifty move rule
+ */
+#define TB_MAX_PIECES 7
+#define TB_WDL_LOSS -2
+#define TB_WDL_BLESSED_LOSS -1
+#define TB_WDL_DRAW 0
+#define TB_WDL_CURSED_WIN 1
+#define TB_WDL_WIN 2
 
 /* ===========================================================================
  * ENUMERATIONS
@@ -88,6 +239,9 @@ typedef unsigned long long U64;
  */
 enum { EMPTY, PIECE_TYPE_WHITE_PAWN, PIECE_TYPE_WHITE_KNIGHT, PIECE_TYPE_WHITE_BISHOP, PIECE_TYPE_WHITE_ROOK, PIECE_TYPE_WHITE_QUEEN, PIECE_TYPE_WHITE_KING, PIECE_TYPE_BLACK_PAWN, PIECE_TYPE_BLACK_KNIGHT, PIECE_TYPE_BLACK_BISHOP, PIECE_TYPE_BLACK_ROOK, PIECE_TYPE_BLACK_QUEEN, PIECE_TYPE_BLACK_KING  };
 
+/** Piece kind offsets: PIECE_TYPE_WHITE_PAWN or PIECE_TYPE_BLACK_PAWN plus a kind gives the coloured piece */
+enum { PIECE_KIND_PAWN, PIECE_KIND_KNIGHT, PIECE_KIND_BISHOP, PIECE_KIND_ROOK, PIECE_KIND_QUEEN, PIECE_KIND_KING };
+
 /** File names (A-H) and FILE_TYPE_NONE for special cases */
 enum { FILE_TYPE_A, FILE_TYPE_B, FILE_TYPE_C, FILE_TYPE_D, FILE_TYPE_E, FILE_TYPE_F, FILE_TYPE_G, FILE_TYPE_H, FILE_TYPE_NONE };
 
@@ -150,6 +304,14 @@ typedef struct {
 	int score;
 } Move;
 
+/**
+ * Compact 16-bit move on 64-square coordinates (see the packed move
+ * encoding below). Used wherever moves are stored rather than played:
+ * transposition table entries and killer slots. Move_Pack and
+ * Move_Unpack convert to and from the full move against a position.
+ */
+typedef unsigned short PackedMove;
+
 /**
  * @struct MoveList
  * @brief List of moves generated for a position
@@ -171,41 +333,73 @@ typedef struct {
 enum {  HFNONE, HFALPHA, HFBETA, HFEXACT};
 
 /**
- * @struct HashEntry
- * @brief Transposition table entry
- * @field posKey - Zobrist hash key for position verification
- * @field move - Best move found for this position
- * @field score - Evaluation score
- * @field depth - Search depth at which this entry was created
- * @field flags - Entry type (exact, alpha, or beta bound)
+ * @typedef HashEntry
+ * @brief Packed transposition table entry (one 64-bit word)
+ *
+ * - Bits 0-15:  Key fragment (low 16 bits of the Zobrist key)
+ * - Bits 16-31: Best move in packed 16-bit form (see Move_Pack)
+ * - Bits 32-47: Score (signed, mate scores stored relative to the node)
+ * - Bits 48-55: Search depth
+ * - Bits 56-57: Bound (HFALPHA, HFBETA or HFEXACT; HFNONE marks an empty slot)
+ * - Bits 58-63: Generation of the search that wrote the entry
+ *
+ * The high bits of the key select the bucket, the fragment tells apart
+ * the positions sharing a bucket.
+ *
+ * Entries are read and written as single atomic 64-bit words, so threads
+ * sharing the table never observe a half-written entry and no lock is
+ * needed. A fragment collision can still hand back another position's
+ * data; probes reject entries whose move fails Move_IsLegal.
+ */
+typedef U64 HashEntry;
+
+#define HASH_BUCKET_SIZE 8      // Entries per bucket (8 x 8 bytes = one 64-byte cache line)
+#define HASH_GENERATION_MASK 63 // Generation counter wraps every 64 searches
+
+/**
+ * @struct HashBucket
+ * @brief Cache-line sized group of entries probed together
  */
 typedef struct {
-	U64 posKey;
-	int move;
-	int score;
-	int depth;
-	int flags;
-} HashEntry;
+	HashEntry entries[HASH_BUCKET_SIZE];
+} HashBucket;
 
 /**
  * @struct HashTable
  * @brief Transposition table for storing previously searched positions
- * @field pTable - Pointer to hash table array
- * @field numEntries - Number of entries in table
- * @field newWrite - Count of new entries written
- * @field overWrite - Count of entries overwritten
- * @field hit - Count of successful lookups
- * @field cut - Count of cutoffs from hash table
+ * @field pTable - Pointer to the (cache-line aligned) bucket array
+ * @field pMemory - Raw allocation backing pTable
+ * @field memorySize - Size in bytes of the pMemory allocation
+ * @field largePages - BOOL_TYPE_TRUE if pMemory is backed by huge/large pages
+ * @field mapped - BOOL_TYPE_TRUE if pMemory is a copy-on-write mapping of a
+ *        HashTable_Save image (HashTable_Load)
+ * @field numBuckets - Number of buckets in table
+ * @field generation - Search generation, bumped by HashTable_NewSearch
+ *
+ * Probe and store counts are kept per thread in SearchStats, not here,
+ * so threads sharing the table don't also share written cache lines.
  */
 typedef struct {
-	HashEntry *pTable;
-	int numEntries;
-	int newWrite;
-	int overWrite;
-	int hit;
-	int cut;
+	HashBucket *pTable;
+	void *pMemory;
+	size_t memorySize;
+	int largePages;
+	int mapped;
+	int numBuckets;
+	int generation;
 } HashTable;
 
+/**
+ * @struct EvalCache
+ * @brief Direct-mapped static evaluation cache shared by all threads
+ * @field entries - Slots of (key high 48 bits | 16-bit eval), NULL when disabled
+ * @field mask - Slot count minus one (slot count is a power of two)
+ */
+typedef struct {
+	U64 *entries;
+	U64 mask;
+} EvalCache;
+
 /**
  * @struct UndoMove
  * @brief Information needed to undo a move
@@ -225,17 +419,241 @@ typedef struct {
 
 } UndoMove;
 
+/**
+ * @struct PawnEntry
+ * @brief Cached evaluation of one pawn structure
+ * @field pawnKey - Pawn-only Zobrist key of the structure
+ * @field passed - Passed pawns [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK]
+ * @field score - Isolated, doubled and passed pawn terms, White's point of view
+ * @field openFiles - Files without pawns (bit per file, A = bit 0)
+ * @field semiOpenFiles - Files without own pawns [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK]
+ */
+typedef struct {
+
+	U64 pawnKey;
+	U64 passed[2];
+	int score;
+	unsigned char openFiles;
+	unsigned char semiOpenFiles[2];
+
+} PawnEntry;
+
+/**
+ * @struct PawnHashTable
+ * @brief Per-thread pawn structure cache, indexed by pawnKey
+ * @field entries - Cached structures
+ * @field probes - Lookups since the last search started
+ * @field hits - Lookups answered from the cache
+ */
+typedef struct {
+
+	PawnEntry entries[PAWN_HASH_ENTRIES];
+	long probes;
+	long hits;
+
+} PawnHashTable;
+
+/**
+ * @struct EvalParam
+ * @brief One tunable evaluation term (a weight or a table of weights)
+ * @field name - Identifier printed by the tuner, as in evaluation_static.c
+ * @field values - The live weights Evaluate_Position reads
+ * @field count - Number of weights (1 for a scalar)
+ */
+typedef struct {
+	const char *name;
+	int *values;
+	int count;
+} EvalParam;
+
+/**
+ * @struct TunePosition
+ * @brief Compact labelled position of a tuning set
+ * @field squares - Piece codes (EMPTY..PIECE_TYPE_BLACK_KING), two per byte,
+ *        low nibble first, a1..h8
+ * @field side - Side to move
+ * @field result - Game result from White's side: 0 loss, 1 draw, 2 win
+ */
+typedef struct {
+	unsigned char squares[32];
+	unsigned char side;
+	unsigned char result;
+} TunePosition;
+
+/**
+ * @struct TuneSet
+ * @brief Positions loaded by Tune_LoadSet
+ * @field positions - Parsed positions
+ * @field count - Number of positions
+ */
+typedef struct {
+	TunePosition *positions;
+	long count;
+} TuneSet;
+
+/**
+ * @struct NnueAccumulator
+ * @brief First network layer of one position, both perspectives
+ * @field values - Hidden pre-activations [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK],
+ *        each seen from that side with its own pieces as "ours"
+ */
+typedef struct {
+
+	short values[2][NNUE_HIDDEN];
+
+} NnueAccumulator;
+
+/**
+ * @struct NnueNetwork
+ * @brief Quantised evaluation network, weights memory mapped from EvalFile
+ * @field featureWeights - Hidden layer columns, NNUE_HIDDEN per input feature
+ * @field featureBias - Hidden layer bias
+ * @field outputWeights - Output layer, side to move's half then the opponent's
+ * @field outputBias - Output bias
+ * @field mapping - Start of the mapped file (NULL when no network is loaded)
+ * @field mappingSize - Length of the mapping in bytes
+ * @field loaded - Whether Evaluate_Position uses the network
+ */
+typedef struct {
+
+	const short *featureWeights;
+	const short *featureBias;
+	const short *outputWeights;
+	int outputBias;
+	const void *mapping;
+	size_t mappingSize;
+	int loaded;
+
+} NnueNetwork;
+
+/**
+ * @struct SearchStats
+ * @brief Search counters of one thread (search_stats.c)
+ * @field nodes - Nodes searched; only filled in aggregated copies (Search_TotalNodes)
+ * @field qNodes - Quiescence nodes
+ * @field ttProbes - Transposition table probes
+ * @field ttHits - Probes that found the position stored deep enough
+ * @field ttCuts - Probes whose stored bound ended the node
+ * @field ttNewWrites - Stores into an empty slot
+ * @field ttOverWrites - Stores that replaced another entry
+ * @field failHighs - Beta cutoffs, quiescence included
+ * @field failHighFirst - Beta cutoffs by the first move searched
+ * @field nullTries - Null move searches
+ * @field nullCuts - Null move searches that failed high
+ *
+ * Each thread owns its counters in its SearchTables; they are only
+ * summed (Stats_Add) when a report is made.
+ */
+typedef struct {
+	long nodes;
+	long qNodes;
+	long ttProbes;
+	long ttHits;
+	long ttCuts;
+	long ttNewWrites;
+	long ttOverWrites;
+	long failHighs;
+	long failHighFirst;
+	long nullTries;
+	long nullCuts;
+} SearchStats;
+
+/**
+ * Move picker stages, in the order moves are handed out
+ * - PICK_STAGE_TT: Hash move (no generation needed)
+ * - PICK_STAGE_GEN_CAPTURES / PICK_STAGE_CAPTURES: Winning and equal captures, MVV-LVA order
+ * - PICK_STAGE_KILLERS: Killer moves of the current ply
+ * - PICK_STAGE_GEN_QUIETS / PICK_STAGE_QUIETS: Remaining quiet moves, history order
+ * - PICK_STAGE_BAD_CAPTURES: Captures with a negative SEE, deferred to the end
+ *   (dropped altogether in captures-only mode)
+ */
+enum {
+	PICK_STAGE_TT, PICK_STAGE_GEN_CAPTURES, PICK_STAGE_CAPTURES, PICK_STAGE_KILLERS,
+	PICK_STAGE_GEN_QUIETS, PICK_STAGE_QUIETS, PICK_STAGE_BAD_CAPTURES, PICK_STAGE_DONE
+};
+
+/**
+ * @struct MovePicker
+ * @brief Staged, lazy move generator for one search node
+ * @field list - Moves of the current generation stage
+ * @field index - Next unpicked entry of list
+ * @field stage - Current PICK_STAGE_*
+ * @field ttMove - Hash move (played first, skipped later)
+ * @field killers - Killer moves of the node's ply
+ * @field badCount - Number of captures deferred by the capture stage; they are
+ *        parked in the top badCount slots of list, which the legal move count
+ *        (at most 218) keeps clear of the quiet moves generated below them
+ * @field badIndex - Next deferred capture to hand out
+ * @field capturesOnly - Quiescence mode: non-losing captures only, no hash move or killers
+ */
+typedef struct {
+	MoveList list[1];
+	int index;
+	int stage;
+	int ttMove;
+	int killers[2];
+	int badCount;
+	int badIndex;
+	int capturesOnly;
+} MovePicker;
+
+/**
+ * @struct SearchPly
+ * @brief One frame of a search thread's stack, indexed by board->ply
+ * @field picker - Move picker of the node at this ply, its move buffer included
+ * @field killers - Killer moves of this ply, packed (0 = none)
+ */
+typedef struct {
+	MovePicker picker;
+	PackedMove killers[2];
+} SearchPly;
+
+/**
+ * @struct SearchTables
+ * @brief Move ordering tables and PV of one search thread
+ * @field PvArray - Principal variation array
+ * @field searchHistory - History heuristic scores [piece][64-square destination]
+ * @field pawnHash - Pawn structure cache used by Evaluate_Position
+ * @field accumulators - NNUE accumulator stack, one entry per ply from the search root
+ * @field lazyExits - Evaluate_Lazy calls decided by the cheap tier since the search started
+ * @field fullEvals - Evaluate_Lazy calls that needed the full evaluation
+ * @field stats - Search counters of this thread since the search started
+ * @field stack - Search frames per ply; allocated once with the board, so a
+ *        node keeps no move list on the C stack and the frames of a line
+ *        lie next to each other
+ */
+typedef struct {
+
+	int PvArray[CHESS_MAX_SEARCH_DEPTH];
+	int searchHistory[13][64];
+	PawnHashTable pawnHash;
+	NnueAccumulator accumulators[CHESS_MAX_SEARCH_DEPTH + 1];
+	long lazyExits;
+	long fullEvals;
+	SearchStats stats;
+	SearchPly stack[CHESS_MAX_SEARCH_DEPTH];
+
+} SearchTables;
+
 /**
  * @struct ChessBoard
- * @brief Complete board representation and game state
+ * @brief Compact position plus pointers to game history and search state
  * 
  * Uses hybrid representation:
  * - 120-square mailbox for fast piece lookup
- * - Bitboards for fast pawn operations
+ * - Bitboards for pieces, occupancy and pawns
  * - Piece lists for iteration
+ *
+ * Everything Move_Make touches on every move sits in the first few
+ * kilobytes. The game history, the per-thread search tables and the
+ * shared transposition table live outside the struct, so a position can
+ * be copied with Board_Copy without dragging tens of kilobytes along.
+ * Boards are set up with Board_Init and released with Board_Free.
  * 
  * @field pieces - 120-square mailbox array
  * @field pawns - Bitboards for pawns [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK, COLOR_TYPE_BOTH]
+ * @field occupied - Occupancy bitboards [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK, COLOR_TYPE_BOTH]
+ * @field pieceBB - Bitboard of the squares holding each piece type (index EMPTY unused)
  * @field KingSq - King square positions [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK]
  * @field side - Side to move (COLOR_TYPE_WHITE or COLOR_TYPE_BLACK)
  * @field enPas - En passant target square (NO_SQ if not available)
@@ -244,26 +662,32 @@ typedef struct {
  * @field hisPly - Total plies in game history
  * @field castlePerm - Castle permission flags
  * @field posKey - Zobrist hash of current position
+ * @field pawnKey - Zobrist hash of the pawns alone (keys the pawn hash)
  * @field pieceCount - Count of each piece type on board
  * @field bigPce - Count of non-pawn pieces [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK]
  * @field majPce - Count of rooks and queens [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK]
  * @field minPce - Count of bishops and knights [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK]
  * @field material - Material score [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK]
- * @field history - Array of undo information for previous moves
+ * @field pstMg - Sum of middlegame piece-square scores per side (g_pstMg)
+ * @field pstEg - Sum of endgame piece-square scores per side (g_pstEg)
  * @field pList - Piece lists organized by type
- * @field HashTable - Transposition table
- * @field PvArray - Principal variation array
- * @field searchHistory - History heuristic scores
- * @field searchKillers - Killer move heuristic
- * @field capturedWhite - Array of captured white pieces (for GUI display)
- * @field capturedBlack - Array of captured black pieces (for GUI display)
- * @field capturedWhiteCount - Count of captured white pieces
- * @field capturedBlackCount - Count of captured black pieces
+ * @field history - Undo information for previous moves (CHESS_MAX_GAME_MOVES entries, owned by the board)
+ * @field tables - Search stack, history heuristic and PV (owned by the board, one per search thread)
+ * @field HashTable - Transposition table (shared by all search threads)
+ * @field accumulator - Top of the NNUE accumulator stack in tables, NULL when
+ *        no network is loaded or the position is not tracked incrementally
+ * @field repetitionFilter - Per-slot count of history keys (REPETITION_INDEX), lets
+ *        repetition checks skip the history scan when the key was never seen
+ *
+ * Only position state lives here; display state such as the captured
+ * pieces panel is derived by the GUI from history.
  */
 typedef struct {
 
 	int pieces[CHESS_BOARD_SQUARE_NUM];
 	U64 pawns[3];
+	U64 occupied[3];
+	U64 pieceBB[13];
 
 	int KingSq[2];
 
@@ -277,53 +701,91 @@ typedef struct {
 	int castlePerm;
 
 	U64 posKey;
+	U64 pawnKey;
 
 	int pieceCount[13];
 	int bigPce[2];
 	int majPce[2];
 	int minPce[2];
 	int material[2];
-
-	UndoMove history[CHESS_MAX_GAME_MOVES];
+	int pstMg[2];
+	int pstEg[2];
 
 	// piece list
 	int pList[13][10];
 
-	HashTable HashTable[1];
-	int PvArray[CHESS_MAX_SEARCH_DEPTH];
+	UndoMove *history;
+	SearchTables *tables;
+	HashTable *HashTable;
+	NnueAccumulator *accumulator;
 
-	int searchHistory[13][CHESS_BOARD_SQUARE_NUM];
-	int searchKillers[2][CHESS_MAX_SEARCH_DEPTH];
-	
-	// Captured pieces tracking
-	int capturedWhite[16];  // Array to store captured white pieces
-	int capturedBlack[16];  // Array to store captured black pieces
-	int capturedWhiteCount; // Count of captured white pieces
-	int capturedBlackCount; // Count of captured black pieces
+	unsigned short repetitionFilter[REPETITION_FILTER_SIZE];
 
 } ChessBoard;
 
+/**
+ * @struct TimeManager
+ * @brief Time budget for one move (search_timeman.c)
+ * @field start - Time the budget counts from (search start, or ponderhit)
+ * @field softTime - Ms after start past which no new iteration starts (-1 = no clock)
+ * @field hardTime - Ms after start at which the search is aborted (-1 = no clock)
+ * @field lastBestMove - Best move of the previous completed iteration
+ * @field stability - Completed iterations the best move has stayed the same
+ * @field lastScore - Score of the previous completed iteration
+ */
+typedef struct {
+	int start;
+	int softTime;
+	int hardTime;
+	int lastBestMove;
+	int stability;
+	int lastScore;
+} TimeManager;
+
 /**
  * @struct SearchInfo
  * @brief Search control and statistics
  * @field starttime - Time when search started
- * @field stoptime - Time when search should stop
+ * @field stoptime - Time when search must stop (hard limit)
+ * @field tm - Soft/hard limits and iteration history for the time manager
+ * @field nextCheck - Node count at which CheckUp runs next
  * @field depth - Maximum search depth
  * @field timeset - Whether time control is set
  * @field movestogo - Moves until next time control
  * @field nodes - Number of nodes searched
  * @field quit - Flag to stop search and exit
  * @field stopped - Flag indicating search was stopped
- * @field fh - First move fail high count (for move ordering statistics)
- * @field fhf - First move fail high first count
- * @field nullCut - Null move cutoffs count
  * @field GAME_MODE - Current game mode (UCI, XBoard, Console)
  * @field POST_THINKING - Whether to post thinking output
+ * @field threadId - Search thread index (0 = main thread, >0 = Lazy SMP helper,
+ *        -1 = offline evaluation that never checks the clock or input)
+ * @field asyncInput - Input is read by another thread while searching (UCI,
+ *        XBoard analysis); CheckUp then polls stopRequest instead of stdin
+ * @field stopRequest - Set by the input thread to stop the search, read atomically
+ * @field statusRequest - Set by the input thread for an XBoard "." status line,
+ *        cleared by the main search thread once printed
+ * @field ponder - Searching on the opponent's time or analysing: no clock and
+ *        no move is played until ponderhit (UCI, cleared atomically) or new
+ *        input (XBoard)
+ * @field ponderMove - Expected reply from the last completed PV (NOMOVE if unknown)
+ * @field tbhits - Successful tablebase probes
+ * @field rootMoves - Root moves the search is limited to (searchmoves, Tb_RootFilter)
+ * @field rootMoveCount - Entries in rootMoves, 0 searches every legal move
+ * @field searchMoves - Root moves given with go searchmoves
+ * @field searchMoveCount - Entries in searchMoves (0 = no restriction)
+ * @field nodeLimit - Stop once all search threads together searched this many
+ *        nodes (0 = none); exact and repeatable with one thread, unlike a time limit
+ * @field nodeCounts - Node counts per threadId that a nodeLimit is shared through
+ *        while helpers search, read and written atomically (NULL = own nodes only)
+ * @field mateLimit - Stop once a mate in this many moves or fewer is found (0 = none)
+ * @field seldepth - Deepest ply the thread reached, quiescence included
  */
 typedef struct {
 
 	int starttime;
 	int stoptime;
+	TimeManager tm;
+	long nextCheck;
 	int depth;
 	int timeset;
 	int movestogo;
@@ -333,24 +795,195 @@ typedef struct {
 	int quit;
 	int stopped;
 
-	float fh;
-	float fhf;
-	int nullCut;
-
 	int GAME_MODE;
 	int POST_THINKING;
 
+	int threadId;
+
+	int asyncInput;
+	int stopRequest;
+	int statusRequest;
+
+	int ponder;
+	int ponderMove;
+
+	long tbhits;
+	int rootMoves[CHESS_MAX_POSITION_MOVES];
+	int rootMoveCount;
+	int searchMoves[CHESS_MAX_POSITION_MOVES];
+	int searchMoveCount;
+
+	long nodeLimit;
+	long *nodeCounts;
+	int mateLimit;
+	int seldepth;
+
 } SearchInfo;
 
+/**
+ * @struct SearchResult
+ * @brief Outcome of a Search_Independent search
+ * @field bestMove - Best move of the last completed iteration (a legal move
+ *        if none completed, NOMOVE without legal moves)
+ * @field score - Score of that iteration from the side to move's view
+ * @field depth - Last completed iteration (0 = none)
+ * @field seldepth - Deepest ply reached, quiescence included
+ * @field nodes - Nodes searched
+ * @field timeMs - Search time in ms
+ * @field pvLength - Moves in pv
+ * @field pv - Principal variation of the last completed iteration
+ */
+typedef struct {
+	int bestMove;
+	int score;
+	int depth;
+	int seldepth;
+	long nodes;
+	int timeMs;
+	int pvLength;
+	int pv[CHESS_MAX_SEARCH_DEPTH];
+} SearchResult;
+
+/**
+ * @struct AnalyseOptions
+ * @brief Settings of a batch analysis run (search_analyse.c)
+ * @field inPath - EPD or FEN file, one position per line
+ * @field outPath - NDJSON output file (NULL = stdout)
+ * @field depth - Depth limit per position
+ * @field nodes - Node limit per position (0 = none)
+ * @field movetime - Time limit per position in ms (0 = none)
+ * @field threads - Worker threads, each searching its own position
+ * @field hashMB - Transposition table size in MB, per worker or shared
+ * @field sharedHash - One table for all workers, kept across positions;
+ *        otherwise every worker clears its own before each position
+ * @field ordered - Write results in input order rather than as completed
+ */
+typedef struct {
+	const char *inPath;
+	const char *outPath;
+	int depth;
+	long nodes;
+	int movetime;
+	int threads;
+	int hashMB;
+	int sharedHash;
+	int ordered;
+} AnalyseOptions;
+
+/**
+ * Outcomes of GameResult
+ */
+enum {
+	GAME_RESULT_NONE,
+	GAME_RESULT_WHITE_MATES,
+	GAME_RESULT_BLACK_MATES,
+	GAME_RESULT_STALEMATE,
+	GAME_RESULT_FIFTY_MOVES,
+	GAME_RESULT_REPETITION,
+	GAME_RESULT_MATERIAL
+};
+
 /**
  * @struct S_OPTIONS
  * @brief Engine configuration options
  * @field UseBook - Whether to use opening book
+ * @field Threads - Number of search threads (1 = single-threaded search)
+ * @field UseLMR - Late move reductions for late quiet moves
+ * @field UseFutility - Futility pruning of quiet moves at frontier nodes
+ * @field UseReverseFutility - Reverse futility (static null move) pruning
+ * @field LazyMargin - Evaluate_Lazy margin in centipawns (0 = always evaluate fully)
+ * @field SyzygyProbeDepth - Minimum remaining depth for tablebase probes at the piece limit
+ * @field SyzygyProbeLimit - Most pieces a position may have to be probed (0 = never)
+ * @field MoveOverhead - Ms kept back from every time budget for GUI and network lag
  */
 typedef struct {
 	int UseBook;
+	int Threads;
+	int UseLMR;
+	int UseFutility;
+	int UseReverseFutility;
+	int LazyMargin;
+	int SyzygyProbeDepth;
+	int SyzygyProbeLimit;
+	int MoveOverhead;
 } S_OPTIONS;
 
+/**
+ * @struct SelfPlayOptions
+ * @brief Settings of a self-play match (search_selfplay.c)
+ * @field openingsPath - EPD/FEN file of start positions (NULL = Polyglot book)
+ * @field pgnPath - PGN file the games are appended to (NULL = none)
+ * @field games - Games to play at most (pairs with colours reversed)
+ * @field concurrency - Games played at once, one worker thread each
+ * @field baseMs - Clock per side in ms (0 = no clock)
+ * @field incMs - Increment per move in ms
+ * @field depth - Depth limit per move
+ * @field nodes - Node limit per move (0 = none)
+ * @field hashMB - Transposition table size per engine in MB
+ * @field bookPlies - Book moves played from the initial position
+ * @field elo0 - SPRT null hypothesis: A is elo0 stronger than B
+ * @field elo1 - SPRT alternative hypothesis: A is elo1 stronger than B
+ * @field alpha - SPRT false positive rate; the LLR upper bound is log((1-beta)/alpha)
+ * @field beta - SPRT false negative rate; the LLR lower bound is log(beta/(1-alpha))
+ * @field engines - Options engine A (index 0) and engine B (index 1) search with
+ */
+typedef struct {
+	const char *openingsPath;
+	const char *pgnPath;
+	int games;
+	int concurrency;
+	int baseMs;
+	int incMs;
+	int depth;
+	long nodes;
+	int hashMB;
+	int bookPlies;
+	double elo0;
+	double elo1;
+	double alpha;
+	double beta;
+	S_OPTIONS engines[2];
+} SelfPlayOptions;
+
+/**
+ * @struct ClusterOptions
+ * @brief Settings of a distributed analysis coordinator or worker (search_cluster.c)
+ * @field inPath - Coordinator: EPD or FEN file, one position per line
+ * @field rootFen - Coordinator: single position analysed instead of a file
+ * @field outPath - Coordinator: NDJSON output file (NULL = stdout)
+ * @field host - Worker: coordinator host name or address
+ * @field port - TCP port the coordinator listens on
+ * @field depth - Depth limit per unit (a split root move is searched one less)
+ * @field nodes - Node limit per unit (0 = none)
+ * @field movetime - Time limit per unit in ms (0 = none)
+ * @field split - Every legal root move of a position is its own work unit
+ * @field shareDepth - Exact hash entries at least this deep are passed
+ *        between workers (0 = no sharing)
+ * @field ordered - Write results in input order rather than as completed
+ * @field attempts - Units a worker was lost on are dispatched this often
+ *        before they are reported as failed
+ * @field threads - Worker: units searched at once, one thread each
+ * @field hashMB - Worker: size of the table all its threads share
+ * @field connectSeconds - Worker: how long to keep trying to reach the coordinator
+ */
+typedef struct {
+	const char *inPath;
+	const char *rootFen;
+	const char *outPath;
+	const char *host;
+	int port;
+	int depth;
+	long nodes;
+	int movetime;
+	int split;
+	int shareDepth;
+	int ordered;
+	int attempts;
+	int threads;
+	int hashMB;
+	int connectSeconds;
+} ClusterOptions;
+
 
 /* GAME MOVE */
 
@@ -392,6 +1025,26 @@ typedef struct {
 
 #define NOMOVE 0            // Represents no move/invalid move
 
+/* ===========================================================================
+ * PACKED (16-BIT) MOVE ENCODING
+ *
+ * Compact form (PackedMove) used where storage matters (transposition
+ * table, killers):
+ * - Bits 0-5:   From square (0-63)
+ * - Bits 6-11:  To square (0-63)
+ * - Bits 12-13: Promotion piece (0 = knight, 1 = bishop, 2 = rook, 3 = queen)
+ * - Bits 14-15: Move type (normal, promotion, en passant, castle)
+ *
+ * Captured piece and pawn-start flag are recovered from the board by
+ * Move_Unpack. NOMOVE packs to 0.
+ * ===========================================================================
+ */
+
+#define PACKED_MOVE_NORMAL 0
+#define PACKED_MOVE_PROMOTION 1
+#define PACKED_MOVE_ENPASSANT 2
+#define PACKED_MOVE_CASTLE 3
+
 
 /* MACROS */
 
@@ -407,18 +1060,63 @@ typedef struct {
 #define SQUARE_120_TO_64(sq120) (g_square120To64[(sq120)])
 #define SQUARE_64_TO_120(sq64) (g_square64To120[(sq64)])
 
-/** Bitboard operations */
+/**
+ * Bitboard operations.
+ *
+ * Build variants (see ARCH in the makefile) select the bit counting and
+ * scanning code at compile time:
+ * - USE_POPCNT: BITBOARD_COUNT is one POPCNT instruction
+ * - USE_BMI: BITBOARD_POP is TZCNT plus BLSR, inlined
+ * - neither: portable loop / de Bruijn table (any CPU, e.g. ARM)
+ * Misc_CheckCpuFeatures refuses to start a variant on a CPU without
+ * the instructions it was built for.
+ */
+#ifdef USE_BMI
+static inline int Bitboard_PopLsb(U64 *bb) {
+	int index = (int)__builtin_ctzll(*bb);
+	*bb &= *bb - 1;
+	return index;
+}
+#define BITBOARD_POP(b) Bitboard_PopLsb(b)                 // Pop least significant bit
+#else
 #define BITBOARD_POP(b) Bitboard_PopBit(b)                 // Pop least significant bit
+#endif
+#ifdef USE_POPCNT
+#define BITBOARD_COUNT(b) __builtin_popcountll(b)            // Count bits in bitboard
+#else
 #define BITBOARD_COUNT(b) Bitboard_CountBits(b)              // Count bits in bitboard
+#endif
 #define BITBOARD_CLEAR_BIT(bb,squareIndex) ((bb) &= g_bitClearMask[(squareIndex)])  // Clear bit at square
 #define BITBOARD_SET_BIT(bb,squareIndex) ((bb) |= g_bitSetMask[(squareIndex)])    // Set bit at square
 
+/**
+ * Slider attack lookups (64-square index, full occupancy bitboard).
+ * Magic multiply-shift by default, PEXT when built with -DUSE_PEXT.
+ */
+#ifdef USE_PEXT
+#define MAGIC_INDEX(m,occ) _pext_u64((occ), (m).mask)
+#else
+#define MAGIC_INDEX(m,occ) ((((occ) & (m).mask) * (m).magic) >> (m).shift)
+#endif
+#define BISHOP_ATTACKS(sq64,occ) (g_bishopMagics[(sq64)].attacks[MAGIC_INDEX(g_bishopMagics[(sq64)],(occ))])
+#define ROOK_ATTACKS(sq64,occ) (g_rookMagics[(sq64)].attacks[MAGIC_INDEX(g_rookMagics[(sq64)],(occ))])
+#define QUEEN_ATTACKS(sq64,occ) (BISHOP_ATTACKS(sq64,occ) | ROOK_ATTACKS(sq64,occ))
+
 /** Piece type queries */
 #define PIECE_IS_BISHOP_QUEEN(p) (g_pieceBishopQueen[(p)])  // Is piece a bishop or queen?
 #define PIECE_IS_ROOK_QUEEN(p) (g_pieceRookQueen[(p)])    // Is piece a rook or queen?
 #define PIECE_IS_KNIGHT(p) (g_pieceKnight[(p)])       // Is piece a knight?
 #define PIECE_IS_KING(p) (g_pieceKing[(p)])         // Is piece a king?
 
+/**
+ * En passant test used by Move_Make and FEN parsing: does a pawn of colour
+ * stand beside the double-pushed pawn on pawnSq (120-square)? Only then
+ * is enPas set and hashed, exactly as Polyglot hashes it.
+ */
+#define EP_CAPTURABLE(board,pawnSq,colour) \
+	((board)->pieces[(pawnSq) - 1] == ((colour) == COLOR_TYPE_WHITE ? PIECE_TYPE_WHITE_PAWN : PIECE_TYPE_BLACK_PAWN) \
+	|| (board)->pieces[(pawnSq) + 1] == ((colour) == COLOR_TYPE_WHITE ? PIECE_TYPE_WHITE_PAWN : PIECE_TYPE_BLACK_PAWN))
+
 /** Mirror square for evaluation symmetry */
 #define SQUARE_MIRROR_64(squareIndex) (Mirror64[(squareIndex)])
 
@@ -430,17 +1128,17 @@ typedef struct {
 /* GLOBALS */
 
 // Square conversion tables
-extern int g_square120To64[CHESS_BOARD_SQUARE_NUM];  // Map 120-square to 64-square index
-extern int g_square64To120[64];          // Map 64-square to 120-square index
+extern const int g_square120To64[CHESS_BOARD_SQUARE_NUM];  // Map 120-square to 64-square index
+extern const int g_square64To120[64];          // Map 64-square to 120-square index
 
 // Bitboard masks
-extern U64 g_bitSetMask[64];    // Masks to set a bit at each square
-extern U64 g_bitClearMask[64];  // Masks to clear a bit at each square
+extern const U64 g_bitSetMask[64];    // Masks to set a bit at each square
+extern const U64 g_bitClearMask[64];  // Masks to clear a bit at each square
 
-// Zobrist hashing keys
-extern U64 g_pieceKeys[13][120];  // Hash keys for pieces at squares
-extern U64 g_sideKey;          // Hash key for side to move
-extern U64 g_castleKeys[16];   // Hash keys for castle permissions
+// Zobrist hashing keys (Polyglot's Random64Poly values, see types_generator.c)
+extern const U64 g_pieceKeys[13][120];  // Hash keys for pieces at squares
+extern const U64 g_sideKey;          // Hash key for side to move
+extern const U64 g_castleKeys[16];   // Hash keys for castle permissions
 
 // Character representations
 extern char PceChar[];   // Character for each piece type
@@ -457,8 +1155,8 @@ extern int g_pieceCol[13];        // Color of each piece
 extern int g_piecePawn[13];       // Is piece a pawn?
 
 // Board properties
-extern int g_filesBoard[CHESS_BOARD_SQUARE_NUM];  // File of each square
-extern int g_ranksBoard[CHESS_BOARD_SQUARE_NUM];  // Rank of each square
+extern const int g_filesBoard[CHESS_BOARD_SQUARE_NUM];  // File of each square
+extern const int g_ranksBoard[CHESS_BOARD_SQUARE_NUM];  // Rank of each square
 
 // Piece movement properties
 extern int g_pieceKnight[13];      // Is piece a knight?
@@ -471,14 +1169,52 @@ extern int g_pieceSlides[13];      // Is piece a sliding piece?
 extern int Mirror64[64];  // Mirror table for position evaluation
 
 // Bitboard masks for evaluation
-extern U64 g_fileBBMask[8];         // Bitboard for each file
-extern U64 g_rankBBMask[8];         // Bitboard for each rank
-extern U64 g_blackPassedMask[64];   // Passed pawn masks for black
-extern U64 g_whitePassedMask[64];   // Passed pawn masks for white
-extern U64 g_isolatedMask[64];      // Isolated pawn masks
-
-// Engine options
-extern S_OPTIONS EngineOptions[1];
+extern const U64 g_fileBBMask[8];   // Bitboard for each file
+extern const U64 g_rankBBMask[8];   // Bitboard for each rank
+extern const U64 g_blackPassedMask[64]; // Passed pawn masks for black
+extern const U64 g_whitePassedMask[64]; // Passed pawn masks for white
+extern const U64 g_isolatedMask[64];    // Isolated pawn masks
+
+// Attack tables (bitboards_attacks.c), 64-square indices
+extern U64 g_knightAttacks[64];     // Knight attacks from each square
+extern U64 g_kingAttacks[64];       // King attacks from each square
+extern U64 g_pawnAttacks[2][64];    // Squares a pawn of each colour attacks
+extern U64 g_betweenMask[64][64];   // Squares strictly between two aligned squares
+extern U64 g_lineMask[64][64];      // Full line through two aligned squares
+extern SliderMagic g_bishopMagics[64];
+extern SliderMagic g_rookMagics[64];
+extern const U64 g_bishopMagicNumbers[64]; // Generated magic multipliers (types_tables.c)
+extern const U64 g_rookMagicNumbers[64];
+
+// MVV-LVA capture ordering scores, [victim][attacker]
+extern const int g_mvvLvaScores[13][13];
+
+// Piece-square scores (evaluation_static.c), [piece][120-square], each from
+// its owner's point of view; middlegame and endgame differ in the king tables
+extern int g_pstMg[13][CHESS_BOARD_SQUARE_NUM];
+extern int g_pstEg[13][CHESS_BOARD_SQUARE_NUM];
+
+// Engine options: the ones the protocols set, and the ones the calling
+// thread searches with (g_engineOptions unless the thread points it at
+// its own set, as self-play does for each side)
+extern S_OPTIONS g_engineOptions[1];
+extern THREAD_LOCAL S_OPTIONS *EngineOptions;
+
+// Transposition table shared by every search thread
+extern HashTable g_hashTable[1];
+
+// Evaluation cache shared by every search thread
+extern EvalCache g_evalCache[1];
+
+// Evaluation network (evaluation_nnue.c), read-only while searching
+extern NnueNetwork g_nnue[1];
+
+// Largest tablebase found by Tb_Init, 0 when none are available
+extern int g_tbMaxPieces;
+
+// Tunable evaluation terms (evaluation_static.c)
+extern EvalParam g_evalParams[];
+extern const int g_evalParamCount;
 
 /* ===========================================================================
  * FUNCTION DECLARATIONS
@@ -496,11 +1232,12 @@ extern S_OPTIONS EngineOptions[1];
  * @brief Initialize all global arrays and data structures
  * 
  * This function must be called once before using the engine. It initializes:
- * - Square conversion tables
- * - Bitboard masks
- * - Zobrist hash keys
- * - Evaluation masks
- * - Move generation tables
+ * - Slider attack tables, from the generated magic numbers
+ * - Piece-square and reduction tables
+ * - The opening book
+ *
+ * Square tables, masks, Zobrist keys and MVV-LVA scores are constant
+ * data generated at build time (types_tables.c).
  */
 extern void Init_All();
 
@@ -529,6 +1266,18 @@ extern int Bitboard_PopBit(U64 *bb);
  */
 extern int Bitboard_CountBits(U64 b);
 
+/* ---------------------------------------------------------------------------
+ * ATTACK TABLES (bitboards_attacks.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Build knight/king/pawn attack sets and the magic slider tables
+ *
+ * Called once from Init_All; must run before any attack lookup.
+ */
+extern void Init_AttackTables();
+
 /* ---------------------------------------------------------------------------
  * HASH KEYS (board_hashkeys.c)
  * ---------------------------------------------------------------------------
@@ -541,11 +1290,43 @@ extern int Bitboard_CountBits(U64 b);
  */
 extern U64 Board_GeneratePositionKey(const ChessBoard *board);
 
+/**
+ * @brief Generate the pawn-only Zobrist key from scratch
+ * @param board Board position
+ * @return XOR of the piece keys of every pawn on the board
+ */
+extern U64 Board_GeneratePawnKey(const ChessBoard *board);
+
 /* ---------------------------------------------------------------------------
  * BOARD OPERATIONS (board_representation.c)
  * ---------------------------------------------------------------------------
  */
 
+/**
+ * @brief Allocate the game history and search tables of a board
+ * @param board Board to set up (HashTable is left to the caller)
+ *
+ * Must be called once before the board is used; exits if memory runs out.
+ */
+extern void Board_Init(ChessBoard *board);
+
+/**
+ * @brief Release the memory allocated by Board_Init
+ * @param board Board to release
+ */
+extern void Board_Free(ChessBoard *board);
+
+/**
+ * @brief Copy a position into another initialised board
+ * @param dest Board set up with Board_Init (keeps its own history and tables)
+ * @param src Board to copy
+ *
+ * Copies the position and the history entries since the last irreversible
+ * move, which is all repetition detection and the search need. Search
+ * tables are not copied.
+ */
+extern void Board_Copy(ChessBoard *dest, const ChessBoard *src);
+
 /**
  * @brief Reset board to empty state
  * @param board Board to reset
@@ -613,6 +1394,18 @@ extern void Board_Mirror(ChessBoard *board);
  */
 extern int Attack_IsSquareAttacked(const int squareIndex, const int side, const ChessBoard *board);
 
+/**
+ * @brief Static Exchange Evaluation of a move
+ * @param board Board position
+ * @param move Capture (or quiet move) to evaluate
+ * @return Material won (positive) or lost (negative) by the side to move
+ *         once the exchange on the target square is played out
+ *
+ * Both sides recapture with their least valuable attacker and may stop
+ * at any point; x-ray attackers are included. Pins and checks are ignored.
+ */
+extern int Attack_SEE(const ChessBoard *board, const int move);
+
 /* ---------------------------------------------------------------------------
  * INPUT/OUTPUT (moves_io.c)
  * ---------------------------------------------------------------------------
@@ -636,12 +1429,41 @@ extern char *PrMove(const int move);
  */
 extern char *PrSq(const int squareIndex);
 
+/**
+ * @brief Pack a move into its 16-bit form
+ * @param move Move to pack
+ * @return Packed move (0 for NOMOVE)
+ */
+extern PackedMove Move_Pack(const int move);
+
+/**
+ * @brief Rebuild a full move from its 16-bit form
+ * @param board Position the move was packed in
+ * @param packed Packed move
+ * @return Encoded move, or NOMOVE if the from square does not hold a
+ *         piece of the side to move
+ *
+ * The result is only as good as the packed input: callers that read it
+ * from a shared table must still check that the move exists.
+ */
+extern int Move_Unpack(const ChessBoard *board, const PackedMove packed);
+
 /**
  * @brief Print all moves in a move list
  * @param list Move list to print
  */
 extern void PrintMoveList(const MoveList *list);
 
+/**
+ * @brief Standard algebraic notation of a legal move, as PGN wants it
+ * @param board Position before the move (made and taken back to test for check)
+ * @param move Legal move
+ * @param san At least 8 characters, receives e.g. "Nbd7", "exd6", "e8=Q+", "O-O#"
+ *
+ * Unlike PrMove it uses no static buffer, so any thread may call it.
+ */
+extern void Move_ToSan(ChessBoard *board, const int move, char *san);
+
 /**
  * @brief Parse string to move (e.g., "e2e4" to encoded move)
  * @param ptrChar String to parse
@@ -691,6 +1513,14 @@ extern int PieceValidEmpty(const int piece);
  */
 extern int PieceValid(const int piece);
 
+/**
+ * @brief Check a FEN well enough for Board_ParseFromFEN to read it safely
+ * @param fen FEN, at least the four position fields
+ * @return BOOL_TYPE_TRUE for eight ranks of eight squares, one king per
+ *         side, a side to move, castling rights and an en passant field
+ */
+extern int Board_IsValidFen(const char *fen);
+
 /**
  * @brief Testing function for evaluation symmetry
  * @param board Board position
@@ -750,6 +1580,42 @@ extern void Move_GenerateAll(const ChessBoard *board, MoveList *list);
  */
 extern void GenerateAllCaps(const ChessBoard *board, MoveList *list);
 
+/**
+ * @brief Generate all non-capture moves only
+ * @param board Board position
+ * @param list Output move list
+ *
+ * Quiet moves, quiet promotions and castling; together with
+ * GenerateAllCaps this yields exactly the Move_GenerateAll list.
+ */
+extern void Move_GenerateQuiets(const ChessBoard *board, MoveList *list);
+
+/**
+ * @brief Generate all legal moves for current position
+ * @param board Board position
+ * @param list Output move list
+ *
+ * Checkers and pinned pieces are computed once; pinned pieces stay on
+ * their pin ray, check evasions are limited to capturing the checker or
+ * blocking, and king moves, castling and en passant are tested against
+ * the enemy attacks directly. Every move may be played with Move_MakeLegal.
+ */
+extern void Move_GenerateLegal(const ChessBoard *board, MoveList *list);
+
+/**
+ * @brief Generate the legal capture moves only
+ * @param board Board position
+ * @param list Output move list
+ */
+extern void Move_GenerateLegalCaptures(const ChessBoard *board, MoveList *list);
+
+/**
+ * @brief Generate the legal non-capture moves only
+ * @param board Board position
+ * @param list Output move list
+ */
+extern void Move_GenerateLegalQuiets(const ChessBoard *board, MoveList *list);
+
 /**
  * @brief Check if a move exists in current position
  * @param board Board position
@@ -759,11 +1625,28 @@ extern void GenerateAllCaps(const ChessBoard *board, MoveList *list);
 extern int MoveExists(ChessBoard *board, const int move);
 
 /**
- * @brief Initialize MVV-LVA (Most Valuable Victim - Least Valuable Attacker) table
- * 
- * This table is used for move ordering to search captures in optimal order.
+ * @brief Cheap pseudo-legality test for a move taken from outside the
+ *        generator (e.g. a transposition table probe)
+ * @param board Board position
+ * @param move Move to check
+ * @return BOOL_TYPE_TRUE if Move_GenerateAll could have produced the move
+ *
+ * Checks piece ownership, the captured piece, move geometry, blocked
+ * slider paths, pawn/promotion/en passant rules and castle conditions,
+ * without generating a move list. Self-check is left to Move_Make.
+ */
+extern int Move_IsPseudoLegal(const ChessBoard *board, const int move);
+
+/**
+ * @brief Full legality test for a move taken from outside the generator
+ * @param board Board position
+ * @param move Move to check
+ * @return BOOL_TYPE_TRUE if Move_GenerateLegal could have produced the move
+ *
+ * Move_IsPseudoLegal plus a check, on bitboards and without making the
+ * move, that the own king is not left attacked.
  */
-extern void Init_MvvLva();
+extern int Move_IsLegal(const ChessBoard *board, const int move);
 
 /* ---------------------------------------------------------------------------
  * MAKE/UNMAKE MOVES (moves_execution.c)
@@ -781,6 +1664,26 @@ extern void Init_MvvLva();
  */
 extern int Move_Make(ChessBoard *board, int move);
 
+/**
+ * @brief Make a move already known to be legal
+ * @param board Board position (modified)
+ * @param move Move from Move_GenerateLegal or validated by Move_IsLegal
+ *
+ * Same as Move_Make without the self-check test afterwards.
+ */
+extern void Move_MakeLegal(ChessBoard *board, int move);
+
+/**
+ * @brief Compute the hash key the position would have after a move
+ * @param board Board position (not modified)
+ * @param move Pseudo-legal move
+ * @return Zobrist key equal to board->posKey after Move_Make(board, move)
+ *
+ * Cheap XOR of the affected piece/castle/en passant/side keys, used to
+ * prefetch the child's TT bucket before the move is made.
+ */
+extern U64 Move_ChildKey(const ChessBoard *board, const int move);
+
 /**
  * @brief Unmake the last move (rollback to previous position)
  * @param board Board position (modified)
@@ -810,15 +1713,41 @@ extern void TakeNullMove(ChessBoard *board);
  * ---------------------------------------------------------------------------
  */
 
+/**
+ * @brief Count leaf nodes of the legal move tree to a given depth
+ * @param board Board position (restored on return)
+ * @param depth Depth to search
+ * @return Number of leaf nodes
+ *
+ * Bulk counts at depth 1 and probes the perft hash when
+ * Search_PerftTest has one allocated.
+ */
+extern U64 Search_Perft(ChessBoard *board, const int depth);
+
 /**
  * @brief Performance test - count all leaf nodes at given depth
  * @param depth Depth to search
  * @param board Board position
+ * @param threads Number of threads the root moves are divided across
+ * @param hashMB Perft hash size in MB (0 = no hash)
  * 
  * Used for debugging move generation and make/unmake functions.
- * Prints node counts for each root move.
+ * Prints node counts for each root move, the total and nodes per second.
+ */
+extern void Search_PerftTest(int depth, ChessBoard *board, const int threads, const int hashMB);
+
+/**
+ * @brief Run an EPD perft regression suite
+ * @param path EPD file, one position per line with ";D<depth> <nodes>" fields
+ * @param maxDepth Depths above this are skipped
+ * @param threads Number of threads positions are spread across
+ * @param hashMB Perft hash size in MB (0 = no hash)
+ * @return Number of failing positions, or -1 if the suite could not be run
+ *
+ * Prints PASS/FAIL, nodes and time per line and a final
+ * "perftsuite result=... passed=... failed=..." summary line.
  */
-extern void Search_PerftTest(int depth, ChessBoard *board);
+extern int Search_PerftSuite(const char *path, const int maxDepth, const int threads, const int hashMB);
 
 /* ---------------------------------------------------------------------------
  * SEARCH (search_algorithm.c)
@@ -834,11 +1763,23 @@ extern void Search_PerftTest(int depth, ChessBoard *board);
  * - Iterative deepening
  * - Principal variation search
  * - Null move pruning
+ * - Late move reductions, futility and reverse futility pruning
+ *   (each switchable through EngineOptions)
  * - Transposition table
  * - Quiescence search
+ * - Lazy SMP: EngineOptions->Threads - 1 helper threads search copies of
+ *   the board and share the transposition table; the main thread's result
+ *   is reported and node counts are summed across threads
  */
 extern void Search_Position(ChessBoard *board, SearchInfo *info);
 
+/**
+ * @brief Initialize the late move reduction table
+ *
+ * Called once from Init_All.
+ */
+extern void Search_InitReductions();
+
 /**
  * @brief Get best move for current position (wrapper for Search_Position)
  * @param board Board position
@@ -847,23 +1788,376 @@ extern void Search_Position(ChessBoard *board, SearchInfo *info);
  */
 extern int Search_GetBestMove(ChessBoard *board, SearchInfo *info);
 
+/**
+ * @brief Quiescence-resolved score of a position, no time or input checks
+ * @param board Board position (searched from ply 0)
+ * @param info Node counter; threadId must be -1
+ * @return Score in centipawns from the side to move's point of view
+ */
+extern int Search_QuiescenceScore(ChessBoard *board, SearchInfo *info);
+
+/**
+ * @brief Single-threaded search without output, input or helpers
+ * @param board Board position; its HashTable may be shared with other searches
+ * @param info Limits (depth, nodeLimit, mateLimit, searchMoves, Time_Allocate);
+ *        stopRequest is the only outside stop signal
+ * @param result Filled with the best move, score, depth, nodes and PV
+ * @return Best move, as in result
+ *
+ * Touches no global search state, so any number of these can run on
+ * separate boards at once (batch analysis). The caller decides when the
+ * hash generation moves on.
+ */
+extern int Search_Independent(ChessBoard *board, SearchInfo *info, SearchResult *result);
+
+/* ---------------------------------------------------------------------------
+ * TIME MANAGER (search_timeman.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Set the soft and hard limits for the coming search
+ * @param info Search control; starttime must already be set
+ * @param time Remaining clock in ms (-1 = no clock)
+ * @param inc Increment per move in ms
+ * @param movestogo Moves until the next time control (0 = sudden death)
+ * @param movetime Fixed time per move in ms (-1 = none), overrides the clock
+ *
+ * Sets timeset and stoptime (the hard limit). MoveOverhead is taken
+ * off first; without time or movetime the search is unlimited.
+ */
+extern void Time_Allocate(SearchInfo *info, const int time, const int inc, const int movestogo, const int movetime);
+
+/**
+ * @brief Restart the budget of a ponder search from now
+ * @param info Search control of the running search
+ */
+extern void Time_PonderHit(SearchInfo *info);
+
+/**
+ * @brief Record a completed iteration and decide whether to start another
+ * @param info Search control (main thread)
+ * @param bestMove Best move of the iteration
+ * @param score Score of the iteration
+ * @return BOOL_TYPE_TRUE when the scaled soft limit has passed
+ *
+ * The soft limit grows while the best move keeps changing or the score
+ * falls, and shrinks once the best move has been stable for a few
+ * iterations; it never passes the hard limit. The caller ignores the
+ * result while pondering.
+ */
+extern int Time_StopIterating(SearchInfo *info, const int bestMove, const int score);
+
+/**
+ * @brief Nodes to search before the next CheckUp
+ * @param info Search control of the calling thread
+ * @param now Current time from Misc_GetTimeMs
+ * @return About one millisecond of nodes at the measured speed for the
+ *         main thread, a fixed interval for helpers
+ */
+extern long Time_CheckInterval(const SearchInfo *info, const int now);
+
+/* ---------------------------------------------------------------------------
+ * SEARCH STATISTICS (search_stats.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Zero a set of counters
+ * @param stats Counters to clear
+ */
+extern void Stats_Clear(SearchStats *stats);
+
+/**
+ * @brief Add one thread's counters to a total
+ * @param total Running total
+ * @param stats Counters to add (nodes included)
+ */
+extern void Stats_Add(SearchStats *total, const SearchStats *stats);
+
+/**
+ * @brief Forget the per-depth record of the previous search
+ *
+ * Called by Search_Position before the first iteration; the record is
+ * kept until the next search so the stats command can show it.
+ */
+extern void Stats_BeginSearch();
+
+/**
+ * @brief Record the totals after a completed iteration
+ * @param depth Iteration depth
+ * @param total Counters summed over all threads, cumulative for the search
+ */
+extern void Stats_RecordIteration(const int depth, const SearchStats *total);
+
+/**
+ * @brief Close the record with the search's final totals
+ * @param total Counters summed over all threads, helpers joined
+ * @param elapsed Search time in ms
+ *
+ * Appends the search to the dump file when one is set.
+ */
+extern void Stats_EndSearch(const SearchStats *total, const int elapsed);
+
+/**
+ * @brief Print the last search's statistics
+ * @param uci BOOL_TYPE_TRUE to print "info string" lines
+ * @param perDepth Also print one line per completed iteration
+ *
+ * Rates: TT hits and cuts per probe, first-move share of the beta
+ * cutoffs, null move cuts per try, quiescence share of the nodes and
+ * the branching factor against the previous iteration.
+ */
+extern void Stats_Print(const int uci, const int perDepth);
+
+/**
+ * @brief Append every following search's statistics to a file
+ * @param path File name; ".csv" gives one CSV row per iteration, anything
+ *        else one JSON object per line; empty or "<empty>" stops dumping
+ */
+extern void Stats_SetDumpFile(const char *path);
+
+/* ---------------------------------------------------------------------------
+ * BENCH (search_bench.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Search the built-in bench positions to a fixed depth
+ * @param board Supplies the transposition table; its position is untouched
+ * @param info Search control; a "quit" read during the run is left set in it
+ * @param depth Search depth for every position
+ * @param threads Search threads (the node signature is deterministic with 1)
+ * @param hashMB Resize the transposition table to this many MB first (0 = keep)
+ * @return Total nodes searched, the bench signature
+ *
+ * The hash and search tables are cleared before every position. Prints
+ * per-position nodes, then total time, nodes and nodes per second.
+ */
+extern long Search_Bench(ChessBoard *board, SearchInfo *info, int depth, int threads, const int hashMB);
+
+/* ---------------------------------------------------------------------------
+ * BATCH ANALYSIS (search_analyse.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Fill analysis settings from command line arguments
+ * @param options Settings to fill; defaults for everything not given
+ * @param argc Arguments after "analyse"
+ * @param argv Input file, then --depth, --nodes, --movetime, --threads,
+ *        --hash, --shared-hash, --order input|completed and --out
+ * @return BOOL_TYPE_FALSE (after printing the usage) on a bad argument
+ */
+extern int Analyse_ParseOptions(AnalyseOptions *options, const int argc, char *argv[]);
+
+/**
+ * @brief Analyse every position of a file on a pool of workers
+ * @param options Settings from Analyse_ParseOptions
+ * @return Number of lines that could not be analysed, or -1 if the run
+ *         could not start
+ *
+ * Positions are streamed from the file, so its size is not limited by
+ * memory. One JSON object per position is written: line, id (EPD "id"
+ * operation), fen, bestmove, score, depth, seldepth, nodes, time and pv.
+ */
+extern int Analyse_Run(const AnalyseOptions *options);
+
+/**
+ * @brief Split an EPD or FEN line into its position and EPD id
+ * @param text Input line (modified)
+ * @param fen Receives the four position fields plus the move counters if
+ *        the line has them (ANALYSE_LINE characters)
+ * @param id Receives the "id" operation, empty if none (ANALYSE_ID characters)
+ * @return BOOL_TYPE_FALSE for blank and comment lines; the FEN is not validated
+ */
+extern int Analyse_ParseLine(char *text, char *fen, char *id);
+
+/**
+ * @brief Search one position the way every analyse worker does
+ * @param board Position to search; its hash table is neither cleared nor aged
+ * @param info Cleared by the caller; only the limits are set here, so
+ *        another thread may already have raised stopRequest
+ * @param depth Depth limit
+ * @param nodes Node limit (0 = none)
+ * @param movetime Time limit in ms (0 = none)
+ * @param result Filled by Search_Independent
+ */
+extern void Analyse_Position(ChessBoard *board, SearchInfo *info, const int depth, const long nodes, const int movetime,
+	SearchResult *result);
+
+/**
+ * @brief Write one analysis result as an NDJSON line
+ * @param output Stream to write to
+ * @param lineNumber Input line number of the position
+ * @param id EPD id, empty for none
+ * @param fen Position as given in the input
+ * @param result Search result, ignored when error is set
+ * @param error Reason the position has no result, NULL if it has one
+ */
+extern void Analyse_WriteResult(FILE *output, const int lineNumber, const char *id, const char *fen,
+	const SearchResult *result, const char *error);
+
+/* ---------------------------------------------------------------------------
+ * DISTRIBUTED ANALYSIS (search_cluster.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Fill coordinator settings from command line arguments
+ * @param options Settings to fill; defaults for everything not given
+ * @param argc Arguments after "coordinator"
+ * @param argv Input file or --fen FEN, then --port, --depth, --nodes,
+ *        --movetime, --split, --share-tt depth, --attempts,
+ *        --order input|completed and --out
+ * @return BOOL_TYPE_FALSE (after printing the usage) on a bad argument
+ */
+extern int Cluster_ParseCoordinatorOptions(ClusterOptions *options, const int argc, char *argv[]);
+
+/**
+ * @brief Hand the positions to the workers that connect and collect their results
+ * @param options Settings from Cluster_ParseCoordinatorOptions
+ * @return Number of units without a result (bad FEN or failed on every
+ *         attempt), or -1 if the run could not start
+ *
+ * Results are written in the analyse NDJSON format. A split root move is
+ * reported from the root position: bestmove is the root move, the pv
+ * starts with it and score, depth and seldepth count from the root.
+ * Units of a worker that disconnects are dispatched again.
+ */
+extern int Cluster_RunCoordinator(const ClusterOptions *options);
+
+/**
+ * @brief Fill worker settings from command line arguments
+ * @param options Settings to fill; defaults for everything not given
+ * @param argc Arguments after "worker"
+ * @param argv host[:port], then --threads, --hash and --connect-timeout seconds
+ * @return BOOL_TYPE_FALSE (after printing the usage) on a bad argument
+ */
+extern int Cluster_ParseWorkerOptions(ClusterOptions *options, const int argc, char *argv[]);
+
+/**
+ * @brief Search units for a coordinator until it has no more
+ * @param options Settings from Cluster_ParseWorkerOptions
+ * @return 0 when the coordinator ended the run, 1 if it could not be
+ *         reached or the connection was lost
+ */
+extern int Cluster_RunWorker(const ClusterOptions *options);
+
+/* ---------------------------------------------------------------------------
+ * SELF-PLAY (search_selfplay.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Fill match settings from command line arguments
+ * @param options Settings to fill; defaults for everything not given
+ * @param argc Arguments after "selfplay"
+ * @param argv --games, --concurrency, --tc base+inc (seconds), --depth,
+ *        --nodes, --hash, --openings file, --book-plies, --pgn file,
+ *        --elo0, --elo1, --alpha, --beta, and --a / --b with
+ *        "Name=value,..." UCI option settings (LMR, Futility,
+ *        ReverseFutility, LazyMargin, MoveOverhead, SyzygyProbeDepth,
+ *        SyzygyProbeLimit) for one engine
+ * @return BOOL_TYPE_FALSE (after printing the usage) on a bad argument
+ */
+extern int SelfPlay_ParseOptions(SelfPlayOptions *options, const int argc, char *argv[]);
+
+/**
+ * @brief Play a match between two option sets until the SPRT decides
+ * @param options Settings from SelfPlay_ParseOptions
+ * @return 1 when H1 (A stronger by elo1) is accepted, -1 for H0, 0 when
+ *         the game limit came first
+ *
+ * Every opening is played twice with colours reversed. After each game
+ * prints the running W/D/L from A's point of view, the Elo estimate and
+ * the log-likelihood ratio with its bounds, and appends the PGN.
+ */
+extern int SelfPlay_Run(const SelfPlayOptions *options);
+
+/* ---------------------------------------------------------------------------
+ * MOVE PICKER (search_movepicker.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Prepare a move picker for a node
+ * @param picker Picker to initialise
+ * @param board Board position
+ * @param ttMove Hash move from HashTable_ProbeEntry (already validated), or NOMOVE
+ * @param capturesOnly BOOL_TYPE_TRUE for quiescence search
+ *
+ * Nothing is generated until MovePicker_Next needs it.
+ */
+extern void MovePicker_Init(MovePicker *picker, const ChessBoard *board, const int ttMove, const int capturesOnly);
+
+/**
+ * @brief Get the next move to search
+ * @param picker Picker prepared with MovePicker_Init
+ * @param board Board position (must be the one the picker was initialised on)
+ * @return Next legal move, or NOMOVE when all moves have been returned
+ *
+ * Every move is returned once and may be played with Move_MakeLegal.
+ */
+extern int MovePicker_Next(MovePicker *picker, const ChessBoard *board);
+
 /* ---------------------------------------------------------------------------
  * MISC UTILITIES (utils_misc.c)
  * ---------------------------------------------------------------------------
  */
 
 /**
- * @brief Get current time in milliseconds
- * @return Time in milliseconds
+ * @brief Get current time in milliseconds from a monotonic clock
+ * @return Milliseconds since the first call; never jumps with wall-clock changes
  */
 extern int Misc_GetTimeMs();
 
 /**
  * @brief Check for user input and handle GUI/console commands
  * @param info Search information (may set quit or stopped flags)
+ *
+ * While pondering the input is only detected, not read, so the protocol
+ * loop still receives the command that ended the ponder search.
  */
 extern void Misc_ReadInput(SearchInfo *info);
 
+/**
+ * @brief Check whether input is waiting on stdin, without reading it
+ * @return Non-zero if a read would not block
+ */
+extern int InputWaiting();
+
+/**
+ * @brief Sleep the calling thread
+ * @param ms Milliseconds
+ */
+extern void Misc_Sleep(const int ms);
+
+/**
+ * @brief Refuse to run a build variant the CPU cannot execute
+ *
+ * Checks the instruction set extensions selected at build time
+ * (USE_POPCNT, USE_BMI, USE_PEXT) against the running CPU and exits
+ * with a message naming the missing feature and the portable build.
+ * Called first in Init_All, before any bitboard code runs.
+ */
+extern void Misc_CheckCpuFeatures();
+
+/**
+ * @brief Map a whole file read-only into memory
+ * @param path File to map
+ * @param size Receives the file length in bytes (0 on failure)
+ * @return Start of the mapping, NULL if the file is missing or empty
+ */
+extern const void *Misc_MapFile(const char *path, size_t *size);
+
+/**
+ * @brief Release a mapping made by Misc_MapFile
+ * @param memory Start of the mapping (NULL is ignored)
+ * @param size Length returned by Misc_MapFile
+ */
+extern void Misc_UnmapFile(const void *memory, const size_t size);
+
 /* ---------------------------------------------------------------------------
  * TRANSPOSITION TABLE (hashtable_pv.c)
  * ---------------------------------------------------------------------------
@@ -875,6 +2169,9 @@ extern void Misc_ReadInput(SearchInfo *info);
  * @param MB Size in megabytes
  * 
  * Allocates memory for hash table. Call before first use.
+ * Uses huge pages (Linux) or large pages (Windows) when the OS grants
+ * them and falls back to normal pages otherwise. If the allocation
+ * fails the size is halved until it fits, down to 1 MB.
  */
 extern void HashTable_Init(HashTable *table, const int MB);
 
@@ -915,12 +2212,104 @@ extern int HashTable_ProbePvMove(const ChessBoard *board);
  */
 extern int HashTable_GetPvLine(const int depth, ChessBoard *board);
 
+/**
+ * @brief Prefetch the bucket a key maps to into the CPU cache
+ * @param table Hash table
+ * @param posKey Zobrist key of the position about to be probed
+ */
+extern void HashTable_Prefetch(const HashTable *table, const U64 posKey);
+
 /**
  * @brief Clear all entries in hash table
  * @param table Hash table to clear
+ *
+ * Large tables are zeroed in slices by EngineOptions->Threads threads.
  */
 extern void HashTable_Clear(HashTable *table);
 
+/**
+ * @brief Start a new search generation
+ * @param table Hash table
+ *
+ * Entries from older generations become preferred replacement victims
+ * instead of having to clear the table between moves.
+ */
+extern void HashTable_NewSearch(HashTable *table);
+
+/**
+ * @brief Table occupancy for UCI hashfull
+ * @param table Hash table
+ * @return Per mille of the sampled entries written in the current generation
+ *
+ * Samples the first HASHFULL_SAMPLE_BUCKETS buckets only, cheap enough
+ * for every info line.
+ */
+extern int HashTable_Hashfull(const HashTable *table);
+
+/**
+ * @brief Release the memory held by the hash table
+ * @param table Hash table to free
+ */
+extern void HashTable_Free(HashTable *table);
+
+/**
+ * @brief Write the table to an image file (UCI savehash)
+ * @param table Hash table, not being searched
+ * @param path Image file to create
+ * @param minDepth Entries shallower than this are left out unless exact
+ *        (0 keeps every entry)
+ * @return Entries written, -1 if the file could not be written
+ *
+ * The image is a header page (format version, Zobrist key fingerprint,
+ * bucket count) followed by the buckets exactly as in memory. Blocks
+ * with no kept entry are skipped as holes, so a filtered image of a
+ * large table is a small sparse file where the file system supports it.
+ */
+extern long long HashTable_Save(const HashTable *table, const char *path, const int minDepth);
+
+/**
+ * @brief Replace the table with a HashTable_Save image (UCI loadhash)
+ * @param table Hash table, not being searched
+ * @param path Image file
+ * @return BOOL_TYPE_TRUE if loaded; otherwise the table is unchanged
+ *
+ * The file is mapped copy-on-write and used as the table, so the load
+ * takes no time whatever the size: pages are read in on first touch and
+ * stores never reach the file. The table takes the image's size.
+ * Images of another format version or key scheme are refused.
+ */
+extern int HashTable_Load(HashTable *table, const char *path);
+
+/**
+ * @brief Read the entry stored for a position, without a board
+ * @param table Hash table
+ * @param posKey Zobrist key of the position
+ * @param move Receives the packed best move
+ * @param score Receives the score as stored (mate scores relative to the node)
+ * @param depth Receives the depth
+ * @param flags Receives the bound (HFALPHA, HFBETA or HFEXACT)
+ * @return BOOL_TYPE_FALSE if the table holds no entry for the key
+ */
+extern int HashTable_ExportEntry(const HashTable *table, const U64 posKey, PackedMove *move, int *score, int *depth,
+	int *flags);
+
+/**
+ * @brief Store an entry another table exported (distributed analysis)
+ * @param table Hash table, may be searched meanwhile
+ * @param posKey Zobrist key of the position
+ * @param move Packed best move
+ * @param score Score as exported
+ * @param depth Depth, 1 to CHESS_MAX_SEARCH_DEPTH - 1
+ * @param flags Bound (HFALPHA, HFBETA or HFEXACT)
+ *
+ * Unlike a search store it never overwrites a deeper entry of the same
+ * position and only evicts entries it is deeper than once aged, so
+ * foreign entries don't push out the local search's own results. The
+ * move is checked with Move_IsLegal on every probe, as for any entry.
+ */
+extern void HashTable_ImportEntry(HashTable *table, const U64 posKey, const PackedMove move, const int score,
+	const int depth, const int flags);
+
 /* ---------------------------------------------------------------------------
  * EVALUATION (evaluation_static.c)
  * ---------------------------------------------------------------------------
@@ -937,9 +2326,196 @@ extern void HashTable_Clear(HashTable *table);
  * - Pawn structure
  * - Piece mobility
  * - King safety
+ *
+ * Material and piece-square sums come from the board's incremental
+ * accumulators; only the structural terms are computed here. With a
+ * network loaded (g_nnue) the score comes from Nnue_Evaluate instead.
  */
 extern int Evaluate_Position(const ChessBoard *board);
 
+/**
+ * @brief Cheap evaluation tier: material and piece-square sums only
+ * @param board Board position
+ * @return Score in centipawns from the side to move's point of view
+ */
+extern int Evaluate_Material(const ChessBoard *board);
+
+/**
+ * @brief Two-tier evaluation against a search window
+ * @param board Board position
+ * @param alpha Lower bound of the window
+ * @param beta Upper bound of the window
+ * @return The cheap score when it lies EngineOptions->LazyMargin or more
+ *         outside (alpha, beta), otherwise the full (cached) evaluation
+ *
+ * Counts each outcome in board->tables (lazyExits, fullEvals).
+ */
+extern int Evaluate_Lazy(const ChessBoard *board, const int alpha, const int beta);
+
+/**
+ * @brief Build g_pstMg/g_pstEg from the piece-square tables
+ *
+ * Called once from Init_All, before any board is set up.
+ */
+extern void Evaluate_InitPieceSquare();
+
+/**
+ * @brief Reset a pawn hash table and its counters
+ * @param table Table to clear
+ *
+ * Every slot is filled with the pawnless structure, whose key is 0, so
+ * an untouched slot never answers a probe wrongly.
+ */
+extern void Evaluate_ClearPawnHash(PawnHashTable *table);
+
+/* ---------------------------------------------------------------------------
+ * EVALUATION CACHE (evaluation_cache.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Allocate (or resize) an evaluation cache
+ * @param cache Cache to initialise
+ * @param MB Size in megabytes, 0 disables the cache
+ */
+extern void EvalCache_Init(EvalCache *cache, const int MB);
+
+/**
+ * @brief Empty every slot of an evaluation cache
+ * @param cache Cache to clear
+ */
+extern void EvalCache_Clear(EvalCache *cache);
+
+/**
+ * @brief Release an evaluation cache's memory
+ * @param cache Cache to free
+ */
+extern void EvalCache_Free(EvalCache *cache);
+
+/**
+ * @brief Evaluate_Position through g_evalCache
+ * @param board Board position
+ * @return Evaluation score in centipawns from the side to move's view
+ *
+ * Lock-free: a hit returns the cached score, a miss evaluates and
+ * overwrites the slot.
+ */
+extern int EvalCache_Evaluate(const ChessBoard *board);
+
+/**
+ * @brief Start loading the cache slot of a position into the CPU cache
+ * @param posKey Key of the position about to be evaluated
+ */
+extern void EvalCache_Prefetch(const U64 posKey);
+
+/* ---------------------------------------------------------------------------
+ * EVALUATION TUNING (evaluation_tune.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Load a labelled EPD/FEN file into compact positions
+ * @param set Set to fill (free with Tune_FreeSet)
+ * @param path File mapped with Misc_MapFile, one position per line with
+ *        its result as "1-0", "0-1", "1/2-1/2" or [1.0], [0.5], [0.0]
+ * @param threads Threads parsing the lines
+ * @return Number of positions loaded (lines without a result or with an
+ *         invalid FEN are skipped)
+ */
+extern long Tune_LoadSet(TuneSet *set, const char *path, const int threads);
+
+/**
+ * @brief Release a tuning set
+ * @param set Set to free
+ */
+extern void Tune_FreeSet(TuneSet *set);
+
+/**
+ * @brief Evaluate every position of a set in parallel
+ * @param set Positions
+ * @param scores Receives set->count scores, White's point of view
+ * @param threads Worker threads
+ * @param qsearch BOOL_TYPE_TRUE to resolve captures with the quiescence
+ *        search, otherwise the static evaluation
+ */
+extern void Tune_EvaluateBatch(const TuneSet *set, int *scores, const int threads, const int qsearch);
+
+/**
+ * @brief Mean squared error of the results predicted from the evaluation
+ * @param set Positions
+ * @param K Sigmoid scaling, prediction = 1 / (1 + 10^(-K * score / 400))
+ * @param threads Worker threads
+ * @param qsearch As for Tune_EvaluateBatch
+ * @return Mean of (result - prediction)^2
+ */
+extern double Tune_Error(const TuneSet *set, const double K, const int threads, const int qsearch);
+
+/**
+ * @brief Texel-tune g_evalParams on a labelled file and print the result
+ * @param path Labelled file, as for Tune_LoadSet
+ * @param threads Worker threads
+ * @param iterations Passes over all weights (0 only reports K and the error)
+ * @param qsearch As for Tune_EvaluateBatch
+ *
+ * Fits K first, then moves every weight by +-1 while the error drops and
+ * prints the tuned terms in the declaration form of evaluation_static.c.
+ */
+extern void Tune_Run(const char *path, const int threads, const int iterations, const int qsearch);
+
+/* ---------------------------------------------------------------------------
+ * NNUE EVALUATION (evaluation_nnue.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Memory map a network file and switch evaluation to it
+ * @param path Network file (NNUE_DEFAULT_FILE format, see evaluation_nnue.c)
+ * @return BOOL_TYPE_TRUE if loaded; otherwise no network is active and
+ *         Evaluate_Position falls back to the classical evaluation
+ */
+extern int Nnue_Load(const char *path);
+
+/**
+ * @brief Unmap the current network, back to the classical evaluation
+ */
+extern void Nnue_Free();
+
+/**
+ * @brief Rebuild a board's accumulator from scratch at its stack base
+ * @param board Board position, usually a search root
+ *
+ * Leaves board->accumulator NULL when no network is loaded.
+ */
+extern void Nnue_Refresh(ChessBoard *board);
+
+/**
+ * @brief Push a copy of the current accumulator before a move is made
+ * @param board Board with a non-NULL accumulator
+ *
+ * Stops tracking (accumulator NULL) when the stack is full.
+ */
+extern void Nnue_Push(ChessBoard *board);
+
+/**
+ * @brief Feature updates applied by the make move piece helpers
+ * @param accumulator Accumulator to update
+ * @param piece Piece added, removed or moved
+ * @param squareIndex 120-square index (from/to for a move)
+ */
+extern void Nnue_AddPiece(NnueAccumulator *accumulator, const int piece, const int squareIndex);
+extern void Nnue_RemovePiece(NnueAccumulator *accumulator, const int piece, const int squareIndex);
+extern void Nnue_MovePiece(NnueAccumulator *accumulator, const int piece, const int from, const int to);
+
+/**
+ * @brief Evaluate with the loaded network
+ * @param board Board position
+ * @return Score in centipawns from the side to move's point of view
+ *
+ * Uses board->accumulator when tracked, otherwise computes the first
+ * layer from the piece lists.
+ */
+extern int Nnue_Evaluate(const ChessBoard *board);
+
 /**
  * @brief Test evaluation symmetry by mirroring position
  * @param board Board position
@@ -958,8 +2534,12 @@ extern void MirrorEvalTest(ChessBoard *board) ;
  * 
  * Handles UCI commands from GUI:
  * - uci, isready, ucinewgame
- * - position, go, stop
+ * - position, go, stop, ponderhit
  * - setoption
+ *
+ * Searches run on their own thread while this one keeps reading stdin,
+ * so isready is answered at once and stop/quit reach the search through
+ * info->stopRequest. End of input acts as quit.
  */
 extern void Uci_Loop(ChessBoard *board, SearchInfo *info);
 
@@ -986,9 +2566,20 @@ extern void Console_Loop(ChessBoard *board, SearchInfo *info);
  * @brief Check if game is over (checkmate, stalemate, draw)
  * @param board Board position
  * @return Result code (0 = game continues, non-zero = game over)
+ *
+ * Prints the result line ("1-0 {white mates ...}") when the game is over.
  */
 extern int checkresult(ChessBoard *board);
 
+/**
+ * @brief Game-ending state of a position, without printing anything
+ * @param board Board position
+ * @return GAME_RESULT_NONE while the game goes on, else the first rule
+ *         that ends it in checkresult's order: fifty moves, threefold
+ *         repetition, insufficient material, mate or stalemate
+ */
+extern int GameResult(ChessBoard *board);
+
 /**
  * @brief Check if position is drawn by insufficient material
  * @param board Board position
@@ -1032,4 +2623,55 @@ extern void PolyBook_Clean();
  */
 extern void PolyBook_Init() ;
 
-#endif
\ No newline at end of file
+/* ---------------------------------------------------------------------------
+ * SYZYGY TABLEBASES (tablebase_syzygy.c)
+ * ---------------------------------------------------------------------------
+ */
+
+/**
+ * @brief Register the tablebases found in a path
+ * @param path Directories separated by ':' (';' on Windows); empty or
+ *        "<empty>" releases the tables and disables probing
+ * @return Number of WDL tables found
+ *
+ * Files are only mapped when first probed. Not thread safe against a
+ * running search. Known 3-5 men positions are probed right away: a wrong
+ * result, or none of them being covered, disables the tables (the count
+ * returned is then still the one found).
+ */
+extern int Tb_Init(const char *path);
+
+/**
+ * @brief Unmap every table and forget the registered files
+ */
+extern void Tb_Free();
+
+/**
+ * @brief Win/draw/loss of the position under the fifty move rule
+ * @param board Position without castling rights, at most g_tbMaxPieces pieces
+ * @param success Set to BOOL_TYPE_TRUE when a table answered
+ * @return TB_WDL_* for the side to move
+ */
+extern int Tb_ProbeWdl(ChessBoard *board, int *success);
+
+/**
+ * @brief Distance to the next capture or pawn move of the optimal line
+ * @param board Position without castling rights, at most g_tbMaxPieces pieces
+ * @param success Set to BOOL_TYPE_TRUE when the tables answered
+ * @return Plies, positive when winning and negative when losing, 100 more
+ *         for cursed wins and blessed losses, 0 for draws
+ */
+extern int Tb_ProbeDtz(ChessBoard *board, int *success);
+
+/**
+ * @brief Restrict the root to the moves that keep the best DTZ result
+ * @param board Root position
+ * @param info Receives rootMoves/rootMoveCount (0 when not filtered)
+ * @return BOOL_TYPE_TRUE if the root was resolved by the tables
+ *
+ * Wins keep the moves with the shortest distance to zeroing that still
+ * convert within the fifty move rule.
+ */
+extern int Tb_RootFilter(ChessBoard *board, SearchInfo *info);
+
+#endif
@@ -0,0 +1,220 @@
+/**
+ * @file types_generator.c
+ * @brief Build-time generator for the constant lookup tables
+ *
+ * Stand-alone program (make tables) that writes types_tables.c to stdout:
+ * - Square conversion tables and bit set/clear masks
+ * - File and rank of every mailbox square, file/rank bitboards
+ * - Passed and isolated pawn masks
+ * - MVV-LVA capture scores
+ * - Zobrist keys, taken from the fixed Polyglot Random64Poly table so
+ *   posKey matches across platforms and runs
+ * - Magic multipliers for the slider tables, searched by
+ *   bitboards_attacks.c built with -DGENERATE_TABLES
+ *
+ * The engine itself never runs this code; it links the generated file
+ * and does no table work for these at start-up.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "types_definitions.h"
+#include "../../openingbook/openingbook_keys.h"
+
+#define POLY_CASTLE_OFFSET 768
+#define POLY_EP_OFFSET 772
+#define POLY_TURN_OFFSET 780
+
+static const int VictimScore[13] = { 0, 100, 200, 300, 400, 500, 600, 100, 200, 300, 400, 500, 600 };
+static const int PolyKindOfPiece[13] = { -1, 1, 3, 5, 7, 9, 11, 0, 2, 4, 6, 8, 10 };
+
+static int Square120To64[CHESS_BOARD_SQUARE_NUM];
+static int Square64To120[64];
+static int FilesBoard[CHESS_BOARD_SQUARE_NUM];
+static int RanksBoard[CHESS_BOARD_SQUARE_NUM];
+static U64 FileBBMask[8];
+static U64 RankBBMask[8];
+static U64 WhitePassedMask[64];
+static U64 BlackPassedMask[64];
+static U64 IsolatedMask[64];
+
+static void BuildSquares() {
+
+	int index = 0;
+	int file = FILE_TYPE_A;
+	int rank = RANK_TYPE_1;
+	int sq64 = 0;
+
+	for(index = 0; index < CHESS_BOARD_SQUARE_NUM; ++index) {
+		Square120To64[index] = 65;
+		FilesBoard[index] = OFFBOARD;
+		RanksBoard[index] = OFFBOARD;
+	}
+
+	for(rank = RANK_TYPE_1; rank <= RANK_TYPE_8; ++rank) {
+		for(file = FILE_TYPE_A; file <= FILE_TYPE_H; ++file) {
+			index = FILE_RANK_TO_SQUARE(file, rank);
+			Square64To120[sq64] = index;
+			Square120To64[index] = sq64;
+			FilesBoard[index] = file;
+			RanksBoard[index] = rank;
+			sq64++;
+		}
+	}
+}
+
+static void BuildEvalMasks() {
+
+	int sq64 = 0;
+	int tsq = 0;
+	int file = 0;
+
+	for(sq64 = 0; sq64 < 64; ++sq64) {
+		FileBBMask[sq64 % 8] |= 1ULL << sq64;
+		RankBBMask[sq64 / 8] |= 1ULL << sq64;
+	}
+
+	for(sq64 = 0; sq64 < 64; ++sq64) {
+		file = sq64 % 8;
+
+		for(tsq = sq64 + 8; tsq < 64; tsq += 8) {
+			WhitePassedMask[sq64] |= 1ULL << tsq;
+		}
+		for(tsq = sq64 - 8; tsq >= 0; tsq -= 8) {
+			BlackPassedMask[sq64] |= 1ULL << tsq;
+		}
+
+		if(file > FILE_TYPE_A) {
+			IsolatedMask[sq64] |= FileBBMask[file - 1];
+			for(tsq = sq64 + 7; tsq < 64; tsq += 8) {
+				WhitePassedMask[sq64] |= 1ULL << tsq;
+			}
+			for(tsq = sq64 - 9; tsq >= 0; tsq -= 8) {
+				BlackPassedMask[sq64] |= 1ULL << tsq;
+			}
+		}
+
+		if(file < FILE_TYPE_H) {
+			IsolatedMask[sq64] |= FileBBMask[file + 1];
+			for(tsq = sq64 + 9; tsq < 64; tsq += 8) {
+				WhitePassedMask[sq64] |= 1ULL << tsq;
+			}
+			for(tsq = sq64 - 7; tsq >= 0; tsq -= 8) {
+				BlackPassedMask[sq64] |= 1ULL << tsq;
+			}
+		}
+	}
+}
+
+// piece keys indexed by mailbox square; the EMPTY row holds the en
+// passant file keys, the side key is Polyglot's white-to-move key
+static U64 PieceKey(const int piece, const int sq120) {
+
+	if(FilesBoard[sq120] == OFFBOARD) {
+		return 0ULL;
+	}
+	if(piece == EMPTY) {
+		return Random64Poly[POLY_EP_OFFSET + FilesBoard[sq120]];
+	}
+	return Random64Poly[64 * PolyKindOfPiece[piece] + Square120To64[sq120]];
+}
+
+static U64 CastleKey(const int castlePerm) {
+
+	U64 key = 0ULL;
+
+	if(castlePerm & CASTLE_TYPE_WKCA) key ^= Random64Poly[POLY_CASTLE_OFFSET + 0];
+	if(castlePerm & CASTLE_TYPE_WQCA) key ^= Random64Poly[POLY_CASTLE_OFFSET + 1];
+	if(castlePerm & CASTLE_TYPE_BKCA) key ^= Random64Poly[POLY_CASTLE_OFFSET + 2];
+	if(castlePerm & CASTLE_TYPE_BQCA) key ^= Random64Poly[POLY_CASTLE_OFFSET + 3];
+	return key;
+}
+
+// one initialiser; group > 0 wraps every group values in inner braces
+static void PrintTable(const char *declaration, const int *ints, const U64 *u64s, const int count, const int perRow, const int group) {
+
+	int index = 0;
+
+	printf("\n%s = {", declaration);
+	for(index = 0; index < count; ++index) {
+		int opens = group > 0 && index % group == 0;
+		int closes = group > 0 && (index + 1) % group == 0;
+
+		if(opens) printf("\n\t{");
+		printf("%s", index % perRow == 0 ? (group > 0 ? "\n\t\t" : "\n\t") : " ");
+		if(ints != NULL) printf("%d", ints[index]);
+		else printf("0x%016llXULL", u64s[index]);
+		if(index + 1 < count && !closes) printf(",");
+		if(closes) printf("\n\t}%s", index + 1 < count ? "," : "");
+	}
+	printf("\n};\n");
+}
+
+int main() {
+
+	static U64 bitSet[64];
+	static U64 bitClear[64];
+	static U64 pieceKeys[13][CHESS_BOARD_SQUARE_NUM];
+	static U64 castleKeys[16];
+	static int mvvLva[13][13];
+	static U64 bishopNumbers[64];
+	static U64 rookNumbers[64];
+	int index = 0;
+	int index2 = 0;
+
+	BuildSquares();
+	BuildEvalMasks();
+	Init_AttackTables();
+
+	for(index = 0; index < 64; ++index) {
+		bitSet[index] = 1ULL << index;
+		bitClear[index] = ~bitSet[index];
+		bishopNumbers[index] = g_bishopMagics[index].magic;
+		rookNumbers[index] = g_rookMagics[index].magic;
+	}
+	for(index = 0; index < 13; ++index) {
+		for(index2 = 0; index2 < CHESS_BOARD_SQUARE_NUM; ++index2) {
+			pieceKeys[index][index2] = PieceKey(index, index2);
+		}
+	}
+	for(index = 0; index < 16; ++index) {
+		castleKeys[index] = CastleKey(index);
+	}
+	for(index = PIECE_TYPE_WHITE_PAWN; index <= PIECE_TYPE_BLACK_KING; ++index) {
+		for(index2 = PIECE_TYPE_WHITE_PAWN; index2 <= PIECE_TYPE_BLACK_KING; ++index2) {
+			mvvLva[index2][index] = VictimScore[index2] + 6 - (VictimScore[index] / 100);
+		}
+	}
+
+	printf("/**\n");
+	printf(" * @file types_tables.c\n");
+	printf(" * @brief Constant lookup tables and Zobrist keys\n");
+	printf(" *\n");
+	printf(" * GENERATED by types_generator.c (make tables), do not edit.\n");
+	printf(" *\n");
+	printf(" * @author Gambit Chess Team\n");
+	printf(" * @date October 2026\n");
+	printf(" */\n\n");
+	printf("#include \"types_definitions.h\"\n");
+
+	PrintTable("const int g_square120To64[CHESS_BOARD_SQUARE_NUM]", Square120To64, NULL, CHESS_BOARD_SQUARE_NUM, 10, 0);
+	PrintTable("const int g_square64To120[64]", Square64To120, NULL, 64, 8, 0);
+	PrintTable("const U64 g_bitSetMask[64]", NULL, bitSet, 64, 4, 0);
+	PrintTable("const U64 g_bitClearMask[64]", NULL, bitClear, 64, 4, 0);
+	PrintTable("const int g_filesBoard[CHESS_BOARD_SQUARE_NUM]", FilesBoard, NULL, CHESS_BOARD_SQUARE_NUM, 10, 0);
+	PrintTable("const int g_ranksBoard[CHESS_BOARD_SQUARE_NUM]", RanksBoard, NULL, CHESS_BOARD_SQUARE_NUM, 10, 0);
+	PrintTable("const U64 g_fileBBMask[8]", NULL, FileBBMask, 8, 4, 0);
+	PrintTable("const U64 g_rankBBMask[8]", NULL, RankBBMask, 8, 4, 0);
+	PrintTable("const U64 g_whitePassedMask[64]", NULL, WhitePassedMask, 64, 4, 0);
+	PrintTable("const U64 g_blackPassedMask[64]", NULL, BlackPassedMask, 64, 4, 0);
+	PrintTable("const U64 g_isolatedMask[64]", NULL, IsolatedMask, 64, 4, 0);
+	PrintTable("const int g_mvvLvaScores[13][13]", &mvvLva[0][0], NULL, 13 * 13, 13, 13);
+	PrintTable("const U64 g_pieceKeys[13][CHESS_BOARD_SQUARE_NUM]", NULL, &pieceKeys[0][0], 13 * CHESS_BOARD_SQUARE_NUM, 4, CHESS_BOARD_SQUARE_NUM);
+	printf("\nconst U64 g_sideKey = 0x%016llXULL;\n", Random64Poly[POLY_TURN_OFFSET]);
+	PrintTable("const U64 g_castleKeys[16]", NULL, castleKeys, 16, 4, 0);
+	PrintTable("const U64 g_bishopMagicNumbers[64]", NULL, bishopNumbers, 64, 4, 0);
+	PrintTable("const U64 g_rookMagicNumbers[64]", NULL, rookNumbers, 64, 4, 0);
+	return 0;
+}
@@ -0,0 +1,680 @@
+/**
+ * @file types_tables.c
+ * @brief Constant lookup tables and Zobrist keys
+ *
+ * GENERATED by types_generator.c (make tables), do not edit.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "types_definitions.h"
+
+const int g_square120To64[CHESS_BOARD_SQUARE_NUM] = {
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 0, 1, 2, 3, 4, 5, 6, 7, 65,
+	65, 8, 9, 10, 11, 12, 13, 14, 15, 65,
+	65, 16, 17, 18, 19, 20, 21, 22, 23, 65,
+	65, 24, 25, 26, 27, 28, 29, 30, 31, 65,
+	65, 32, 33, 34, 35, 36, 37, 38, 39, 65,
+	65, 40, 41, 42, 43, 44, 45, 46, 47, 65,
+	65, 48, 49, 50, 51, 52, 53, 54, 55, 65,
+	65, 56, 57, 58, 59, 60, 61, 62, 63, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65
+};
+
+const int g_square64To120[64] = {
+	21, 22, 23, 24, 25, 26, 27, 28,
+	31, 32, 33, 34, 35, 36, 37, 38,
+	41, 42, 43, 44, 45, 46, 47, 48,
+	51, 52, 53, 54, 55, 56, 57, 58,
+	61, 62, 63, 64, 65, 66, 67, 68,
+	71, 72, 73, 74, 75, 76, 77, 78,
+	81, 82, 83, 84, 85, 86, 87, 88,
+	91, 92, 93, 94, 95, 96, 97, 98
+};
+
+const U64 g_bitSetMask[64] = {
+	0x0000000000000001ULL, 0x0000000000000002ULL, 0x0000000000000004ULL, 0x0000000000000008ULL,
+	0x0000000000000010ULL, 0x0000000000000020ULL, 0x0000000000000040ULL, 0x0000000000000080ULL,
+	0x0000000000000100ULL, 0x0000000000000200ULL, 0x0000000000000400ULL, 0x0000000000000800ULL,
+	0x0000000000001000ULL, 0x0000000000002000ULL, 0x0000000000004000ULL, 0x0000000000008000ULL,
+	0x0000000000010000ULL, 0x0000000000020000ULL, 0x0000000000040000ULL, 0x0000000000080000ULL,
+	0x0000000000100000ULL, 0x0000000000200000ULL, 0x0000000000400000ULL, 0x0000000000800000ULL,
+	0x0000000001000000ULL, 0x0000000002000000ULL, 0x0000000004000000ULL, 0x0000000008000000ULL,
+	0x0000000010000000ULL, 0x0000000020000000ULL, 0x0000000040000000ULL, 0x0000000080000000ULL,
+	0x0000000100000000ULL, 0x0000000200000000ULL, 0x0000000400000000ULL, 0x0000000800000000ULL,
+	0x0000001000000000ULL, 0x0000002000000000ULL, 0x0000004000000000ULL, 0x0000008000000000ULL,
+	0x0000010000000000ULL, 0x0000020000000000ULL, 0x0000040000000000ULL, 0x0000080000000000ULL,
+	0x0000100000000000ULL, 0x0000200000000000ULL, 0x0000400000000000ULL, 0x0000800000000000ULL,
+	0x0001000000000000ULL, 0x0002000000000000ULL, 0x0004000000000000ULL, 0x0008000000000000ULL,
+	0x0010000000000000ULL, 0x0020000000000000ULL, 0x0040000000000000ULL, 0x0080000000000000ULL,
+	0x0100000000000000ULL, 0x0200000000000000ULL, 0x0400000000000000ULL, 0x0800000000000000ULL,
+	0x1000000000000000ULL, 0x2000000000000000ULL, 0x4000000000000000ULL, 0x8000000000000000ULL
+};
+
+const U64 g_bitClearMask[64] = {
+	0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFDULL, 0xFFFFFFFFFFFFFFFBULL, 0xFFFFFFFFFFFFFFF7ULL,
+	0xFFFFFFFFFFFFFFEFULL, 0xFFFFFFFFFFFFFFDFULL, 0xFFFFFFFFFFFFFFBFULL, 0xFFFFFFFFFFFFFF7FULL,
+	0xFFFFFFFFFFFFFEFFULL, 0xFFFFFFFFFFFFFDFFULL, 0xFFFFFFFFFFFFFBFFULL, 0xFFFFFFFFFFFFF7FFULL,
+	0xFFFFFFFFFFFFEFFFULL, 0xFFFFFFFFFFFFDFFFULL, 0xFFFFFFFFFFFFBFFFULL, 0xFFFFFFFFFFFF7FFFULL,
+	0xFFFFFFFFFFFEFFFFULL, 0xFFFFFFFFFFFDFFFFULL, 0xFFFFFFFFFFFBFFFFULL, 0xFFFFFFFFFFF7FFFFULL,
+	0xFFFFFFFFFFEFFFFFULL, 0xFFFFFFFFFFDFFFFFULL, 0xFFFFFFFFFFBFFFFFULL, 0xFFFFFFFFFF7FFFFFULL,
+	0xFFFFFFFFFEFFFFFFULL, 0xFFFFFFFFFDFFFFFFULL, 0xFFFFFFFFFBFFFFFFULL, 0xFFFFFFFFF7FFFFFFULL,
+	0xFFFFFFFFEFFFFFFFULL, 0xFFFFFFFFDFFFFFFFULL, 0xFFFFFFFFBFFFFFFFULL, 0xFFFFFFFF7FFFFFFFULL,
+	0xFFFFFFFEFFFFFFFFULL, 0xFFFFFFFDFFFFFFFFULL, 0xFFFFFFFBFFFFFFFFULL, 0xFFFFFFF7FFFFFFFFULL,
+	0xFFFFFFEFFFFFFFFFULL, 0xFFFFFFDFFFFFFFFFULL, 0xFFFFFFBFFFFFFFFFULL, 0xFFFFFF7FFFFFFFFFULL,
+	0xFFFFFEFFFFFFFFFFULL, 0xFFFFFDFFFFFFFFFFULL, 0xFFFFFBFFFFFFFFFFULL, 0xFFFFF7FFFFFFFFFFULL,
+	0xFFFFEFFFFFFFFFFFULL, 0xFFFFDFFFFFFFFFFFULL, 0xFFFFBFFFFFFFFFFFULL, 0xFFFF7FFFFFFFFFFFULL,
+	0xFFFEFFFFFFFFFFFFULL, 0xFFFDFFFFFFFFFFFFULL, 0xFFFBFFFFFFFFFFFFULL, 0xFFF7FFFFFFFFFFFFULL,
+	0xFFEFFFFFFFFFFFFFULL, 0xFFDFFFFFFFFFFFFFULL, 0xFFBFFFFFFFFFFFFFULL, 0xFF7FFFFFFFFFFFFFULL,
+	0xFEFFFFFFFFFFFFFFULL, 0xFDFFFFFFFFFFFFFFULL, 0xFBFFFFFFFFFFFFFFULL, 0xF7FFFFFFFFFFFFFFULL,
+	0xEFFFFFFFFFFFFFFFULL, 0xDFFFFFFFFFFFFFFFULL, 0xBFFFFFFFFFFFFFFFULL, 0x7FFFFFFFFFFFFFFFULL
+};
+
+const int g_filesBoard[CHESS_BOARD_SQUARE_NUM] = {
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 0, 1, 2, 3, 4, 5, 6, 7, 100,
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100
+};
+
+const int g_ranksBoard[CHESS_BOARD_SQUARE_NUM] = {
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 0, 0, 0, 0, 0, 0, 0, 0, 100,
+	100, 1, 1, 1, 1, 1, 1, 1, 1, 100,
+	100, 2, 2, 2, 2, 2, 2, 2, 2, 100,
+	100, 3, 3, 3, 3, 3, 3, 3, 3, 100,
+	100, 4, 4, 4, 4, 4, 4, 4, 4, 100,
+	100, 5, 5, 5, 5, 5, 5, 5, 5, 100,
+	100, 6, 6, 6, 6, 6, 6, 6, 6, 100,
+	100, 7, 7, 7, 7, 7, 7, 7, 7, 100,
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 100, 100, 100, 100, 100, 100, 100, 100, 100
+};
+
+const U64 g_fileBBMask[8] = {
+	0x0101010101010101ULL, 0x0202020202020202ULL, 0x0404040404040404ULL, 0x0808080808080808ULL,
+	0x1010101010101010ULL, 0x2020202020202020ULL, 0x4040404040404040ULL, 0x8080808080808080ULL
+};
+
+const U64 g_rankBBMask[8] = {
+	0x00000000000000FFULL, 0x000000000000FF00ULL, 0x0000000000FF0000ULL, 0x00000000FF000000ULL,
+	0x000000FF00000000ULL, 0x0000FF0000000000ULL, 0x00FF000000000000ULL, 0xFF00000000000000ULL
+};
+
+const U64 g_whitePassedMask[64] = {
+	0x0303030303030300ULL, 0x0707070707070700ULL, 0x0E0E0E0E0E0E0E00ULL, 0x1C1C1C1C1C1C1C00ULL,
+	0x3838383838383800ULL, 0x7070707070707000ULL, 0xE0E0E0E0E0E0E000ULL, 0xC0C0C0C0C0C0C000ULL,
+	0x0303030303030000ULL, 0x0707070707070000ULL, 0x0E0E0E0E0E0E0000ULL, 0x1C1C1C1C1C1C0000ULL,
+	0x3838383838380000ULL, 0x7070707070700000ULL, 0xE0E0E0E0E0E00000ULL, 0xC0C0C0C0C0C00000ULL,
+	0x0303030303000000ULL, 0x0707070707000000ULL, 0x0E0E0E0E0E000000ULL, 0x1C1C1C1C1C000000ULL,
+	0x3838383838000000ULL, 0x7070707070000000ULL, 0xE0E0E0E0E0000000ULL, 0xC0C0C0C0C0000000ULL,
+	0x0303030300000000ULL, 0x0707070700000000ULL, 0x0E0E0E0E00000000ULL, 0x1C1C1C1C00000000ULL,
+	0x3838383800000000ULL, 0x7070707000000000ULL, 0xE0E0E0E000000000ULL, 0xC0C0C0C000000000ULL,
+	0x0303030000000000ULL, 0x0707070000000000ULL, 0x0E0E0E0000000000ULL, 0x1C1C1C0000000000ULL,
+	0x3838380000000000ULL, 0x7070700000000000ULL, 0xE0E0E00000000000ULL, 0xC0C0C00000000000ULL,
+	0x0303000000000000ULL, 0x0707000000000000ULL, 0x0E0E000000000000ULL, 0x1C1C000000000000ULL,
+	0x3838000000000000ULL, 0x7070000000000000ULL, 0xE0E0000000000000ULL, 0xC0C0000000000000ULL,
+	0x0300000000000000ULL, 0x0700000000000000ULL, 0x0E00000000000000ULL, 0x1C00000000000000ULL,
+	0x3800000000000000ULL, 0x7000000000000000ULL, 0xE000000000000000ULL, 0xC000000000000000ULL,
+	0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+	0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+};
+
+const U64 g_blackPassedMask[64] = {
+	0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+	0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+	0x0000000000000003ULL, 0x0000000000000007ULL, 0x000000000000000EULL, 0x000000000000001CULL,
+	0x0000000000000038ULL, 0x0000000000000070ULL, 0x00000000000000E0ULL, 0x00000000000000C0ULL,
+	0x0000000000000303ULL, 0x0000000000000707ULL, 0x0000000000000E0EULL, 0x0000000000001C1CULL,
+	0x0000000000003838ULL, 0x0000000000007070ULL, 0x000000000000E0E0ULL, 0x000000000000C0C0ULL,
+	0x0000000000030303ULL, 0x0000000000070707ULL, 0x00000000000E0E0EULL, 0x00000000001C1C1CULL,
+	0x0000000000383838ULL, 0x0000000000707070ULL, 0x0000000000E0E0E0ULL, 0x0000000000C0C0C0ULL,
+	0x0000000003030303ULL, 0x0000000007070707ULL, 0x000000000E0E0E0EULL, 0x000000001C1C1C1CULL,
+	0x0000000038383838ULL, 0x0000000070707070ULL, 0x00000000E0E0E0E0ULL, 0x00000000C0C0C0C0ULL,
+	0x0000000303030303ULL, 0x0000000707070707ULL, 0x0000000E0E0E0E0EULL, 0x0000001C1C1C1C1CULL,
+	0x0000003838383838ULL, 0x0000007070707070ULL, 0x000000E0E0E0E0E0ULL, 0x000000C0C0C0C0C0ULL,
+	0x0000030303030303ULL, 0x0000070707070707ULL, 0x00000E0E0E0E0E0EULL, 0x00001C1C1C1C1C1CULL,
+	0x0000383838383838ULL, 0x0000707070707070ULL, 0x0000E0E0E0E0E0E0ULL, 0x0000C0C0C0C0C0C0ULL,
+	0x0003030303030303ULL, 0x0007070707070707ULL, 0x000E0E0E0E0E0E0EULL, 0x001C1C1C1C1C1C1CULL,
+	0x0038383838383838ULL, 0x0070707070707070ULL, 0x00E0E0E0E0E0E0E0ULL, 0x00C0C0C0C0C0C0C0ULL
+};
+
+const U64 g_isolatedMask[64] = {
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL,
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL,
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL,
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL,
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL,
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL,
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL,
+	0x0202020202020202ULL, 0x0505050505050505ULL, 0x0A0A0A0A0A0A0A0AULL, 0x1414141414141414ULL,
+	0x2828282828282828ULL, 0x5050505050505050ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x4040404040404040ULL
+};
+
+const int g_mvvLvaScores[13][13] = {
+	{
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+	},
+	{
+		0, 105, 104, 103, 102, 101, 100, 105, 104, 103, 102, 101, 100
+	},
+	{
+		0, 205, 204, 203, 202, 201, 200, 205, 204, 203, 202, 201, 200
+	},
+	{
+		0, 305, 304, 303, 302, 301, 300, 305, 304, 303, 302, 301, 300
+	},
+	{
+		0, 405, 404, 403, 402, 401, 400, 405, 404, 403, 402, 401, 400
+	},
+	{
+		0, 505, 504, 503, 502, 501, 500, 505, 504, 503, 502, 501, 500
+	},
+	{
+		0, 605, 604, 603, 602, 601, 600, 605, 604, 603, 602, 601, 600
+	},
+	{
+		0, 105, 104, 103, 102, 101, 100, 105, 104, 103, 102, 101, 100
+	},
+	{
+		0, 205, 204, 203, 202, 201, 200, 205, 204, 203, 202, 201, 200
+	},
+	{
+		0, 305, 304, 303, 302, 301, 300, 305, 304, 303, 302, 301, 300
+	},
+	{
+		0, 405, 404, 403, 402, 401, 400, 405, 404, 403, 402, 401, 400
+	},
+	{
+		0, 505, 504, 503, 502, 501, 500, 505, 504, 503, 502, 501, 500
+	},
+	{
+		0, 605, 604, 603, 602, 601, 600, 605, 604, 603, 602, 601, 600
+	}
+};
+
+const U64 g_pieceKeys[13][CHESS_BOARD_SQUARE_NUM] = {
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x70CC73D90BC26E24ULL, 0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL,
+		0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL, 0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL,
+		0x67A34DAC4356550BULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x70CC73D90BC26E24ULL,
+		0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL, 0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL,
+		0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL, 0x67A34DAC4356550BULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x70CC73D90BC26E24ULL, 0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL,
+		0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL, 0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL,
+		0x67A34DAC4356550BULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x70CC73D90BC26E24ULL,
+		0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL, 0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL,
+		0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL, 0x67A34DAC4356550BULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x70CC73D90BC26E24ULL, 0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL,
+		0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL, 0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL,
+		0x67A34DAC4356550BULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x70CC73D90BC26E24ULL,
+		0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL, 0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL,
+		0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL, 0x67A34DAC4356550BULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x70CC73D90BC26E24ULL, 0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL,
+		0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL, 0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL,
+		0x67A34DAC4356550BULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x70CC73D90BC26E24ULL,
+		0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL, 0x1C99DED33CB890A1ULL, 0xCF3145DE0ADD4289ULL,
+		0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL, 0x67A34DAC4356550BULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x5355F900C2A82DC7ULL, 0x07FB9F855A997142ULL, 0x5093417AA8A7ED5EULL,
+		0x7BCBC38DA25A7F3CULL, 0x19FC8A768CF4B6D4ULL, 0x637A7780DECFC0D9ULL, 0x8249A47AEE0E41F7ULL,
+		0x79AD695501E7D1E8ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x14ACBAF4777D5776ULL,
+		0xF145B6BECCDEA195ULL, 0xDABF2AC8201752FCULL, 0x24C3C94DF9C8D3F6ULL, 0xBB6E2924F03912EAULL,
+		0x0CE26C0B95C980D9ULL, 0xA49CD132BFBF7CC4ULL, 0xE99D662AF4243939ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x27E6AD7891165C3FULL, 0x8535F040B9744FF1ULL, 0x54B3F4FA5F40D873ULL,
+		0x72B12C32127FED2BULL, 0xEE954D3C7B411F47ULL, 0x9A85AC909A24EAA1ULL, 0x70AC4CD9F04F21F5ULL,
+		0xF9B89D3E99A075C2ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x87B3E2B2B5C907B1ULL,
+		0xA366E5B8C54F48B8ULL, 0xAE4A9346CC3F7CF2ULL, 0x1920C04D47267BBDULL, 0x87BF02C6B49E2AE9ULL,
+		0x092237AC237F3859ULL, 0xFF07F64EF8ED14D0ULL, 0x8DE8DCA9F03CC54EULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x9C1633264DB49C89ULL, 0xB3F22C3D0B0B38EDULL, 0x390E5FB44D01144BULL,
+		0x5BFEA5B4712768E9ULL, 0x1E1032911FA78984ULL, 0x9A74ACB964E78CB3ULL, 0x4F80F7A035DAFB04ULL,
+		0x6304D09A0B3738C4ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x2171E64683023A08ULL,
+		0x5B9B63EB9CEFF80CULL, 0x506AACF489889342ULL, 0x1881AFC9A3A701D6ULL, 0x6503080440750644ULL,
+		0xDFD395339CDBF4A7ULL, 0xEF927DBCF00C20F2ULL, 0x7B32F7D1E03680ECULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xB9FD7620E7316243ULL, 0x05A7E8A57DB91B77ULL, 0xB5889C6E15630A75ULL,
+		0x4A750A09CE9573F7ULL, 0xCF464CEC899A2F8AULL, 0xF538639CE705B824ULL, 0x3C79A0FF5580EF7FULL,
+		0xEDE6C87F8477609DULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x799E81F05BC93F31ULL,
+		0x86536B8CF3428A8CULL, 0x97D7374C60087B73ULL, 0xA246637CFF328532ULL, 0x043FCAE60CC0EBA0ULL,
+		0x920E449535DD359EULL, 0x70EB093B15B290CCULL, 0x73A1921916591CBDULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xC547F57E42A7444EULL, 0x78E37644E7CAD29EULL, 0xFE9A44E9362F05FAULL,
+		0x08BD35CC38336615ULL, 0x9315E5EB3A129ACEULL, 0x94061B871E04DF75ULL, 0xDF1D9F9D784BA010ULL,
+		0x3BBA57B68871B59DULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xD2B7ADEEDED1F73FULL,
+		0xF7A255D83BC373F8ULL, 0xD7F4F2448C0CEB81ULL, 0xD95BE88CD210FFA7ULL, 0x336F52F8FF4728E7ULL,
+		0xA74049DAC312AC71ULL, 0xA2F61BB6E437FDB5ULL, 0x4F2A5CB07F6A35B3ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x87D380BDA5BF7859ULL, 0x16B9F7E06C453A21ULL, 0x7BA2484C8A0FD54EULL,
+		0xF3A678CAD9A2E38CULL, 0x39B0BF7DDE437BA2ULL, 0xFCAF55C1BF8A4424ULL, 0x18FCF680573FA594ULL,
+		0x4C0563B89F495AC3ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x40E087931A00930DULL,
+		0x8CFFA9412EB642C1ULL, 0x68CA39053261169FULL, 0x7A1EE967D27579E2ULL, 0x9D1D60E5076F5B6FULL,
+		0x3810E399B6F65BA2ULL, 0x32095B6D4AB5F9B1ULL, 0x35CAB62109DD038AULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xA90B24499FCFAFB1ULL, 0x77A225A07CC2C6BDULL, 0x513E5E634C70E331ULL,
+		0x4361C0CA3F692F12ULL, 0xD941ACA44B20A45BULL, 0x528F7C8602C5807BULL, 0x52AB92BEB9613989ULL,
+		0x9D1DFA2EFC557F73ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x722FF175F572C348ULL,
+		0x1D1260A51107FE97ULL, 0x7A249A57EC0C9BA2ULL, 0x04208FE9E8F7F2D6ULL, 0x5A110C6058B920A0ULL,
+		0x0CD9A497658A5698ULL, 0x56FD23C8F9715A4CULL, 0x284C847B9D887AAEULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x04FEABFBBDB619CBULL, 0x742E1E651C60BA83ULL, 0x9A9632E65904AD3CULL,
+		0x881B82A13B51B9E2ULL, 0x506E6744CD974924ULL, 0xB0183DB56FFC6A79ULL, 0x0ED9B915C66ED37EULL,
+		0x5E11E86D5873D484ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xF678647E3519AC6EULL,
+		0x1B85D488D0F20CC5ULL, 0xDAB9FE6525D89021ULL, 0x0D151D86ADB73615ULL, 0xA865A54EDCC0F019ULL,
+		0x93C42566AEF98FFBULL, 0x99E7AFEABE000731ULL, 0x48CBFF086DDF285AULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x23B70EDB1955C4BFULL, 0xC330DE426430F69DULL, 0x4715ED43E8A45C0AULL,
+		0xA8D7E4DAB780A08DULL, 0x0572B974F03CE0BBULL, 0xB57D2E985E1419C7ULL, 0xE8D9ECBE2CF3D73FULL,
+		0x2FE4B17170E59750ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x11317BA87905E790ULL,
+		0x7FBF21EC8A1F45ECULL, 0x1725CABFCB045B00ULL, 0x964E915CD5E2B207ULL, 0x3E2B8BCBF016D66DULL,
+		0xBE7444E39328A0ACULL, 0xF85B2B4FBCDE44B7ULL, 0x49353FEA39BA63B1ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x1DD01AAFCD53486AULL, 0x1FCA8A92FD719F85ULL, 0xFC7C95D827357AFAULL,
+		0x18A6A990C8B35EBDULL, 0xCCCB7005C6B9C28DULL, 0x3BDBB92C43B17F26ULL, 0xAA70B5B4F89695A2ULL,
+		0xE94C39A54A98307FULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xB7A0B174CFF6F36EULL,
+		0xD4DBA84729AF48ADULL, 0x2E18BC1AD9704A68ULL, 0x2DE0966DAF2F8B1CULL, 0xB9C11D5B1E43A07EULL,
+		0x64972D68DEE33360ULL, 0x94628D38D0C20584ULL, 0xDBC0D2B6AB90A559ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xD2733C4335C6A72FULL, 0x7E75D99D94A70F4DULL, 0x6CED1983376FA72BULL,
+		0x97FCAACBF030BC24ULL, 0x7B77497B32503B12ULL, 0x8547EDDFB81CCB94ULL, 0x79999CDFF70902CBULL,
+		0xCFFE1939438E9B24ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x829626E3892D95D7ULL,
+		0x92FAE24291F2B3F1ULL, 0x63E22C147B9C3403ULL, 0xC678B6D860284A1CULL, 0x5873888850659AE7ULL,
+		0x0981DCD296A8736DULL, 0x9F65789A6509A440ULL, 0x9FF38FED72E9052FULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xE479EE5B9930578CULL, 0xE7F28ECD2D49EECDULL, 0x56C074A581EA17FEULL,
+		0x5544F7D774B14AEFULL, 0x7B3F0195FC6F290FULL, 0x12153635B2C0CF57ULL, 0x7F5126DBBA5E0CA7ULL,
+		0x7A76956C3EAFB413ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x3D5774A11D31AB39ULL,
+		0x8A1B083821F40CB4ULL, 0x7B4A38E32537DF62ULL, 0x950113646D1D6E03ULL, 0x4DA8979A0041E8A9ULL,
+		0x3BC36E078F7515D7ULL, 0x5D0A12F27AD310D1ULL, 0x7F9D1A2E1EBE1327ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xA09E8C8C35AB96DEULL, 0xFA7E393983325753ULL, 0xD6B6D0ECC617C699ULL,
+		0xDFEA21EA9E7557E3ULL, 0xB67C1FA481680AF8ULL, 0xCA1E3785A9E724E5ULL, 0x1CFC8BED0D681639ULL,
+		0xD18D8549D140CAEAULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x4ED0FE7E9DC91335ULL,
+		0xE4DBF0634473F5D2ULL, 0x1761F93A44D5AEFEULL, 0x53898E4C3910DA55ULL, 0x734DE8181F6EC39AULL,
+		0x2680B122BAA28D97ULL, 0x298AF231C85BAFABULL, 0x7983EED3740847D5ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x66C1A2A1A60CD889ULL, 0x9E17E49642A3E4C1ULL, 0xEDB454E7BADC0805ULL,
+		0x50B704CAB602C329ULL, 0x4CC317FB9CDDD023ULL, 0x66B4835D9EAFEA22ULL, 0x219B97E26FFC81BDULL,
+		0x261E4E4C0A333A9DULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x1FE2CCA76517DB90ULL,
+		0xD7504DFA8816EDBBULL, 0xB9571FA04DC089C8ULL, 0x1DDC0325259B27DEULL, 0xCF3F4688801EB9AAULL,
+		0xF4F5D05C10CAB243ULL, 0x38B6525C21A42B0EULL, 0x36F60E2BA4FA6800ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xEB3593803173E0CEULL, 0x9C4CD6257C5A3603ULL, 0xAF0C317D32ADAA8AULL,
+		0x258E5A80C7204C4BULL, 0x8B889D624D44885DULL, 0xF4D14597E660F855ULL, 0xD4347F66EC8941C3ULL,
+		0xE699ED85B0DFB40DULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x2472F6207C2D0484ULL,
+		0xC2A1E7B5B459AEB5ULL, 0xAB4F6451CC1D45ECULL, 0x63767572AE3D6174ULL, 0xA59E0BD101731A28ULL,
+		0x116D0016CB948F09ULL, 0x2CF9C8CA052F6E9FULL, 0x0B090A7560A968E3ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xABEEDDB2DDE06FF1ULL, 0x58EFC10B06A2068DULL, 0xC6E57A78FBD986E0ULL,
+		0x2EAB8CA63CE802D7ULL, 0x14A195640116F336ULL, 0x7C0828DD624EC390ULL, 0xD74BBE77E6116AC7ULL,
+		0x804456AF10F5FB53ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xEBE9EA2ADF4321C7ULL,
+		0x03219A39EE587A30ULL, 0x49787FEF17AF9924ULL, 0xA1E9300CD8520548ULL, 0x5B45E522E4B1B4EFULL,
+		0xB49C3B3995091A36ULL, 0xD4490AD526F14431ULL, 0x12A8F216AF9418C2ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x6FFE73E81B637FB3ULL, 0xDDF957BC36D8B9CAULL, 0x64D0E29EEA8838B3ULL,
+		0x08DD9BDFD96B9F63ULL, 0x087E79E5A57D1D13ULL, 0xE328E230E3E2B3FBULL, 0x1C2559E30F0946BEULL,
+		0x720BF5F26F4D2EAAULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xB0774D261CC609DBULL,
+		0x443F64EC5A371195ULL, 0x4112CF68649A260EULL, 0xD813F2FAB7F5C5CAULL, 0x660D3257380841EEULL,
+		0x59AC2C7873F910A3ULL, 0xE846963877671A17ULL, 0x93B633ABFA3469F8ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xC0C0F5A60EF4CDCFULL, 0xCAF21ECD4377B28CULL, 0x57277707199B8175ULL,
+		0x506C11B9D90E8B1DULL, 0xD83CC2687A19255FULL, 0x4A29C6465A314CD1ULL, 0xED2DF21216235097ULL,
+		0xB5635C95FF7296E2ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x22AF003AB672E811ULL,
+		0x52E762596BF68235ULL, 0x9AEBA33AC6ECC6B0ULL, 0x944F6DE09134DFB6ULL, 0x6C47BEC883A7DE39ULL,
+		0x6AD047C430A12104ULL, 0xA5B1CFDBA0AB4067ULL, 0x7C45D833AFF07862ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x5092EF950A16DA0BULL, 0x9338E69C052B8E7BULL, 0x455A4B4CFE30E3F5ULL,
+		0x6B02E63195AD0CF8ULL, 0x6B17B224BAD6BF27ULL, 0xD1E0CCD25BB9C169ULL, 0xDE0C89A556B9AE70ULL,
+		0x50065E535A213CF6ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x9C1169FA2777B874ULL,
+		0x78EDEFD694AF1EEDULL, 0x6DC93D9526A50E68ULL, 0xEE97F453F06791EDULL, 0x32AB0EDB696703D3ULL,
+		0x3A6853C7E70757A7ULL, 0x31865CED6120F37DULL, 0x67FEF95D92607890ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x1F2B1D1F15F6DC9CULL, 0xB69E38A8965C6B65ULL, 0xAA9119FF184CCCF4ULL,
+		0xF43C732873F24C13ULL, 0xFB4A3D794A9A80D2ULL, 0x3550C2321FD6109CULL, 0x371F77E76BB8417EULL,
+		0x6BFA9AAE5EC05779ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xCD04F3FF001A4778ULL,
+		0xE3273522064480CAULL, 0x9F91508BFFCFC14AULL, 0x049A7F41061A9E60ULL, 0xFCB6BE43A9F2FE9BULL,
+		0x08DE8A1C7797DA9BULL, 0x8F9887E6078735A1ULL, 0xB5B4071DBFC73A66ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x55B6344CF97AAFAEULL, 0xB862225B055B6960ULL, 0xCAC09AFBDDD2CDB4ULL,
+		0xDAF8E9829FE96B5FULL, 0xB5FDFC5D3132C498ULL, 0x310CB380DB6F7503ULL, 0xE87FBB46217A360EULL,
+		0x2102AE466EBB1148ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xF8549E1A3AA5E00DULL,
+		0x07A69AFDCC42261AULL, 0xC4C118BFE78FEAAEULL, 0xF9F4892ED96BD438ULL, 0x1AF3DBE25D8F45DAULL,
+		0xF5B4B0B0D2DEEEB4ULL, 0x962ACEEFA82E1C84ULL, 0x046E3ECAAF453CE9ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xF05D129681949A4CULL, 0x964781CE734B3C84ULL, 0x9C2ED44081CE5FBDULL,
+		0x522E23F3925E319EULL, 0x177E00F9FC32F791ULL, 0x2BC60A63A6F3B3F2ULL, 0x222BBFAE61725606ULL,
+		0x486289DDCC3D6780ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x7DC7785B8EFDFC80ULL,
+		0x8AF38731C02BA980ULL, 0x1FAB64EA29A2DDF7ULL, 0xE4D9429322CD065AULL, 0x9DA058C67844F20CULL,
+		0x24C0E332B70019B0ULL, 0x233003B5A6CFE6ADULL, 0xD586BD01C5C217F6ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x5E5637885F29BC2BULL, 0x7EBA726D8C94094BULL, 0x0A56A5F0BFE39272ULL,
+		0xD79476A84EE20D06ULL, 0x9E4C1269BAA4BF37ULL, 0x17EFEE45B0DEE640ULL, 0x1D95B0A5FCF90BC6ULL,
+		0x93CBE0B699C2585DULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x65FA4F227A2B6D79ULL,
+		0xD5F9E858292504D5ULL, 0xC2B5A03F71471A6FULL, 0x59300222B4561E00ULL, 0xCE2F8642CA0712DCULL,
+		0x7CA9723FBB2E8988ULL, 0x2785338347F2BA08ULL, 0xC61BB3A141E50E8CULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x150F361DAB9DEC26ULL, 0x9F6A419D382595F4ULL, 0x64A53DC924FE7AC9ULL,
+		0x142DE49FFF7A7C3DULL, 0x0C335248857FA9E7ULL, 0x0A9C32D5EAE45305ULL, 0xE6C42178C4BBB92EULL,
+		0x71F1CE2490D20B07ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xF1BCC3D275AFE51AULL,
+		0xE728E8C83C334074ULL, 0x96FBF83A12884624ULL, 0x81A1549FD6573DA5ULL, 0x5FA7867CAF35E149ULL,
+		0x56986E2EF3ED091BULL, 0x917F1DD5F8886C61ULL, 0xD20D8C88C8FFE65FULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x9D39247E33776D41ULL, 0x2AF7398005AAA5C7ULL, 0x44DB015024623547ULL,
+		0x9C15F73E62A76AE2ULL, 0x75834465489C0C89ULL, 0x3290AC3A203001BFULL, 0x0FBBAD1F61042279ULL,
+		0xE83A908FF2FB60CAULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0D7E765D58755C10ULL,
+		0x1A083822CEAFE02DULL, 0x9605D5F0E25EC3B0ULL, 0xD021FF5CD13A2ED5ULL, 0x40BDF15D4A672E32ULL,
+		0x011355146FD56395ULL, 0x5DB4832046F3D9E5ULL, 0x239F8B2D7FF719CCULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x05D1A1AE85B49AA1ULL, 0x679F848F6E8FC971ULL, 0x7449BBFF801FED0BULL,
+		0x7D11CDB1C3B7ADF0ULL, 0x82C7709E781EB7CCULL, 0xF3218F1C9510786CULL, 0x331478F3AF51BBE6ULL,
+		0x4BB38DE5E7219443ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xAA649C6EBCFD50FCULL,
+		0x8DBD98A352AFD40BULL, 0x87D2074B81D79217ULL, 0x19F3C751D3E92AE1ULL, 0xB4AB30F062B19ABFULL,
+		0x7B0500AC42047AC4ULL, 0xC9452CA81A09D85DULL, 0x24AA6C514DA27500ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x4C9F34427501B447ULL, 0x14A68FD73C910841ULL, 0xA71B9B83461CBD93ULL,
+		0x03488B95B0F1850FULL, 0x637B2B34FF93C040ULL, 0x09D1BC9A3DD90A94ULL, 0x3575668334A1DD3BULL,
+		0x735E2B97A4C45A23ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x18727070F1BD400BULL,
+		0x1FCBACD259BF02E7ULL, 0xD310A7C2CE9B6555ULL, 0xBF983FE0FE5D8244ULL, 0x9F74D14F7454A824ULL,
+		0x51EBDC4AB9BA3035ULL, 0x5C82C505DB9AB0FAULL, 0xFCF7FE8A3430B241ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x3253A729B9BA3DDEULL, 0x8C74C368081B3075ULL, 0xB9BC6C87167C33E7ULL,
+		0x7EF48F2B83024E20ULL, 0x11D505D4C351BD7FULL, 0x6568FCA92C76A243ULL, 0x4DE0B0F40F32A7B8ULL,
+		0x96D693460CC37E5DULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x42E240CB63689F2FULL,
+		0x6D2BDCDAE2919661ULL, 0x42880B0236E4D951ULL, 0x5F0F4A5898171BB6ULL, 0x39F890F579F92F88ULL,
+		0x93C5B5F47356388BULL, 0x63DC359D8D231B78ULL, 0xEC16CA8AEA98AD76ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x56436C9FE1A1AA8DULL, 0xEFAC4B70633B8F81ULL, 0xBB215798D45DF7AFULL,
+		0x45F20042F24F1768ULL, 0x930F80F4E8EB7462ULL, 0xFF6712FFCFD75EA1ULL, 0xAE623FD67468AA70ULL,
+		0xDD2C5BC84BC8D8FCULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x7EED120D54CF2DD9ULL,
+		0x22FE545401165F1CULL, 0xC91800E98FB99929ULL, 0x808BD68E6AC10365ULL, 0xDEC468145B7605F6ULL,
+		0x1BEDE3A3AEF53302ULL, 0x43539603D6C55602ULL, 0xAA969B5C691CCB7AULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xA87832D392EFEE56ULL, 0x65942C7B3C7E11AEULL, 0xDED2D633CAD004F6ULL,
+		0x21F08570F420E565ULL, 0xB415938D7DA94E3CULL, 0x91B859E59ECB6350ULL, 0x10CFF333E0ED804AULL,
+		0x28AED140BE0BB7DDULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xC5CC1D89724FA456ULL,
+		0x5648F680F11A2741ULL, 0x2D255069F0B7DAB3ULL, 0x9BC5A38EF729ABD4ULL, 0xEF2F054308F6A2BCULL,
+		0xAF2042F5CC5C2858ULL, 0x480412BAB7F5BE2AULL, 0xAEF3AF4A563DFE43ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x19AFE59AE451497FULL, 0x52593803DFF1E840ULL, 0xF4F076E65F2CE6F0ULL,
+		0x11379625747D5AF3ULL, 0xBCE5D2248682C115ULL, 0x9DA4243DE836994FULL, 0x066F70B33FE09017ULL,
+		0x4DC4DE189B671A1CULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x51039AB7712457C3ULL,
+		0xC07A3F80C31FB4B4ULL, 0xB46EE9C5E64A6E7CULL, 0xB3819A42ABE61C87ULL, 0x21A007933A522A20ULL,
+		0x2DF16F761598AA4FULL, 0x763C4A1371B368FDULL, 0xF793C46702E086A0ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xD7288E012AEB8D31ULL, 0xDE336A2A4BC1C44BULL, 0x0BF692B38D079F23ULL,
+		0x2C604A7A177326B3ULL, 0x4850E73E03EB6064ULL, 0xCFC447F1E53C8E1BULL, 0xB05CA3F564268D99ULL,
+		0x9AE182C8BC9474E8ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xA4FC4BD4FC5558CAULL,
+		0xE755178D58FC4E76ULL, 0x69B97DB1A4C03DFEULL, 0xF9B5B7C4ACC67C96ULL, 0xFC6A82D64B8655FBULL,
+		0x9C684CB6C4D24417ULL, 0x8EC97D2917456ED0ULL, 0x6703DF9D2924E97EULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x7F9B6AF1EBF78BAFULL, 0x58627E1A149BBA21ULL, 0x2CD16E2ABD791E33ULL,
+		0xD363EFF5F0977996ULL, 0x0CE2A38C344A6EEDULL, 0x1A804AADB9CFA741ULL, 0x907F30421D78C5DEULL,
+		0x501F65EDB3034D07ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x37624AE5A48FA6E9ULL,
+		0x957BAF61700CFF4EULL, 0x3A6C27934E31188AULL, 0xD49503536ABCA345ULL, 0x088E049589C432E0ULL,
+		0xF943AEE7FEBF21B8ULL, 0x6C3B8E3E336139D3ULL, 0x364F6FFA464EE52EULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xD60F6DCEDC314222ULL, 0x56963B0DCA418FC0ULL, 0x16F50EDF91E513AFULL,
+		0xEF1955914B609F93ULL, 0x565601C0364E3228ULL, 0xECB53939887E8175ULL, 0xBAC7A9A18531294BULL,
+		0xB344C470397BBA52ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x65D34954DAF3CEBDULL,
+		0xB4B81B3FA97511E2ULL, 0xB422061193D6F6A7ULL, 0x071582401C38434DULL, 0x7A13F18BBEDC4FF5ULL,
+		0xBC4097B116C524D2ULL, 0x59B97885E2F2EA28ULL, 0x99170A5DC3115544ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x6F423357E7C6A9F9ULL, 0x325928EE6E6F8794ULL, 0xD0E4366228B03343ULL,
+		0x565C31F7DE89EA27ULL, 0x30F5611484119414ULL, 0xD873DB391292ED4FULL, 0x7BD94E1D8E17DEBCULL,
+		0xC7D9F16864A76E94ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x947AE053EE56E63CULL,
+		0xC8C93882F9475F5FULL, 0x3A9BF55BA91F81CAULL, 0xD9A11FBB3D9808E4ULL, 0x0FD22063EDC29FCAULL,
+		0xB3F256D8ACA0B0B9ULL, 0xB03031A8B4516E84ULL, 0x35DD37D5871448AFULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xE9F6082B05542E4EULL, 0xEBFAFA33D7254B59ULL, 0x9255ABB50D532280ULL,
+		0xB9AB4CE57F2D34F3ULL, 0x693501D628297551ULL, 0xC62C58F97DD949BFULL, 0xCD454F8F19C5126AULL,
+		0xBBE83F4ECC2BDECBULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xDC842B7E2819E230ULL,
+		0xBA89142E007503B8ULL, 0xA3BC941D0A5061CBULL, 0xE9F6760E32CD8021ULL, 0x09C7E552BC76492FULL,
+		0x852F54934DA55CC9ULL, 0x8107FCCF064FCF56ULL, 0x098954D51FFF6580ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xDA3A361B1C5157B1ULL, 0xDCDD7D20903D0C25ULL, 0x36833336D068F707ULL,
+		0xCE68341F79893389ULL, 0xAB9090168DD05F34ULL, 0x43954B3252DC25E5ULL, 0xB438C2B67F98E5E9ULL,
+		0x10DCD78E3851A492ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xDBC27AB5447822BFULL,
+		0x9B3CDB65F82CA382ULL, 0xB67B7896167B4C84ULL, 0xBFCED1B0048EAC50ULL, 0xA9119B60369FFEBDULL,
+		0x1FFF7AC80904BF45ULL, 0xAC12FB171817EEE7ULL, 0xAF08DA9177DDA93DULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x1B0CAB936E65C744ULL, 0xB559EB1D04E5E932ULL, 0xC37B45B3F8D6F2BAULL,
+		0xC3A9DC228CAAC9E9ULL, 0xF3B8B6675A6507FFULL, 0x9FC477DE4ED681DAULL, 0x67378D8ECCEF96CBULL,
+		0x6DD856D94D259236ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xA319CE15B0B4DB31ULL,
+		0x073973751F12DD5EULL, 0x8A8E849EB32781A5ULL, 0xE1925C71285279F5ULL, 0x74C04BF1790C0EFEULL,
+		0x4DDA48153C94938AULL, 0x9D266D6A1CC0542CULL, 0x7440FB816508C4FEULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x13328503DF48229FULL, 0xD6BF7BAEE43CAC40ULL, 0x4838D65F6EF6748FULL,
+		0x1E152328F3318DEAULL, 0x8F8419A348F296BFULL, 0x72C8834A5957B511ULL, 0xD7A023A73260B45CULL,
+		0x94EBC8ABCFB56DAEULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x9FC10D0F989993E0ULL,
+		0xDE68A2355B93CAE6ULL, 0xA44CFE79AE538BBEULL, 0x9D1D84FCCE371425ULL, 0x51D2B1AB2DDFB636ULL,
+		0x2FD7E4B9E72CD38CULL, 0x65CA5B96B7552210ULL, 0xDD69A0D8AB3B546DULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x604D51B25FBF70E2ULL, 0x73AA8A564FB7AC9EULL, 0x1A8C1E992B941148ULL,
+		0xAAC40A2703D9BEA0ULL, 0x764DBEAE7FA4F3A6ULL, 0x1E99B96E70A9BE8BULL, 0x2C5E9DEB57EF4743ULL,
+		0x3A938FEE32D29981ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x26E6DB8FFDF5ADFEULL,
+		0x469356C504EC9F9DULL, 0xC8763C5B08D1908CULL, 0x3F6C6AF859D80055ULL, 0x7F7CC39420A3A545ULL,
+		0x9BFB227EBDF4C5CEULL, 0x89039D79D6FC5C5CULL, 0x8FE88B57305E2AB6ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x001F837CC7350524ULL, 0x1877B51E57A764D5ULL, 0xA2853B80F17F58EEULL,
+		0x993E1DE72D36D310ULL, 0xB3598080CE64A656ULL, 0x252F59CF0D9F04BBULL, 0xD23C8E176D113600ULL,
+		0x1BDA0492E7E4586EULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x21E0BD5026C619BFULL,
+		0x3B097ADAF088F94EULL, 0x8D14DEDB30BE846EULL, 0xF95CFFA23AF5F6F4ULL, 0x3871700761B3F743ULL,
+		0xCA672B91E9E4FA16ULL, 0x64C8E531BFF53B55ULL, 0x241260ED4AD1E87DULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x106C09B972D2E822ULL, 0x7FBA195410E5CA30ULL, 0x7884D9BC6CB569D8ULL,
+		0x0647DFEDCD894A29ULL, 0x63573FF03E224774ULL, 0x4FC8E9560F91B123ULL, 0x1DB956E450275779ULL,
+		0xB8D91274B9E9D4FBULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xA2EBEE47E2FBFCE1ULL,
+		0xD9F1F30CCD97FB09ULL, 0xEFED53D75FD64E6BULL, 0x2E6D02C36017F67FULL, 0xA9AA4D20DB084E9BULL,
+		0xB64BE8D8B25396C1ULL, 0x70CB6AF7C2D5BCF0ULL, 0x98F076A4F7A2322EULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0xBF84470805E69B5FULL, 0x94C3251F06F90CF3ULL, 0x3E003E616A6591E9ULL,
+		0xB925A6CD0421AFF3ULL, 0x61BDD1307C66E300ULL, 0xBF8D5108E27E0D48ULL, 0x240AB57A8B888B20ULL,
+		0xFC87614BAF287E07ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xEF02CDD06FFDB432ULL,
+		0xA1082C0466DF6C0AULL, 0x8215E577001332C8ULL, 0xD39BB9C3A48DB6CFULL, 0x2738259634305C14ULL,
+		0x61CF4F94C97DF93DULL, 0x1B6BACA2AE4E125BULL, 0x758F450C88572E0BULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x959F587D507A8359ULL, 0xB063E962E045F54DULL, 0x60E8ED72C0DFF5D1ULL,
+		0x7B64978555326F9FULL, 0xFD080D236DA814BAULL, 0x8C90FD9B083F4558ULL, 0x106F72FE81E2C590ULL,
+		0x7976033A39F7D952ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xA4EC0132764CA04BULL,
+		0x733EA705FAE4FA77ULL, 0xB4D8F77BC3E56167ULL, 0x9E21F4F903B33FD9ULL, 0x9D765E419FB69F6DULL,
+		0xD30C088BA61EA5EFULL, 0x5D94337FBFAF7F5BULL, 0x1A4E4822EB4D7A59ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	},
+	{
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x230E343DFBA08D33ULL, 0x43ED7F5A0FAE657DULL, 0x3A88A0FBBCB05C63ULL,
+		0x21874B8B4D2DBC4FULL, 0x1BDEA12E35F6A8C9ULL, 0x53C065C6C8E63528ULL, 0xE34A1D250E7A8D6BULL,
+		0xD6B04D3B7651DD7EULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x5E90277E7CB39E2DULL,
+		0x2C046F22062DC67DULL, 0xB10BB459132D0A26ULL, 0x3FA9DDFB67E2F199ULL, 0x0E09B88E1914F7AFULL,
+		0x10E8B35AF3EEAB37ULL, 0x9EEDECA8E272B933ULL, 0xD4C718BC4AE8AE5FULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x81536D601170FC20ULL, 0x91B534F885818A06ULL, 0xEC8177F83F900978ULL,
+		0x190E714FADA5156EULL, 0xB592BF39B0364963ULL, 0x89C350C893AE7DC1ULL, 0xAC042E70F8B383F2ULL,
+		0xB49B52E587A1EE60ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xFB152FE3FF26DA89ULL,
+		0x3E666E6F69AE2C15ULL, 0x3B544EBE544C19F9ULL, 0xE805A1E290CF2456ULL, 0x24B33C9D7ED25117ULL,
+		0xE74733427B72F0C1ULL, 0x0A804D18B7097475ULL, 0x57E3306D881EDB4FULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x4AE7D6A36EB5DBCBULL, 0x2D8D5432157064C8ULL, 0xD1E649DE1E7F268BULL,
+		0x8A328A1CEDFE552CULL, 0x07A3AEC79624C7DAULL, 0x84547DDC3E203C94ULL, 0x990A98FD5071D263ULL,
+		0x1A4FF12616EEFC89ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xF6F7FD1431714200ULL,
+		0x30C05B1BA332F41CULL, 0x8D2636B81555A786ULL, 0x46C9FEB55D120902ULL, 0xCCEC0A73B49C9921ULL,
+		0x4E9D2827355FC492ULL, 0x19EBB029435DCB0FULL, 0x4659D2B743848A2CULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x963EF2C96B33BE31ULL, 0x74F85198B05A2E7DULL, 0x5A0F544DD2B1FB18ULL,
+		0x03727073C2E134B1ULL, 0xC7F6AA2DE59AEA61ULL, 0x352787BAA0D7C22FULL, 0x9853EAB63B5E0B35ULL,
+		0xABBDCDD7ED5C0860ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xCF05DAF5AC8D77B0ULL,
+		0x49CAD48CEBF4A71EULL, 0x7A4C10EC2158C4A6ULL, 0xD9E92AA246BF719EULL, 0x13AE978D09FE5557ULL,
+		0x730499AF921549FFULL, 0x4E4B705B92903BA4ULL, 0xFF577222C14F0A3AULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+		0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+	}
+};
+
+const U64 g_sideKey = 0xF8D626AAAF278509ULL;
+
+const U64 g_castleKeys[16] = {
+	0x0000000000000000ULL, 0x31D71DCE64B2C310ULL, 0xF165B587DF898190ULL, 0xC0B2A849BB3B4280ULL,
+	0xA57E6339DD2CF3A0ULL, 0x94A97EF7B99E30B0ULL, 0x541BD6BE02A57230ULL, 0x65CCCB706617B120ULL,
+	0x1EF6E6DBB1961EC9ULL, 0x2F21FB15D524DDD9ULL, 0xEF93535C6E1F9F59ULL, 0xDE444E920AAD5C49ULL,
+	0xBB8885E26CBAED69ULL, 0x8A5F982C08082E79ULL, 0x4AED3065B3336CF9ULL, 0x7B3A2DABD781AFE9ULL
+};
+
+const U64 g_bishopMagicNumbers[64] = {
+	0x10102002004A1420ULL, 0x8020040400584008ULL, 0x10510800811201C8ULL, 0x5204042080000088ULL,
+	0x2204106880000002ULL, 0x1401042004000000ULL, 0x0400880410042004ULL, 0x0028208200A02020ULL,
+	0x1500241990010E00ULL, 0x8001200182020A40ULL, 0x40004101030B0000ULL, 0x8002041042000100ULL,
+	0x4010011041020038ULL, 0x0000010421044000ULL, 0x1500210808020A00ULL, 0x8000088400880520ULL,
+	0x0405004010040100ULL, 0x1005823210040108ULL, 0x2708008102040011ULL, 0x4048200404009100ULL,
+	0x0018104101400024ULL, 0x0003000601190101ULL, 0x8004803108491000ULL, 0x8014241200820800ULL,
+	0x0006E080100C3040ULL, 0x0501044A11041800ULL, 0x9020300008004045ULL, 0x0894080000220040ULL,
+	0x1001010083104000ULL, 0x5004030040900080ULL, 0x000400422C012400ULL, 0x0002128698404812ULL,
+	0x1010108404900440ULL, 0x0928021182084100ULL, 0x2006080409020024ULL, 0x1010202020180080ULL,
+	0xA010008200202200ULL, 0x2098015100019004ULL, 0x0002041440810811ULL, 0x802A02020000B098ULL,
+	0x0009015090004060ULL, 0x4000821082081001ULL, 0x0100210040420800ULL, 0x0800004010488A00ULL,
+	0x2000081104004040ULL, 0x4C8E029015000082ULL, 0x0420340322224842ULL, 0x1298260043400210ULL,
+	0x0000822802400008ULL, 0x00008A0101600000ULL, 0x3040003412080021ULL, 0x3040290220884800ULL,
+	0x4A1500401041004AULL, 0x8010200282020781ULL, 0x0020203142209091ULL, 0x0070300600902110ULL,
+	0x0040808800B62048ULL, 0x0000810400C44420ULL, 0x00080400440C0441ULL, 0x8340080020840411ULL,
+	0x0000000104208200ULL, 0x0000800810D00080ULL, 0x0400530411080200ULL, 0x4040702400932244ULL
+};
+
+const U64 g_rookMagicNumbers[64] = {
+	0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+	0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+	0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+	0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+	0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+	0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+	0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+	0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+	0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+	0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+	0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+	0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+	0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+	0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+	0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+	0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
@@ -0,0 +1,113 @@
+/**
+ * @file evaluation_cache.c
+ * @brief Static evaluation cache keyed by position key
+ *
+ * Transpositions bring the same positions back to quiescence and to the
+ * pruning decisions of the main search many times over. This small
+ * direct-mapped table remembers Evaluate_Position results so repeats
+ * cost one load instead of a full evaluation.
+ *
+ * Each slot is a single 64-bit word:
+ * - Bits 0-15:  Evaluation (signed, side to move's point of view)
+ * - Bits 16-63: Upper 48 bits of the Zobrist key
+ *
+ * Slots are loaded and stored as whole words with relaxed atomics, so
+ * all search threads share the table without locks and never see a torn
+ * entry. A clash simply overwrites the slot.
+ *
+ * The transposition table has no room for a static eval in its 64-bit
+ * entries, so the eval is cached here only.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "types_definitions.h"
+
+#define EVAL_KEY_MASK 0xFFFFFFFFFFFF0000ULL
+
+#if defined(__GNUC__) || defined(__clang__)
+#define EVAL_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define EVAL_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#else
+#define EVAL_LOAD(p) (*(volatile U64 *)(p))
+#define EVAL_STORE(p,v) (*(volatile U64 *)(p) = (v))
+#endif
+
+EvalCache g_evalCache[1];
+
+void EvalCache_Free(EvalCache *cache) {
+	free(cache->entries);
+	cache->entries = NULL;
+	cache->mask = 0ULL;
+}
+
+void EvalCache_Init(EvalCache *cache, const int MB) {
+
+	U64 count = 1ULL;
+	U64 bytes = (U64)MB * 1024 * 1024;
+
+	EvalCache_Free(cache);
+	if(MB <= 0) {
+		return;
+	}
+
+	// round down to a power of two so the index is a single mask
+	while(count * 2 * sizeof(U64) <= bytes) {
+		count *= 2;
+	}
+	cache->entries = (U64 *) calloc(count, sizeof(U64));
+	if(cache->entries == NULL) {
+		printf("Eval Cache Allocation Failed, running without it\n");
+		return;
+	}
+	cache->mask = count - 1;
+}
+
+void EvalCache_Clear(EvalCache *cache) {
+
+	U64 index = 0ULL;
+
+	if(cache->entries == NULL) {
+		return;
+	}
+	for(index = 0; index <= cache->mask; ++index) {
+		cache->entries[index] = 0ULL;
+	}
+}
+
+void EvalCache_Prefetch(const U64 posKey) {
+#if defined(__GNUC__) || defined(__clang__)
+	if(g_evalCache->entries != NULL) {
+		__builtin_prefetch(&g_evalCache->entries[posKey & g_evalCache->mask]);
+	}
+#else
+	(void)posKey;
+#endif
+}
+
+int EvalCache_Evaluate(const ChessBoard *board) {
+
+	EvalCache *cache = g_evalCache;
+	U64 *slot = NULL;
+	U64 entry = 0ULL;
+	int score = 0;
+
+	if(cache->entries == NULL) {
+		return Evaluate_Position(board);
+	}
+
+	slot = &cache->entries[board->posKey & cache->mask];
+	entry = EVAL_LOAD(slot);
+	if(((entry ^ board->posKey) & EVAL_KEY_MASK) == 0ULL && entry != 0ULL) {
+		ASSERT((int)(short)(entry & 0xFFFF) == Evaluate_Position(board));
+		return (int)(short)(entry & 0xFFFF);
+	}
+
+	score = Evaluate_Position(board);
+	ASSERT(score > -32768 && score < 32768);
+	EVAL_STORE(slot, (board->posKey & EVAL_KEY_MASK) | (U64)(unsigned short)score);
+	return score;
+}
@@ -0,0 +1,348 @@
+/**
+ * @file evaluation_nnue.c
+ * @brief Efficiently updatable neural network evaluation
+ *
+ * A (768 -> NNUE_HIDDEN) x 2 -> 1 network:
+ * - Inputs: one feature per (piece, square), seen from each side with
+ *   the board flipped for Black, so both halves share one weight matrix
+ * - Hidden layer: int16 accumulators, one per perspective, updated by
+ *   the make move piece helpers as pieces appear, vanish and move
+ * - Output: clipped ReLU (0..NNUE_QA) of both halves, side to move first,
+ *   dotted with int16 weights into an int32 sum
+ *
+ * The accumulators sit on a per-ply stack in the board's search tables.
+ * Move_Make pushes a copy and updates it, Move_Take pops the pointer,
+ * so unmaking costs nothing. The stack is rebuilt from scratch at every
+ * search root.
+ *
+ * Kernels use AVX2, SSE2 (x86-64 baseline, also the popcnt build) or
+ * NEON when the compiler targets them, with a scalar fallback.
+ *
+ * Network file, little-endian, read in place through Misc_MapFile:
+ * - Bytes 0-3: Magic "GNUE"
+ * - Bytes 4-7: Version (1)
+ * - Bytes 8-11: Hidden width (must equal NNUE_HIDDEN)
+ * - Bytes 12-15: Output bias (int32, scaled by NNUE_QA * NNUE_QB)
+ * - Bytes 16-63: Reserved, keeps the weights 64-byte aligned
+ * - int16 feature weights [NNUE_INPUTS][NNUE_HIDDEN] (scale NNUE_QA)
+ * - int16 feature bias [NNUE_HIDDEN] (scale NNUE_QA)
+ * - int16 output weights [2][NNUE_HIDDEN] (scale NNUE_QB)
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "types_definitions.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NNUE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define NNUE_NEON
+#endif
+
+#define NNUE_MAGIC "GNUE"
+#define NNUE_VERSION 1
+#define NNUE_HEADER_SIZE 64
+#define NNUE_QA 255
+#define NNUE_QB 64
+#define NNUE_SCALE 400
+
+#define NNUE_FILE_SIZE (NNUE_HEADER_SIZE \
+	+ sizeof(short) * ((size_t)NNUE_INPUTS * NNUE_HIDDEN + NNUE_HIDDEN + 2 * NNUE_HIDDEN))
+
+NnueNetwork g_nnue[1];
+
+// feature of a piece on a 120 square, seen by perspective
+static inline int FeatureIndex(const int perspective, const int piece, const int squareIndex) {
+
+	int sq64 = SQUARE_120_TO_64(squareIndex);
+	int kind = (piece - 1) % 6;
+	int theirs = g_pieceCol[piece] != perspective;
+
+	if(perspective == COLOR_TYPE_BLACK) {
+		sq64 ^= 56;
+	}
+	return (theirs * 6 + kind) * 64 + sq64;
+}
+
+static inline const short *Column(const int feature) {
+	return g_nnue->featureWeights + (size_t)feature * NNUE_HIDDEN;
+}
+
+/* --- kernels --- */
+
+static inline void AddColumn(short *values, const short *add) {
+	int index = 0;
+#if defined(NNUE_AVX2)
+	for(index = 0; index < NNUE_HIDDEN; index += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)&values[index]);
+		v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i *)&add[index]));
+		_mm256_storeu_si256((__m256i *)&values[index], v);
+	}
+#elif defined(NNUE_SSE2)
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)&values[index]);
+		v = _mm_add_epi16(v, _mm_loadu_si128((const __m128i *)&add[index]));
+		_mm_storeu_si128((__m128i *)&values[index], v);
+	}
+#elif defined(NNUE_NEON)
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		vst1q_s16(&values[index], vaddq_s16(vld1q_s16(&values[index]), vld1q_s16(&add[index])));
+	}
+#else
+	for(index = 0; index < NNUE_HIDDEN; ++index) {
+		values[index] += add[index];
+	}
+#endif
+}
+
+static inline void SubColumn(short *values, const short *sub) {
+	int index = 0;
+#if defined(NNUE_AVX2)
+	for(index = 0; index < NNUE_HIDDEN; index += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)&values[index]);
+		v = _mm256_sub_epi16(v, _mm256_loadu_si256((const __m256i *)&sub[index]));
+		_mm256_storeu_si256((__m256i *)&values[index], v);
+	}
+#elif defined(NNUE_SSE2)
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)&values[index]);
+		v = _mm_sub_epi16(v, _mm_loadu_si128((const __m128i *)&sub[index]));
+		_mm_storeu_si128((__m128i *)&values[index], v);
+	}
+#elif defined(NNUE_NEON)
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		vst1q_s16(&values[index], vsubq_s16(vld1q_s16(&values[index]), vld1q_s16(&sub[index])));
+	}
+#else
+	for(index = 0; index < NNUE_HIDDEN; ++index) {
+		values[index] -= sub[index];
+	}
+#endif
+}
+
+// one pass for a moving piece instead of a subtract and an add
+static inline void AddSubColumn(short *values, const short *add, const short *sub) {
+	int index = 0;
+#if defined(NNUE_AVX2)
+	for(index = 0; index < NNUE_HIDDEN; index += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)&values[index]);
+		v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i *)&add[index]));
+		v = _mm256_sub_epi16(v, _mm256_loadu_si256((const __m256i *)&sub[index]));
+		_mm256_storeu_si256((__m256i *)&values[index], v);
+	}
+#elif defined(NNUE_SSE2)
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)&values[index]);
+		v = _mm_add_epi16(v, _mm_loadu_si128((const __m128i *)&add[index]));
+		v = _mm_sub_epi16(v, _mm_loadu_si128((const __m128i *)&sub[index]));
+		_mm_storeu_si128((__m128i *)&values[index], v);
+	}
+#elif defined(NNUE_NEON)
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		int16x8_t v = vaddq_s16(vld1q_s16(&values[index]), vld1q_s16(&add[index]));
+		vst1q_s16(&values[index], vsubq_s16(v, vld1q_s16(&sub[index])));
+	}
+#else
+	for(index = 0; index < NNUE_HIDDEN; ++index) {
+		values[index] += add[index] - sub[index];
+	}
+#endif
+}
+
+// sum of clamp(values, 0, NNUE_QA) * weights
+static inline int ClippedDot(const short *values, const short *weights) {
+	int index = 0;
+#if defined(NNUE_AVX2)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i limit = _mm256_set1_epi16(NNUE_QA);
+	__m256i sum = _mm256_setzero_si256();
+	for(index = 0; index < NNUE_HIDDEN; index += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)&values[index]);
+		v = _mm256_min_epi16(_mm256_max_epi16(v, zero), limit);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, _mm256_loadu_si256((const __m256i *)&weights[index])));
+	}
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(half);
+#elif defined(NNUE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i limit = _mm_set1_epi16(NNUE_QA);
+	__m128i sum = _mm_setzero_si128();
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)&values[index]);
+		v = _mm_min_epi16(_mm_max_epi16(v, zero), limit);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(v, _mm_loadu_si128((const __m128i *)&weights[index])));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#elif defined(NNUE_NEON)
+	const int16x8_t zero = vdupq_n_s16(0);
+	const int16x8_t limit = vdupq_n_s16(NNUE_QA);
+	int32x4_t sum = vdupq_n_s32(0);
+	for(index = 0; index < NNUE_HIDDEN; index += 8) {
+		int16x8_t v = vminq_s16(vmaxq_s16(vld1q_s16(&values[index]), zero), limit);
+		int16x8_t w = vld1q_s16(&weights[index]);
+		sum = vmlal_s16(sum, vget_low_s16(v), vget_low_s16(w));
+		sum = vmlal_s16(sum, vget_high_s16(v), vget_high_s16(w));
+	}
+	return vgetq_lane_s32(sum, 0) + vgetq_lane_s32(sum, 1) + vgetq_lane_s32(sum, 2) + vgetq_lane_s32(sum, 3);
+#else
+	int sum = 0;
+	for(index = 0; index < NNUE_HIDDEN; ++index) {
+		int v = values[index];
+		if(v < 0) v = 0;
+		if(v > NNUE_QA) v = NNUE_QA;
+		sum += v * weights[index];
+	}
+	return sum;
+#endif
+}
+
+/* --- accumulator maintenance --- */
+
+static void ComputeAccumulator(const ChessBoard *board, NnueAccumulator *accumulator) {
+
+	int piece = 0;
+	int index = 0;
+	int perspective = 0;
+
+	for(perspective = COLOR_TYPE_WHITE; perspective <= COLOR_TYPE_BLACK; ++perspective) {
+		memcpy(accumulator->values[perspective], g_nnue->featureBias, sizeof(accumulator->values[perspective]));
+		for(piece = PIECE_TYPE_WHITE_PAWN; piece <= PIECE_TYPE_BLACK_KING; ++piece) {
+			for(index = 0; index < board->pieceCount[piece]; ++index) {
+				AddColumn(accumulator->values[perspective], Column(FeatureIndex(perspective, piece, board->pList[piece][index])));
+			}
+		}
+	}
+}
+
+void Nnue_AddPiece(NnueAccumulator *accumulator, const int piece, const int squareIndex) {
+	AddColumn(accumulator->values[COLOR_TYPE_WHITE], Column(FeatureIndex(COLOR_TYPE_WHITE, piece, squareIndex)));
+	AddColumn(accumulator->values[COLOR_TYPE_BLACK], Column(FeatureIndex(COLOR_TYPE_BLACK, piece, squareIndex)));
+}
+
+void Nnue_RemovePiece(NnueAccumulator *accumulator, const int piece, const int squareIndex) {
+	SubColumn(accumulator->values[COLOR_TYPE_WHITE], Column(FeatureIndex(COLOR_TYPE_WHITE, piece, squareIndex)));
+	SubColumn(accumulator->values[COLOR_TYPE_BLACK], Column(FeatureIndex(COLOR_TYPE_BLACK, piece, squareIndex)));
+}
+
+void Nnue_MovePiece(NnueAccumulator *accumulator, const int piece, const int from, const int to) {
+	AddSubColumn(accumulator->values[COLOR_TYPE_WHITE],
+		Column(FeatureIndex(COLOR_TYPE_WHITE, piece, to)), Column(FeatureIndex(COLOR_TYPE_WHITE, piece, from)));
+	AddSubColumn(accumulator->values[COLOR_TYPE_BLACK],
+		Column(FeatureIndex(COLOR_TYPE_BLACK, piece, to)), Column(FeatureIndex(COLOR_TYPE_BLACK, piece, from)));
+}
+
+void Nnue_Refresh(ChessBoard *board) {
+
+	if(g_nnue->loaded == BOOL_TYPE_FALSE) {
+		board->accumulator = NULL;
+		return;
+	}
+	board->accumulator = board->tables->accumulators;
+	ComputeAccumulator(board, board->accumulator);
+}
+
+void Nnue_Push(ChessBoard *board) {
+
+	NnueAccumulator *next = board->accumulator + 1;
+
+	ASSERT(board->accumulator != NULL);
+
+	// game moves made outside a search can outgrow the stack; the next
+	// search root refreshes it
+	if(next >= board->tables->accumulators + CHESS_MAX_SEARCH_DEPTH + 1) {
+		board->accumulator = NULL;
+		return;
+	}
+	memcpy(next, board->accumulator, sizeof(NnueAccumulator));
+	board->accumulator = next;
+}
+
+int Nnue_Evaluate(const ChessBoard *board) {
+
+	NnueAccumulator scratch[1];
+	const NnueAccumulator *accumulator = board->accumulator;
+	int side = board->side;
+	int score = 0;
+
+	ASSERT(g_nnue->loaded == BOOL_TYPE_TRUE);
+
+	if(accumulator == NULL) {
+		ComputeAccumulator(board, scratch);
+		accumulator = scratch;
+	}
+#ifdef DEBUG
+	else {
+		ComputeAccumulator(board, scratch);
+		ASSERT(memcmp(scratch, accumulator, sizeof(NnueAccumulator)) == 0);
+	}
+#endif
+
+	score = ClippedDot(accumulator->values[side], g_nnue->outputWeights)
+		+ ClippedDot(accumulator->values[side ^ 1], g_nnue->outputWeights + NNUE_HIDDEN)
+		+ g_nnue->outputBias;
+	score = (int)((long long)score * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+
+	// leave room for mate scores
+	if(score > CHESS_IS_MATE - 1) score = CHESS_IS_MATE - 1;
+	if(score < -(CHESS_IS_MATE - 1)) score = -(CHESS_IS_MATE - 1);
+	return score;
+}
+
+/* --- network file --- */
+
+void Nnue_Free() {
+
+	Misc_UnmapFile(g_nnue->mapping, g_nnue->mappingSize);
+	memset(g_nnue, 0, sizeof(NnueNetwork));
+}
+
+int Nnue_Load(const char *path) {
+
+	size_t size = 0;
+	const unsigned char *memory = NULL;
+	int version = 0;
+	int hidden = 0;
+
+	Nnue_Free();
+	if(path == NULL || path[0] == '\0') {
+		return BOOL_TYPE_FALSE;
+	}
+
+	memory = (const unsigned char *) Misc_MapFile(path, &size);
+	if(memory == NULL) {
+		return BOOL_TYPE_FALSE;
+	}
+	g_nnue->mapping = memory;
+	g_nnue->mappingSize = size;
+
+	if(size >= NNUE_HEADER_SIZE) {
+		memcpy(&version, memory + 4, sizeof(int));
+		memcpy(&hidden, memory + 8, sizeof(int));
+	}
+	if(size != NNUE_FILE_SIZE || memcmp(memory, NNUE_MAGIC, 4) != 0
+		|| version != NNUE_VERSION || hidden != NNUE_HIDDEN) {
+		printf("Invalid network file %s\n", path);
+		Nnue_Free();
+		return BOOL_TYPE_FALSE;
+	}
+
+	memcpy(&g_nnue->outputBias, memory + 12, sizeof(int));
+	g_nnue->featureWeights = (const short *)(memory + NNUE_HEADER_SIZE);
+	g_nnue->featureBias = g_nnue->featureWeights + (size_t)NNUE_INPUTS * NNUE_HIDDEN;
+	g_nnue->outputWeights = g_nnue->featureBias + NNUE_HIDDEN;
+	g_nnue->loaded = BOOL_TYPE_TRUE;
+
+	return BOOL_TYPE_TRUE;
+}
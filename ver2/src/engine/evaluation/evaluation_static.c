@@ -10,6 +10,27 @@
  * - King safety
  * - Bishop pair bonus
  * 
+ * Material and piece-square scores are kept incrementally on the board
+ * (material, pstMg, pstEg, updated by make/unmake from g_pstMg/g_pstEg),
+ * so Evaluate_Position only adds the structural terms.
+ * Those are computed set-wise, for all pieces of a colour at once, from
+ * file fills, shifts and masks over the piece bitboards. Black's pawns
+ * are flipped vertically so both colours run the same code over
+ * [COLOR_TYPE_WHITE, COLOR_TYPE_BLACK] arrays. Pawn structure terms,
+ * passed pawns and open files are cached per thread in a pawn hash
+ * keyed by board->pawnKey.
+ * When an EvalFile network is loaded, everything past the material draw
+ * check is handed to Nnue_Evaluate instead.
+ *
+ * Evaluate_Lazy adds a second tier for window searches: the material and
+ * piece-square part alone decides when it lies more than
+ * EngineOptions->LazyMargin outside (alpha, beta); only the remaining
+ * positions pay for the structural terms.
+ *
+ * The weights are plain ints listed in g_evalParams so the Texel tuner
+ * (evaluation_tune.c) can adjust them; a tuned piece-square table only
+ * takes effect after Evaluate_InitPieceSquare.
+ *
  * Returns a score in centipawns from the perspective of the side to move.
  * Positive scores favor the current player, negative scores favor the opponent.
  * 
@@ -22,15 +43,56 @@
 #include "stdio.h"
 #include "types_definitions.h"
 
-const int PawnIsolated = -10;
-const int PawnPassed[8] = { 0, 5, 10, 20, 35, 60, 100, 200 }; 
-const int RookOpenFile = 10;
-const int RookSemiOpenFile = 5;
-const int QueenOpenFile = 5;
-const int QueenSemiOpenFile = 3;
-const int BishopPair = 30;
+int PawnIsolated = -10;
+int PawnDoubled = -10;
+int PawnPassed[8] = { 0, 5, 10, 20, 35, 60, 100, 200 }; 
+int RookOpenFile = 10;
+int RookSemiOpenFile = 5;
+int QueenOpenFile = 5;
+int QueenSemiOpenFile = 3;
+int BishopPair = 30;
+
+#define BB_FILE_A 0x0101010101010101ULL
+#define BB_FILE_H 0x8080808080808080ULL
+#define BB_DARK_SQUARES 0xAA55AA55AA55AA55ULL
+
+static inline U64 FlipVertical(U64 bb) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_bswap64(bb);
+#else
+	bb = ((bb >> 8) & 0x00FF00FF00FF00FFULL) | ((bb & 0x00FF00FF00FF00FFULL) << 8);
+	bb = ((bb >> 16) & 0x0000FFFF0000FFFFULL) | ((bb & 0x0000FFFF0000FFFFULL) << 16);
+	return (bb >> 32) | (bb << 32);
+#endif
+}
+
+static inline U64 NorthFill(U64 bb) {
+	bb |= bb << 8;
+	bb |= bb << 16;
+	return bb | (bb << 32);
+}
+
+static inline U64 SouthFill(U64 bb) {
+	bb |= bb >> 8;
+	bb |= bb >> 16;
+	return bb | (bb >> 32);
+}
+
+// the neighbouring files' squares of every square in bb
+static inline U64 AdjacentFiles(const U64 bb) {
+	return ((bb << 1) & ~BB_FILE_A) | ((bb >> 1) & ~BB_FILE_H);
+}
 
-const int PawnTable[64] = {
+// bit f set when file f holds a square of bb, and back to a file mask
+static inline int FileSet(const U64 bb) {
+	return (int)((NorthFill(bb) | SouthFill(bb)) & 0xFF);
+}
+
+static inline U64 FileMask(const int files) {
+	return (U64)files * BB_FILE_A;
+}
+
+int PawnTable[64] = {
 0	,	0	,	0	,	0	,	0	,	0	,	0	,	0	,
 10	,	10	,	0	,	-10	,	-10	,	0	,	10	,	10	,
 5	,	0	,	0	,	5	,	5	,	0	,	0	,	5	,
@@ -41,7 +103,7 @@ const int PawnTable[64] = {
 0	,	0	,	0	,	0	,	0	,	0	,	0	,	0	
 };
 
-const int KnightTable[64] = {
+int KnightTable[64] = {
 0	,	-10	,	0	,	0	,	0	,	0	,	-10	,	0	,
 0	,	0	,	0	,	5	,	5	,	0	,	0	,	0	,
 0	,	0	,	10	,	10	,	10	,	10	,	0	,	0	,
@@ -52,7 +114,7 @@ const int KnightTable[64] = {
 0	,	0	,	0	,	0	,	0	,	0	,	0	,	0		
 };
 
-const int BishopTable[64] = {
+int BishopTable[64] = {
 0	,	0	,	-10	,	0	,	0	,	-10	,	0	,	0	,
 0	,	0	,	0	,	10	,	10	,	0	,	0	,	0	,
 0	,	0	,	10	,	15	,	15	,	10	,	0	,	0	,
@@ -63,7 +125,7 @@ const int BishopTable[64] = {
 0	,	0	,	0	,	0	,	0	,	0	,	0	,	0	
 };
 
-const int RookTable[64] = {
+int RookTable[64] = {
 0	,	0	,	5	,	10	,	10	,	5	,	0	,	0	,
 0	,	0	,	5	,	10	,	10	,	5	,	0	,	0	,
 0	,	0	,	5	,	10	,	10	,	5	,	0	,	0	,
@@ -74,7 +136,7 @@ const int RookTable[64] = {
 0	,	0	,	5	,	10	,	10	,	5	,	0	,	0		
 };
 
-const int KingE[64] = {	
+int KingE[64] = {	
 	-50	,	-10	,	0	,	0	,	0	,	0	,	-10	,	-50	,
 	-10,	0	,	10	,	10	,	10	,	10	,	0	,	-10	,
 	0	,	10	,	20	,	20	,	20	,	20	,	10	,	0	,
@@ -85,7 +147,7 @@ const int KingE[64] = {
 	-50	,	-10	,	0	,	0	,	0	,	0	,	-10	,	-50	
 };
 
-const int KingO[64] = {	
+int KingO[64] = {	
 	0	,	5	,	5	,	-10	,	-10	,	0	,	10	,	5	,
 	-30	,	-30	,	-30	,	-30	,	-30	,	-30	,	-30	,	-30	,
 	-50	,	-50	,	-50	,	-50	,	-50	,	-50	,	-50	,	-50	,
@@ -95,6 +157,121 @@ const int KingO[64] = {
 	-70	,	-70	,	-70	,	-70	,	-70	,	-70	,	-70	,	-70	,
 	-70	,	-70	,	-70	,	-70	,	-70	,	-70	,	-70	,	-70		
 };
+// every tunable term, in the order Tune_Run walks and prints them
+EvalParam g_evalParams[] = {
+	{ "PawnIsolated", &PawnIsolated, 1 },
+	{ "PawnDoubled", &PawnDoubled, 1 },
+	{ "PawnPassed", PawnPassed, 8 },
+	{ "RookOpenFile", &RookOpenFile, 1 },
+	{ "RookSemiOpenFile", &RookSemiOpenFile, 1 },
+	{ "QueenOpenFile", &QueenOpenFile, 1 },
+	{ "QueenSemiOpenFile", &QueenSemiOpenFile, 1 },
+	{ "BishopPair", &BishopPair, 1 },
+	{ "PawnTable", PawnTable, 64 },
+	{ "KnightTable", KnightTable, 64 },
+	{ "BishopTable", BishopTable, 64 },
+	{ "RookTable", RookTable, 64 },
+	{ "KingE", KingE, 64 },
+	{ "KingO", KingO, 64 }
+};
+const int g_evalParamCount = (int)(sizeof(g_evalParams) / sizeof(g_evalParams[0]));
+
+int g_pstMg[13][CHESS_BOARD_SQUARE_NUM];
+int g_pstEg[13][CHESS_BOARD_SQUARE_NUM];
+
+// tables are written from White's side, Black reads them mirrored
+void Evaluate_InitPieceSquare() {
+
+	const int *tables[13] = { NULL, PawnTable, KnightTable, BishopTable, RookTable, NULL, NULL,
+		PawnTable, KnightTable, BishopTable, RookTable, NULL, NULL };
+	int piece = 0;
+	int sq64 = 0;
+	int index = 0;
+
+	for(piece = EMPTY; piece <= PIECE_TYPE_BLACK_KING; ++piece) {
+		for(index = 0; index < CHESS_BOARD_SQUARE_NUM; ++index) {
+			g_pstMg[piece][index] = 0;
+			g_pstEg[piece][index] = 0;
+		}
+	}
+
+	for(piece = PIECE_TYPE_WHITE_PAWN; piece <= PIECE_TYPE_BLACK_KING; ++piece) {
+		for(sq64 = 0; sq64 < 64; ++sq64) {
+			index = g_pieceCol[piece] == COLOR_TYPE_WHITE ? sq64 : SQUARE_MIRROR_64(sq64);
+			if(piece == PIECE_TYPE_WHITE_KING || piece == PIECE_TYPE_BLACK_KING) {
+				g_pstMg[piece][SQUARE_64_TO_120(sq64)] = KingO[index];
+				g_pstEg[piece][SQUARE_64_TO_120(sq64)] = KingE[index];
+			} else if(tables[piece] != NULL) {
+				g_pstMg[piece][SQUARE_64_TO_120(sq64)] = tables[piece][index];
+				g_pstEg[piece][SQUARE_64_TO_120(sq64)] = tables[piece][index];
+			}
+		}
+	}
+}
+
+void Evaluate_ClearPawnHash(PawnHashTable *table) {
+
+	int index = 0;
+
+	for(index = 0; index < PAWN_HASH_ENTRIES; ++index) {
+		table->entries[index].pawnKey = 0ULL;
+		table->entries[index].passed[COLOR_TYPE_WHITE] = 0ULL;
+		table->entries[index].passed[COLOR_TYPE_BLACK] = 0ULL;
+		table->entries[index].score = 0;
+		table->entries[index].openFiles = 0xFF;
+		table->entries[index].semiOpenFiles[COLOR_TYPE_WHITE] = 0xFF;
+		table->entries[index].semiOpenFiles[COLOR_TYPE_BLACK] = 0xFF;
+	}
+	table->probes = 0;
+	table->hits = 0;
+}
+
+// pawn terms depend on the pawns alone, so they are cached by pawnKey
+static const PawnEntry *ProbePawnHash(const ChessBoard *board) {
+
+	PawnHashTable *table = &board->tables->pawnHash;
+	PawnEntry *entry = &table->entries[board->pawnKey & (PAWN_HASH_ENTRIES - 1)];
+
+	table->probes++;
+	if(entry->pawnKey == board->pawnKey) {
+		table->hits++;
+		return entry;
+	}
+
+	// Black's pawns are flipped, so for both colours "own" pawns advance
+	// north and the squares south of an enemy pawn are the ones it guards
+	U64 own[2] = { board->pawns[COLOR_TYPE_WHITE], FlipVertical(board->pawns[COLOR_TYPE_BLACK]) };
+	U64 enemy[2] = { board->pawns[COLOR_TYPE_BLACK], FlipVertical(board->pawns[COLOR_TYPE_WHITE]) };
+	U64 passed[2];
+	int files[2];
+	int terms[2];
+	int color;
+	int rank;
+
+	for(color = COLOR_TYPE_WHITE; color <= COLOR_TYPE_BLACK; ++color) {
+		U64 guarded = SouthFill(enemy[color] >> 8);
+		U64 isolated = own[color] & ~FileMask(FileSet(AdjacentFiles(own[color])));
+		U64 doubled = own[color] & SouthFill(own[color] >> 8);
+
+		passed[color] = own[color] & ~(guarded | AdjacentFiles(guarded));
+		files[color] = FileSet(own[color]);
+		terms[color] = PawnIsolated * BITBOARD_COUNT(isolated) + PawnDoubled * BITBOARD_COUNT(doubled);
+		for(rank = RANK_TYPE_2; rank <= RANK_TYPE_7; ++rank) {
+			terms[color] += PawnPassed[rank] * BITBOARD_COUNT(passed[color] & g_rankBBMask[rank]);
+		}
+	}
+
+	entry->pawnKey = board->pawnKey;
+	entry->score = terms[COLOR_TYPE_WHITE] - terms[COLOR_TYPE_BLACK];
+	entry->passed[COLOR_TYPE_WHITE] = passed[COLOR_TYPE_WHITE];
+	entry->passed[COLOR_TYPE_BLACK] = FlipVertical(passed[COLOR_TYPE_BLACK]);
+	entry->openFiles = (unsigned char)~(files[COLOR_TYPE_WHITE] | files[COLOR_TYPE_BLACK]);
+	entry->semiOpenFiles[COLOR_TYPE_WHITE] = (unsigned char)~files[COLOR_TYPE_WHITE];
+	entry->semiOpenFiles[COLOR_TYPE_BLACK] = (unsigned char)~files[COLOR_TYPE_BLACK];
+
+	return entry;
+}
+
 // sjeng 11.2
 //8/6R1/2k5/6P1/8/8/4nP2/6K1 w - - 1 41 
 int MaterialDraw(const ChessBoard *board) {
@@ -123,168 +300,96 @@ int MaterialDraw(const ChessBoard *board) {
 
 #define ENDGAME_MAT (1 * g_pieceVal[PIECE_TYPE_WHITE_ROOK] + 2 * g_pieceVal[PIECE_TYPE_WHITE_KNIGHT] + 2 * g_pieceVal[PIECE_TYPE_WHITE_PAWN] + g_pieceVal[PIECE_TYPE_WHITE_KING])
 
-int Evaluate_Position(const ChessBoard *board) {
+// cheap tier, White's point of view: material and the incrementally
+// kept piece-square sums; each king takes its endgame table once the
+// opponent is down to endgame material
+static inline int MaterialScore(const ChessBoard *board) {
+
+	int score = board->material[COLOR_TYPE_WHITE] - board->material[COLOR_TYPE_BLACK];
+
+	//8/p6k/6p1/5p2/P4K2/8/5pB1/8 b - - 2 62 
+	if( (board->material[COLOR_TYPE_BLACK] <= ENDGAME_MAT) ) {
+		score += board->pstEg[COLOR_TYPE_WHITE];
+	} else {
+		score += board->pstMg[COLOR_TYPE_WHITE];
+	}
+
+	if( (board->material[COLOR_TYPE_WHITE] <= ENDGAME_MAT) ) {
+		score -= board->pstEg[COLOR_TYPE_BLACK];
+	} else {
+		score -= board->pstMg[COLOR_TYPE_BLACK];
+	}
+	return score;
+}
+
+static inline int IsMaterialDraw(const ChessBoard *board) {
+	return !board->pieceCount[PIECE_TYPE_WHITE_PAWN] && !board->pieceCount[PIECE_TYPE_BLACK_PAWN] && MaterialDraw(board) == BOOL_TYPE_TRUE;
+}
+
+int Evaluate_Material(const ChessBoard *board) {
 
 	ASSERT(Board_Check(board));
 
-	int piece;
-	int pieceCount;
-	int squareIndex;
-	int score = board->material[COLOR_TYPE_WHITE] - board->material[COLOR_TYPE_BLACK];
-	
-	if(!board->pieceCount[PIECE_TYPE_WHITE_PAWN] && !board->pieceCount[PIECE_TYPE_BLACK_PAWN] && MaterialDraw(board) == BOOL_TYPE_TRUE) {
+	if(IsMaterialDraw(board)) {
 		return 0;
 	}
-	
-	piece = PIECE_TYPE_WHITE_PAWN;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_120_TO_64(squareIndex)>=0 && SQUARE_120_TO_64(squareIndex)<=63);
-		score += PawnTable[SQUARE_120_TO_64(squareIndex)];	
-		
-		if( (g_isolatedMask[SQUARE_120_TO_64(squareIndex)] & board->pawns[COLOR_TYPE_WHITE]) == 0) {
-			//printf("PIECE_TYPE_WHITE_PAWN Iso:%s\n",PrSq(squareIndex));
-			score += PawnIsolated;
-		}
-		
-		if( (g_whitePassedMask[SQUARE_120_TO_64(squareIndex)] & board->pawns[COLOR_TYPE_BLACK]) == 0) {
-			//printf("PIECE_TYPE_WHITE_PAWN Passed:%s\n",PrSq(squareIndex));
-			score += PawnPassed[g_ranksBoard[squareIndex]];
-		}
-		
-	}	
+	return board->side == COLOR_TYPE_WHITE ? MaterialScore(board) : -MaterialScore(board);
+}
 
-	piece = PIECE_TYPE_BLACK_PAWN;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))>=0 && SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))<=63);
-		score -= PawnTable[SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))];	
-		
-		if( (g_isolatedMask[SQUARE_120_TO_64(squareIndex)] & board->pawns[COLOR_TYPE_BLACK]) == 0) {
-			//printf("PIECE_TYPE_BLACK_PAWN Iso:%s\n",PrSq(squareIndex));
-			score -= PawnIsolated;
-		}
-		
-		if( (g_blackPassedMask[SQUARE_120_TO_64(squareIndex)] & board->pawns[COLOR_TYPE_WHITE]) == 0) {
-			//printf("PIECE_TYPE_BLACK_PAWN Passed:%s\n",PrSq(squareIndex));
-			score -= PawnPassed[7 - g_ranksBoard[squareIndex]];
+int Evaluate_Lazy(const ChessBoard *board, const int alpha, const int beta) {
+
+	SearchTables *tables = board->tables;
+	int margin = EngineOptions->LazyMargin;
+
+	// the network has no cheap part that bounds it
+	if(margin > 0 && g_nnue->loaded == BOOL_TYPE_FALSE) {
+		int score = Evaluate_Material(board);
+		if(score - margin >= beta || score + margin <= alpha) {
+			tables->lazyExits++;
+			return score;
 		}
-	}	
-	
-	piece = PIECE_TYPE_WHITE_KNIGHT;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_120_TO_64(squareIndex)>=0 && SQUARE_120_TO_64(squareIndex)<=63);
-		score += KnightTable[SQUARE_120_TO_64(squareIndex)];
-	}	
+	}
+	tables->fullEvals++;
+	return EvalCache_Evaluate(board);
+}
 
-	piece = PIECE_TYPE_BLACK_KNIGHT;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))>=0 && SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))<=63);
-		score -= KnightTable[SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))];
-	}			
-	
-	piece = PIECE_TYPE_WHITE_BISHOP;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_120_TO_64(squareIndex)>=0 && SQUARE_120_TO_64(squareIndex)<=63);
-		score += BishopTable[SQUARE_120_TO_64(squareIndex)];
-	}	
+static inline int EvaluatePosition(const ChessBoard *board) {
 
-	piece = PIECE_TYPE_BLACK_BISHOP;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))>=0 && SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))<=63);
-		score -= BishopTable[SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))];
-	}	
+	ASSERT(Board_Check(board));
 
-	piece = PIECE_TYPE_WHITE_ROOK;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_120_TO_64(squareIndex)>=0 && SQUARE_120_TO_64(squareIndex)<=63);
-		score += RookTable[SQUARE_120_TO_64(squareIndex)];
-		
-		ASSERT(FileRankValid(g_filesBoard[squareIndex]));
-		
-		if(!(board->pawns[COLOR_TYPE_BOTH] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score += RookOpenFile;
-		} else if(!(board->pawns[COLOR_TYPE_WHITE] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score += RookSemiOpenFile;
-		}
-	}	
+	if(IsMaterialDraw(board)) {
+		return 0;
+	}
 
-	piece = PIECE_TYPE_BLACK_ROOK;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))>=0 && SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))<=63);
-		score -= RookTable[SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))];
-		ASSERT(FileRankValid(g_filesBoard[squareIndex]));
-		if(!(board->pawns[COLOR_TYPE_BOTH] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score -= RookOpenFile;
-		} else if(!(board->pawns[COLOR_TYPE_BLACK] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score -= RookSemiOpenFile;
-		}
-	}	
-	
-	piece = PIECE_TYPE_WHITE_QUEEN;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_120_TO_64(squareIndex)>=0 && SQUARE_120_TO_64(squareIndex)<=63);
-		ASSERT(FileRankValid(g_filesBoard[squareIndex]));
-		if(!(board->pawns[COLOR_TYPE_BOTH] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score += QueenOpenFile;
-		} else if(!(board->pawns[COLOR_TYPE_WHITE] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score += QueenSemiOpenFile;
-		}
-	}	
+	if(g_nnue->loaded == BOOL_TYPE_TRUE) {
+		return Nnue_Evaluate(board);
+	}
 
-	piece = PIECE_TYPE_BLACK_QUEEN;	
-	for(pieceCount = 0; pieceCount < board->pieceCount[piece]; ++pieceCount) {
-		squareIndex = board->pList[piece][pieceCount];
-		ASSERT(SqOnBoard(squareIndex));
-		ASSERT(SQUARE_120_TO_64(squareIndex)>=0 && SQUARE_120_TO_64(squareIndex)<=63);
-		ASSERT(FileRankValid(g_filesBoard[squareIndex]));
-		if(!(board->pawns[COLOR_TYPE_BOTH] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score -= QueenOpenFile;
-		} else if(!(board->pawns[COLOR_TYPE_BLACK] & g_fileBBMask[g_filesBoard[squareIndex]])) {
-			score -= QueenSemiOpenFile;
+	int score = MaterialScore(board);
+
+	const PawnEntry *pawnEntry = ProbePawnHash(board);
+	score += pawnEntry->score;
+
+	U64 openFiles = FileMask(pawnEntry->openFiles);
+	U64 rooks[2] = { board->pieceBB[PIECE_TYPE_WHITE_ROOK], board->pieceBB[PIECE_TYPE_BLACK_ROOK] };
+	U64 queens[2] = { board->pieceBB[PIECE_TYPE_WHITE_QUEEN], board->pieceBB[PIECE_TYPE_BLACK_QUEEN] };
+	U64 bishops[2] = { board->pieceBB[PIECE_TYPE_WHITE_BISHOP], board->pieceBB[PIECE_TYPE_BLACK_BISHOP] };
+	int terms[2];
+	int color;
+
+	for(color = COLOR_TYPE_WHITE; color <= COLOR_TYPE_BLACK; ++color) {
+		U64 semiOpen = FileMask(pawnEntry->semiOpenFiles[color]) & ~openFiles;
+
+		terms[color] = RookOpenFile * BITBOARD_COUNT(rooks[color] & openFiles)
+			+ RookSemiOpenFile * BITBOARD_COUNT(rooks[color] & semiOpen)
+			+ QueenOpenFile * BITBOARD_COUNT(queens[color] & openFiles)
+			+ QueenSemiOpenFile * BITBOARD_COUNT(queens[color] & semiOpen);
+		// a pair only counts with bishops on both square colours
+		if((bishops[color] & BB_DARK_SQUARES) && (bishops[color] & ~BB_DARK_SQUARES)) {
+			terms[color] += BishopPair;
 		}
-	}	
-	//8/p6k/6p1/5p2/P4K2/8/5pB1/8 b - - 2 62 
-	piece = PIECE_TYPE_WHITE_KING;
-	squareIndex = board->pList[piece][0];
-	ASSERT(SqOnBoard(squareIndex));
-	ASSERT(SQUARE_120_TO_64(squareIndex)>=0 && SQUARE_120_TO_64(squareIndex)<=63);
-	
-	if( (board->material[COLOR_TYPE_BLACK] <= ENDGAME_MAT) ) {
-		score += KingE[SQUARE_120_TO_64(squareIndex)];
-	} else {
-		score += KingO[SQUARE_120_TO_64(squareIndex)];
-	}
-	
-	piece = PIECE_TYPE_BLACK_KING;
-	squareIndex = board->pList[piece][0];
-	ASSERT(SqOnBoard(squareIndex));
-	ASSERT(SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))>=0 && SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))<=63);
-	
-	if( (board->material[COLOR_TYPE_WHITE] <= ENDGAME_MAT) ) {
-		score -= KingE[SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))];
-	} else {
-		score -= KingO[SQUARE_MIRROR_64(SQUARE_120_TO_64(squareIndex))];
 	}
-	
-	if(board->pieceCount[PIECE_TYPE_WHITE_BISHOP] >= 2) score += BishopPair;
-	if(board->pieceCount[PIECE_TYPE_BLACK_BISHOP] >= 2) score -= BishopPair;
+	score += terms[COLOR_TYPE_WHITE] - terms[COLOR_TYPE_BLACK];
 	
 	if(board->side == COLOR_TYPE_WHITE) {
 		return score;
@@ -293,6 +398,14 @@ int Evaluate_Position(const ChessBoard *board) {
 	}	
 }
 
+int Evaluate_Position(const ChessBoard *board) {
+	int score;
+	PROFILE_BEGIN(PROFILE_EVALUATE);
+	score = EvaluatePosition(board);
+	PROFILE_END(PROFILE_EVALUATE);
+	return score;
+}
+
 
 
 
@@ -0,0 +1,429 @@
+/**
+ * @file evaluation_tune.c
+ * @brief Batch evaluation and Texel tuning over labelled position files
+ *
+ * Offline tuning of the classical evaluation weights (g_evalParams):
+ * - Loading: the EPD/FEN file is memory mapped, its lines are split
+ *   among threads, parsed with Board_ParseFromFEN and packed into
+ *   34-byte TunePosition records
+ * - Batch evaluation: threads score slices of the set statically or
+ *   through the quiescence search, each on a private board
+ * - Tuning: the sigmoid scale K is fitted to the data, then every weight
+ *   is moved by +-1 for as long as the mean squared error between the
+ *   results and the predicted scores keeps dropping (Texel's method)
+ *
+ * The tuned terms are printed in the declaration form of
+ * evaluation_static.c, ready to paste back.
+ *
+ * Castling rights and en passant squares are not kept; they do not
+ * affect the static evaluation.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "math.h"
+#include "types_definitions.h"
+#include <pthread.h>
+
+#define TUNE_LINE_MAX 256
+
+typedef struct {
+	const TuneSet *set;
+	const char *text;
+	const long *lineStart;
+	long first;
+	long last;
+	int *scores;
+	double K;
+	int qsearch;
+	double error;
+	pthread_t handle;
+} TuneWorker;
+
+/* --- loading --- */
+
+// game result of a line, White's side in half points, -1 if none
+static int ParseResult(const char *line) {
+
+	const char *bracket = strchr(line, '[');
+
+	if(strstr(line, "1/2-1/2") != NULL) return 1;
+	if(strstr(line, "1-0") != NULL) return 2;
+	if(strstr(line, "0-1") != NULL) return 0;
+	if(bracket != NULL) {
+		double value = atof(bracket + 1);
+		if(value > 0.75) return 2;
+		if(value > 0.25) return 1;
+		return 0;
+	}
+	return -1;
+}
+
+static void PackPosition(const ChessBoard *board, const int result, TunePosition *position) {
+
+	int sq64 = 0;
+
+	memset(position, 0, sizeof(TunePosition));
+	for(sq64 = 0; sq64 < 64; ++sq64) {
+		position->squares[sq64 >> 1] |= (unsigned char)(board->pieces[SQUARE_64_TO_120(sq64)] << ((sq64 & 1) * 4));
+	}
+	position->side = (unsigned char)board->side;
+	position->result = (unsigned char)result;
+}
+
+static void UnpackPosition(const TunePosition *position, ChessBoard *board) {
+
+	int sq64 = 0;
+
+	Board_Reset(board);
+	for(sq64 = 0; sq64 < 64; ++sq64) {
+		board->pieces[SQUARE_64_TO_120(sq64)] = (position->squares[sq64 >> 1] >> ((sq64 & 1) * 4)) & 0xF;
+	}
+	board->side = position->side;
+	board->posKey = Board_GeneratePositionKey(board);
+	Board_UpdateListsMaterial(board);
+	board->pawnKey = Board_GeneratePawnKey(board);
+}
+
+static void *Tune_ParseWorker(void *arg) {
+
+	TuneWorker *worker = (TuneWorker *)arg;
+	TunePosition *positions = worker->set->positions;
+	ChessBoard board[1];
+	char line[TUNE_LINE_MAX];
+	long index = 0;
+
+	Board_Init(board);
+	for(index = worker->first; index < worker->last; ++index) {
+		const char *start = worker->text + worker->lineStart[index];
+		size_t length = (size_t)(worker->lineStart[index + 1] - worker->lineStart[index]);
+		int result = -1;
+
+		if(length >= TUNE_LINE_MAX) length = TUNE_LINE_MAX - 1;
+		memcpy(line, start, length);
+		line[length] = '\0';
+
+		// unusable lines are marked with an impossible result
+		positions[index].result = 0xFF;
+		result = ParseResult(line);
+		if(result < 0 || Board_ParseFromFEN(line, board) != 0) {
+			continue;
+		}
+		if(board->pieceCount[PIECE_TYPE_WHITE_KING] != 1 || board->pieceCount[PIECE_TYPE_BLACK_KING] != 1) {
+			continue;
+		}
+		PackPosition(board, result, &positions[index]);
+	}
+	Board_Free(board);
+	return NULL;
+}
+
+static int ClampThreads(const int threads) {
+	if(threads < 1) return 1;
+	if(threads > CHESS_MAX_THREADS) return CHESS_MAX_THREADS;
+	return threads;
+}
+
+// runs routine over count items split into one slice per thread
+static void RunWorkers(TuneWorker *workers, const int threads, const long count, void *(*routine)(void *)) {
+
+	int index = 0;
+
+	for(index = 0; index < threads; ++index) {
+		workers[index].first = count * index / threads;
+		workers[index].last = count * (index + 1) / threads;
+		if(threads == 1 || pthread_create(&workers[index].handle, NULL, routine, &workers[index]) != 0) {
+			routine(&workers[index]);
+			workers[index].handle = 0;
+		}
+	}
+	for(index = 0; index < threads; ++index) {
+		if(threads > 1 && workers[index].handle != 0) {
+			pthread_join(workers[index].handle, NULL);
+		}
+	}
+}
+
+long Tune_LoadSet(TuneSet *set, const char *path, const int threads) {
+
+	TuneWorker workers[CHESS_MAX_THREADS];
+	int workerCount = ClampThreads(threads);
+	size_t size = 0;
+	const char *text = (const char *) Misc_MapFile(path, &size);
+	long *lineStart = NULL;
+	long lines = 0;
+	long kept = 0;
+	long index = 0;
+	size_t offset = 0;
+
+	set->positions = NULL;
+	set->count = 0;
+	if(text == NULL) {
+		printf("tune: cannot read %s\n", path);
+		return 0;
+	}
+
+	for(offset = 0; offset < size; ++offset) {
+		if(text[offset] == '\n') lines++;
+	}
+	lines++;
+
+	lineStart = (long *) malloc((size_t)(lines + 1) * sizeof(long));
+	set->positions = (TunePosition *) malloc((size_t)lines * sizeof(TunePosition));
+	if(lineStart == NULL || set->positions == NULL) {
+		printf("tune: out of memory for %ld lines\n", lines);
+		free(lineStart);
+		Tune_FreeSet(set);
+		Misc_UnmapFile(text, size);
+		return 0;
+	}
+
+	// lineStart[n + 1] is the end of line n
+	lines = 0;
+	lineStart[0] = 0;
+	for(offset = 0; offset < size; ++offset) {
+		if(text[offset] == '\n') {
+			lineStart[++lines] = (long)offset + 1;
+		}
+	}
+	if(lineStart[lines] < (long)size) {
+		lineStart[++lines] = (long)size;
+	}
+
+	set->count = lines;
+	for(index = 0; index < workerCount; ++index) {
+		memset(&workers[index], 0, sizeof(TuneWorker));
+		workers[index].set = set;
+		workers[index].text = text;
+		workers[index].lineStart = lineStart;
+	}
+	RunWorkers(workers, workerCount, lines, Tune_ParseWorker);
+
+	for(index = 0; index < lines; ++index) {
+		if(set->positions[index].result != 0xFF) {
+			set->positions[kept++] = set->positions[index];
+		}
+	}
+	set->count = kept;
+
+	free(lineStart);
+	Misc_UnmapFile(text, size);
+	return kept;
+}
+
+void Tune_FreeSet(TuneSet *set) {
+	free(set->positions);
+	set->positions = NULL;
+	set->count = 0;
+}
+
+/* --- batch evaluation --- */
+
+static inline int EvaluateWhite(ChessBoard *board, SearchInfo *info, const int qsearch) {
+
+	int score = qsearch ? Search_QuiescenceScore(board, info) : Evaluate_Position(board);
+	return board->side == COLOR_TYPE_WHITE ? score : -score;
+}
+
+static inline double Sigmoid(const double K, const int score) {
+	return 1.0 / (1.0 + pow(10.0, -K * score / 400.0));
+}
+
+// scores a slice; fills scores when given, adds up the squared error
+static void *Tune_EvalWorker(void *arg) {
+
+	TuneWorker *worker = (TuneWorker *)arg;
+	ChessBoard board[1];
+	SearchInfo info[1];
+	long index = 0;
+
+	memset(info, 0, sizeof(SearchInfo));
+	info->threadId = -1;
+	Board_Init(board);
+
+	worker->error = 0.0;
+	for(index = worker->first; index < worker->last; ++index) {
+		const TunePosition *position = &worker->set->positions[index];
+		int score = 0;
+
+		UnpackPosition(position, board);
+		score = EvaluateWhite(board, info, worker->qsearch);
+		if(worker->scores != NULL) {
+			worker->scores[index] = score;
+		} else {
+			double delta = position->result * 0.5 - Sigmoid(worker->K, score);
+			worker->error += delta * delta;
+		}
+	}
+
+	Board_Free(board);
+	return NULL;
+}
+
+static double RunEvaluation(const TuneSet *set, int *scores, const double K, const int threads, const int qsearch) {
+
+	TuneWorker workers[CHESS_MAX_THREADS];
+	int workerCount = ClampThreads(threads);
+	double error = 0.0;
+	int index = 0;
+
+	for(index = 0; index < workerCount; ++index) {
+		memset(&workers[index], 0, sizeof(TuneWorker));
+		workers[index].set = set;
+		workers[index].scores = scores;
+		workers[index].K = K;
+		workers[index].qsearch = qsearch;
+	}
+	RunWorkers(workers, workerCount, set->count, Tune_EvalWorker);
+
+	for(index = 0; index < workerCount; ++index) {
+		error += workers[index].error;
+	}
+	return set->count > 0 ? error / set->count : 0.0;
+}
+
+void Tune_EvaluateBatch(const TuneSet *set, int *scores, const int threads, const int qsearch) {
+	RunEvaluation(set, scores, 0.0, threads, qsearch);
+}
+
+double Tune_Error(const TuneSet *set, const double K, const int threads, const int qsearch) {
+	return RunEvaluation(set, NULL, K, threads, qsearch);
+}
+
+/* --- tuning --- */
+
+static double FitK(const TuneSet *set, const int threads, const int qsearch) {
+
+	double K = 1.0;
+	double step = 0.1;
+	double best = Tune_Error(set, K, threads, qsearch);
+
+	// coordinate descent with shrinking steps
+	while(step > 0.0005) {
+		int moved = BOOL_TYPE_TRUE;
+		while(moved == BOOL_TYPE_TRUE) {
+			double up = Tune_Error(set, K + step, threads, qsearch);
+			double down = K - step > 0.0 ? Tune_Error(set, K - step, threads, qsearch) : best + 1.0;
+			moved = BOOL_TYPE_FALSE;
+			if(up < best) {
+				K += step;
+				best = up;
+				moved = BOOL_TYPE_TRUE;
+			} else if(down < best) {
+				K -= step;
+				best = down;
+				moved = BOOL_TYPE_TRUE;
+			}
+		}
+		step /= 10.0;
+	}
+	return K;
+}
+
+static void PrintParams() {
+
+	int param = 0;
+	int index = 0;
+
+	for(param = 0; param < g_evalParamCount; ++param) {
+		const EvalParam *term = &g_evalParams[param];
+		if(term->count == 1) {
+			printf("int %s = %d;\n", term->name, term->values[0]);
+			continue;
+		}
+		printf("int %s[%d] = {", term->name, term->count);
+		for(index = 0; index < term->count; ++index) {
+			if(term->count > 8 && index % 8 == 0) printf("\n\t");
+			else if(index > 0) printf(" ");
+			printf("%d%s", term->values[index], index + 1 < term->count ? "," : "");
+		}
+		printf("%s};\n", term->count > 8 ? "\n" : " ");
+	}
+}
+
+void Tune_Run(const char *path, const int threads, const int iterations, const int qsearch) {
+
+	TuneSet set[1];
+	EvalCache savedCache = *g_evalCache;
+	int savedNnue = g_nnue->loaded;
+	int savedLazy = EngineOptions->LazyMargin;
+	int start = Misc_GetTimeMs();
+	int iteration = 0;
+	int param = 0;
+	int index = 0;
+
+	if(Tune_LoadSet(set, path, threads) == 0) {
+		printf("tune: no labelled positions in %s\n", path);
+		Tune_FreeSet(set);
+		return;
+	}
+	printf("tune: %ld positions loaded in %d ms\n", set->count, Misc_GetTimeMs() - start);
+
+	// every score must come from the live weights: classical evaluation,
+	// no eval cache and no lazy exits
+	g_evalCache->entries = NULL;
+	g_nnue->loaded = BOOL_TYPE_FALSE;
+	EngineOptions->LazyMargin = 0;
+
+	start = Misc_GetTimeMs();
+	double K = FitK(set, threads, qsearch);
+	double best = Tune_Error(set, K, threads, qsearch);
+	int elapsed = Misc_GetTimeMs() - start;
+	printf("tune: K %.4f error %.6f (%s eval)\n", K, best, qsearch ? "quiescence" : "static");
+
+	start = Misc_GetTimeMs();
+	Tune_Error(set, K, threads, qsearch);
+	elapsed = Misc_GetTimeMs() - start;
+	printf("tune: %ld evaluations/second on %d thread(s)\n",
+		elapsed > 0 ? set->count * 1000 / elapsed : set->count, ClampThreads(threads));
+
+	for(iteration = 1; iteration <= iterations; ++iteration) {
+		int improved = 0;
+
+		for(param = 0; param < g_evalParamCount; ++param) {
+			for(index = 0; index < g_evalParams[param].count; ++index) {
+				int *value = &g_evalParams[param].values[index];
+				double error = 0.0;
+
+				*value += 1;
+				Evaluate_InitPieceSquare();
+				error = Tune_Error(set, K, threads, qsearch);
+				if(error < best) {
+					best = error;
+					improved++;
+					continue;
+				}
+
+				*value -= 2;
+				Evaluate_InitPieceSquare();
+				error = Tune_Error(set, K, threads, qsearch);
+				if(error < best) {
+					best = error;
+					improved++;
+					continue;
+				}
+
+				*value += 1;
+				Evaluate_InitPieceSquare();
+			}
+		}
+
+		printf("tune: iteration %d error %.6f, %d weights changed\n", iteration, best, improved);
+		if(improved == 0) {
+			break;
+		}
+	}
+
+	if(iterations > 0) {
+		PrintParams();
+	}
+
+	*g_evalCache = savedCache;
+	EvalCache_Clear(g_evalCache);
+	g_nnue->loaded = savedNnue;
+	EngineOptions->LazyMargin = savedLazy;
+	Tune_FreeSet(set);
+}
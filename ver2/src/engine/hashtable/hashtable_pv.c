@@ -8,10 +8,31 @@
  * - Implement iterative deepening efficiently
  * - Provide principal variation extraction
  * 
- * Uses Zobrist hashing for position identification.
+ * Uses Zobrist hashing for position identification. The table is an
+ * array of 64-byte buckets of eight packed 64-bit entries; the high half
+ * of the key selects the bucket (multiply-shift, no modulo) and a 16-bit
+ * key fragment identifies the entry inside it. The search prefetches a
+ * child's bucket (HashTable_Prefetch) before making the move.
+ *
+ * Entries are loaded and stored as whole 64-bit words with relaxed
+ * atomics, which is lock-free and compiles to plain moves on 64-bit
+ * targets. Probed moves are checked with Move_IsLegal so a key
+ * fragment collision cannot feed a bogus move to the search.
+ *
+ * The table memory comes from huge pages (MAP_HUGETLB or transparent
+ * huge pages via madvise on Linux, MEM_LARGE_PAGES on Windows) when the
+ * OS allows it, which cuts TLB misses on multi-gigabyte tables, and is
+ * zeroed by several threads in parallel.
+ *
+ * HashTable_Save writes the buckets behind a header page as an image
+ * file; HashTable_Load maps such an image copy-on-write and uses the
+ * mapping as the table, so a warm table of any size is there at once.
+ * HashTable_ExportEntry and HashTable_ImportEntry move single entries
+ * between tables by key, for workers of a distributed analysis.
+ *
  * Implements replacement scheme that considers:
  * - Search depth
- * - Entry age
+ * - Entry age (generation counter bumped every search instead of clearing)
  * - Exact vs bound scores
  * 
  * @author Gambit Chess Team
@@ -19,7 +40,64 @@
  */
 
 #include "stdio.h"
+#include "string.h"
 #include "types_definitions.h"
+#include <pthread.h>
+#ifdef WIN32
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define ENTRY_KEY(e) ((unsigned)((e) & 0xFFFF))
+#define ENTRY_MOVE(e) ((unsigned short)(((e) >> 16) & 0xFFFF))
+#define ENTRY_SCORE(e) ((int)(short)(((e) >> 32) & 0xFFFF))
+#define ENTRY_DEPTH(e) ((int)(((e) >> 48) & 0xFF))
+#define ENTRY_FLAGS(e) ((int)(((e) >> 56) & 0x3))
+#define ENTRY_GENERATION(e) ((int)(((e) >> 58) & HASH_GENERATION_MASK))
+
+#define PACK_ENTRY(key,move,score,depth,flags,generation) \
+	( (U64)((key) & 0xFFFF) \
+	| ((U64)(move) << 16) \
+	| ((U64)((unsigned short)(score)) << 32) \
+	| ((U64)((depth) & 0xFF) << 48) \
+	| ((U64)((flags) & 0x3) << 56) \
+	| ((U64)((generation) & HASH_GENERATION_MASK) << 58) )
+
+#define HASH_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+#define HASH_PARALLEL_CLEAR_SIZE ((size_t)64 * 1024 * 1024)
+
+#define HASH_IMAGE_MAGIC "GAMBITTT"
+#define HASH_IMAGE_VERSION 1 // Entry packing, bucket mapping and Move_Pack format
+#define HASH_IMAGE_BYTE_ORDER 0x0102030405060708ULL
+#define HASH_IMAGE_HEADER_SIZE 4096 // One page, so the mapped buckets are page aligned
+#define HASH_IMAGE_BLOCK_BUCKETS 64 // Buckets filtered and written at a time (one 4 KB page, the usual file system block)
+
+// Header at the start of a savehash image, padded to HASH_IMAGE_HEADER_SIZE
+typedef struct {
+	char magic[8];
+	U64 byteOrder;
+	int version;
+	int bucketSize;
+	U64 keyScheme;
+	U64 numBuckets;
+	int generation;
+	int minDepth;
+	long long entries;
+} HashImageHeader;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ENTRY_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ENTRY_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#else
+#define ENTRY_LOAD(p) (*(volatile HashEntry *)(p))
+#define ENTRY_STORE(p,v) (*(volatile HashEntry *)(p) = (v))
+#endif
+
+HashTable g_hashTable[1];
 
 int HashTable_GetPvLine(const int depth, ChessBoard *board) {
 
@@ -34,7 +112,7 @@ int HashTable_GetPvLine(const int depth, ChessBoard *board) {
 	
 		if( MoveExists(board, move) ) {
 			Move_Make(board, move);
-			board->PvArray[count++] = move;
+			board->tables->PvArray[count++] = move;
 		} else {
 			break;
 		}		
@@ -49,65 +127,247 @@ int HashTable_GetPvLine(const int depth, ChessBoard *board) {
 	
 }
 
+static inline HashBucket *BucketOf(const HashTable *table, const U64 posKey) {
+	return &table->pTable[((posKey >> 32) * (U64)table->numBuckets) >> 32];
+}
+
+void HashTable_Prefetch(const HashTable *table, const U64 posKey) {
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(BucketOf(table, posKey));
+#else
+	(void)table;
+	(void)posKey;
+#endif
+}
+
+// unpack the stored move; a move that is not pseudo-legal here means the
+// fragment matched a different position
+static inline int EntryMoveValid(const ChessBoard *board, const HashEntry entry, int *move) {
+	*move = Move_Unpack(board, ENTRY_MOVE(entry));
+	if(*move != NOMOVE && !Move_IsLegal(board, *move)) {
+		*move = NOMOVE;
+		return BOOL_TYPE_FALSE;
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+typedef struct {
+	char *start;
+	size_t size;
+} ClearSlice;
+
+static void *ClearSliceThread(void *arg) {
+	ClearSlice *slice = (ClearSlice *)arg;
+	memset(slice->start, 0, slice->size);
+	return NULL;
+}
+
 void HashTable_Clear(HashTable *table) {
 
-  HashEntry *tableEntry;
-  
-  for (tableEntry = table->pTable; tableEntry < table->pTable + table->numEntries; tableEntry++) {
-    tableEntry->posKey = 0ULL;
-    tableEntry->move = NOMOVE;
-    tableEntry->depth = 0;
-    tableEntry->score = 0;
-    tableEntry->flags = 0;
-  }
-  table->newWrite=0;
+	size_t tableSize = (size_t)table->numBuckets * sizeof(HashBucket);
+	int threads = EngineOptions->Threads;
+	ClearSlice slices[CHESS_MAX_THREADS];
+	pthread_t handles[CHESS_MAX_THREADS];
+	int started[CHESS_MAX_THREADS];
+	size_t sliceSize = 0;
+	int index = 0;
+
+	if(threads < 1) threads = 1;
+	if(threads > CHESS_MAX_THREADS) threads = CHESS_MAX_THREADS;
+	if(tableSize < HASH_PARALLEL_CLEAR_SIZE) threads = 1;
+
+	// slices are whole buckets so no two threads touch the same cache line
+	sliceSize = (size_t)(table->numBuckets / threads) * sizeof(HashBucket);
+	for(index = 0; index < threads; ++index) {
+		slices[index].start = (char *)table->pTable + index * sliceSize;
+		slices[index].size = (index == threads - 1) ? tableSize - index * sliceSize : sliceSize;
+		started[index] = index > 0 && pthread_create(&handles[index], NULL, ClearSliceThread, &slices[index]) == 0;
+	}
+	for(index = 0; index < threads; ++index) {
+		if(index == 0 || !started[index]) {
+			ClearSliceThread(&slices[index]);
+		}
+	}
+	for(index = 1; index < threads; ++index) {
+		if(started[index]) {
+			pthread_join(handles[index], NULL);
+		}
+	}
+
+	table->generation = 0;
+}
+
+void HashTable_NewSearch(HashTable *table) {
+	table->generation = (table->generation + 1) & HASH_GENERATION_MASK;
+}
+
+int HashTable_Hashfull(const HashTable *table) {
+
+	HashEntry entry;
+	int buckets = table->numBuckets < HASHFULL_SAMPLE_BUCKETS ? table->numBuckets : HASHFULL_SAMPLE_BUCKETS;
+	int bucket = 0;
+	int index = 0;
+	int used = 0;
+
+	for(bucket = 0; bucket < buckets; ++bucket) {
+		for(index = 0; index < HASH_BUCKET_SIZE; ++index) {
+			entry = ENTRY_LOAD(&table->pTable[bucket].entries[index]);
+			if(ENTRY_FLAGS(entry) != HFNONE && ENTRY_GENERATION(entry) == table->generation) {
+				used++;
+			}
+		}
+	}
+	return buckets > 0 ? used * 1000 / (buckets * HASH_BUCKET_SIZE) : 0;
+}
+
+// try huge/large pages first, then plain pages; the result is at least
+// cache-line aligned
+static void *AllocateTable(HashTable *table, const size_t size) {
+
+	void *memory = NULL;
+
+	table->largePages = BOOL_TYPE_FALSE;
+	table->mapped = BOOL_TYPE_FALSE;
+	table->memorySize = size;
+
+#ifdef WIN32
+	SIZE_T largeMinimum = GetLargePageMinimum();
+	HANDLE token;
+	TOKEN_PRIVILEGES privileges;
+
+	if(largeMinimum > 0 && OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+		if(LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)) {
+			privileges.PrivilegeCount = 1;
+			privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+			if(AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL) && GetLastError() == ERROR_SUCCESS) {
+				size_t largeSize = (size + largeMinimum - 1) & ~(size_t)(largeMinimum - 1);
+				memory = VirtualAlloc(NULL, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				if(memory != NULL) {
+					table->largePages = BOOL_TYPE_TRUE;
+					table->memorySize = largeSize;
+				}
+			}
+		}
+		CloseHandle(token);
+	}
+	if(memory == NULL) {
+		memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+#else
+#ifdef MAP_HUGETLB
+	// explicit huge pages only exist if the administrator reserved them
+	if(size >= HASH_HUGE_PAGE_SIZE) {
+		size_t hugeSize = (size + HASH_HUGE_PAGE_SIZE - 1) & ~(size_t)(HASH_HUGE_PAGE_SIZE - 1);
+		memory = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if(memory == MAP_FAILED) {
+			memory = NULL;
+		} else {
+			table->largePages = BOOL_TYPE_TRUE;
+			table->memorySize = hugeSize;
+		}
+	}
+#endif
+	if(memory == NULL) {
+		memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(memory == MAP_FAILED) {
+			memory = NULL;
+		}
+#ifdef MADV_HUGEPAGE
+		// otherwise ask for transparent huge pages
+		else if(size >= HASH_HUGE_PAGE_SIZE) {
+			madvise(memory, size, MADV_HUGEPAGE);
+		}
+#endif
+	}
+#endif
+
+	return memory;
+}
+
+void HashTable_Free(HashTable *table) {
+
+	if(table->pMemory != NULL) {
+#ifdef WIN32
+		if(table->mapped == BOOL_TYPE_TRUE) {
+			UnmapViewOfFile(table->pMemory);
+		} else {
+			VirtualFree(table->pMemory, 0, MEM_RELEASE);
+		}
+#else
+		munmap(table->pMemory, table->memorySize);
+#endif
+	}
+	table->pMemory = NULL;
+	table->pTable = NULL;
+	table->memorySize = 0;
+	table->largePages = BOOL_TYPE_FALSE;
+	table->mapped = BOOL_TYPE_FALSE;
+	table->numBuckets = 0;
 }
 
 void HashTable_Init(HashTable *table, const int MB) {  
 	
-	int HashSize = 0x100000 * MB;
-    table->numEntries = HashSize / sizeof(HashEntry);
-    table->numEntries -= 2;
-	
-	if(table->pTable!=NULL) {
-		free(table->pTable);
-	}
-		
-    table->pTable = (HashEntry *) malloc(table->numEntries * sizeof(HashEntry));
-	if(table->pTable == NULL) {
-		printf("Hash Allocation Failed, trying %dMB...\n",MB/2);
-		HashTable_Init(table,MB/2);
-	} else {
-		HashTable_Clear(table);
-		// Hash table initialized silently
+	int size = MB;
+
+	HashTable_Free(table);
+
+	// page allocations are page aligned, so pTable is cache-line aligned too
+	while(size >= 1) {
+		table->pMemory = AllocateTable(table, (size_t)0x100000 * size);
+		if(table->pMemory != NULL) {
+			break;
+		}
+		printf("Hash Allocation Failed, trying %dMB...\n",size/2);
+		size /= 2;
 	}
-	
+
+	if(table->pMemory == NULL) {
+		printf("Hash Allocation Failed\n");
+		exit(1);
+	}
+
+	table->pTable = (HashBucket *)table->pMemory;
+	table->numBuckets = (int)(((size_t)0x100000 * size) / sizeof(HashBucket));
+	HashTable_Clear(table);
+	// Hash table initialized silently
 }
 
-int HashTable_ProbeEntry(ChessBoard *board, int *move, int *score, int alpha, int beta, int depth) {
+static inline int ProbeEntry(ChessBoard *board, int *move, int *score, int alpha, int beta, int depth) {
 
-	int index = board->posKey % board->HashTable->numEntries;
+	HashBucket *bucket = BucketOf(board->HashTable, board->posKey);
+	unsigned key = ENTRY_KEY(board->posKey);
+	HashEntry entry;
+	int index = 0;
+	int entryMove = NOMOVE;
 	
-	ASSERT(index >= 0 && index <= board->HashTable->numEntries - 1);
     ASSERT(depth>=1&&depth<CHESS_MAX_SEARCH_DEPTH);
     ASSERT(alpha<beta);
     ASSERT(alpha>=-CHESS_INFINITE&&alpha<=CHESS_INFINITE);
     ASSERT(beta>=-CHESS_INFINITE&&beta<=CHESS_INFINITE);
     ASSERT(board->ply>=0&&board->ply<CHESS_MAX_SEARCH_DEPTH);
-	
-	if( board->HashTable->pTable[index].posKey == board->posKey ) {
-		*move = board->HashTable->pTable[index].move;
-		if(board->HashTable->pTable[index].depth >= depth){
-			board->HashTable->hit++;
+
+	board->tables->stats.ttProbes++;
+	for(index = 0; index < HASH_BUCKET_SIZE; ++index) {
+		entry = ENTRY_LOAD(&bucket->entries[index]);
+		if(ENTRY_FLAGS(entry) == HFNONE || ENTRY_KEY(entry) != key) {
+			continue;
+		}
+
+		if(!EntryMoveValid(board, entry, &entryMove)) {
+			break;
+		}
+		*move = entryMove;
+		if(ENTRY_DEPTH(entry) >= depth){
+			board->tables->stats.ttHits++;
 			
-			ASSERT(board->HashTable->pTable[index].depth>=1&&board->HashTable->pTable[index].depth<CHESS_MAX_SEARCH_DEPTH);
-            ASSERT(board->HashTable->pTable[index].flags>=HFALPHA&&board->HashTable->pTable[index].flags<=HFEXACT);
+			ASSERT(ENTRY_DEPTH(entry)>=1&&ENTRY_DEPTH(entry)<CHESS_MAX_SEARCH_DEPTH);
+            ASSERT(ENTRY_FLAGS(entry)>=HFALPHA&&ENTRY_FLAGS(entry)<=HFEXACT);
 			
-			*score = board->HashTable->pTable[index].score;
+			*score = ENTRY_SCORE(entry);
 			if(*score > CHESS_IS_MATE) *score -= board->ply;
             else if(*score < -CHESS_IS_MATE) *score += board->ply;
 			
-			switch(board->HashTable->pTable[index].flags) {
+			switch(ENTRY_FLAGS(entry)) {
 				
                 ASSERT(*score>=-CHESS_INFINITE&&*score<=CHESS_INFINITE);
 
@@ -127,61 +387,364 @@ int HashTable_ProbeEntry(ChessBoard *board, int *move, int *score, int alpha, in
                 default: ASSERT(BOOL_TYPE_FALSE); break;
             }
 		}
+		break;
 	}
 	
 	return BOOL_TYPE_FALSE;
 }
 
+int HashTable_ProbeEntry(ChessBoard *board, int *move, int *score, int alpha, int beta, int depth) {
+	int found;
+	PROFILE_BEGIN(PROFILE_PROBE_HASH);
+	found = ProbeEntry(board, move, score, alpha, beta, depth);
+	PROFILE_END(PROFILE_PROBE_HASH);
+	return found;
+}
+
 void HashTable_StoreEntry(ChessBoard *board, const int move, int score, const int flags, const int depth) {
 
-	int index = board->posKey % board->HashTable->numEntries;
+	HashTable *table = board->HashTable;
+	HashBucket *bucket = BucketOf(table, board->posKey);
+	unsigned key = ENTRY_KEY(board->posKey);
+	PackedMove packedMove = Move_Pack(move);
+	HashEntry entry;
+	int index = 0;
+	int replace = 0;
+	int replaceValue = 0;
+	int value = 0;
 	
-	ASSERT(index >= 0 && index <= board->HashTable->numEntries - 1);
 	ASSERT(depth>=1&&depth<CHESS_MAX_SEARCH_DEPTH);
     ASSERT(flags>=HFALPHA&&flags<=HFEXACT);
     ASSERT(score>=-CHESS_INFINITE&&score<=CHESS_INFINITE);
     ASSERT(board->ply>=0&&board->ply<CHESS_MAX_SEARCH_DEPTH);
-	
-	if( board->HashTable->pTable[index].posKey == 0) {
-		board->HashTable->newWrite++;
+
+	// pick the slot: same position first, then an empty slot, otherwise
+	// the entry with the lowest depth once its age has been discounted
+	replaceValue = CHESS_INFINITE;
+	for(index = 0; index < HASH_BUCKET_SIZE; ++index) {
+		entry = ENTRY_LOAD(&bucket->entries[index]);
+		if(ENTRY_FLAGS(entry) == HFNONE) {
+			replace = index;
+			break;
+		}
+		if(ENTRY_KEY(entry) == key) {
+			// keep a deeper bound from this search unless the new result is
+			// exact, but still refresh its move
+			if(flags != HFEXACT && depth + 3 < ENTRY_DEPTH(entry) && ENTRY_GENERATION(entry) == table->generation) {
+				if(packedMove != 0) {
+					ENTRY_STORE(&bucket->entries[index], (entry & ~((U64)0xFFFF << 16)) | ((U64)packedMove << 16));
+				}
+				return;
+			}
+			if(packedMove == 0) {
+				packedMove = ENTRY_MOVE(entry);
+			}
+			replace = index;
+			break;
+		}
+		value = ENTRY_DEPTH(entry) - 8 * ((table->generation - ENTRY_GENERATION(entry)) & HASH_GENERATION_MASK);
+		if(value < replaceValue) {
+			replaceValue = value;
+			replace = index;
+		}
+	}
+
+	if(ENTRY_FLAGS(ENTRY_LOAD(&bucket->entries[replace])) == HFNONE) {
+		board->tables->stats.ttNewWrites++;
 	} else {
-		board->HashTable->overWrite++;
+		board->tables->stats.ttOverWrites++;
 	}
 	
 	if(score > CHESS_IS_MATE) score += board->ply;
     else if(score < -CHESS_IS_MATE) score -= board->ply;
 	
-	board->HashTable->pTable[index].move = move;
-    board->HashTable->pTable[index].posKey = board->posKey;
-	board->HashTable->pTable[index].flags = flags;
-	board->HashTable->pTable[index].score = score;
-	board->HashTable->pTable[index].depth = depth;
+	ENTRY_STORE(&bucket->entries[replace], PACK_ENTRY(key, packedMove, score, depth, flags, table->generation));
 }
 
 int HashTable_ProbePvMove(const ChessBoard *board) {
 
-	int index = board->posKey % board->HashTable->numEntries;
-	ASSERT(index >= 0 && index <= board->HashTable->numEntries - 1);
+	HashBucket *bucket = BucketOf(board->HashTable, board->posKey);
+	unsigned key = ENTRY_KEY(board->posKey);
+	HashEntry entry;
+	int index = 0;
+	int move = NOMOVE;
 	
-	if( board->HashTable->pTable[index].posKey == board->posKey ) {
-		return board->HashTable->pTable[index].move;
+	for(index = 0; index < HASH_BUCKET_SIZE; ++index) {
+		entry = ENTRY_LOAD(&bucket->entries[index]);
+		if(ENTRY_FLAGS(entry) != HFNONE && ENTRY_KEY(entry) == key) {
+			EntryMoveValid(board, entry, &move);
+			return move;
+		}
 	}
 	
 	return NOMOVE;
 }
 
+int HashTable_ExportEntry(const HashTable *table, const U64 posKey, PackedMove *move, int *score, int *depth,
+	int *flags) {
+
+	HashBucket *bucket = BucketOf(table, posKey);
+	unsigned key = ENTRY_KEY(posKey);
+	HashEntry entry;
+	int index = 0;
+
+	for(index = 0; index < HASH_BUCKET_SIZE; ++index) {
+		entry = ENTRY_LOAD(&bucket->entries[index]);
+		if(ENTRY_FLAGS(entry) != HFNONE && ENTRY_KEY(entry) == key) {
+			*move = ENTRY_MOVE(entry);
+			*score = ENTRY_SCORE(entry);
+			*depth = ENTRY_DEPTH(entry);
+			*flags = ENTRY_FLAGS(entry);
+			return BOOL_TYPE_TRUE;
+		}
+	}
+	return BOOL_TYPE_FALSE;
+}
+
+void HashTable_ImportEntry(HashTable *table, const U64 posKey, const PackedMove move, const int score,
+	const int depth, const int flags) {
+
+	HashBucket *bucket = BucketOf(table, posKey);
+	unsigned key = ENTRY_KEY(posKey);
+	HashEntry entry;
+	int index = 0;
+	int replace = -1;
+	int replaceValue = depth;
+	int value = 0;
+
+	if(depth < 1 || depth >= CHESS_MAX_SEARCH_DEPTH || flags < HFALPHA || flags > HFEXACT
+		|| score < -CHESS_INFINITE || score > CHESS_INFINITE) {
+		return;
+	}
+
+	// as HashTable_StoreEntry, but a slot is only taken from an entry
+	// worth less than the imported one
+	for(index = 0; index < HASH_BUCKET_SIZE; ++index) {
+		entry = ENTRY_LOAD(&bucket->entries[index]);
+		if(ENTRY_FLAGS(entry) == HFNONE) {
+			replace = index;
+			break;
+		}
+		if(ENTRY_KEY(entry) == key) {
+			replace = ENTRY_DEPTH(entry) < depth ? index : -1;
+			break;
+		}
+		value = ENTRY_DEPTH(entry) - 8 * ((table->generation - ENTRY_GENERATION(entry)) & HASH_GENERATION_MASK);
+		if(value < replaceValue) {
+			replaceValue = value;
+			replace = index;
+		}
+	}
+
+	if(replace >= 0) {
+		ENTRY_STORE(&bucket->entries[replace], PACK_ENTRY(key, move, score, depth, flags, table->generation));
+	}
+}
+
+// fingerprint of the Zobrist keys: an image is only valid for the keys
+// its positions were hashed with
+static U64 KeyScheme() {
+
+	U64 fingerprint = g_sideKey;
+	int piece = 0;
+	int square = 0;
+
+	for(piece = 0; piece < 13; ++piece) {
+		for(square = 0; square < CHESS_BOARD_SQUARE_NUM; ++square) {
+			fingerprint = ((fingerprint << 7) | (fingerprint >> 57)) ^ g_pieceKeys[piece][square];
+		}
+	}
+	for(square = 0; square < 16; ++square) {
+		fingerprint = ((fingerprint << 7) | (fingerprint >> 57)) ^ g_castleKeys[square];
+	}
+	return fingerprint;
+}
+
+static int SkipBytes(FILE *file, const size_t bytes) {
+#ifdef WIN32
+	return _fseeki64(file, (__int64)bytes, SEEK_CUR);
+#else
+	return fseeko(file, (off_t)bytes, SEEK_CUR);
+#endif
+}
+
+long long HashTable_Save(const HashTable *table, const char *path, const int minDepth) {
+
+	static HashBucket block[HASH_IMAGE_BLOCK_BUCKETS];
+	char page[HASH_IMAGE_HEADER_SIZE];
+	HashImageHeader header;
+	HashEntry entry;
+	FILE *file = fopen(path, "wb");
+	long long saved = 0;
+	int first = 0;
+	int count = 0;
+	int bucket = 0;
+	int index = 0;
+	int kept = 0;
+	int blockEntries = 0;
+	int ok = BOOL_TYPE_TRUE;
+
+	if(file == NULL) {
+		return -1;
+	}
 
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, HASH_IMAGE_MAGIC, sizeof(header.magic));
+	header.byteOrder = HASH_IMAGE_BYTE_ORDER;
+	header.version = HASH_IMAGE_VERSION;
+	header.bucketSize = (int)sizeof(HashBucket);
+	header.keyScheme = KeyScheme();
+	header.numBuckets = (U64)table->numBuckets;
+	header.generation = table->generation;
+	header.minDepth = minDepth;
 
+	// the header is written again with the entry count at the end
+	memset(page, 0, sizeof(page));
+	ok = fwrite(page, sizeof(page), 1, file) == 1;
 
+	for(first = 0; ok && first < table->numBuckets; first += count) {
+		count = table->numBuckets - first < HASH_IMAGE_BLOCK_BUCKETS ? table->numBuckets - first : HASH_IMAGE_BLOCK_BUCKETS;
+		blockEntries = 0;
+		for(bucket = 0; bucket < count; ++bucket) {
+			// kept entries move to the front of their bucket, where a
+			// store looks for an empty slot first
+			kept = 0;
+			for(index = 0; index < HASH_BUCKET_SIZE; ++index) {
+				entry = ENTRY_LOAD(&table->pTable[first + bucket].entries[index]);
+				if(ENTRY_FLAGS(entry) != HFNONE && (ENTRY_DEPTH(entry) >= minDepth || ENTRY_FLAGS(entry) == HFEXACT)) {
+					block[bucket].entries[kept++] = entry;
+				}
+			}
+			for(index = kept; index < HASH_BUCKET_SIZE; ++index) {
+				block[bucket].entries[index] = 0;
+			}
+			blockEntries += kept;
+		}
+		saved += blockEntries;
+
+		// an empty block becomes a hole, except the last, which gives the
+		// file its length
+		if(blockEntries == 0 && first + count < table->numBuckets) {
+			ok = SkipBytes(file, (size_t)count * sizeof(HashBucket)) == 0;
+		} else {
+			ok = fwrite(block, sizeof(HashBucket), (size_t)count, file) == (size_t)count;
+		}
+	}
+
+	header.entries = saved;
+	memcpy(page, &header, sizeof(header));
+	if(ok) {
+		ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(page, sizeof(page), 1, file) == 1;
+	}
+	if(fclose(file) != 0) {
+		ok = BOOL_TYPE_FALSE;
+	}
+	return ok ? saved : -1;
+}
 
+// map a whole file readable and writable; writes go to private copies of
+// the pages, never to the file
+static void *MapImage(const char *path, size_t *size) {
 
+	void *memory = NULL;
 
+	*size = 0;
+#ifdef WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	HANDLE mapping = NULL;
+	LARGE_INTEGER length;
 
+	if(file == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+	if(GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if(mapping != NULL) {
+			memory = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(mapping);
+			if(memory != NULL) {
+				*size = (size_t)length.QuadPart;
+			}
+		}
+	}
+	CloseHandle(file);
+#else
+	struct stat status;
+	int file = open(path, O_RDONLY);
 
+	if(file < 0) {
+		return NULL;
+	}
+	if(fstat(file, &status) == 0 && status.st_size > 0) {
+		memory = mmap(NULL, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		if(memory == MAP_FAILED) {
+			memory = NULL;
+		} else {
+			*size = (size_t)status.st_size;
+#ifdef MADV_WILLNEED
+			// start reading the pages in the background
+			madvise(memory, *size, MADV_WILLNEED);
+#endif
+		}
+	}
+	close(file);
+#endif
+	return memory;
+}
 
+static void UnmapImage(void *memory, const size_t size) {
+#ifdef WIN32
+	(void)size;
+	UnmapViewOfFile(memory);
+#else
+	munmap(memory, size);
+#endif
+}
 
+int HashTable_Load(HashTable *table, const char *path) {
 
+	HashImageHeader header;
+	FILE *file = fopen(path, "rb");
+	void *memory = NULL;
+	size_t size = 0;
+	int ok = BOOL_TYPE_FALSE;
 
+	if(file == NULL) {
+		printf("Hash image %s not found\n", path);
+		return BOOL_TYPE_FALSE;
+	}
+	ok = fread(&header, sizeof(header), 1, file) == 1;
+	fclose(file);
 
+	if(!ok || memcmp(header.magic, HASH_IMAGE_MAGIC, sizeof(header.magic)) != 0
+		|| header.byteOrder != HASH_IMAGE_BYTE_ORDER || header.bucketSize != (int)sizeof(HashBucket)) {
+		printf("Invalid hash image %s\n", path);
+		return BOOL_TYPE_FALSE;
+	}
+	if(header.version != HASH_IMAGE_VERSION || header.keyScheme != KeyScheme()) {
+		printf("Hash image %s was written by an incompatible version\n", path);
+		return BOOL_TYPE_FALSE;
+	}
+	if(header.numBuckets < 1 || header.numBuckets > ((U64)CHESS_MAX_HASH << 20) / sizeof(HashBucket)) {
+		printf("Invalid hash image %s\n", path);
+		return BOOL_TYPE_FALSE;
+	}
 
+	memory = MapImage(path, &size);
+	if(memory == NULL || size != HASH_IMAGE_HEADER_SIZE + header.numBuckets * sizeof(HashBucket)) {
+		printf("Invalid hash image %s\n", path);
+		if(memory != NULL) {
+			UnmapImage(memory, size);
+		}
+		return BOOL_TYPE_FALSE;
+	}
 
+	HashTable_Free(table);
+	table->pMemory = memory;
+	table->memorySize = size;
+	table->mapped = BOOL_TYPE_TRUE;
+	table->pTable = (HashBucket *)((char *)memory + HASH_IMAGE_HEADER_SIZE);
+	table->numBuckets = (int)header.numBuckets;
+	table->generation = header.generation & HASH_GENERATION_MASK;
+	return BOOL_TYPE_TRUE;
+}
@@ -6,15 +6,21 @@
  * - Iterative deepening
  * - Principal Variation Search (PVS)
  * - Null move pruning
- * - Quiescence search (for tactical stability)
+ * - Late move reductions, futility and reverse futility pruning
+ * - Quiescence search (for tactical stability, SEE and delta pruning)
  * - Transposition table integration
- * - Move ordering (hash move, MVV-LVA, killer moves, history heuristic)
+ * - Staged move ordering (hash move, MVV-LVA, killer moves, history heuristic)
  * - Time management
  * - Aspiration windows
+ * - Lazy SMP (helper threads sharing the transposition table)
  * 
  * The search is the core of the chess engine's decision-making process,
  * evaluating positions to find the best move.
  * 
+ * Every node takes its move picker and killers from the thread's search
+ * stack (board->tables->stack[board->ply]), allocated once with the
+ * board, so a recursion frame holds only a few scalars.
+ * 
  * @author Gambit Chess Team
  * @date February 2026
  */
@@ -22,48 +28,193 @@
 // search.c
 
 #include "stdio.h"
+#include "math.h"
+#include "string.h"
+#include "limits.h"
 #include "types_definitions.h"
+#include <pthread.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STOP_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STOP_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define NODES_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define NODES_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#else
+#define STOP_LOAD(p) (*(volatile int *)(p))
+#define STOP_STORE(p,v) (*(volatile int *)(p) = (v))
+#define NODES_LOAD(p) (*(volatile long *)(p))
+#define NODES_STORE(p,v) (*(volatile long *)(p) = (v))
+#endif
 
 
 int rootDepth;
 
-static void CheckUp(SearchInfo *info) {
-	// .. check if time up, or interrupt from GUI
-	if(info->timeset == BOOL_TYPE_TRUE && Misc_GetTimeMs() > info->stoptime) {
-		info->stopped = BOOL_TYPE_TRUE;
+// root move the main thread is searching, for the XBoard analysis status
+static int rootMove = NOMOVE;
+static int rootMoveNumber = 0;
+static int rootMoveTotal = 0;
+
+#define QS_DELTA_MARGIN 200 // Positional slack allowed on top of the captured material
+
+#define RFP_MAX_DEPTH 6       // Reverse futility only close to the horizon
+#define RFP_MARGIN 100        // Per-ply margin the static eval must beat beta by
+#define FUTILITY_MAX_DEPTH 3  // Futility pruning at frontier and pre-frontier nodes
+#define LMR_MIN_DEPTH 3       // No reductions below this depth
+#define LMR_MIN_MOVES 4       // Moves searched at full depth before reducing
+
+#define ASPIRATION_MIN_DEPTH 5    // Shallower iterations use the full window
+#define ASPIRATION_WINDOW 25      // Initial half-width around the previous score
+#define ASPIRATION_MAX_WINDOW 800 // Beyond this the failing side is opened fully
+
+#define NODE_BUDGET_CHECK 128 // Most nodes between budget checks while helpers share go nodes
+
+static const int FutilityMargin[FUTILITY_MAX_DEPTH + 1] = { 0, 200, 325, 550 };
+
+static int Reductions[CHESS_MAX_SEARCH_DEPTH][CHESS_MAX_POSITION_MOVES];
+
+void Search_InitReductions() {
+
+	int depth = 0;
+	int moveNum = 0;
+
+	for(depth = 0; depth < CHESS_MAX_SEARCH_DEPTH; ++depth) {
+		for(moveNum = 0; moveNum < CHESS_MAX_POSITION_MOVES; ++moveNum) {
+			Reductions[depth][moveNum] = (depth && moveNum) ? (int)(0.75 + log(depth) * log(moveNum) / 2.25) : 0;
+		}
 	}
+}
 
-	Misc_ReadInput(info);
+/**
+ * Lazy SMP helper thread. Each helper owns a board with its own search
+ * tables (killers, history, PV array), a Board_Copy of the root position
+ * and its own SearchInfo; only the transposition table is shared through
+ * board->HashTable. It searches with the main thread's options.
+ */
+typedef struct {
+	ChessBoard board[1];
+	SearchInfo info[1];
+	S_OPTIONS *options;
+	pthread_t handle;
+} SearchHelper;
+
+static SearchHelper *helpers = NULL;
+static int helperCapacity = 0;
+static int activeHelpers = 0;
+static volatile int helpersStop = BOOL_TYPE_FALSE;
+
+// go nodes with helpers: each thread publishes its count at every check
+static long budgetCounts[CHESS_MAX_THREADS];
+static int budgetThreads = 0;
+
+static long Search_TotalNodes(const SearchInfo *info);
+
+// answers the XBoard "." command: stat01: time nodes ply movesleft total move
+static void PrintStatus(const SearchInfo *info, const int now) {
+
+	printf("stat01: %d %ld %d %d %d %s\n", (now - info->starttime) / 10, Search_TotalNodes(info),
+		rootDepth, rootMoveTotal - rootMoveNumber, rootMoveTotal,
+		rootMove != NOMOVE ? PrMove(rootMove) : "(none)");
 }
 
-static void PickNextMove(int moveNum, MoveList *list) {
+// go nodes: true once the budget is spent. Alone a thread checks again
+// exactly when it would be; with helpers the counts are only as fresh as
+// each thread's last check, so the checks come every NODE_BUDGET_CHECK
+// nodes at most and the threads together overshoot by about that much
+// per thread
+static int NodeBudgetSpent(SearchInfo *info) {
 
-	Move temp;
+	long total = info->nodes;
+	long share = 0;
+	int threads = 1;
 	int index = 0;
-	int bestScore = 0;
-	int bestNum = moveNum;
 
-	for (index = moveNum; index < list->count; ++index) {
-		if (list->moves[index].score > bestScore) {
-			bestScore = list->moves[index].score;
-			bestNum = index;
+	if(info->nodeCounts != NULL) {
+		NODES_STORE(&info->nodeCounts[info->threadId], info->nodes);
+		threads = budgetThreads;
+		total = 0;
+		for(index = 0; index < threads; ++index) {
+			total += NODES_LOAD(&info->nodeCounts[index]);
+		}
+	}
+
+	if(total >= info->nodeLimit) {
+		return BOOL_TYPE_TRUE;
+	}
+	share = (info->nodeLimit - total + threads - 1) / threads;
+	if(threads > 1 && share > NODE_BUDGET_CHECK) {
+		share = NODE_BUDGET_CHECK;
+	}
+	if(info->nextCheck > info->nodes + share) {
+		info->nextCheck = info->nodes + share;
+	}
+	return BOOL_TYPE_FALSE;
+}
+
+static void CheckUp(SearchInfo *info) {
+
+	int now = 0;
+
+	// offline evaluation never stops
+	if(info->threadId < 0) {
+		info->nextCheck = LONG_MAX;
+		return;
+	}
+
+	// helpers never touch the clock or stdin, they follow the main thread
+	if(info->threadId != 0) {
+		info->nextCheck = info->nodes + Time_CheckInterval(info, 0);
+		if(helpersStop == BOOL_TYPE_TRUE) {
+			info->stopped = BOOL_TYPE_TRUE;
 		}
+		if(info->nodeCounts != NULL && NodeBudgetSpent(info)) {
+			info->stopped = BOOL_TYPE_TRUE;
+		}
+		return;
 	}
 
-	ASSERT(moveNum>=0 && moveNum<list->count);
-	ASSERT(bestNum>=0 && bestNum<list->count);
-	ASSERT(bestNum>=moveNum);
+	now = Misc_GetTimeMs();
+	info->nextCheck = info->nodes + Time_CheckInterval(info, now);
+
+	// go nodes: the budget covers every search thread, not only this one
+	if(info->nodeLimit > 0 && NodeBudgetSpent(info)) {
+		info->stopped = BOOL_TYPE_TRUE;
+	}
 
-	temp = list->moves[moveNum];
-	list->moves[moveNum] = list->moves[bestNum];
-	list->moves[bestNum] = temp;
+	// .. check if the hard limit passed, or interrupt from GUI; a ponder
+	// search has no clock until ponderhit
+	if(info->timeset == BOOL_TYPE_TRUE && !STOP_LOAD(&info->ponder) && now > info->stoptime) {
+		info->stopped = BOOL_TYPE_TRUE;
+	}
+
+	// an input thread owns stdin and only raises the stop flag
+	if(info->asyncInput == BOOL_TYPE_TRUE) {
+		if(STOP_LOAD(&info->stopRequest)) {
+			info->stopped = BOOL_TYPE_TRUE;
+		}
+		if(STOP_LOAD(&info->statusRequest)) {
+			STOP_STORE(&info->statusRequest, BOOL_TYPE_FALSE);
+			PrintStatus(info, now);
+		}
+		return;
+	}
+
+	Misc_ReadInput(info);
 }
 
+// a repeated position has the same side to move and lies at least four
+// plies back, after the last irreversible move; most nodes are rejected by
+// the filter before any history entry is read
 static int IsRepetition(const ChessBoard *board) {
 
 	int index = 0;
+	int stop = board->hisPly - board->fiftyMove;
+
+	if(board->fiftyMove < 4 || board->repetitionFilter[REPETITION_INDEX(board->posKey)] == 0) {
+		return BOOL_TYPE_FALSE;
+	}
 
-	for(index = board->hisPly - board->fiftyMove; index < board->hisPly-1; ++index) {
+	if(stop < 0) stop = 0;
+	for(index = board->hisPly - 4; index >= stop; index -= 2) {
 		ASSERT(index >= 0 && index < CHESS_MAX_GAME_MOVES);
 		if(board->posKey == board->history[index].posKey) {
 			return BOOL_TYPE_TRUE;
@@ -72,53 +223,102 @@ static int IsRepetition(const ChessBoard *board) {
 	return BOOL_TYPE_FALSE;
 }
 
+static int IsRootMove(const SearchInfo *info, const int move) {
+
+	int index = 0;
+
+	for(index = 0; index < info->rootMoveCount; ++index) {
+		if(info->rootMoves[index] == move) {
+			return BOOL_TYPE_TRUE;
+		}
+	}
+	return BOOL_TYPE_FALSE;
+}
+
+// GUIs show the root move being searched once an iteration takes a while
+static void ReportCurrMove(const SearchInfo *info, const int move, const int number) {
+
+	if(Misc_GetTimeMs() - info->starttime >= CURRMOVE_REPORT_MS) {
+		printf("info depth %d currmove %s currmovenumber %d\n", rootDepth, PrMove(move), number);
+	}
+}
+
+// UCI score field: moves to mate rather than the raw mate score
+static const char *UciScore(const int score) {
+
+	static char text[32];
+
+	if(score > CHESS_IS_MATE) {
+		sprintf(text, "mate %d", (CHESS_INFINITE - score + 1) / 2);
+	} else if(score < -CHESS_IS_MATE) {
+		sprintf(text, "mate -%d", (CHESS_INFINITE + score) / 2);
+	} else {
+		sprintf(text, "cp %d", score);
+	}
+	return text;
+}
+
 static void Search_ClearFor(ChessBoard *board, SearchInfo *info) {
 
 	int index = 0;
 	int index2 = 0;
 
 	for(index = 0; index < 13; ++index) {
-		for(index2 = 0; index2 < CHESS_BOARD_SQUARE_NUM; ++index2) {
-			board->searchHistory[index][index2] = 0;
+		for(index2 = 0; index2 < 64; ++index2) {
+			board->tables->searchHistory[index][index2] = 0;
 		}
 	}
 
-	for(index = 0; index < 2; ++index) {
-		for(index2 = 0; index2 < CHESS_MAX_SEARCH_DEPTH; ++index2) {
-			board->searchKillers[index][index2] = 0;
-		}
+	for(index = 0; index < CHESS_MAX_SEARCH_DEPTH; ++index) {
+		board->tables->stack[index].killers[0] = 0;
+		board->tables->stack[index].killers[1] = 0;
 	}
 
-	board->HashTable->overWrite=0;
-	board->HashTable->hit=0;
-	board->HashTable->cut=0;
+	Stats_Clear(&board->tables->stats);
+	board->tables->pawnHash.probes = 0;
+	board->tables->pawnHash.hits = 0;
+	board->tables->lazyExits = 0;
+	board->tables->fullEvals = 0;
 	board->ply = 0;
+	Nnue_Refresh(board);
 
 	info->stopped = 0;
 	info->nodes = 0;
-	info->fh = 0;
-	info->fhf = 0;
+	info->nextCheck = 0;
+	info->nodeCounts = NULL;
+	info->seldepth = 0;
+	info->tbhits = 0;
 }
 
-static int Quiescence(int alpha, int beta, ChessBoard *board, SearchInfo *info) {
+static inline int Quiescence(int alpha, int beta, ChessBoard *board, SearchInfo *info);
+
+static int QuiescenceNode(int alpha, int beta, ChessBoard *board, SearchInfo *info) {
 
 	ASSERT(Board_Check(board));
 	ASSERT(beta>alpha);
-	if(( info->nodes & 2047 ) == 0) {
+#ifdef DEBUG
+	int OldAlpha = alpha;
+#endif
+	if(info->nodes >= info->nextCheck) {
 		CheckUp(info);
 	}
 
 	info->nodes++;
+	board->tables->stats.qNodes++;
+	if(board->ply > info->seldepth) {
+		info->seldepth = board->ply;
+	}
 
 	if(IsRepetition(board) || board->fiftyMove >= 100) {
 		return 0;
 	}
 
 	if(board->ply > CHESS_MAX_SEARCH_DEPTH - 1) {
-		return Evaluate_Position(board);
+		return EvalCache_Evaluate(board);
 	}
 
-	int Score = Evaluate_Position(board);
+	int StandPat = Evaluate_Lazy(board, alpha, beta);
+	int Score = StandPat;
 
 	ASSERT(Score>-CHESS_INFINITE && Score<CHESS_INFINITE);
 
@@ -130,20 +330,25 @@ static int Quiescence(int alpha, int beta, ChessBoard *board, SearchInfo *info)
 		alpha = Score;
 	}
 
-	MoveList list[1];
-    GenerateAllCaps(board,list);
+	MovePicker *picker = &board->tables->stack[board->ply].picker;
+	MovePicker_Init(picker, board, NOMOVE, BOOL_TYPE_TRUE);
 
-    int MoveNum = 0;
+	int Move = NOMOVE;
 	int Legal = 0;
 	Score = -CHESS_INFINITE;
 
-	for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {
+	while((Move = MovePicker_Next(picker, board)) != NOMOVE) {
+
+		// delta pruning: even winning the victim for free stays below alpha
+		if(MOVE_GET_PROMOTED(Move) == EMPTY &&
+		   StandPat + g_pieceVal[(Move & MFLAGEP) ? PIECE_TYPE_WHITE_PAWN : MOVE_GET_CAPTURED(Move)] + QS_DELTA_MARGIN <= alpha) {
+			continue;
+		}
 
-		PickNextMove(MoveNum, list);
+		// the child stands pat first, start loading its eval slot
+		EvalCache_Prefetch(Move_ChildKey(board, Move));
 
-        if ( !Move_Make(board,list->moves[MoveNum].move))  {
-            continue;
-        }
+        Move_MakeLegal(board,Move);
 
 		Legal++;
 		Score = -Quiescence( -beta, -alpha, board, info);
@@ -156,9 +361,9 @@ static int Quiescence(int alpha, int beta, ChessBoard *board, SearchInfo *info)
 		if(Score > alpha) {
 			if(Score >= beta) {
 				if(Legal==1) {
-					info->fhf++;
+					board->tables->stats.failHighFirst++;
 				}
-				info->fh++;
+				board->tables->stats.failHighs++;
 				return beta;
 			}
 			alpha = Score;
@@ -170,6 +375,24 @@ static int Quiescence(int alpha, int beta, ChessBoard *board, SearchInfo *info)
 	return alpha;
 }
 
+// the profiler times the whole quiescence tree below each entry once
+static inline int Quiescence(int alpha, int beta, ChessBoard *board, SearchInfo *info) {
+	int score;
+	PROFILE_BEGIN(PROFILE_QUIESCENCE);
+	score = QuiescenceNode(alpha, beta, board, info);
+	PROFILE_END(PROFILE_QUIESCENCE);
+	return score;
+}
+
+int Search_QuiescenceScore(ChessBoard *board, SearchInfo *info) {
+
+	ASSERT(info->threadId < 0);
+
+	board->ply = 0;
+	info->stopped = BOOL_TYPE_FALSE;
+	return Quiescence(-CHESS_INFINITE, CHESS_INFINITE, board, info);
+}
+
 static int AlphaBeta(int alpha, int beta, int depth, ChessBoard *board, SearchInfo *info, int DoNull) {
 
 	ASSERT(Board_Check(board));
@@ -181,18 +404,21 @@ static int AlphaBeta(int alpha, int beta, int depth, ChessBoard *board, SearchIn
 		// return Evaluate_Position(board);
 	}
 
-	if(( info->nodes & 2047 ) == 0) {
+	if(info->nodes >= info->nextCheck) {
 		CheckUp(info);
 	}
 
 	info->nodes++;
+	if(board->ply > info->seldepth) {
+		info->seldepth = board->ply;
+	}
 
 	if((IsRepetition(board) || board->fiftyMove >= 100) && board->ply) {
 		return 0;
 	}
 
 	if(board->ply > CHESS_MAX_SEARCH_DEPTH - 1) {
-		return Evaluate_Position(board);
+		return EvalCache_Evaluate(board);
 	}
 
 	int InCheck = Attack_IsSquareAttacked(board->KingSq[board->side],board->side^1,board);
@@ -203,13 +429,63 @@ static int AlphaBeta(int alpha, int beta, int depth, ChessBoard *board, SearchIn
 
 	int Score = -CHESS_INFINITE;
 	int PvMove = NOMOVE;
-
-	if( HashTable_ProbeEntry(board, &PvMove, &Score, alpha, beta, depth) == BOOL_TYPE_TRUE ) {
-		board->HashTable->cut++;
+	int PvNode = beta - alpha > 1;
+	int StaticEval = 0;
+	int Futile = BOOL_TYPE_FALSE;
+
+	// the root is always searched, so every iteration reports a real
+	// score, PV and node count; its entry only orders the moves
+	if( HashTable_ProbeEntry(board, &PvMove, &Score, alpha, beta, depth) == BOOL_TYPE_TRUE
+		&& board->ply ) {
+		board->tables->stats.ttCuts++;
 		return Score;
 	}
 
+	// tablebase result once a capture or pawn move reset the counter; at
+	// the piece limit only with enough depth left to be worth the probe
+	if(board->ply && g_tbMaxPieces > 0 && board->fiftyMove == 0 && board->castlePerm == 0
+		&& board->ply < CHESS_MAX_SEARCH_DEPTH - TB_MAX_PIECES) {
+		int pieces = BITBOARD_COUNT(board->occupied[COLOR_TYPE_BOTH]);
+		int limit = g_tbMaxPieces < EngineOptions->SyzygyProbeLimit ? g_tbMaxPieces : EngineOptions->SyzygyProbeLimit;
+		int success = BOOL_TYPE_FALSE;
+		int wdl = 0;
+
+		if(pieces <= limit && (pieces < limit || depth >= EngineOptions->SyzygyProbeDepth)) {
+			wdl = Tb_ProbeWdl(board, &success);
+		}
+		if(success) {
+			int tbScore = wdl < TB_WDL_BLESSED_LOSS ? -CHESS_TB_WIN + board->ply
+				: wdl > TB_WDL_CURSED_WIN ? CHESS_TB_WIN - board->ply : 2 * wdl;
+			int tbFlag = wdl < TB_WDL_BLESSED_LOSS ? HFALPHA : wdl > TB_WDL_CURSED_WIN ? HFBETA : HFEXACT;
+
+			info->tbhits++;
+			if(tbFlag == HFEXACT || (tbFlag == HFBETA ? tbScore >= beta : tbScore <= alpha)) {
+				HashTable_StoreEntry(board, NOMOVE, tbScore, tbFlag,
+					depth + 6 < CHESS_MAX_SEARCH_DEPTH ? depth + 6 : CHESS_MAX_SEARCH_DEPTH - 1);
+				return tbScore;
+			}
+		}
+	}
+
+	if(!PvNode && !InCheck) {
+		StaticEval = EvalCache_Evaluate(board);
+
+		// reverse futility: the static eval beats beta by more than the
+		// remaining depth could plausibly give back
+		if(EngineOptions->UseReverseFutility && depth <= RFP_MAX_DEPTH && abs(beta) < CHESS_IS_MATE
+			&& StaticEval - RFP_MARGIN * depth >= beta) {
+			return beta;
+		}
+
+		// futility: quiet moves cannot lift a hopeless eval up to alpha
+		if(EngineOptions->UseFutility && depth <= FUTILITY_MAX_DEPTH && abs(alpha) < CHESS_IS_MATE
+			&& StaticEval + FutilityMargin[depth] <= alpha) {
+			Futile = BOOL_TYPE_TRUE;
+		}
+	}
+
 	if( DoNull && !InCheck && board->ply && (board->bigPce[board->side] > 0) && depth >= 4) {
+		board->tables->stats.nullTries++;
 		MakeNullMove(board);
 		Score = -AlphaBeta( -beta, -beta + 1, depth-4, board, info, BOOL_TYPE_FALSE);
 		TakeNullMove(board);
@@ -218,43 +494,80 @@ static int AlphaBeta(int alpha, int beta, int depth, ChessBoard *board, SearchIn
 		}
 
 		if (Score >= beta && abs(Score) < CHESS_IS_MATE) {
-			info->nullCut++;
+			board->tables->stats.nullCuts++;
 			return beta;
 		}
 	}
 
-	MoveList list[1];
-    Move_GenerateAll(board,list);
+	SearchPly *frame = &board->tables->stack[board->ply];
+	MovePicker *picker = &frame->picker;
+	MovePicker_Init(picker, board, PvMove, BOOL_TYPE_FALSE);
 
-    int MoveNum = 0;
+	int Move = NOMOVE;
 	int Legal = 0;
+	int Quiet = BOOL_TYPE_FALSE;
+	int GivesCheck = BOOL_TYPE_FALSE;
+	int Reduction = 0;
 	int OldAlpha = alpha;
 	int BestMove = NOMOVE;
+	U64 ChildKey = 0ULL;
 
 	int BestScore = -CHESS_INFINITE;
 
 	Score = -CHESS_INFINITE;
 
-	if( PvMove != NOMOVE) {
-		for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {
-			if( list->moves[MoveNum].move == PvMove) {
-				list->moves[MoveNum].score = 2000000;
-				//printf("Pv move found \n");
-				break;
-			}
+	while((Move = MovePicker_Next(picker, board)) != NOMOVE) {
+
+		if(board->ply == 0 && info->rootMoveCount > 0 && !IsRootMove(info, Move)) {
+			continue;
 		}
-	}
 
-	for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {
+		if(board->ply == 0 && info->threadId == 0) {
+			rootMove = Move;
+			rootMoveNumber = Legal + 1;
+			if(info->GAME_MODE == MODE_TYPE_UCI) {
+				ReportCurrMove(info, Move, Legal + 1);
+			}
+		}
 
-		PickNextMove(MoveNum, list);
+		// start loading the child's TT bucket and eval slot while the move is made
+		ChildKey = Move_ChildKey(board, Move);
+		HashTable_Prefetch(board->HashTable, ChildKey);
+		EvalCache_Prefetch(ChildKey);
 
-        if ( !Move_Make(board,list->moves[MoveNum].move))  {
-            continue;
-        }
+        Move_MakeLegal(board,Move);
 
 		Legal++;
-		Score = -AlphaBeta( -beta, -alpha, depth-1, board, info, BOOL_TYPE_TRUE);
+		Quiet = !(Move & MFLAGCAP) && MOVE_GET_PROMOTED(Move) == EMPTY;
+		GivesCheck = Attack_IsSquareAttacked(board->KingSq[board->side],board->side^1,board);
+
+		if(Futile && Quiet && !GivesCheck && Legal > 1) {
+			Move_Take(board);
+			continue;
+		}
+
+		// late quiet moves are searched at reduced depth first
+		Reduction = 0;
+		if(EngineOptions->UseLMR && depth >= LMR_MIN_DEPTH && Legal > LMR_MIN_MOVES && Quiet && !InCheck && !GivesCheck
+			&& Move != picker->killers[0] && Move != picker->killers[1]) {
+			Reduction = Reductions[depth][Legal];
+			if(PvNode && Reduction > 0) Reduction--;
+			if(Reduction > depth - 2) Reduction = depth - 2;
+		}
+
+		// principal variation search: the first move gets the full window,
+		// the rest a zero window, re-searched only when they beat alpha
+		if(Legal == 1) {
+			Score = -AlphaBeta( -beta, -alpha, depth-1, board, info, BOOL_TYPE_TRUE);
+		} else {
+			Score = -AlphaBeta( -alpha - 1, -alpha, depth-1-Reduction, board, info, BOOL_TYPE_TRUE);
+			if(Score > alpha && Reduction > 0) {
+				Score = -AlphaBeta( -alpha - 1, -alpha, depth-1, board, info, BOOL_TYPE_TRUE);
+			}
+			if(Score > alpha && Score < beta) {
+				Score = -AlphaBeta( -beta, -alpha, depth-1, board, info, BOOL_TYPE_TRUE);
+			}
+		}
 		Move_Take(board);
 
 		if(info->stopped == BOOL_TYPE_TRUE) {
@@ -262,17 +575,17 @@ static int AlphaBeta(int alpha, int beta, int depth, ChessBoard *board, SearchIn
 		}
 		if(Score > BestScore) {
 			BestScore = Score;
-			BestMove = list->moves[MoveNum].move;
+			BestMove = Move;
 			if(Score > alpha) {
 				if(Score >= beta) {
 					if(Legal==1) {
-						info->fhf++;
+						board->tables->stats.failHighFirst++;
 					}
-					info->fh++;
+					board->tables->stats.failHighs++;
 
-					if(!(list->moves[MoveNum].move & MFLAGCAP)) {
-						board->searchKillers[1][board->ply] = board->searchKillers[0][board->ply];
-						board->searchKillers[0][board->ply] = list->moves[MoveNum].move;
+					if(!(Move & MFLAGCAP)) {
+						frame->killers[1] = frame->killers[0];
+						frame->killers[0] = Move_Pack(Move);
 					}
 
 					HashTable_StoreEntry(board, BestMove, beta, HFBETA, depth);
@@ -281,8 +594,8 @@ static int AlphaBeta(int alpha, int beta, int depth, ChessBoard *board, SearchIn
 				}
 				alpha = Score;
 
-				if(!(list->moves[MoveNum].move & MFLAGCAP)) {
-					board->searchHistory[board->pieces[MOVE_GET_FROM_SQUARE(BestMove)]][MOVE_GET_TO_SQUARE(BestMove)] += depth;
+				if(!(Move & MFLAGCAP)) {
+					board->tables->searchHistory[board->pieces[MOVE_GET_FROM_SQUARE(BestMove)]][SQUARE_120_TO_64(MOVE_GET_TO_SQUARE(BestMove))] += depth;
 				}
 			}
 		}
@@ -307,15 +620,250 @@ static int AlphaBeta(int alpha, int beta, int depth, ChessBoard *board, SearchIn
 	return alpha;
 }
 
+// iterative deepening step: search a narrow window around the previous
+// iteration's score and widen it on the side that failed
+static int AspirationSearch(const int depth, const int previousScore, ChessBoard *board, SearchInfo *info) {
+
+	int delta = ASPIRATION_WINDOW;
+	int alpha = -CHESS_INFINITE;
+	int beta = CHESS_INFINITE;
+	int score = 0;
+
+	if(depth >= ASPIRATION_MIN_DEPTH && abs(previousScore) < CHESS_IS_MATE) {
+		alpha = previousScore - delta;
+		beta = previousScore + delta;
+	}
+
+	while(BOOL_TYPE_TRUE) {
+		score = AlphaBeta(alpha, beta, depth, board, info, BOOL_TYPE_TRUE);
+		if(info->stopped == BOOL_TYPE_TRUE) {
+			return score;
+		}
+
+		delta *= 2;
+		if(score <= alpha && alpha > -CHESS_INFINITE) {
+			alpha = (delta > ASPIRATION_MAX_WINDOW) ? -CHESS_INFINITE : score - delta;
+		} else if(score >= beta && beta < CHESS_INFINITE) {
+			beta = (delta > ASPIRATION_MAX_WINDOW) ? CHESS_INFINITE : score + delta;
+		} else {
+			return score;
+		}
+	}
+}
+
+static void *Search_HelperThread(void *arg) {
+
+	SearchHelper *helper = (SearchHelper *)arg;
+	int currentDepth = 0;
+	int score = 0;
+
+	EngineOptions = helper->options;
+
+	// odd helpers start one ply deeper so the threads desynchronise
+	for( currentDepth = 1 + (helper->info->threadId & 1); currentDepth <= helper->info->depth; ++currentDepth ) {
+		score = AspirationSearch(currentDepth, score, helper->board, helper->info);
+		if(helper->info->stopped == BOOL_TYPE_TRUE) {
+			break;
+		}
+	}
+	PROFILE_FLUSH();
+	return NULL;
+}
+
+static void Search_StartHelpers(const ChessBoard *board, SearchInfo *info) {
+
+	int index = 0;
+	int count = EngineOptions->Threads - 1;
+
+	if(count > CHESS_MAX_THREADS - 1) count = CHESS_MAX_THREADS - 1;
+	activeHelpers = 0;
+	if(count <= 0) {
+		return;
+	}
+
+	if(count > helperCapacity) {
+		SearchHelper *grown = (SearchHelper *) realloc(helpers, count * sizeof(SearchHelper));
+		if(grown == NULL) {
+			// stdout carries the protocol; only UCI has a line for remarks
+			if(info->GAME_MODE == MODE_TYPE_UCI) {
+				printf("info string Helper thread allocation failed, searching with %d thread(s)\n", helperCapacity + 1);
+			} else {
+				fprintf(stderr, "Helper thread allocation failed, searching with %d thread(s)\n", helperCapacity + 1);
+			}
+			count = helperCapacity;
+		} else {
+			helpers = grown;
+			for(index = helperCapacity; index < count; ++index) {
+				Board_Init(helpers[index].board);
+			}
+			helperCapacity = count;
+		}
+	}
+
+	helpersStop = BOOL_TYPE_FALSE;
+
+	// a node budget covers the helpers' nodes too; slots of helpers that
+	// fail to start stay at zero
+	if(info->nodeLimit > 0 && count > 0) {
+		for(index = 0; index <= count; ++index) {
+			budgetCounts[index] = 0;
+		}
+		budgetThreads = count + 1;
+		info->nodeCounts = budgetCounts;
+	}
+
+	for(index = 0; index < count; ++index) {
+		SearchHelper *helper = &helpers[index];
+		Board_Copy(helper->board, board);
+		*helper->info = *info;
+		helper->info->threadId = index + 1;
+		helper->options = EngineOptions;
+		helper->info->POST_THINKING = BOOL_TYPE_FALSE;
+		if(helper->info->depth > CHESS_MAX_SEARCH_DEPTH - 1) {
+			helper->info->depth = CHESS_MAX_SEARCH_DEPTH - 1;
+		}
+		Search_ClearFor(helper->board, helper->info);
+		helper->info->nodeCounts = info->nodeCounts;
+		if(pthread_create(&helper->handle, NULL, Search_HelperThread, helper) != 0) {
+			break;
+		}
+		activeHelpers++;
+	}
+}
+
+// joins the helpers and folds their node counts into the main thread's
+static void Search_StopHelpers(ChessBoard *board, SearchInfo *info) {
+
+	int index = 0;
+
+	helpersStop = BOOL_TYPE_TRUE;
+	for(index = 0; index < activeHelpers; ++index) {
+		pthread_join(helpers[index].handle, NULL);
+		info->nodes += helpers[index].info->nodes;
+		info->tbhits += helpers[index].info->tbhits;
+		Stats_Add(&board->tables->stats, &helpers[index].board->tables->stats);
+	}
+	activeHelpers = 0;
+	info->nodeCounts = NULL;
+}
+
+static long Search_TotalNodes(const SearchInfo *info) {
+
+	int index = 0;
+	long nodes = info->nodes;
+
+	for(index = 0; index < activeHelpers; ++index) {
+		nodes += helpers[index].info->nodes;
+	}
+	return nodes;
+}
+
+static long Search_TotalTbHits(const SearchInfo *info) {
+
+	int index = 0;
+	long tbhits = info->tbhits;
+
+	for(index = 0; index < activeHelpers; ++index) {
+		tbhits += helpers[index].info->tbhits;
+	}
+	return tbhits;
+}
+
+// counters of every thread; read racily while helpers still run, which
+// is good enough for a report
+static void Search_TotalStats(const ChessBoard *board, const SearchInfo *info, SearchStats *total) {
+
+	int index = 0;
+
+	*total = board->tables->stats;
+	for(index = 0; index < activeHelpers; ++index) {
+		Stats_Add(total, &helpers[index].board->tables->stats);
+	}
+	total->nodes = Search_TotalNodes(info);
+}
+
+// root move list: go searchmoves, narrowed to the tablebase's best DTZ
+// moves when any of those are among them
+static void Search_PrepareRoot(ChessBoard *board, SearchInfo *info) {
+
+	int index = 0;
+	int index2 = 0;
+	int count = 0;
+
+	info->rootMoveCount = 0;
+	if(g_tbMaxPieces > 0 && EngineOptions->SyzygyProbeLimit > 0
+		&& BITBOARD_COUNT(board->occupied[COLOR_TYPE_BOTH]) <= EngineOptions->SyzygyProbeLimit
+		&& Tb_RootFilter(board, info) && info->searchMoveCount > 0) {
+		for(index = 0; index < info->rootMoveCount; ++index) {
+			for(index2 = 0; index2 < info->searchMoveCount; ++index2) {
+				if(info->rootMoves[index] == info->searchMoves[index2]) {
+					info->rootMoves[count++] = info->rootMoves[index];
+					break;
+				}
+			}
+		}
+		info->rootMoveCount = count;
+	}
+
+	if(info->rootMoveCount == 0) {
+		for(index = 0; index < info->searchMoveCount; ++index) {
+			info->rootMoves[index] = info->searchMoves[index];
+		}
+		info->rootMoveCount = info->searchMoveCount;
+	}
+}
+
+// stopped before the first iteration completed: any legal (root) move
+// still beats answering with none
+static int Search_FallbackMove(const ChessBoard *board, const SearchInfo *info) {
+
+	MoveList list[1];
+
+	if(info->rootMoveCount > 0) {
+		return info->rootMoves[0];
+	}
+	Move_GenerateLegal(board, list);
+	return list->count > 0 ? list->moves[0].move : NOMOVE;
+}
+
+// cache and search statistics for the finished search
+static void Search_PrintStats(const ChessBoard *board, const SearchInfo *info) {
+
+	const PawnHashTable *pawnHash = &board->tables->pawnHash;
+	long hitRate = pawnHash->probes > 0 ? pawnHash->hits * 100 / pawnHash->probes : 0;
+	long lazyCalls = board->tables->lazyExits + board->tables->fullEvals;
+	long lazyRate = lazyCalls > 0 ? board->tables->lazyExits * 100 / lazyCalls : 0;
+
+	if(info->GAME_MODE == MODE_TYPE_UCI) {
+		printf("info string pawn hash hits %ld/%ld (%ld%%)\n", pawnHash->hits, pawnHash->probes, hitRate);
+		printf("info string lazy eval cheap %ld full %ld (%ld%% avoided)\n",
+			board->tables->lazyExits, board->tables->fullEvals, lazyRate);
+		Stats_Print(BOOL_TYPE_TRUE, BOOL_TYPE_FALSE);
+	} else if(info->POST_THINKING == BOOL_TYPE_TRUE && info->GAME_MODE != MODE_TYPE_XBOARD) {
+		printf("Pawn hash hits:%ld/%ld (%ld%%)\n", pawnHash->hits, pawnHash->probes, hitRate);
+		printf("Lazy eval cheap:%ld full:%ld (%ld%% avoided)\n",
+			board->tables->lazyExits, board->tables->fullEvals, lazyRate);
+		Stats_Print(BOOL_TYPE_FALSE, BOOL_TYPE_FALSE);
+	}
+}
+
 void Search_Position(ChessBoard *board, SearchInfo *info) {
 
 	int bestMove = NOMOVE;
+	int ponderMove = NOMOVE;
 	int bestScore = -CHESS_INFINITE;
 	int currentDepth = 0;
 	int pvMoves = 0;
 	int pvNum = 0;
+	long nodes = 0;
+	int elapsed = 0;
+	SearchStats stats[1];
+	MoveList list[1];
 
+	info->threadId = 0;
 	Search_ClearFor(board,info);
+	HashTable_NewSearch(board->HashTable);
+	Stats_BeginSearch();
 	
 	if(EngineOptions->UseBook == BOOL_TYPE_TRUE) {
 		bestMove = PolyBook_GetMove(board);
@@ -325,26 +873,40 @@ void Search_Position(ChessBoard *board, SearchInfo *info) {
 
 	// iterative deepening
 	if(bestMove == NOMOVE) {
+		Search_PrepareRoot(board, info);
+		rootMove = NOMOVE;
+		rootMoveNumber = 0;
+		rootMoveTotal = info->rootMoveCount;
+		if(rootMoveTotal == 0) {
+			Move_GenerateLegal(board, list);
+			rootMoveTotal = list->count;
+		}
+		Search_StartHelpers(board, info);
 		for( currentDepth = 1; currentDepth <= info->depth; ++currentDepth ) {
-								// alpha	 beta
 			rootDepth = currentDepth;
-			bestScore = AlphaBeta(-CHESS_INFINITE, CHESS_INFINITE, currentDepth, board, info, BOOL_TYPE_TRUE);
+			bestScore = AspirationSearch(currentDepth, bestScore, board, info);
 
 			if(info->stopped == BOOL_TYPE_TRUE) {
 				break;
 			}
 
 			pvMoves = HashTable_GetPvLine(currentDepth, board);
-			bestMove = board->PvArray[0];
+			bestMove = board->tables->PvArray[0];
+			ponderMove = pvMoves > 1 ? board->tables->PvArray[1] : NOMOVE;
+			Search_TotalStats(board, info, stats);
+			Stats_RecordIteration(currentDepth, stats);
+			nodes = Search_TotalNodes(info);
+			elapsed = Misc_GetTimeMs()-info->starttime;
 			if(info->GAME_MODE == MODE_TYPE_UCI) {
-				printf("info score cp %d depth %d nodes %ld time %d ",
-					bestScore,currentDepth,info->nodes,Misc_GetTimeMs()-info->starttime);
+				printf("info depth %d seldepth %d score %s nodes %ld nps %ld hashfull %d tbhits %ld time %d ",
+					currentDepth,info->seldepth,UciScore(bestScore),nodes,elapsed > 0 ? nodes * 1000 / elapsed : nodes,
+					HashTable_Hashfull(board->HashTable),Search_TotalTbHits(info),elapsed);
 			} else if(info->GAME_MODE == MODE_TYPE_XBOARD && info->POST_THINKING == BOOL_TYPE_TRUE) {
 				printf("%d %d %d %ld ",
-					currentDepth,bestScore,(Misc_GetTimeMs()-info->starttime)/10,info->nodes);
+					currentDepth,bestScore,elapsed/10,nodes);
 			} else if(info->POST_THINKING == BOOL_TYPE_TRUE) {
 				printf("score:%d depth:%d nodes:%ld time:%d(ms) ",
-					bestScore,currentDepth,info->nodes,Misc_GetTimeMs()-info->starttime);
+					bestScore,currentDepth,nodes,elapsed);
 			}
 			if(info->GAME_MODE == MODE_TYPE_UCI || info->POST_THINKING == BOOL_TYPE_TRUE) {
 				pvMoves = HashTable_GetPvLine(currentDepth, board);
@@ -352,21 +914,57 @@ void Search_Position(ChessBoard *board, SearchInfo *info) {
 					printf("pv");
 				}
 				for(pvNum = 0; pvNum < pvMoves; ++pvNum) {
-					printf(" %s",PrMove(board->PvArray[pvNum]));
+					printf(" %s",PrMove(board->tables->PvArray[pvNum]));
 				}
 				printf("\n");
 			}
 
-			//printf("Hits:%d Overwrite:%d NewWrite:%d Cut:%d\nOrdering %.2f NullCut:%d\n",board->HashTable->hit,board->HashTable->overWrite,board->HashTable->newWrite,board->HashTable->cut,
-			//(info->fhf/info->fh)*100,info->nullCut);
+			// past the soft limit the next iteration would likely be cut
+			// off by the hard one before it finishes
+			if(Time_StopIterating(info, bestMove, bestScore) && !STOP_LOAD(&info->ponder)) {
+				break;
+			}
+
+			// go mate: a mate within the asked number of moves ends the search
+			if(info->mateLimit > 0 && bestScore > CHESS_IS_MATE
+				&& (CHESS_INFINITE - bestScore + 1) / 2 <= info->mateLimit && !STOP_LOAD(&info->ponder)) {
+				break;
+			}
+
+		}
+		Search_StopHelpers(board, info);
+		PROFILE_FLUSH();
+		Search_TotalStats(board, info, stats);
+		Stats_EndSearch(stats, Misc_GetTimeMs() - info->starttime);
+		if(bestMove == NOMOVE) {
+			bestMove = Search_FallbackMove(board, info);
 		}
 	}
+	info->ponderMove = ponderMove;
 
+	// a UCI ponder search that ran out of depth answers only after
+	// ponderhit or stop
 	if(info->GAME_MODE == MODE_TYPE_UCI) {
-		printf("bestmove %s\n",PrMove(bestMove));
+		while(STOP_LOAD(&info->ponder) && !STOP_LOAD(&info->stopRequest)) {
+			Misc_Sleep(1);
+		}
+	}
+
+	Search_PrintStats(board, info);
+	PROFILE_REPORT();
+
+	if(info->GAME_MODE == MODE_TYPE_UCI) {
+		printf("bestmove %s",PrMove(bestMove));
+		if(ponderMove != NOMOVE) {
+			printf(" ponder %s",PrMove(ponderMove));
+		}
+		printf("\n");
 	} else if(info->GAME_MODE == MODE_TYPE_XBOARD) {
-		printf("move %s\n",PrMove(bestMove));
-		Move_Make(board, bestMove);
+		// pondering on the expected reply never plays a move
+		if(info->ponder == BOOL_TYPE_FALSE) {
+			printf("move %s\n",PrMove(bestMove));
+			Move_Make(board, bestMove);
+		}
 	} else {
 		printf("\n\n***!! Gambit makes move %s !!***\n\n",PrMove(bestMove));
 		Move_Make(board, bestMove);
@@ -383,7 +981,9 @@ int Search_GetBestMove(ChessBoard *board, SearchInfo *info) {
 	int pvMoves = 0;
 	int pvNum = 0;
 
+	info->threadId = 0;
 	Search_ClearFor(board,info);
+	HashTable_NewSearch(board->HashTable);
 	
 	if(EngineOptions->UseBook == BOOL_TYPE_TRUE) {
 		bestMove = PolyBook_GetMove(board);
@@ -391,17 +991,26 @@ int Search_GetBestMove(ChessBoard *board, SearchInfo *info) {
 
 	// iterative deepening
 	if(bestMove == NOMOVE) {
+		Search_PrepareRoot(board, info);
+		Search_StartHelpers(board, info);
 		for( currentDepth = 1; currentDepth <= info->depth; ++currentDepth ) {
-								// alpha	 beta
 			rootDepth = currentDepth;
-			bestScore = AlphaBeta(-CHESS_INFINITE, CHESS_INFINITE, currentDepth, board, info, BOOL_TYPE_TRUE);
+			bestScore = AspirationSearch(currentDepth, bestScore, board, info);
 
 			if(info->stopped == BOOL_TYPE_TRUE) {
 				break;
 			}
 
 			pvMoves = HashTable_GetPvLine(currentDepth, board);
-			bestMove = board->PvArray[0];
+			bestMove = board->tables->PvArray[0];
+			if(Time_StopIterating(info, bestMove, bestScore)) {
+				break;
+			}
+		}
+		Search_StopHelpers(board, info);
+		PROFILE_FLUSH();
+		if(bestMove == NOMOVE) {
+			bestMove = Search_FallbackMove(board, info);
 		}
 	}
 	
@@ -427,3 +1036,55 @@ int Search_GetBestMove(ChessBoard *board, SearchInfo *info) {
 
 
 
+
+int Search_Independent(ChessBoard *board, SearchInfo *info, SearchResult *result) {
+
+	int currentDepth = 0;
+	int score = -CHESS_INFINITE;
+	int index = 0;
+
+	// the main thread's limits apply, but input reaches it only through
+	// stopRequest and the root currmove report stays off
+	info->threadId = 0;
+	info->asyncInput = BOOL_TYPE_TRUE;
+	info->GAME_MODE = MODE_TYPE_CONSOLE;
+	info->POST_THINKING = BOOL_TYPE_FALSE;
+	if(info->depth > CHESS_MAX_SEARCH_DEPTH - 1) {
+		info->depth = CHESS_MAX_SEARCH_DEPTH - 1;
+	}
+	Search_ClearFor(board, info);
+
+	memset(result, 0, sizeof(SearchResult));
+	result->bestMove = NOMOVE;
+
+	Search_PrepareRoot(board, info);
+	for( currentDepth = 1; currentDepth <= info->depth; ++currentDepth ) {
+		score = AspirationSearch(currentDepth, score, board, info);
+		if(info->stopped == BOOL_TYPE_TRUE) {
+			break;
+		}
+
+		result->pvLength = HashTable_GetPvLine(currentDepth, board);
+		for(index = 0; index < result->pvLength; ++index) {
+			result->pv[index] = board->tables->PvArray[index];
+		}
+		result->bestMove = result->pvLength > 0 ? result->pv[0] : NOMOVE;
+		result->score = score;
+		result->depth = currentDepth;
+
+		if(Time_StopIterating(info, result->bestMove, score)) {
+			break;
+		}
+		if(info->mateLimit > 0 && score > CHESS_IS_MATE && (CHESS_INFINITE - score + 1) / 2 <= info->mateLimit) {
+			break;
+		}
+	}
+
+	if(result->bestMove == NOMOVE) {
+		result->bestMove = Search_FallbackMove(board, info);
+	}
+	result->seldepth = info->seldepth;
+	result->nodes = info->nodes;
+	result->timeMs = Misc_GetTimeMs() - info->starttime;
+	return result->bestMove;
+}
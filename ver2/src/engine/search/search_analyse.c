@@ -0,0 +1,453 @@
+/**
+ * @file search_analyse.c
+ * @brief Batch analysis of EPD/FEN files on a pool of search workers
+ *
+ * The calling thread streams the input file into a ring of jobs, a
+ * fixed number per worker, and waits whenever the ring is full, so
+ * files of any length run in constant memory. Each worker:
+ * - Owns a board, search tables and SearchInfo and runs one
+ *   Search_Independent per position
+ * - Uses its own transposition table, cleared before every position so
+ *   results do not depend on which worker got which line, or one table
+ *   shared by all workers and kept across positions (--shared-hash) for
+ *   files of related positions
+ *
+ * Results are written as NDJSON, either in input order (a finished job
+ * waits in the ring until every earlier one is written) or as soon as
+ * they complete. Moves are only formatted under the output lock, since
+ * PrMove returns a static buffer.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "types_definitions.h"
+#include <pthread.h>
+
+#define ANALYSE_JOBS_PER_WORKER 4 // Ring slots per worker: input read ahead of the searches
+#define ANALYSE_DEFAULT_HASH 16   // Transposition table MB unless --hash is given
+
+enum { JOB_EMPTY, JOB_QUEUED, JOB_DONE };
+
+/**
+ * One line of the input: its FEN, the EPD id if any, and once searched
+ * the result.
+ */
+typedef struct {
+	char fen[ANALYSE_LINE];
+	char id[ANALYSE_ID];
+	int lineNumber;
+	int state;
+	int badFen;
+	SearchResult result;
+} AnalyseJob;
+
+typedef struct {
+	ChessBoard board[1];
+	SearchInfo info[1];
+	HashTable table[1];
+	pthread_t handle;
+} AnalyseWorker;
+
+static const AnalyseOptions *settings = NULL;
+static AnalyseJob *jobs = NULL;
+static int jobCount = 0;
+static long readCount = 0;
+static long runNext = 0;
+static long writeNext = 0;
+static int readDone = BOOL_TYPE_FALSE;
+static int failedCount = 0;
+static long totalNodes = 0;
+static FILE *output = NULL;
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobQueued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobFreed = PTHREAD_COND_INITIALIZER;
+
+static void Usage() {
+	printf("usage: gambit analyse <in.epd> [--depth N] [--nodes N] [--movetime ms] [--threads N]\n");
+	printf("                      [--hash MB] [--shared-hash] [--order input|completed] [--out file]\n");
+}
+
+int Analyse_ParseOptions(AnalyseOptions *options, const int argc, char *argv[]) {
+
+	int index = 0;
+	int depthGiven = BOOL_TYPE_FALSE;
+
+	memset(options, 0, sizeof(AnalyseOptions));
+	options->threads = 1;
+	options->hashMB = ANALYSE_DEFAULT_HASH;
+	options->ordered = BOOL_TYPE_TRUE;
+
+	if(argc < 1 || argv[0][0] == '-') {
+		Usage();
+		return BOOL_TYPE_FALSE;
+	}
+	options->inPath = argv[0];
+
+	for(index = 1; index < argc; ++index) {
+		const char *value = index + 1 < argc ? argv[index + 1] : NULL;
+
+		if(strcmp(argv[index], "--shared-hash") == 0) {
+			options->sharedHash = BOOL_TYPE_TRUE;
+			continue;
+		}
+		if(value == NULL) {
+			Usage();
+			return BOOL_TYPE_FALSE;
+		}
+		if(strcmp(argv[index], "--depth") == 0) {
+			options->depth = atoi(value);
+			depthGiven = BOOL_TYPE_TRUE;
+		} else if(strcmp(argv[index], "--nodes") == 0) {
+			options->nodes = atol(value);
+		} else if(strcmp(argv[index], "--movetime") == 0) {
+			options->movetime = atoi(value);
+		} else if(strcmp(argv[index], "--threads") == 0) {
+			options->threads = atoi(value);
+		} else if(strcmp(argv[index], "--hash") == 0) {
+			options->hashMB = atoi(value);
+		} else if(strcmp(argv[index], "--out") == 0) {
+			options->outPath = value;
+		} else if(strcmp(argv[index], "--order") == 0 && strcmp(value, "input") == 0) {
+			options->ordered = BOOL_TYPE_TRUE;
+		} else if(strcmp(argv[index], "--order") == 0 && strcmp(value, "completed") == 0) {
+			options->ordered = BOOL_TYPE_FALSE;
+		} else {
+			Usage();
+			return BOOL_TYPE_FALSE;
+		}
+		index++;
+	}
+
+	// a node or time limit alone searches as deep as it allows
+	if(!depthGiven) {
+		options->depth = options->nodes > 0 || options->movetime > 0 ? CHESS_MAX_SEARCH_DEPTH - 1 : ANALYSE_DEFAULT_DEPTH;
+	}
+	if(options->depth < 1) options->depth = 1;
+	if(options->depth > CHESS_MAX_SEARCH_DEPTH - 1) options->depth = CHESS_MAX_SEARCH_DEPTH - 1;
+	if(options->threads < 1) options->threads = 1;
+	if(options->threads > CHESS_MAX_THREADS) options->threads = CHESS_MAX_THREADS;
+	if(options->hashMB < 1) options->hashMB = 1;
+	if(options->hashMB > CHESS_MAX_HASH) options->hashMB = CHESS_MAX_HASH;
+	return BOOL_TYPE_TRUE;
+}
+
+/* --- input --- */
+
+// FEN or EPD line: four position fields, then either the two move
+// counters (FEN) or operations such as bm and id (EPD)
+int Analyse_ParseLine(char *text, char *fen, char *id) {
+
+	char *end = text + strlen(text);
+	char *ptr = text;
+	char *idField = NULL;
+	int fields = 0;
+
+	while(end > text && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+	while(*ptr == ' ' || *ptr == '\t') ptr++;
+	if(*ptr == '\0' || *ptr == '#') {
+		return BOOL_TYPE_FALSE;
+	}
+
+	id[0] = '\0';
+	idField = strstr(ptr, " id \"");
+	if(idField != NULL) {
+		char *close = strchr(idField + 5, '"');
+		int length = close != NULL ? (int)(close - (idField + 5)) : 0;
+		if(length > ANALYSE_ID - 1) length = ANALYSE_ID - 1;
+		memcpy(id, idField + 5, length);
+		id[length] = '\0';
+	}
+
+	// keep the counters only if both are there, EPD operations never
+	// start with a digit
+	for(end = ptr; *end != '\0'; ++end) {
+		if(*end == ' ' && ++fields == 4) break;
+	}
+	if(*end == ' ' && end[1] >= '0' && end[1] <= '9') {
+		char *counter = strchr(end + 1, ' ');
+		if(counter != NULL && counter[1] >= '0' && counter[1] <= '9') {
+			end = strchr(counter + 1, ' ');
+			if(end == NULL) end = ptr + strlen(ptr);
+		}
+	}
+	*end = '\0';
+
+	strncpy(fen, ptr, ANALYSE_LINE - 1);
+	fen[ANALYSE_LINE - 1] = '\0';
+	return BOOL_TYPE_TRUE;
+}
+
+/* --- output (under jobLock) --- */
+
+static void WriteString(FILE *output, const char *text) {
+
+	fputc('"', output);
+	for(; *text != '\0'; ++text) {
+		if(*text == '"' || *text == '\\') {
+			fputc('\\', output);
+			fputc(*text, output);
+		} else if((unsigned char)*text >= 0x20) {
+			fputc(*text, output);
+		}
+	}
+	fputc('"', output);
+}
+
+void Analyse_WriteResult(FILE *output, const int lineNumber, const char *id, const char *fen,
+	const SearchResult *result, const char *error) {
+
+	int index = 0;
+
+	fprintf(output, "{\"line\":%d,", lineNumber);
+	if(id[0] != '\0') {
+		fprintf(output, "\"id\":");
+		WriteString(output, id);
+		fputc(',', output);
+	}
+	fprintf(output, "\"fen\":");
+	WriteString(output, fen);
+
+	if(error != NULL) {
+		fprintf(output, ",\"error\":");
+		WriteString(output, error);
+		fprintf(output, "}\n");
+		return;
+	}
+
+	fprintf(output, ",\"bestmove\":\"%s\",\"score\":{", result->bestMove != NOMOVE ? PrMove(result->bestMove) : "0000");
+	if(result->score > CHESS_IS_MATE) {
+		fprintf(output, "\"mate\":%d}", (CHESS_INFINITE - result->score + 1) / 2);
+	} else if(result->score < -CHESS_IS_MATE) {
+		fprintf(output, "\"mate\":-%d}", (CHESS_INFINITE + result->score) / 2);
+	} else {
+		fprintf(output, "\"cp\":%d}", result->score);
+	}
+	fprintf(output, ",\"depth\":%d,\"seldepth\":%d,\"nodes\":%ld,\"time\":%d,\"pv\":[",
+		result->depth, result->seldepth, result->nodes, result->timeMs);
+	for(index = 0; index < result->pvLength; ++index) {
+		fprintf(output, "%s\"%s\"", index > 0 ? "," : "", PrMove(result->pv[index]));
+	}
+	fprintf(output, "]}\n");
+}
+
+static void WriteJob(const AnalyseJob *job) {
+	Analyse_WriteResult(output, job->lineNumber, job->id, job->fen, &job->result, job->badFen ? "bad fen" : NULL);
+}
+
+static void FinishJob(AnalyseJob *job) {
+
+	job->state = JOB_DONE;
+	if(job->badFen) {
+		failedCount++;
+	}
+	totalNodes += job->result.nodes;
+
+	if(!settings->ordered) {
+		WriteJob(job);
+		job->state = JOB_EMPTY;
+	} else {
+		// a line finished early waits for every earlier one
+		while(writeNext < runNext && jobs[writeNext % jobCount].state == JOB_DONE) {
+			WriteJob(&jobs[writeNext % jobCount]);
+			jobs[writeNext % jobCount].state = JOB_EMPTY;
+			writeNext++;
+		}
+	}
+	pthread_cond_broadcast(&jobFreed);
+}
+
+/* --- workers --- */
+
+void Analyse_Position(ChessBoard *board, SearchInfo *info, const int depth, const long nodes, const int movetime,
+	SearchResult *result) {
+
+	info->depth = depth;
+	info->nodeLimit = nodes;
+	info->starttime = Misc_GetTimeMs();
+	Time_Allocate(info, -1, 0, 0, movetime > 0 ? movetime : -1);
+	Search_Independent(board, info, result);
+}
+
+static void AnalysePosition(AnalyseWorker *worker, AnalyseJob *job) {
+
+	memset(&job->result, 0, sizeof(SearchResult));
+	if(job->badFen || Board_ParseFromFEN(job->fen, worker->board) != 0) {
+		job->badFen = BOOL_TYPE_TRUE;
+		return;
+	}
+	if(!settings->sharedHash) {
+		HashTable_Clear(worker->board->HashTable);
+	}
+	memset(worker->info, 0, sizeof(SearchInfo));
+	Analyse_Position(worker->board, worker->info, settings->depth, settings->nodes, settings->movetime, &job->result);
+}
+
+static void *AnalyseThread(void *arg) {
+
+	AnalyseWorker *worker = (AnalyseWorker *)arg;
+	AnalyseJob *job = NULL;
+
+	pthread_mutex_lock(&jobLock);
+	while(BOOL_TYPE_TRUE) {
+		while(runNext == readCount && !readDone) {
+			pthread_cond_wait(&jobQueued, &jobLock);
+		}
+		if(runNext == readCount) {
+			break;
+		}
+		job = &jobs[runNext % jobCount];
+		runNext++;
+		pthread_mutex_unlock(&jobLock);
+
+		AnalysePosition(worker, job);
+
+		pthread_mutex_lock(&jobLock);
+		FinishJob(job);
+	}
+	pthread_mutex_unlock(&jobLock);
+	PROFILE_FLUSH();
+	return NULL;
+}
+
+// reads the input into the ring while the workers empty it
+static int ReadInput(FILE *file) {
+
+	char text[ANALYSE_LINE];
+	int lineNumber = 0;
+	int length = 0;
+	AnalyseJob *job = NULL;
+
+	while(fgets(text, sizeof(text), file) != NULL) {
+		lineNumber++;
+		length = (int)strlen(text);
+		if(length == ANALYSE_LINE - 1 && text[length - 1] != '\n') {
+			int skipped = 0;
+			while((skipped = fgetc(file)) != EOF && skipped != '\n');
+		}
+
+		pthread_mutex_lock(&jobLock);
+		job = &jobs[readCount % jobCount];
+		while(job->state != JOB_EMPTY) {
+			pthread_cond_wait(&jobFreed, &jobLock);
+		}
+		pthread_mutex_unlock(&jobLock);
+
+		if(!Analyse_ParseLine(text, job->fen, job->id)) {
+			continue;
+		}
+		job->badFen = !Board_IsValidFen(job->fen);
+		job->lineNumber = lineNumber;
+
+		pthread_mutex_lock(&jobLock);
+		job->state = JOB_QUEUED;
+		readCount++;
+		pthread_cond_signal(&jobQueued);
+		pthread_mutex_unlock(&jobLock);
+	}
+
+	pthread_mutex_lock(&jobLock);
+	readDone = BOOL_TYPE_TRUE;
+	pthread_cond_broadcast(&jobQueued);
+	pthread_mutex_unlock(&jobLock);
+	return (int)readCount;
+}
+
+int Analyse_Run(const AnalyseOptions *options) {
+
+	FILE *file = fopen(options->inPath, "r");
+	FILE *report = options->outPath != NULL ? stdout : stderr;
+	AnalyseWorker *workers = NULL;
+	int workerCount = options->threads;
+	int started = 0;
+	int positions = 0;
+	int index = 0;
+
+	if(file == NULL) {
+		printf("analyse: cannot open %s\n", options->inPath);
+		return -1;
+	}
+	output = options->outPath != NULL ? fopen(options->outPath, "w") : stdout;
+	if(output == NULL) {
+		printf("analyse: cannot write %s\n", options->outPath);
+		fclose(file);
+		return -1;
+	}
+
+	jobCount = workerCount * ANALYSE_JOBS_PER_WORKER;
+	jobs = (AnalyseJob *) calloc(jobCount, sizeof(AnalyseJob));
+	workers = (AnalyseWorker *) calloc(workerCount, sizeof(AnalyseWorker));
+	if(jobs == NULL || workers == NULL) {
+		printf("analyse: allocation failed\n");
+		free(jobs);
+		free(workers);
+		jobs = NULL;
+		fclose(file);
+		if(output != stdout) fclose(output);
+		return -1;
+	}
+
+	settings = options;
+	readCount = 0;
+	runNext = 0;
+	writeNext = 0;
+	readDone = BOOL_TYPE_FALSE;
+	failedCount = 0;
+	totalNodes = 0;
+	if(options->sharedHash) {
+		HashTable_Init(g_hashTable, options->hashMB);
+	}
+
+	fprintf(report, "analyse: %s, depth %d, nodes %ld, movetime %d, %d worker(s), %s hash %dMB, %s order\n",
+		options->inPath, options->depth, options->nodes, options->movetime, workerCount,
+		options->sharedHash ? "shared" : "private", options->hashMB, options->ordered ? "input" : "completed");
+	int start = Misc_GetTimeMs();
+
+	for(index = 0; index < workerCount; ++index) {
+		AnalyseWorker *worker = &workers[index];
+		Board_Init(worker->board);
+		if(options->sharedHash) {
+			worker->board->HashTable = g_hashTable;
+		} else {
+			HashTable_Init(worker->table, options->hashMB);
+			worker->board->HashTable = worker->table;
+		}
+		if(pthread_create(&worker->handle, NULL, AnalyseThread, worker) != 0) {
+			HashTable_Free(worker->table);
+			Board_Free(worker->board);
+			break;
+		}
+		started++;
+	}
+
+	if(started == 0) {
+		printf("analyse: no worker thread could be started\n");
+		readDone = BOOL_TYPE_TRUE;
+	} else {
+		positions = ReadInput(file);
+	}
+	fclose(file);
+
+	for(index = 0; index < started; ++index) {
+		pthread_join(workers[index].handle, NULL);
+		HashTable_Free(workers[index].table);
+		Board_Free(workers[index].board);
+	}
+	if(output != stdout) {
+		fclose(output);
+	}
+
+	int elapsed = Misc_GetTimeMs() - start;
+	fprintf(report, "analyse result positions=%d failed=%d nodes=%ld time=%d nps=%ld\n", positions, failedCount,
+		totalNodes, elapsed, elapsed > 0 ? totalNodes * 1000 / elapsed : totalNodes);
+
+	free(workers);
+	free(jobs);
+	jobs = NULL;
+	settings = NULL;
+	output = NULL;
+	return started == 0 ? -1 : failedCount;
+}
@@ -0,0 +1,1310 @@
+/**
+ * @file search_cluster.c
+ * @brief Distributed batch analysis: a coordinator and worker engines over TCP
+ *
+ * The coordinator reads an EPD/FEN file (or one --fen position) into
+ * work units, one per position or, with --split, one per legal root
+ * move, and waits for workers to connect. Each worker searches units
+ * with the analyse search (Analyse_Position) on as many threads as it
+ * announced, all sharing one transposition table kept across units.
+ * The coordinator:
+ * - Keeps every worker supplied with as many units as it has threads
+ * - Dispatches the units of a worker that disconnects, or whose TCP
+ *   keepalive fails, again; a unit lost --attempts times is reported as
+ *   failed, in case it is what brings the workers down
+ * - Writes the results in the analyse NDJSON format, in input order or
+ *   as completed, and reports the best root move of a split position
+ * - With --share-tt, forwards the exact entries a worker found along
+ *   each result's PV to all other workers, so a subtree that recurs in
+ *   another unit is not searched again elsewhere in the cluster
+ *
+ * The protocol is line based text:
+ *   worker:      hello <protocol> <threads> <name>
+ *   coordinator: config <protocol> <shareDepth>
+ *   coordinator: unit <id> <depth> <nodes> <movetime> <rootmove|-> <fen>
+ *   worker:      result <id> <bestmove> <score> <depth> <seldepth> <nodes> <time> [pv...]
+ *   worker:      result <id> error <reason>
+ *   both:        tt <key> <packed move> <score> <depth>
+ *   coordinator: quit
+ * Moves are in UCI notation, except that tt carries entries exactly as
+ * HashTable_ExportEntry returns them, so all nodes must run the same build.
+ *
+ * The coordinator is a single-threaded select loop, so it needs no locks
+ * and may use PrMove. A worker reads the socket on its main thread and
+ * searches on the others; their sends go out under one lock, so lines
+ * never interleave and PrMove is only called with the lock held.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#ifdef _WIN32
+#define FD_SETSIZE 512 // select limit, counted in sockets on Windows
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#endif
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <stdarg.h>
+#include "types_definitions.h"
+#include <pthread.h>
+
+#define CLUSTER_PROTOCOL 1          // Bumped whenever a message changes
+#define CLUSTER_LINE 2048           // Longest message: a unit with its FEN, or a result with its PV
+#define CLUSTER_BUFFER 65536        // Receive buffer per connection
+#define CLUSTER_MAX_WORKERS 256     // Connections the coordinator accepts at once
+#define CLUSTER_MOVE 8              // UCI move text ("e7e8q") plus terminator
+#define CLUSTER_NAME 64             // Worker name shown in the coordinator's log
+#define CLUSTER_DEFAULT_ATTEMPTS 3  // Dispatches of a unit before a lost worker fails it
+#define CLUSTER_DEFAULT_HASH 64     // Worker table MB unless --hash is given
+#define CLUSTER_CONNECT_SECONDS 60  // Worker connect retries unless --connect-timeout is given
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STOP_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define STOP_STORE(p,v) (*(volatile int *)(p) = (v))
+#endif
+
+#ifdef _WIN32
+typedef SOCKET ClusterSocket;
+#define CLUSTER_NO_SOCKET INVALID_SOCKET
+#define CloseSocket closesocket
+#else
+typedef int ClusterSocket;
+#define CLUSTER_NO_SOCKET (-1)
+#define CloseSocket close
+#endif
+
+/**
+ * Bytes received on a connection that don't form a whole line yet.
+ */
+typedef struct {
+	ClusterSocket sock;
+	int length;
+	char data[CLUSTER_BUFFER];
+} LineReader;
+
+/* --- sockets --- */
+
+static int Sockets_Start() {
+#ifdef _WIN32
+	WSADATA data;
+	return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+	// a peer that went away shows up as a failed send, not a signal
+	signal(SIGPIPE, SIG_IGN);
+	return BOOL_TYPE_TRUE;
+#endif
+}
+
+static void Sockets_Stop() {
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+// no Nagle delay for the short messages, and keepalive probes so a
+// machine that dies without closing the connection is noticed
+static void Socket_Tune(const ClusterSocket sock) {
+
+	int on = 1;
+
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&on, sizeof(on));
+	setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (const char *)&on, sizeof(on));
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+	{
+		int idle = 60;
+		int interval = 10;
+		int count = 3;
+		setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, (const char *)&idle, sizeof(idle));
+		setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, (const char *)&interval, sizeof(interval));
+		setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, (const char *)&count, sizeof(count));
+	}
+#endif
+}
+
+static int Socket_SendLine(const ClusterSocket sock, const char *format, ...) {
+
+	char text[CLUSTER_LINE];
+	const char *ptr = text;
+	va_list args;
+	int length = 0;
+	int sent = 0;
+
+	va_start(args, format);
+	length = vsnprintf(text, sizeof(text) - 1, format, args);
+	va_end(args);
+	if(length < 0 || length >= (int)sizeof(text) - 1) {
+		return BOOL_TYPE_FALSE;
+	}
+	text[length++] = '\n';
+
+	while(length > 0) {
+		sent = (int)send(sock, ptr, length, 0);
+		if(sent <= 0) {
+			return BOOL_TYPE_FALSE;
+		}
+		ptr += sent;
+		length -= sent;
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+// appends what has arrived; BOOL_TYPE_FALSE once the connection is
+// closed, broken, or sends a line longer than any message
+static int Reader_Fill(LineReader *reader) {
+
+	int received = 0;
+
+	if(reader->length >= CLUSTER_BUFFER - 1) {
+		return BOOL_TYPE_FALSE;
+	}
+	received = (int)recv(reader->sock, reader->data + reader->length, CLUSTER_BUFFER - 1 - reader->length, 0);
+	if(received <= 0) {
+		return BOOL_TYPE_FALSE;
+	}
+	reader->length += received;
+	return BOOL_TYPE_TRUE;
+}
+
+// the next whole line from offset on, or NULL after moving the partial
+// rest to the front of the buffer
+static char *Reader_Next(LineReader *reader, int *offset) {
+
+	char *start = reader->data + *offset;
+	char *end = (char *)memchr(start, '\n', reader->length - *offset);
+
+	if(end == NULL) {
+		memmove(reader->data, start, reader->length - *offset);
+		reader->length -= *offset;
+		*offset = 0;
+		return NULL;
+	}
+	*end = '\0';
+	if(end > start && end[-1] == '\r') {
+		end[-1] = '\0';
+	}
+	*offset = (int)(end + 1 - reader->data);
+	return start;
+}
+
+static void PrintScore(FILE *stream, const int score) {
+	if(score > CHESS_IS_MATE) {
+		fprintf(stream, "mate %d", (CHESS_INFINITE - score + 1) / 2);
+	} else if(score < -CHESS_IS_MATE) {
+		fprintf(stream, "mate -%d", (CHESS_INFINITE + score) / 2);
+	} else {
+		fprintf(stream, "cp %d", score);
+	}
+}
+
+/* ===========================================================================
+ * COORDINATOR
+ * ===========================================================================
+ */
+
+enum { UNIT_QUEUED, UNIT_RUNNING, UNIT_DONE };
+
+/**
+ * One input line: the position as given and, once all its units are
+ * in, the best of them.
+ */
+typedef struct {
+	char *fen;
+	char id[ANALYSE_ID];
+	int lineNumber;
+	int unitsLeft;
+	int unitCount;
+	int bestMove;
+	int bestScore;
+} ClusterGroup;
+
+/**
+ * The search of a position, or of one root move of it.
+ */
+typedef struct {
+	int group;
+	char move[CLUSTER_MOVE];
+	int state;
+	int attempts;
+	int peer;
+	SearchResult *result;
+	const char *error;
+} ClusterUnit;
+
+typedef struct {
+	LineReader reader[1];
+	int ready;
+	int slots;
+	int busy;
+	int done;
+	char name[CLUSTER_NAME];
+} ClusterPeer;
+
+static const ClusterOptions *settings = NULL;
+static ClusterGroup *groups = NULL;
+static int groupCount = 0;
+static int groupCapacity = 0;
+static ClusterUnit *units = NULL;
+static int unitCount = 0;
+static int unitCapacity = 0;
+static int *requeued = NULL;
+static int requeuedCount = 0;
+static int nextUnit = 0;
+static int writeNext = 0;
+static int doneCount = 0;
+static int failedCount = 0;
+static int requeueTotal = 0;
+static long totalNodes = 0;
+static long sharedEntries = 0;
+static ClusterPeer *peers = NULL;
+static ChessBoard resultBoard[1];
+static FILE *output = NULL;
+static FILE *report = NULL;
+
+static void CoordinatorUsage() {
+	printf("usage: gambit coordinator <in.epd> | --fen \"<fen>\" [--port N] [--depth N] [--nodes N]\n");
+	printf("                          [--movetime ms] [--split] [--share-tt depth] [--attempts N]\n");
+	printf("                          [--order input|completed] [--out file]\n");
+}
+
+int Cluster_ParseCoordinatorOptions(ClusterOptions *options, const int argc, char *argv[]) {
+
+	int index = 1;
+	int depthGiven = BOOL_TYPE_FALSE;
+
+	memset(options, 0, sizeof(ClusterOptions));
+	options->port = CLUSTER_DEFAULT_PORT;
+	options->ordered = BOOL_TYPE_TRUE;
+	options->attempts = CLUSTER_DEFAULT_ATTEMPTS;
+
+	if(argc >= 2 && strcmp(argv[0], "--fen") == 0) {
+		options->rootFen = argv[1];
+		index = 2;
+	} else if(argc >= 1 && argv[0][0] != '-') {
+		options->inPath = argv[0];
+	} else {
+		CoordinatorUsage();
+		return BOOL_TYPE_FALSE;
+	}
+
+	for(; index < argc; ++index) {
+		const char *value = index + 1 < argc ? argv[index + 1] : NULL;
+
+		if(strcmp(argv[index], "--split") == 0) {
+			options->split = BOOL_TYPE_TRUE;
+			continue;
+		}
+		if(value == NULL) {
+			CoordinatorUsage();
+			return BOOL_TYPE_FALSE;
+		}
+		if(strcmp(argv[index], "--port") == 0) {
+			options->port = atoi(value);
+		} else if(strcmp(argv[index], "--depth") == 0) {
+			options->depth = atoi(value);
+			depthGiven = BOOL_TYPE_TRUE;
+		} else if(strcmp(argv[index], "--nodes") == 0) {
+			options->nodes = atol(value);
+		} else if(strcmp(argv[index], "--movetime") == 0) {
+			options->movetime = atoi(value);
+		} else if(strcmp(argv[index], "--share-tt") == 0) {
+			options->shareDepth = atoi(value);
+		} else if(strcmp(argv[index], "--attempts") == 0) {
+			options->attempts = atoi(value);
+		} else if(strcmp(argv[index], "--out") == 0) {
+			options->outPath = value;
+		} else if(strcmp(argv[index], "--order") == 0 && strcmp(value, "input") == 0) {
+			options->ordered = BOOL_TYPE_TRUE;
+		} else if(strcmp(argv[index], "--order") == 0 && strcmp(value, "completed") == 0) {
+			options->ordered = BOOL_TYPE_FALSE;
+		} else {
+			CoordinatorUsage();
+			return BOOL_TYPE_FALSE;
+		}
+		index++;
+	}
+
+	// a node or time limit alone searches as deep as it allows
+	if(!depthGiven) {
+		options->depth = options->nodes > 0 || options->movetime > 0 ? CHESS_MAX_SEARCH_DEPTH - 1 : ANALYSE_DEFAULT_DEPTH;
+	}
+	if(options->depth < 1) options->depth = 1;
+	if(options->depth > CHESS_MAX_SEARCH_DEPTH - 1) options->depth = CHESS_MAX_SEARCH_DEPTH - 1;
+	if(options->port < 1 || options->port > 65535) options->port = CLUSTER_DEFAULT_PORT;
+	if(options->shareDepth < 0) options->shareDepth = 0;
+	if(options->attempts < 1) options->attempts = 1;
+	return BOOL_TYPE_TRUE;
+}
+
+static int Grow(void **array, int *capacity, const int count, const size_t size) {
+
+	void *grown = NULL;
+	int newCapacity = *capacity > 0 ? *capacity * 2 : 256;
+
+	if(count < *capacity) {
+		return BOOL_TYPE_TRUE;
+	}
+	grown = realloc(*array, (size_t)newCapacity * size);
+	if(grown == NULL) {
+		return BOOL_TYPE_FALSE;
+	}
+	*array = grown;
+	*capacity = newCapacity;
+	return BOOL_TYPE_TRUE;
+}
+
+/* --- results --- */
+
+static void WriteUnit(ClusterUnit *unit) {
+
+	ClusterGroup *group = &groups[unit->group];
+
+	Analyse_WriteResult(output, group->lineNumber, group->id, group->fen, unit->result, unit->error);
+	free(unit->result);
+	unit->result = NULL;
+}
+
+static void FinishUnit(const int index, SearchResult *result, const char *error) {
+
+	ClusterUnit *unit = &units[index];
+	ClusterGroup *group = &groups[unit->group];
+
+	unit->state = UNIT_DONE;
+	unit->result = result;
+	unit->error = error;
+	doneCount++;
+	if(error != NULL) {
+		failedCount++;
+	} else {
+		totalNodes += result->nodes;
+		if(result->score > group->bestScore) {
+			group->bestScore = result->score;
+			group->bestMove = result->bestMove;
+		}
+	}
+
+	if(--group->unitsLeft == 0 && group->unitCount > 1 && group->bestMove != NOMOVE) {
+		fprintf(report, "coordinator: line %d%s%s best %s ", group->lineNumber, group->id[0] != '\0' ? " " : "", group->id,
+			PrMove(group->bestMove));
+		PrintScore(report, group->bestScore);
+		fprintf(report, " of %d root moves\n", group->unitCount);
+	}
+
+	if(!settings->ordered) {
+		WriteUnit(unit);
+	} else {
+		// a unit finished early waits for every earlier one
+		while(writeNext < unitCount && units[writeNext].state == UNIT_DONE) {
+			WriteUnit(&units[writeNext]);
+			writeNext++;
+		}
+	}
+}
+
+// the worker searched the position after the root move; seen from the
+// root the score changes sign and a mate is one ply further away
+static void FromRoot(SearchResult *result, const int rootMove) {
+
+	int length = result->pvLength < CHESS_MAX_SEARCH_DEPTH - 1 ? result->pvLength : CHESS_MAX_SEARCH_DEPTH - 1;
+
+	memmove(result->pv + 1, result->pv, length * sizeof(int));
+	result->pv[0] = rootMove;
+	result->pvLength = length + 1;
+	result->bestMove = rootMove;
+	if(result->score > CHESS_IS_MATE) {
+		result->score = -result->score + 1;
+	} else if(result->score < -CHESS_IS_MATE) {
+		result->score = -result->score - 1;
+	} else {
+		result->score = -result->score;
+	}
+	result->depth++;
+	result->seldepth++;
+}
+
+// "<bestmove> <score> <depth> <seldepth> <nodes> <time> [pv...]", the
+// moves checked against the unit's position
+static int ParseResult(const ClusterUnit *unit, char *text, SearchResult *result) {
+
+	ClusterGroup *group = &groups[unit->group];
+	char token[16];
+	int offset = 0;
+	int rootMove = NOMOVE;
+	int move = NOMOVE;
+
+	memset(result, 0, sizeof(SearchResult));
+	if(sscanf(text, "%15s %d %d %d %ld %d%n", token, &result->score, &result->depth, &result->seldepth,
+		&result->nodes, &result->timeMs, &offset) != 6) {
+		return BOOL_TYPE_FALSE;
+	}
+	if(result->score < -CHESS_INFINITE || result->score > CHESS_INFINITE || Board_ParseFromFEN(group->fen, resultBoard) != 0) {
+		return BOOL_TYPE_FALSE;
+	}
+	if(unit->move[0] != '-') {
+		rootMove = Move_Parse((char *)unit->move, resultBoard);
+		if(rootMove == NOMOVE || !Move_Make(resultBoard, rootMove)) {
+			return BOOL_TYPE_FALSE;
+		}
+		resultBoard->ply = 0;
+	}
+	result->bestMove = strcmp(token, "0000") != 0 ? Move_Parse(token, resultBoard) : NOMOVE;
+
+	text += offset;
+	while(result->pvLength < CHESS_MAX_SEARCH_DEPTH - 1 && sscanf(text, "%15s%n", token, &offset) == 1) {
+		text += offset;
+		move = Move_Parse(token, resultBoard);
+		if(move == NOMOVE || !Move_Make(resultBoard, move)) {
+			break;
+		}
+		resultBoard->ply = 0;
+		result->pv[result->pvLength++] = move;
+	}
+
+	if(rootMove != NOMOVE) {
+		FromRoot(result, rootMove);
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+/* --- input --- */
+
+static int AddUnit(const int group, const char *move) {
+
+	ClusterUnit *unit = NULL;
+
+	if(!Grow((void **)&units, &unitCapacity, unitCount, sizeof(ClusterUnit))) {
+		return BOOL_TYPE_FALSE;
+	}
+	unit = &units[unitCount++];
+	memset(unit, 0, sizeof(ClusterUnit));
+	unit->group = group;
+	unit->peer = -1;
+	strncpy(unit->move, move, CLUSTER_MOVE - 1);
+	unit->state = UNIT_QUEUED;
+	groups[group].unitCount++;
+	groups[group].unitsLeft++;
+	return BOOL_TYPE_TRUE;
+}
+
+// one group per position, with a unit per root move when splitting; a
+// bad FEN is answered here and never dispatched
+static int AddPosition(const char *fen, const char *id, const int lineNumber) {
+
+	ClusterGroup *group = NULL;
+	MoveList list[1];
+	int index = 0;
+	int valid = BOOL_TYPE_FALSE;
+
+	if(!Grow((void **)&groups, &groupCapacity, groupCount, sizeof(ClusterGroup))) {
+		return BOOL_TYPE_FALSE;
+	}
+	group = &groups[groupCount];
+	memset(group, 0, sizeof(ClusterGroup));
+	group->fen = (char *)malloc(strlen(fen) + 1);
+	if(group->fen == NULL) {
+		return BOOL_TYPE_FALSE;
+	}
+	strcpy(group->fen, fen);
+	strncpy(group->id, id, ANALYSE_ID - 1);
+	group->lineNumber = lineNumber;
+	group->bestMove = NOMOVE;
+	group->bestScore = -CHESS_INFINITE - 1;
+	groupCount++;
+
+	valid = Board_IsValidFen(group->fen) && Board_ParseFromFEN(group->fen, resultBoard) == 0;
+	list->count = 0;
+	if(valid && settings->split) {
+		Move_GenerateLegal(resultBoard, list);
+	}
+	if(list->count == 0) {
+		if(!AddUnit(groupCount - 1, "-")) {
+			return BOOL_TYPE_FALSE;
+		}
+		if(!valid) {
+			FinishUnit(unitCount - 1, NULL, "bad fen");
+		}
+		return BOOL_TYPE_TRUE;
+	}
+	for(index = 0; index < list->count; ++index) {
+		if(!AddUnit(groupCount - 1, PrMove(list->moves[index].move))) {
+			return BOOL_TYPE_FALSE;
+		}
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+static int ReadPositions() {
+
+	FILE *file = NULL;
+	char text[ANALYSE_LINE];
+	char fen[ANALYSE_LINE];
+	char id[ANALYSE_ID];
+	int lineNumber = 0;
+	int length = 0;
+
+	if(settings->rootFen != NULL) {
+		return AddPosition(settings->rootFen, "", 1);
+	}
+
+	file = fopen(settings->inPath, "r");
+	if(file == NULL) {
+		printf("coordinator: cannot open %s\n", settings->inPath);
+		return BOOL_TYPE_FALSE;
+	}
+	while(fgets(text, sizeof(text), file) != NULL) {
+		lineNumber++;
+		length = (int)strlen(text);
+		if(length == ANALYSE_LINE - 1 && text[length - 1] != '\n') {
+			int skipped = 0;
+			while((skipped = fgetc(file)) != EOF && skipped != '\n');
+		}
+		if(Analyse_ParseLine(text, fen, id) && !AddPosition(fen, id, lineNumber)) {
+			printf("coordinator: out of memory at line %d\n", lineNumber);
+			fclose(file);
+			return BOOL_TYPE_FALSE;
+		}
+	}
+	fclose(file);
+	return BOOL_TYPE_TRUE;
+}
+
+/* --- workers --- */
+
+static void DropPeer(const int index, const char *reason) {
+
+	ClusterPeer *peer = &peers[index];
+	int lost = 0;
+	int unit = 0;
+
+	CloseSocket(peer->reader->sock);
+	peer->reader->sock = CLUSTER_NO_SOCKET;
+	for(unit = 0; unit < unitCount && peer->busy > 0; ++unit) {
+		if(units[unit].state != UNIT_RUNNING || units[unit].peer != index) {
+			continue;
+		}
+		peer->busy--;
+		lost++;
+		if(units[unit].attempts >= settings->attempts) {
+			FinishUnit(unit, NULL, "worker lost");
+		} else {
+			units[unit].state = UNIT_QUEUED;
+			units[unit].peer = -1;
+			requeued[requeuedCount++] = unit;
+			requeueTotal++;
+		}
+	}
+	if(peer->ready) {
+		fprintf(report, "coordinator: worker %s %s after %d unit(s), %d unit(s) returned to the queue\n",
+			peer->name, reason, peer->done, lost);
+	}
+}
+
+static void AcceptPeer(const ClusterSocket listener) {
+
+	struct sockaddr_storage address;
+	socklen_t addressLength = sizeof(address);
+	ClusterSocket sock = accept(listener, (struct sockaddr *)&address, &addressLength);
+	ClusterPeer *peer = NULL;
+	int index = 0;
+
+	if(sock == CLUSTER_NO_SOCKET) {
+		return;
+	}
+	for(index = 0; index < CLUSTER_MAX_WORKERS && peers[index].reader->sock != CLUSTER_NO_SOCKET; ++index);
+	if(index == CLUSTER_MAX_WORKERS) {
+		CloseSocket(sock);
+		return;
+	}
+
+	peer = &peers[index];
+	memset(peer, 0, sizeof(ClusterPeer));
+	peer->reader->sock = sock;
+	if(getnameinfo((struct sockaddr *)&address, addressLength, peer->name, sizeof(peer->name), NULL, 0, NI_NUMERICHOST) != 0) {
+		strcpy(peer->name, "?");
+	}
+	Socket_Tune(sock);
+}
+
+static void HandleHello(const int index, const char *line) {
+
+	ClusterPeer *peer = &peers[index];
+	char name[CLUSTER_NAME];
+	int protocol = 0;
+	int slots = 0;
+	int length = (int)strlen(peer->name);
+
+	name[0] = '\0';
+	if(sscanf(line, "hello %d %d %40s", &protocol, &slots, name) < 2 || protocol != CLUSTER_PROTOCOL) {
+		fprintf(report, "coordinator: %s speaks another protocol, refused\n", peer->name);
+		DropPeer(index, "refused");
+		return;
+	}
+	if(slots < 1) slots = 1;
+	if(slots > CHESS_MAX_THREADS) slots = CHESS_MAX_THREADS;
+	if(name[0] != '\0' && length + (int)strlen(name) + 4 < CLUSTER_NAME) {
+		strcat(strcat(strcat(peer->name, " ("), name), ")");
+	}
+	if(!Socket_SendLine(peer->reader->sock, "config %d %d", CLUSTER_PROTOCOL, settings->shareDepth)) {
+		DropPeer(index, "disconnected");
+		return;
+	}
+	peer->slots = slots;
+	peer->ready = BOOL_TYPE_TRUE;
+	fprintf(report, "coordinator: worker %s connected, %d thread(s)\n", peer->name, slots);
+}
+
+static void HandleResult(const int index, const char *line) {
+
+	ClusterPeer *peer = &peers[index];
+	SearchResult *result = NULL;
+	int unit = -1;
+	int offset = 0;
+
+	if(sscanf(line, "result %d %n", &unit, &offset) < 1 || unit < 0 || unit >= unitCount
+		|| units[unit].state != UNIT_RUNNING || units[unit].peer != index) {
+		return;
+	}
+	peer->busy--;
+	peer->done++;
+
+	if(strncmp(line + offset, "error", 5) == 0) {
+		FinishUnit(unit, NULL, "worker error");
+		return;
+	}
+	result = (SearchResult *)malloc(sizeof(SearchResult));
+	if(result == NULL || !ParseResult(&units[unit], (char *)line + offset, result)) {
+		free(result);
+		FinishUnit(unit, NULL, "bad result");
+		return;
+	}
+	FinishUnit(unit, result, NULL);
+}
+
+// an entry one worker found is passed on to all the others
+static void ForwardEntry(const int index, const char *line) {
+
+	int other = 0;
+
+	if(settings->shareDepth <= 0) {
+		return;
+	}
+	sharedEntries++;
+	for(other = 0; other < CLUSTER_MAX_WORKERS; ++other) {
+		if(other != index && peers[other].reader->sock != CLUSTER_NO_SOCKET && peers[other].ready
+			&& !Socket_SendLine(peers[other].reader->sock, "%s", line)) {
+			DropPeer(other, "disconnected");
+		}
+	}
+}
+
+static void ReadPeer(const int index) {
+
+	ClusterPeer *peer = &peers[index];
+	char *line = NULL;
+	int offset = 0;
+
+	if(!Reader_Fill(peer->reader)) {
+		DropPeer(index, "disconnected");
+		return;
+	}
+	while(peer->reader->sock != CLUSTER_NO_SOCKET && (line = Reader_Next(peer->reader, &offset)) != NULL) {
+		if(strncmp(line, "hello ", 6) == 0 && !peer->ready) {
+			HandleHello(index, line);
+		} else if(!peer->ready) {
+			DropPeer(index, "refused");
+		} else if(strncmp(line, "result ", 7) == 0) {
+			HandleResult(index, line);
+		} else if(strncmp(line, "tt ", 3) == 0) {
+			ForwardEntry(index, line);
+		}
+	}
+}
+
+static int NextUnit() {
+
+	if(requeuedCount > 0) {
+		return requeued[--requeuedCount];
+	}
+	while(nextUnit < unitCount && units[nextUnit].state != UNIT_QUEUED) {
+		nextUnit++;
+	}
+	return nextUnit < unitCount ? nextUnit++ : -1;
+}
+
+static void Dispatch() {
+
+	ClusterPeer *peer = NULL;
+	ClusterUnit *unit = NULL;
+	int index = 0;
+	int next = 0;
+	int depth = 0;
+
+	for(index = 0; index < CLUSTER_MAX_WORKERS; ++index) {
+		peer = &peers[index];
+		while(peer->reader->sock != CLUSTER_NO_SOCKET && peer->ready && peer->busy < peer->slots) {
+			if((next = NextUnit()) < 0) {
+				return;
+			}
+			unit = &units[next];
+			unit->state = UNIT_RUNNING;
+			unit->peer = index;
+			unit->attempts++;
+			peer->busy++;
+
+			// a root move is one ply of the requested depth
+			depth = unit->move[0] != '-' && settings->depth > 1 ? settings->depth - 1 : settings->depth;
+			if(!Socket_SendLine(peer->reader->sock, "unit %d %d %ld %d %s %s", next, depth, settings->nodes,
+				settings->movetime, unit->move, groups[unit->group].fen)) {
+				DropPeer(index, "disconnected");
+			}
+		}
+	}
+}
+
+static ClusterSocket Listen(const int port) {
+
+	struct sockaddr_in address;
+	ClusterSocket listener = socket(AF_INET, SOCK_STREAM, 0);
+	int on = 1;
+
+	if(listener == CLUSTER_NO_SOCKET) {
+		return CLUSTER_NO_SOCKET;
+	}
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char *)&on, sizeof(on));
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons((unsigned short)port);
+	if(bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+		CloseSocket(listener);
+		return CLUSTER_NO_SOCKET;
+	}
+	return listener;
+}
+
+static void FreeCoordinator() {
+
+	int index = 0;
+
+	for(index = 0; index < unitCount; ++index) {
+		free(units[index].result);
+	}
+	for(index = 0; index < groupCount; ++index) {
+		free(groups[index].fen);
+	}
+	free(units);
+	free(groups);
+	free(requeued);
+	free(peers);
+	units = NULL;
+	groups = NULL;
+	requeued = NULL;
+	peers = NULL;
+	unitCount = unitCapacity = 0;
+	groupCount = groupCapacity = 0;
+}
+
+int Cluster_RunCoordinator(const ClusterOptions *options) {
+
+	ClusterSocket listener = CLUSTER_NO_SOCKET;
+	int index = 0;
+	int result = -1;
+
+	report = options->outPath != NULL ? stdout : stderr;
+	output = options->outPath != NULL ? fopen(options->outPath, "w") : stdout;
+	if(output == NULL) {
+		printf("coordinator: cannot write %s\n", options->outPath);
+		return -1;
+	}
+
+	settings = options;
+	requeuedCount = 0;
+	nextUnit = 0;
+	writeNext = 0;
+	doneCount = 0;
+	failedCount = 0;
+	requeueTotal = 0;
+	totalNodes = 0;
+	sharedEntries = 0;
+	Board_Init(resultBoard);
+	peers = (ClusterPeer *) malloc(CLUSTER_MAX_WORKERS * sizeof(ClusterPeer));
+
+	if(peers == NULL) {
+		printf("coordinator: allocation failed\n");
+		goto done;
+	}
+	if(!ReadPositions()) {
+		goto done;
+	}
+	requeued = (int *) malloc((unitCount + 1) * sizeof(int));
+	if(requeued == NULL) {
+		printf("coordinator: allocation failed\n");
+		goto done;
+	}
+	for(index = 0; index < CLUSTER_MAX_WORKERS; ++index) {
+		peers[index].reader->sock = CLUSTER_NO_SOCKET;
+	}
+
+	if(!Sockets_Start()) {
+		printf("coordinator: sockets unavailable\n");
+		goto done;
+	}
+	listener = Listen(options->port);
+	if(listener == CLUSTER_NO_SOCKET) {
+		printf("coordinator: cannot listen on port %d\n", options->port);
+		Sockets_Stop();
+		goto done;
+	}
+
+	fprintf(report, "coordinator: %s, %d position(s), %d unit(s), depth %d, nodes %ld, movetime %d, port %d, tt sharing %s\n",
+		options->rootFen != NULL ? "root position" : options->inPath, groupCount, unitCount, options->depth,
+		options->nodes, options->movetime, options->port, options->shareDepth > 0 ? "on" : "off");
+	int start = Misc_GetTimeMs();
+
+	while(doneCount < unitCount) {
+		fd_set readable;
+		struct timeval timeout;
+		ClusterSocket highest = listener;
+
+		FD_ZERO(&readable);
+		FD_SET(listener, &readable);
+		for(index = 0; index < CLUSTER_MAX_WORKERS; ++index) {
+			if(peers[index].reader->sock != CLUSTER_NO_SOCKET) {
+				FD_SET(peers[index].reader->sock, &readable);
+				if(peers[index].reader->sock > highest) highest = peers[index].reader->sock;
+			}
+		}
+		timeout.tv_sec = 1;
+		timeout.tv_usec = 0;
+		if(select((int)highest + 1, &readable, NULL, NULL, &timeout) < 0) {
+#ifndef _WIN32
+			if(errno == EINTR) continue;
+#endif
+			printf("coordinator: select failed\n");
+			break;
+		}
+
+		if(FD_ISSET(listener, &readable)) {
+			AcceptPeer(listener);
+		}
+		for(index = 0; index < CLUSTER_MAX_WORKERS; ++index) {
+			if(peers[index].reader->sock != CLUSTER_NO_SOCKET && FD_ISSET(peers[index].reader->sock, &readable)) {
+				ReadPeer(index);
+			}
+		}
+		Dispatch();
+	}
+
+	for(index = 0; index < CLUSTER_MAX_WORKERS; ++index) {
+		if(peers[index].reader->sock != CLUSTER_NO_SOCKET) {
+			Socket_SendLine(peers[index].reader->sock, "quit");
+			CloseSocket(peers[index].reader->sock);
+		}
+	}
+	CloseSocket(listener);
+	Sockets_Stop();
+
+	int elapsed = Misc_GetTimeMs() - start;
+	fprintf(report, "coordinator result units=%d failed=%d requeued=%d shared=%ld nodes=%ld time=%d nps=%ld\n",
+		unitCount, failedCount, requeueTotal, sharedEntries, totalNodes, elapsed,
+		elapsed > 0 ? totalNodes * 1000 / elapsed : totalNodes);
+	result = doneCount < unitCount ? -1 : failedCount;
+
+done:
+	if(output != stdout) {
+		fclose(output);
+	}
+	Board_Free(resultBoard);
+	FreeCoordinator();
+	settings = NULL;
+	output = NULL;
+	return result;
+}
+
+/* ===========================================================================
+ * WORKER
+ * ===========================================================================
+ */
+
+typedef struct {
+	int id;
+	int depth;
+	long nodes;
+	int movetime;
+	char move[CLUSTER_MOVE];
+	char fen[ANALYSE_LINE];
+} WorkerUnit;
+
+typedef struct {
+	ChessBoard board[1];
+	SearchInfo info[1];
+	int searching;
+	pthread_t handle;
+} WorkerSlot;
+
+static ClusterSocket coordinator = CLUSTER_NO_SOCKET;
+static int workerShareDepth = 0;
+static WorkerUnit workerQueue[CHESS_MAX_THREADS];
+static int queueHead = 0;
+static int queueTail = 0;
+static int workerQuit = BOOL_TYPE_FALSE;
+static int workerDone = 0;
+static pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t unitQueued = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t sendLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void WorkerUsage() {
+	printf("usage: gambit worker <host>[:port] [--threads N] [--hash MB] [--connect-timeout s]\n");
+}
+
+int Cluster_ParseWorkerOptions(ClusterOptions *options, const int argc, char *argv[]) {
+
+	static char host[256];
+	char *colon = NULL;
+	int index = 0;
+
+	memset(options, 0, sizeof(ClusterOptions));
+	options->port = CLUSTER_DEFAULT_PORT;
+	options->threads = 1;
+	options->hashMB = CLUSTER_DEFAULT_HASH;
+	options->connectSeconds = CLUSTER_CONNECT_SECONDS;
+
+	if(argc < 1 || argv[0][0] == '-') {
+		WorkerUsage();
+		return BOOL_TYPE_FALSE;
+	}
+	strncpy(host, argv[0], sizeof(host) - 1);
+	host[sizeof(host) - 1] = '\0';
+	colon = strrchr(host, ':');
+	if(colon != NULL) {
+		*colon = '\0';
+		options->port = atoi(colon + 1);
+	}
+	options->host = host;
+
+	for(index = 1; index < argc; ++index) {
+		const char *value = index + 1 < argc ? argv[index + 1] : NULL;
+
+		if(value == NULL) {
+			WorkerUsage();
+			return BOOL_TYPE_FALSE;
+		}
+		if(strcmp(argv[index], "--threads") == 0) {
+			options->threads = atoi(value);
+		} else if(strcmp(argv[index], "--hash") == 0) {
+			options->hashMB = atoi(value);
+		} else if(strcmp(argv[index], "--connect-timeout") == 0) {
+			options->connectSeconds = atoi(value);
+		} else {
+			WorkerUsage();
+			return BOOL_TYPE_FALSE;
+		}
+		index++;
+	}
+
+	if(options->port < 1 || options->port > 65535) options->port = CLUSTER_DEFAULT_PORT;
+	if(options->threads < 1) options->threads = 1;
+	if(options->threads > CHESS_MAX_THREADS) options->threads = CHESS_MAX_THREADS;
+	if(options->hashMB < 1) options->hashMB = 1;
+	if(options->hashMB > CHESS_MAX_HASH) options->hashMB = CHESS_MAX_HASH;
+	if(options->connectSeconds < 0) options->connectSeconds = 0;
+	return BOOL_TYPE_TRUE;
+}
+
+// every address of the host in turn, again each second until it
+// answers, so workers may start before the coordinator
+static ClusterSocket Connect(const char *host, const int port, const int seconds) {
+
+	struct addrinfo hints;
+	struct addrinfo *addresses = NULL;
+	struct addrinfo *address = NULL;
+	ClusterSocket sock = CLUSTER_NO_SOCKET;
+	char service[16];
+	int deadline = Misc_GetTimeMs() + seconds * 1000;
+	int waiting = BOOL_TYPE_FALSE;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	sprintf(service, "%d", port);
+
+	while(BOOL_TYPE_TRUE) {
+		if(getaddrinfo(host, service, &hints, &addresses) == 0) {
+			for(address = addresses; address != NULL; address = address->ai_next) {
+				sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+				if(sock == CLUSTER_NO_SOCKET) {
+					continue;
+				}
+				if(connect(sock, address->ai_addr, (int)address->ai_addrlen) == 0) {
+					break;
+				}
+				CloseSocket(sock);
+				sock = CLUSTER_NO_SOCKET;
+			}
+			freeaddrinfo(addresses);
+		}
+		if(sock != CLUSTER_NO_SOCKET || Misc_GetTimeMs() >= deadline) {
+			return sock;
+		}
+		if(!waiting) {
+			printf("worker: waiting for the coordinator at %s:%d\n", host, port);
+			waiting = BOOL_TYPE_TRUE;
+		}
+		Misc_Sleep(1000);
+	}
+}
+
+static void SendResult(const WorkerUnit *unit, const SearchResult *result) {
+
+	char text[CLUSTER_LINE];
+	int length = 0;
+	int index = 0;
+
+	length = sprintf(text, "result %d %s %d %d %d %ld %d", unit->id,
+		result->bestMove != NOMOVE ? PrMove(result->bestMove) : "0000",
+		result->score, result->depth, result->seldepth, result->nodes, result->timeMs);
+	for(index = 0; index < result->pvLength && length < CLUSTER_LINE - 16; ++index) {
+		length += sprintf(text + length, " %s", PrMove(result->pv[index]));
+	}
+	Socket_SendLine(coordinator, "%s", text);
+}
+
+// the exact entries along the PV, deep enough to be worth another
+// worker's time; board is at the unit's position
+static void ShareEntries(ChessBoard *board, const SearchResult *result) {
+
+	PackedMove move = 0;
+	int score = 0;
+	int depth = 0;
+	int flags = HFNONE;
+	int made = 0;
+
+	for(made = 0; made <= result->pvLength; ++made) {
+		if(HashTable_ExportEntry(board->HashTable, board->posKey, &move, &score, &depth, &flags)
+			&& flags == HFEXACT && depth >= workerShareDepth) {
+			Socket_SendLine(coordinator, "tt %016llx %u %d %d", (unsigned long long)board->posKey, (unsigned)move, score, depth);
+		}
+		if(made == result->pvLength || !Move_Make(board, result->pv[made])) {
+			break;
+		}
+	}
+	while(made-- > 0) {
+		Move_Take(board);
+	}
+}
+
+static void SearchUnit(WorkerSlot *slot, WorkerUnit *unit) {
+
+	SearchResult result;
+	int rootMove = NOMOVE;
+	int valid = Board_ParseFromFEN(unit->fen, slot->board) == 0;
+
+	if(valid && unit->move[0] != '-') {
+		rootMove = Move_Parse(unit->move, slot->board);
+		valid = rootMove != NOMOVE && Move_Make(slot->board, rootMove);
+	}
+	if(!valid) {
+		pthread_mutex_lock(&sendLock);
+		Socket_SendLine(coordinator, "result %d error bad position", unit->id);
+		pthread_mutex_unlock(&sendLock);
+		return;
+	}
+
+	Analyse_Position(slot->board, slot->info, unit->depth, unit->nodes, unit->movetime, &result);
+
+	pthread_mutex_lock(&sendLock);
+	SendResult(unit, &result);
+	if(workerShareDepth > 0) {
+		ShareEntries(slot->board, &result);
+	}
+	pthread_mutex_unlock(&sendLock);
+}
+
+static void *WorkerThread(void *arg) {
+
+	WorkerSlot *slot = (WorkerSlot *)arg;
+	WorkerUnit unit;
+
+	pthread_mutex_lock(&queueLock);
+	while(BOOL_TYPE_TRUE) {
+		while(queueHead == queueTail && !workerQuit) {
+			pthread_cond_wait(&unitQueued, &queueLock);
+		}
+		if(workerQuit) {
+			break;
+		}
+		unit = workerQueue[queueHead % CHESS_MAX_THREADS];
+		queueHead++;
+		// cleared under the lock, so a stop raised for this search is never lost
+		memset(slot->info, 0, sizeof(SearchInfo));
+		slot->searching = BOOL_TYPE_TRUE;
+		pthread_mutex_unlock(&queueLock);
+
+		SearchUnit(slot, &unit);
+
+		pthread_mutex_lock(&queueLock);
+		slot->searching = BOOL_TYPE_FALSE;
+		workerDone++;
+	}
+	pthread_mutex_unlock(&queueLock);
+	PROFILE_FLUSH();
+	return NULL;
+}
+
+static void QueueUnit(const char *line) {
+
+	WorkerUnit *unit = NULL;
+	int offset = 0;
+
+	pthread_mutex_lock(&queueLock);
+	if(queueTail - queueHead < CHESS_MAX_THREADS) {
+		unit = &workerQueue[queueTail % CHESS_MAX_THREADS];
+		if(sscanf(line, "unit %d %d %ld %d %7s %n", &unit->id, &unit->depth, &unit->nodes, &unit->movetime,
+			unit->move, &offset) == 5 && offset > 0) {
+			strncpy(unit->fen, line + offset, ANALYSE_LINE - 1);
+			unit->fen[ANALYSE_LINE - 1] = '\0';
+			queueTail++;
+			pthread_cond_signal(&unitQueued);
+		}
+	}
+	pthread_mutex_unlock(&queueLock);
+}
+
+static void ImportEntry(const char *line) {
+
+	unsigned long long key = 0;
+	unsigned move = 0;
+	int score = 0;
+	int depth = 0;
+
+	if(sscanf(line, "tt %llx %u %d %d", &key, &move, &score, &depth) == 4) {
+		HashTable_ImportEntry(g_hashTable, (U64)key, (PackedMove)move, score, depth, HFEXACT);
+	}
+}
+
+// BOOL_TYPE_FALSE once the coordinator ends the run
+static int HandleMessage(const char *line) {
+
+	if(strncmp(line, "unit ", 5) == 0) {
+		QueueUnit(line);
+	} else if(strncmp(line, "tt ", 3) == 0) {
+		ImportEntry(line);
+	} else if(strcmp(line, "quit") == 0) {
+		return BOOL_TYPE_FALSE;
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+int Cluster_RunWorker(const ClusterOptions *options) {
+
+	LineReader *reader = NULL;
+	WorkerSlot *slots = NULL;
+	char name[CLUSTER_NAME];
+	char *line = NULL;
+	int configured = BOOL_TYPE_FALSE;
+	int ended = BOOL_TYPE_FALSE;
+	int started = 0;
+	int offset = 0;
+	int index = 0;
+	int protocol = 0;
+
+	reader = (LineReader *) malloc(sizeof(LineReader));
+	slots = (WorkerSlot *) calloc(options->threads, sizeof(WorkerSlot));
+	if(reader == NULL || slots == NULL || !Sockets_Start()) {
+		printf("worker: cannot start\n");
+		free(reader);
+		free(slots);
+		return 1;
+	}
+
+	coordinator = Connect(options->host, options->port, options->connectSeconds);
+	if(coordinator == CLUSTER_NO_SOCKET) {
+		printf("worker: cannot reach %s:%d\n", options->host, options->port);
+		Sockets_Stop();
+		free(reader);
+		free(slots);
+		return 1;
+	}
+	Socket_Tune(coordinator);
+	reader->sock = coordinator;
+	reader->length = 0;
+
+	if(gethostname(name, sizeof(name)) != 0) {
+		strcpy(name, "-");
+	}
+	name[sizeof(name) - 1] = '\0';
+	Socket_SendLine(coordinator, "hello %d %d %s", CLUSTER_PROTOCOL, options->threads, name);
+
+	// nothing is searched before the coordinator has accepted us
+	while(!configured && Reader_Fill(reader)) {
+		while(!configured && (line = Reader_Next(reader, &offset)) != NULL) {
+			configured = sscanf(line, "config %d %d", &protocol, &workerShareDepth) == 2 && protocol == CLUSTER_PROTOCOL;
+		}
+	}
+	if(!configured) {
+		printf("worker: refused by %s:%d\n", options->host, options->port);
+		CloseSocket(coordinator);
+		Sockets_Stop();
+		free(reader);
+		free(slots);
+		return 1;
+	}
+
+	HashTable_Init(g_hashTable, options->hashMB);
+	queueHead = queueTail = 0;
+	workerQuit = BOOL_TYPE_FALSE;
+	workerDone = 0;
+	for(index = 0; index < options->threads; ++index) {
+		Board_Init(slots[index].board);
+		slots[index].board->HashTable = g_hashTable;
+		if(pthread_create(&slots[index].handle, NULL, WorkerThread, &slots[index]) != 0) {
+			Board_Free(slots[index].board);
+			break;
+		}
+		started++;
+	}
+	printf("worker: connected to %s:%d, %d thread(s), hash %dMB, tt sharing %s\n", options->host, options->port,
+		started, options->hashMB, workerShareDepth > 0 ? "on" : "off");
+
+	// lines that came in with config first, then whatever arrives
+	do {
+		while(!ended && (line = Reader_Next(reader, &offset)) != NULL) {
+			ended = !HandleMessage(line);
+		}
+	} while(!ended && started > 0 && Reader_Fill(reader));
+
+	// a lost coordinator stops the searches still running
+	pthread_mutex_lock(&queueLock);
+	workerQuit = BOOL_TYPE_TRUE;
+	for(index = 0; index < started; ++index) {
+		if(slots[index].searching) {
+			STOP_STORE(&slots[index].info->stopRequest, BOOL_TYPE_TRUE);
+		}
+	}
+	pthread_cond_broadcast(&unitQueued);
+	pthread_mutex_unlock(&queueLock);
+	for(index = 0; index < started; ++index) {
+		pthread_join(slots[index].handle, NULL);
+		Board_Free(slots[index].board);
+	}
+	CloseSocket(coordinator);
+	coordinator = CLUSTER_NO_SOCKET;
+	Sockets_Stop();
+
+	printf("worker: %d unit(s) searched, %s\n", workerDone, ended ? "run complete" : "connection lost");
+	free(reader);
+	free(slots);
+	return ended ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file search_movepicker.c
+ * @brief Staged, lazy move picker for the search
+ *
+ * Hands out the moves of a node one at a time, generating them only
+ * when the previous stage is exhausted:
+ * - Hash move (validated by the probe, no generation)
+ * - Winning and equal captures (MVV-LVA order)
+ * - Killer moves (validated with Move_IsLegal)
+ * - Quiet moves (history order)
+ * - Losing captures (negative static exchange evaluation)
+ *
+ * Most cut nodes fail high on the hash move or a capture and never pay
+ * for quiet move generation. Every move handed out is legal, so the
+ * search plays it with Move_MakeLegal. Quiescence uses the same picker in
+ * captures-only mode, where losing captures are pruned. The search keeps
+ * one picker per ply in its thread's search stack.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "types_definitions.h"
+
+// selection step: move the best scored remaining entry to list->moves[index]
+static int PickBest(MoveList *list, const int index) {
+
+	Move temp;
+	int bestNum = index;
+	int bestScore = list->moves[index].score;
+	int moveNum = 0;
+
+	for(moveNum = index + 1; moveNum < list->count; ++moveNum) {
+		if(list->moves[moveNum].score > bestScore) {
+			bestScore = list->moves[moveNum].score;
+			bestNum = moveNum;
+		}
+	}
+
+	temp = list->moves[index];
+	list->moves[index] = list->moves[bestNum];
+	list->moves[bestNum] = temp;
+
+	return list->moves[index].move;
+}
+
+// only a capture of a cheaper piece can lose material, so the exchange
+// evaluation is skipped for everything else
+static int CaptureIsLosing(const ChessBoard *board, const int move) {
+
+	if(move & MFLAGEP) {
+		return BOOL_TYPE_FALSE;
+	}
+	if(g_pieceVal[board->pieces[MOVE_GET_FROM_SQUARE(move)]] <= g_pieceVal[MOVE_GET_CAPTURED(move)]) {
+		return BOOL_TYPE_FALSE;
+	}
+	return Attack_SEE(board, move) < 0;
+}
+
+void MovePicker_Init(MovePicker *picker, const ChessBoard *board, const int ttMove, const int capturesOnly) {
+
+	ASSERT(Board_Check(board));
+
+	picker->list->count = 0;
+	picker->index = 0;
+	picker->badCount = 0;
+	picker->badIndex = 0;
+	picker->capturesOnly = capturesOnly;
+
+	if(capturesOnly) {
+		picker->stage = PICK_STAGE_GEN_CAPTURES;
+		picker->ttMove = NOMOVE;
+		picker->killers[0] = NOMOVE;
+		picker->killers[1] = NOMOVE;
+	} else {
+		picker->stage = PICK_STAGE_TT;
+		picker->ttMove = ttMove;
+		picker->killers[0] = Move_Unpack(board, board->tables->stack[board->ply].killers[0]);
+		picker->killers[1] = Move_Unpack(board, board->tables->stack[board->ply].killers[1]);
+	}
+}
+
+int MovePicker_Next(MovePicker *picker, const ChessBoard *board) {
+
+	int move = NOMOVE;
+
+	while(BOOL_TYPE_TRUE) {
+		switch(picker->stage) {
+
+			case PICK_STAGE_TT:
+				picker->stage = PICK_STAGE_GEN_CAPTURES;
+				if(picker->ttMove != NOMOVE) {
+					ASSERT(Move_IsLegal(board, picker->ttMove));
+					return picker->ttMove;
+				}
+				break;
+
+			case PICK_STAGE_GEN_CAPTURES:
+				Move_GenerateLegalCaptures(board, picker->list);
+				picker->index = 0;
+				picker->stage = PICK_STAGE_CAPTURES;
+				break;
+
+			case PICK_STAGE_CAPTURES:
+				while(picker->index < picker->list->count) {
+					move = PickBest(picker->list, picker->index++);
+					if(move == picker->ttMove) {
+						continue;
+					}
+					if(CaptureIsLosing(board, move)) {
+						// quiescence never searches losing captures
+						if(!picker->capturesOnly) {
+							picker->list->moves[CHESS_MAX_POSITION_MOVES - 1 - picker->badCount++].move = move;
+						}
+						continue;
+					}
+					return move;
+				}
+				picker->stage = picker->capturesOnly ? PICK_STAGE_DONE : PICK_STAGE_KILLERS;
+				picker->index = 0;
+				break;
+
+			case PICK_STAGE_KILLERS:
+				// index counts the killer slots already tried
+				while(picker->index < 2) {
+					move = picker->killers[picker->index++];
+					if(move == NOMOVE || move == picker->ttMove || (move & MFLAGCAP)) {
+						continue;
+					}
+					if(picker->index == 2 && move == picker->killers[0]) {
+						continue;
+					}
+					if(Move_IsLegal(board, move)) {
+						return move;
+					}
+				}
+				picker->stage = PICK_STAGE_GEN_QUIETS;
+				break;
+
+			case PICK_STAGE_GEN_QUIETS:
+				Move_GenerateLegalQuiets(board, picker->list);
+				ASSERT(picker->list->count <= CHESS_MAX_POSITION_MOVES - picker->badCount);
+				picker->index = 0;
+				picker->stage = PICK_STAGE_QUIETS;
+				break;
+
+			case PICK_STAGE_QUIETS:
+				while(picker->index < picker->list->count) {
+					move = PickBest(picker->list, picker->index++);
+					if(move == picker->ttMove || move == picker->killers[0] || move == picker->killers[1]) {
+						continue;
+					}
+					return move;
+				}
+				picker->stage = PICK_STAGE_BAD_CAPTURES;
+				break;
+
+			case PICK_STAGE_BAD_CAPTURES:
+				if(picker->badIndex < picker->badCount) {
+					return picker->list->moves[CHESS_MAX_POSITION_MOVES - 1 - picker->badIndex++].move;
+				}
+				picker->stage = PICK_STAGE_DONE;
+				break;
+
+			default:
+				return NOMOVE;
+		}
+	}
+
+	return NOMOVE;
+}
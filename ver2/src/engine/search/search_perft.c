@@ -1,90 +1,415 @@
 /**
  * @file search_perft.c
  * @brief Performance testing (Perft) for move generation validation
- * 
+ *
  * Perft (Performance Test) is a debugging function that counts all
  * leaf nodes at a given depth. It's used to:
  * - Validate move generation correctness
  * - Test make/unmake move functions
  * - Benchmark move generation speed
  * - Compare with known perft values from test positions
- * 
+ *
  * The function performs an exhaustive tree search to a specified depth
  * and counts all positions reached, dividing by root move.
- * 
+ *
+ * To keep deep runs practical:
+ * - Bulk counting: at depth 1 the legal move count is the leaf count,
+ *   so the last ply is never made
+ * - Optional perft hash keyed on (posKey, depth), shared lock-free by
+ *   all threads (each slot stores key ^ data so torn writes never match)
+ * - Parallel divide: root moves are handed out to worker threads, each
+ *   searching its own copy of the board
+ * - Regression suite: every position and depth of an EPD perft file
+ *   (";D1 20 ;D2 400 ..."), positions spread over a thread pool, with a
+ *   one-line machine-readable summary at the end
+ *
  * @author Gambit Chess Team
  * @date February 2026
  */
 
 #include "types_definitions.h"
 #include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <pthread.h>
 
-long leafNodes;
+#define PERFT_SUITE_MAX_DEPTH 16
+#define PERFT_SUITE_LINE 512
 
-void Perft(int depth, ChessBoard *board) {
+/**
+ * Perft hash slot. data packs the subtree node count (upper 56 bits)
+ * with the depth (low 8 bits); check holds posKey ^ data.
+ */
+typedef struct {
+	U64 check;
+	U64 data;
+} PerftEntry;
+
+static PerftEntry *perftTable = NULL;
+static U64 perftTableMask = 0ULL;
+
+/**
+ * One perft worker: a private board plus the root move cursor it shares
+ * with the others.
+ */
+typedef struct {
+	ChessBoard board[1];
+	pthread_t handle;
+} PerftWorker;
+
+static MoveList rootList[1];
+static U64 rootNodes[CHESS_MAX_POSITION_MOVES];
+static volatile int rootNext = 0;
+
+static int PerftTable_Init(const int MB) {
+
+	U64 count = 1ULL;
+	U64 bytes = (U64)MB * 1024 * 1024;
+
+	perftTable = NULL;
+	perftTableMask = 0ULL;
+	if(MB <= 0) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	// round down to a power of two so probes are a single mask
+	while(count * 2 * sizeof(PerftEntry) <= bytes) {
+		count *= 2;
+	}
+	perftTable = (PerftEntry *) calloc(count, sizeof(PerftEntry));
+	if(perftTable == NULL) {
+		printf("Perft hash allocation failed, running without it\n");
+		return BOOL_TYPE_FALSE;
+	}
+	perftTableMask = count - 1;
+	return BOOL_TYPE_TRUE;
+}
+
+static void PerftTable_Free() {
+	free(perftTable);
+	perftTable = NULL;
+	perftTableMask = 0ULL;
+}
+
+U64 Search_Perft(ChessBoard *board, const int depth) {
 
-    ASSERT(Board_Check(board));  
+	ASSERT(Board_Check(board));
 
 	if(depth == 0) {
-        leafNodes++;
-        return;
-    }	
-
-    MoveList list[1];
-    Move_GenerateAll(board,list);
-      
-    int MoveNum = 0;
-	for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {	
-       
-        if ( !Move_Make(board,list->moves[MoveNum].move))  {
-            continue;
-        }
-        Perft(depth - 1, board);
-        Move_Take(board);
-    }
-
-    return;
+		return 1ULL;
+	}
+
+	MoveList list[1];
+	Move_GenerateLegal(board, list);
+
+	if(depth == 1) {
+		return (U64)list->count;
+	}
+
+	PerftEntry *entry = NULL;
+	if(perftTable != NULL) {
+		entry = &perftTable[board->posKey & perftTableMask];
+		U64 data = entry->data;
+		if((entry->check ^ data) == board->posKey && (int)(data & 0xFF) == depth) {
+			return data >> 8;
+		}
+	}
+
+	U64 nodes = 0ULL;
+	int MoveNum = 0;
+	for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {
+		Move_MakeLegal(board, list->moves[MoveNum].move);
+		nodes += Search_Perft(board, depth - 1);
+		Move_Take(board);
+	}
+
+	if(entry != NULL) {
+		U64 data = (nodes << 8) | (U64)depth;
+		entry->data = data;
+		entry->check = board->posKey ^ data;
+	}
+
+	return nodes;
 }
 
+// claim root moves until none are left
+static void PerftDivide(ChessBoard *board, const int depth) {
+
+	int MoveNum = 0;
+
+	while((MoveNum = __sync_fetch_and_add(&rootNext, 1)) < rootList->count) {
+		Move_MakeLegal(board, rootList->moves[MoveNum].move);
+		rootNodes[MoveNum] = Search_Perft(board, depth - 1);
+		Move_Take(board);
+	}
+}
+
+static int perftDepth = 0;
+
+static void *PerftWorkerThread(void *arg) {
+	PerftWorker *worker = (PerftWorker *)arg;
+	PerftDivide(worker->board, perftDepth);
+	return NULL;
+}
+
+void Search_PerftTest(int depth, ChessBoard *board, const int threads, const int hashMB) {
+
+	ASSERT(Board_Check(board));
 
-void Search_PerftTest(int depth, ChessBoard *board) {
+	PerftWorker *workers = NULL;
+	int workerCount = threads - 1;
+	int started = 0;
+	int index = 0;
 
-    ASSERT(Board_Check(board));
+	if(depth < 1) depth = 1;
+	if(workerCount > CHESS_MAX_THREADS - 1) workerCount = CHESS_MAX_THREADS - 1;
+	if(workerCount < 0) workerCount = 0;
 
 	Board_Print(board);
-	printf("\nStarting Test To Depth:%d\n",depth);	
-	leafNodes = 0;
+	printf("\nStarting Test To Depth:%d Threads:%d Hash:%dMB\n", depth, workerCount + 1, hashMB > 0 ? hashMB : 0);
+	PerftTable_Init(hashMB);
+
 	int start = Misc_GetTimeMs();
-    MoveList list[1];
-    Move_GenerateAll(board,list);	
-    
-    int move;	    
-    int MoveNum = 0;
-	for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {
-        move = list->moves[MoveNum].move;
-        if ( !Move_Make(board,move))  {
-            continue;
-        }
-        long cumnodes = leafNodes;
-        Perft(depth - 1, board);
-        Move_Take(board);        
-        long oldnodes = leafNodes - cumnodes;
-        printf("move %d : %s : %ld\n",MoveNum+1,PrMove(move),oldnodes);
-    }
-	
-	printf("\nTest Complete : %ld nodes visited in %dms\n",leafNodes,Misc_GetTimeMs() - start);
-
-    return;
+	Move_GenerateLegal(board, rootList);
+	rootNext = 0;
+	perftDepth = depth;
+
+	if(workerCount > 0) {
+		workers = (PerftWorker *) calloc(workerCount, sizeof(PerftWorker));
+		if(workers == NULL) {
+			printf("Perft worker allocation failed, running single-threaded\n");
+			workerCount = 0;
+		}
+	}
+	for(index = 0; index < workerCount; ++index) {
+		Board_Init(workers[index].board);
+		Board_Copy(workers[index].board, board);
+		if(pthread_create(&workers[index].handle, NULL, PerftWorkerThread, &workers[index]) != 0) {
+			Board_Free(workers[index].board);
+			break;
+		}
+		started++;
+	}
+
+	// the calling thread works through root moves as well
+	PerftDivide(board, depth);
+
+	for(index = 0; index < started; ++index) {
+		pthread_join(workers[index].handle, NULL);
+		Board_Free(workers[index].board);
+	}
+	free(workers);
+	PerftTable_Free();
+
+	int elapsed = Misc_GetTimeMs() - start;
+	U64 total = 0ULL;
+	int MoveNum = 0;
+	for(MoveNum = 0; MoveNum < rootList->count; ++MoveNum) {
+		total += rootNodes[MoveNum];
+		printf("move %d : %s : %llu\n", MoveNum + 1, PrMove(rootList->moves[MoveNum].move), (unsigned long long)rootNodes[MoveNum]);
+	}
+
+	printf("\nTest Complete : %llu nodes visited in %dms (%llu nps)\n", (unsigned long long)total, elapsed,
+		(unsigned long long)(elapsed > 0 ? total * 1000ULL / (U64)elapsed : total));
+
+	return;
 }
 
+/**
+ * One EPD line of a perft suite: the position, the expected counts by
+ * depth and what the run produced.
+ */
+typedef struct {
+	char fen[PERFT_SUITE_LINE];
+	int lineNumber;
+	int maxDepth;
+	U64 expected[PERFT_SUITE_MAX_DEPTH + 1];
+	int failDepth;
+	U64 failNodes;
+	U64 nodes;
+	int timeMs;
+} PerftSuiteLine;
 
+static PerftSuiteLine *suiteLines = NULL;
+static int suiteCount = 0;
+static volatile int suiteNext = 0;
+static int suitePassed = 0;
+static pthread_mutex_t suiteLock = PTHREAD_MUTEX_INITIALIZER;
 
+// fen up to the first ';', then ";D<depth> <nodes>" fields
+static int PerftSuite_ParseLine(char *text, PerftSuiteLine *line, const int maxDepth) {
 
+	char *field = strchr(text, ';');
+	char *end = NULL;
+	int depth = 0;
 
+	memset(line, 0, sizeof(PerftSuiteLine));
+	if(field == NULL) {
+		return BOOL_TYPE_FALSE;
+	}
+	*field = '\0';
+	if(snprintf(line->fen, sizeof(line->fen), "%s", text) >= (int)sizeof(line->fen)) {
+		return BOOL_TYPE_FALSE;
+	}
+	end = line->fen + strlen(line->fen);
+	while(end > line->fen && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
 
+	while(field != NULL) {
+		char *next = strchr(field + 1, ';');
+		char *ptr = field + 1;
+		while(*ptr == ' ' || *ptr == '\t') ptr++;
+		if(*ptr == 'D') {
+			depth = (int)strtol(ptr + 1, &end, 10);
+			if(depth >= 1 && depth <= PERFT_SUITE_MAX_DEPTH && depth <= maxDepth) {
+				line->expected[depth] = strtoull(end, NULL, 10);
+				if(depth > line->maxDepth) line->maxDepth = depth;
+			}
+		}
+		field = next;
+	}
+	return line->maxDepth > 0;
+}
 
+static void PerftSuite_RunLine(ChessBoard *board, PerftSuiteLine *line) {
 
+	int depth = 0;
+	int start = Misc_GetTimeMs();
+	U64 nodes = 0ULL;
 
+	if(Board_ParseFromFEN(line->fen, board) != 0) {
+		line->failDepth = -1;
+		return;
+	}
+	for(depth = 1; depth <= line->maxDepth; ++depth) {
+		if(line->expected[depth] == 0ULL) {
+			continue;
+		}
+		nodes = Search_Perft(board, depth);
+		line->nodes += nodes;
+		if(nodes != line->expected[depth]) {
+			line->failDepth = depth;
+			line->failNodes = nodes;
+			break;
+		}
+	}
+	line->timeMs = Misc_GetTimeMs() - start;
+}
+
+static void PerftSuite_Work(ChessBoard *board) {
 
+	int index = 0;
 
+	while((index = __sync_fetch_and_add(&suiteNext, 1)) < suiteCount) {
+		PerftSuiteLine *line = &suiteLines[index];
+		PerftSuite_RunLine(board, line);
 
+		pthread_mutex_lock(&suiteLock);
+		if(line->failDepth == 0) {
+			suitePassed++;
+			printf("line %d : PASS : depth %d : %llu nodes : %dms\n", line->lineNumber, line->maxDepth,
+				(unsigned long long)line->nodes, line->timeMs);
+		} else if(line->failDepth < 0) {
+			printf("line %d : FAIL : bad fen\n", line->lineNumber);
+		} else {
+			printf("line %d : FAIL : depth %d expected %llu got %llu : %s\n", line->lineNumber, line->failDepth,
+				(unsigned long long)line->expected[line->failDepth], (unsigned long long)line->failNodes, line->fen);
+		}
+		pthread_mutex_unlock(&suiteLock);
+	}
+}
+
+static void *PerftSuiteThread(void *arg) {
+	PerftWorker *worker = (PerftWorker *)arg;
+	PerftSuite_Work(worker->board);
+	return NULL;
+}
+
+int Search_PerftSuite(const char *path, const int maxDepth, const int threads, const int hashMB) {
+
+	FILE *file = fopen(path, "r");
+	char text[PERFT_SUITE_LINE];
+	int capacity = 0;
+	int lineNumber = 0;
+	int index = 0;
+	int started = 0;
+	int workerCount = threads;
+	PerftWorker *workers = NULL;
+
+	if(file == NULL) {
+		printf("perftsuite: cannot open %s\n", path);
+		return -1;
+	}
+
+	suiteCount = 0;
+	while(fgets(text, sizeof(text), file) != NULL) {
+		lineNumber++;
+		if(suiteCount == capacity) {
+			int grown = capacity ? capacity * 2 : 64;
+			PerftSuiteLine *lines = (PerftSuiteLine *) realloc(suiteLines, grown * sizeof(PerftSuiteLine));
+			if(lines == NULL) {
+				printf("perftsuite: out of memory at line %d\n", lineNumber);
+				break;
+			}
+			suiteLines = lines;
+			capacity = grown;
+		}
+		if(PerftSuite_ParseLine(text, &suiteLines[suiteCount], maxDepth)) {
+			suiteLines[suiteCount].lineNumber = lineNumber;
+			suiteCount++;
+		}
+	}
+	fclose(file);
+
+	if(workerCount > CHESS_MAX_THREADS) workerCount = CHESS_MAX_THREADS;
+	if(workerCount < 1) workerCount = 1;
+	workers = (PerftWorker *) calloc(workerCount, sizeof(PerftWorker));
+	if(workers == NULL) {
+		free(suiteLines);
+		suiteLines = NULL;
+		printf("perftsuite: worker allocation failed\n");
+		return -1;
+	}
+
+	printf("perftsuite: %d positions, max depth %d, %d thread(s)\n", suiteCount, maxDepth, workerCount);
+	PerftTable_Init(hashMB);
+	suiteNext = 0;
+	suitePassed = 0;
+	int start = Misc_GetTimeMs();
+
+	for(index = 0; index < workerCount; ++index) {
+		Board_Init(workers[index].board);
+		if(pthread_create(&workers[index].handle, NULL, PerftSuiteThread, &workers[index]) != 0) {
+			Board_Free(workers[index].board);
+			break;
+		}
+		started++;
+	}
+	if(started == 0) {
+		// no threads available, run the suite on the calling thread
+		Board_Init(workers[0].board);
+		PerftSuite_Work(workers[0].board);
+		Board_Free(workers[0].board);
+	}
+	for(index = 0; index < started; ++index) {
+		pthread_join(workers[index].handle, NULL);
+		Board_Free(workers[index].board);
+	}
+	free(workers);
+	PerftTable_Free();
+
+	int elapsed = Misc_GetTimeMs() - start;
+	U64 total = 0ULL;
+	for(index = 0; index < suiteCount; ++index) {
+		total += suiteLines[index].nodes;
+	}
+	int failed = suiteCount - suitePassed;
+
+	printf("perftsuite result=%s positions=%d passed=%d failed=%d nodes=%llu time=%d nps=%llu\n",
+		failed == 0 ? "pass" : "fail", suiteCount, suitePassed, failed, (unsigned long long)total, elapsed,
+		(unsigned long long)(elapsed > 0 ? total * 1000ULL / (U64)elapsed : total));
+
+	free(suiteLines);
+	suiteLines = NULL;
+	suiteCount = 0;
+	return failed;
+}
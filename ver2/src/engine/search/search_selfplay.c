@@ -0,0 +1,642 @@
+/**
+ * @file search_selfplay.c
+ * @brief Concurrent self-play matches between two option sets, with SPRT
+ *
+ * Plays engine A against engine B inside one process, one game per
+ * worker thread, so fast time controls are not dominated by process and
+ * pipe overhead. Each worker:
+ * - Owns one board and two transposition tables, one per engine, cleared
+ *   at the start of every game
+ * - Points the thread's EngineOptions at the side to move's option set
+ *   before every Search_Independent, so the two engines can differ in
+ *   any search option
+ * - Keeps the clocks itself: a move that takes longer than the time left
+ *   loses the game
+ *
+ * Openings come from an EPD/FEN file or a few random Polyglot book moves,
+ * and every opening is played twice with colours reversed. Games end by
+ * GameResult (mate, stalemate, fifty moves, repetition, material), on
+ * time, or drawn at the length the history leaves room for.
+ *
+ * After every game the running W/D/L of engine A, its Elo estimate and
+ * the log-likelihood ratio of the normal-approximation GSPRT are printed;
+ * the match stops once the ratio leaves [log(beta/(1-alpha)),
+ * log((1-beta)/alpha)]. Games still running then are completed and counted.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+#include "time.h"
+#include "types_definitions.h"
+#include <pthread.h>
+
+#define SELFPLAY_LINE 256
+#define SELFPLAY_MAX_BOOK_PLIES 64
+#define SELFPLAY_PGN_COLUMNS 79 // PGN export lines stay below 80 characters
+#define SELFPLAY_MOVETEXT_SIZE (CHESS_MAX_GAME_MOVES * 12)
+#define SELFPLAY_MAX_PLY (CHESS_MAX_GAME_MOVES - CHESS_MAX_SEARCH_DEPTH - 1) // History a game may use, the search needs the rest
+
+static const char *StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+/**
+ * Start of one game pair: a position plus the book moves played from it.
+ */
+typedef struct {
+	char fen[SELFPLAY_LINE];
+	int moves[SELFPLAY_MAX_BOOK_PLIES];
+	int count;
+} SelfPlayOpening;
+
+/**
+ * Movetext of one game, wrapped at SELFPLAY_PGN_COLUMNS.
+ */
+typedef struct {
+	char *text;
+	int length;
+	int column;
+} PgnText;
+
+typedef struct {
+	ChessBoard board[1];
+	SearchInfo info[1];
+	HashTable tables[2];
+	S_OPTIONS engines[2];
+	PgnText pgn;
+	pthread_t handle;
+} SelfPlayWorker;
+
+static const SelfPlayOptions *settings = NULL;
+static char (*openings)[SELFPLAY_LINE] = NULL;
+static int openingCount = 0;
+static SelfPlayOpening pairOpening;
+static int nextGame = 0;
+static long wins = 0;
+static long draws = 0;
+static long losses = 0;
+static int decision = 0;
+static char matchDate[16];
+static FILE *pgnFile = NULL;
+static pthread_mutex_t matchLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void Usage() {
+	printf("usage: gambit selfplay [--games N] [--concurrency N] [--tc base+inc] [--depth N] [--nodes N]\n");
+	printf("                       [--hash MB] [--openings file.epd] [--book-plies N] [--pgn file]\n");
+	printf("                       [--elo0 E] [--elo1 E] [--alpha A] [--beta B]\n");
+	printf("                       [--a Name=value,...] [--b Name=value,...]\n");
+}
+
+// "LMR=false,LazyMargin=150": the UCI names of the search options
+static int ParseEngineOptions(S_OPTIONS *engine, char *text) {
+
+	char *name = strtok(text, ",");
+
+	while(name != NULL) {
+		char *value = strchr(name, '=');
+		int number = 0;
+
+		if(value == NULL) {
+			return BOOL_TYPE_FALSE;
+		}
+		*value++ = '\0';
+		number = strcmp(value, "true") == 0 ? BOOL_TYPE_TRUE : strcmp(value, "false") == 0 ? BOOL_TYPE_FALSE : atoi(value);
+
+		if(strcmp(name, "LMR") == 0) {
+			engine->UseLMR = number;
+		} else if(strcmp(name, "Futility") == 0) {
+			engine->UseFutility = number;
+		} else if(strcmp(name, "ReverseFutility") == 0) {
+			engine->UseReverseFutility = number;
+		} else if(strcmp(name, "LazyMargin") == 0) {
+			engine->LazyMargin = number;
+		} else if(strcmp(name, "MoveOverhead") == 0) {
+			engine->MoveOverhead = number;
+		} else if(strcmp(name, "SyzygyProbeDepth") == 0) {
+			engine->SyzygyProbeDepth = number;
+		} else if(strcmp(name, "SyzygyProbeLimit") == 0) {
+			engine->SyzygyProbeLimit = number;
+		} else {
+			return BOOL_TYPE_FALSE;
+		}
+		name = strtok(NULL, ",");
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+int SelfPlay_ParseOptions(SelfPlayOptions *options, const int argc, char *argv[]) {
+
+	int index = 0;
+	int clockGiven = BOOL_TYPE_FALSE;
+	int limitGiven = BOOL_TYPE_FALSE;
+
+	memset(options, 0, sizeof(SelfPlayOptions));
+	options->games = 1000;
+	options->concurrency = 1;
+	options->baseMs = 10000;
+	options->incMs = 100;
+	options->depth = CHESS_MAX_SEARCH_DEPTH - 1;
+	options->hashMB = 16;
+	options->bookPlies = 8;
+	options->elo0 = 0.0;
+	options->elo1 = 5.0;
+	options->alpha = 0.05;
+	options->beta = 0.05;
+	options->engines[0] = *g_engineOptions;
+	options->engines[0].Threads = 1;
+	options->engines[0].UseBook = BOOL_TYPE_FALSE;
+	options->engines[1] = options->engines[0];
+
+	for(index = 0; index < argc; ++index) {
+		char *value = index + 1 < argc ? argv[index + 1] : NULL;
+
+		if(value == NULL) {
+			Usage();
+			return BOOL_TYPE_FALSE;
+		}
+		if(strcmp(argv[index], "--games") == 0) {
+			options->games = atoi(value);
+		} else if(strcmp(argv[index], "--concurrency") == 0) {
+			options->concurrency = atoi(value);
+		} else if(strcmp(argv[index], "--tc") == 0) {
+			char *inc = NULL;
+			options->baseMs = (int)(strtod(value, &inc) * 1000.0);
+			options->incMs = *inc == '+' ? (int)(strtod(inc + 1, NULL) * 1000.0) : 0;
+			clockGiven = BOOL_TYPE_TRUE;
+		} else if(strcmp(argv[index], "--depth") == 0) {
+			options->depth = atoi(value);
+			limitGiven = BOOL_TYPE_TRUE;
+		} else if(strcmp(argv[index], "--nodes") == 0) {
+			options->nodes = atol(value);
+			limitGiven = BOOL_TYPE_TRUE;
+		} else if(strcmp(argv[index], "--hash") == 0) {
+			options->hashMB = atoi(value);
+		} else if(strcmp(argv[index], "--openings") == 0) {
+			options->openingsPath = value;
+		} else if(strcmp(argv[index], "--book-plies") == 0) {
+			options->bookPlies = atoi(value);
+		} else if(strcmp(argv[index], "--pgn") == 0) {
+			options->pgnPath = value;
+		} else if(strcmp(argv[index], "--elo0") == 0) {
+			options->elo0 = atof(value);
+		} else if(strcmp(argv[index], "--elo1") == 0) {
+			options->elo1 = atof(value);
+		} else if(strcmp(argv[index], "--alpha") == 0) {
+			options->alpha = atof(value);
+		} else if(strcmp(argv[index], "--beta") == 0) {
+			options->beta = atof(value);
+		} else if(strcmp(argv[index], "--a") == 0 || strcmp(argv[index], "--b") == 0) {
+			if(!ParseEngineOptions(&options->engines[argv[index][2] == 'b'], value)) {
+				Usage();
+				return BOOL_TYPE_FALSE;
+			}
+		} else {
+			Usage();
+			return BOOL_TYPE_FALSE;
+		}
+		index++;
+	}
+
+	// a depth or node limit alone plays without a clock
+	if(limitGiven && !clockGiven) {
+		options->baseMs = 0;
+		options->incMs = 0;
+	}
+	if(options->games < 1) options->games = 1;
+	if(options->concurrency < 1) options->concurrency = 1;
+	if(options->concurrency > CHESS_MAX_THREADS) options->concurrency = CHESS_MAX_THREADS;
+	if(options->depth < 1) options->depth = 1;
+	if(options->depth > CHESS_MAX_SEARCH_DEPTH - 1) options->depth = CHESS_MAX_SEARCH_DEPTH - 1;
+	if(options->hashMB < 1) options->hashMB = 1;
+	if(options->hashMB > CHESS_MAX_HASH) options->hashMB = CHESS_MAX_HASH;
+	if(options->bookPlies < 0) options->bookPlies = 0;
+	if(options->bookPlies > SELFPLAY_MAX_BOOK_PLIES) options->bookPlies = SELFPLAY_MAX_BOOK_PLIES;
+	if(options->alpha <= 0.0 || options->alpha >= 1.0 || options->beta <= 0.0 || options->beta >= 1.0) {
+		Usage();
+		return BOOL_TYPE_FALSE;
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+/* --- openings --- */
+
+// the four position fields of every usable line; the game starts at move 1
+static int LoadOpenings(const char *path) {
+
+	FILE *file = fopen(path, "r");
+	char text[SELFPLAY_LINE];
+	int capacity = 0;
+	int skipped = 0;
+
+	if(file == NULL) {
+		printf("selfplay: cannot open %s\n", path);
+		return -1;
+	}
+
+	openingCount = 0;
+	while(fgets(text, sizeof(text), file) != NULL) {
+		char *ptr = text;
+		char *end = NULL;
+		int fields = 0;
+		size_t length = strlen(text);
+		int c = 0;
+
+		// a line longer than the buffer counts once, its tail is dropped
+		if(length > 0 && text[length - 1] != '\n' && !feof(file)) {
+			while((c = fgetc(file)) != EOF && c != '\n');
+			skipped++;
+			continue;
+		}
+
+		while(*ptr == ' ' || *ptr == '\t') ptr++;
+		if(*ptr == '\0' || *ptr == '\n' || *ptr == '\r' || *ptr == '#') {
+			continue;
+		}
+		for(end = ptr; *end != '\0' && *end != '\n' && *end != '\r'; ++end) {
+			if(*end == ' ' && ++fields == 4) break;
+		}
+		*end = '\0';
+		// the move counters are appended below and must fit as well
+		length = strlen(ptr);
+		if(length + sizeof(" 0 1") > SELFPLAY_LINE || !Board_IsValidFen(ptr)) {
+			skipped++;
+			continue;
+		}
+
+		if(openingCount == capacity) {
+			int grown = capacity ? capacity * 2 : 256;
+			char (*lines)[SELFPLAY_LINE] = realloc(openings, grown * sizeof(*openings));
+			if(lines == NULL) {
+				break;
+			}
+			openings = lines;
+			capacity = grown;
+		}
+		memcpy(openings[openingCount], ptr, length);
+		memcpy(openings[openingCount] + length, " 0 1", sizeof(" 0 1"));
+		openingCount++;
+	}
+	fclose(file);
+
+	if(skipped > 0) {
+		printf("selfplay: skipped %d malformed line(s) in %s\n", skipped, path);
+	}
+	return openingCount;
+}
+
+// random book moves from the position; PolyBook_GetMove uses rand(),
+// so this runs under matchLock
+static void PlayBookLine(ChessBoard *board, SelfPlayOpening *opening) {
+
+	int move = NOMOVE;
+
+	Board_ParseFromFEN(opening->fen, board);
+	while(opening->count < settings->bookPlies && (move = PolyBook_GetMove(board)) != NOMOVE) {
+		if(!Move_Make(board, move)) {
+			break;
+		}
+		board->ply = 0;
+		opening->moves[opening->count++] = move;
+	}
+}
+
+/* --- PGN --- */
+
+static void Pgn_Append(PgnText *pgn, const char *token) {
+
+	int length = (int)strlen(token);
+
+	if(pgn->length + length + 2 >= SELFPLAY_MOVETEXT_SIZE) {
+		return;
+	}
+	if(pgn->column > 0 && pgn->column + 1 + length > SELFPLAY_PGN_COLUMNS) {
+		pgn->text[pgn->length++] = '\n';
+		pgn->column = 0;
+	} else if(pgn->column > 0) {
+		pgn->text[pgn->length++] = ' ';
+		pgn->column++;
+	}
+	memcpy(pgn->text + pgn->length, token, length + 1);
+	pgn->length += length;
+	pgn->column += length;
+}
+
+// move number (before white's moves and the first move), SAN, then the move
+static void PlayMove(ChessBoard *board, PgnText *pgn, const int move, const int ply, const int startSide) {
+
+	char token[16];
+	int moveNumber = 1 + (ply + (startSide == COLOR_TYPE_BLACK)) / 2;
+
+	if(board->side == COLOR_TYPE_WHITE) {
+		sprintf(token, "%d.", moveNumber);
+		Pgn_Append(pgn, token);
+	} else if(ply == 0) {
+		sprintf(token, "%d...", moveNumber);
+		Pgn_Append(pgn, token);
+	}
+	Move_ToSan(board, move, token);
+	Pgn_Append(pgn, token);
+
+	Move_Make(board, move);
+	board->ply = 0;
+}
+
+static void WritePgn(const SelfPlayOpening *opening, const PgnText *pgn, const int game, const int aWhite,
+	const char *result, const char *reason) {
+
+	if(pgnFile == NULL) {
+		return;
+	}
+	fprintf(pgnFile, "[Event \"Gambit self-play\"]\n[Site \"?\"]\n[Date \"%s\"]\n[Round \"%d\"]\n", matchDate, game + 1);
+	fprintf(pgnFile, "[White \"%s\"]\n[Black \"%s\"]\n[Result \"%s\"]\n", aWhite ? "A" : "B", aWhite ? "B" : "A", result);
+	if(strcmp(opening->fen, StartFen) != 0) {
+		fprintf(pgnFile, "[SetUp \"1\"]\n[FEN \"%s\"]\n", opening->fen);
+	}
+	if(settings->baseMs > 0) {
+		fprintf(pgnFile, "[TimeControl \"%g+%g\"]\n", settings->baseMs / 1000.0, settings->incMs / 1000.0);
+	}
+	fprintf(pgnFile, "\n%s%s{%s} %s\n\n", pgn->text, pgn->length > 0 ? " " : "", reason, result);
+	fflush(pgnFile);
+}
+
+/* --- SPRT --- */
+
+static double EloToScore(const double elo) {
+	return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// log-likelihood ratio of H1 (elo1) against H0 (elo0), with the score
+// treated as normally distributed around its mean
+static double Sprt_Llr() {
+
+	double n = (double)(wins + draws + losses);
+	double score = 0.0;
+	double variance = 0.0;
+	double s0 = EloToScore(settings->elo0);
+	double s1 = EloToScore(settings->elo1);
+
+	if(n == 0.0) {
+		return 0.0;
+	}
+	score = (wins + draws * 0.5) / n;
+	variance = (wins * (1.0 - score) * (1.0 - score) + draws * (0.5 - score) * (0.5 - score)
+		+ losses * score * score) / n;
+	if(variance <= 0.0) {
+		return 0.0;
+	}
+	return n * (s1 - s0) * (2.0 * score - s0 - s1) / (2.0 * variance);
+}
+
+static double EloEstimate() {
+
+	double n = (double)(wins + draws + losses);
+	double score = n > 0.0 ? (wins + draws * 0.5) / n : 0.5;
+
+	if(score <= 0.0) score = 0.5 / n;
+	if(score >= 1.0) score = 1.0 - 0.5 / n;
+	return 400.0 * log10(score / (1.0 - score));
+}
+
+/* --- games --- */
+
+// white's point of view: 1 win, 0 draw, -1 loss
+static int PlayGame(SelfPlayWorker *worker, const SelfPlayOpening *opening, const int aWhite, const char **reason) {
+
+	ChessBoard *board = worker->board;
+	SearchInfo *info = worker->info;
+	SearchResult result[1];
+	int clock[2] = { settings->baseMs, settings->baseMs };
+	int startSide = COLOR_TYPE_WHITE;
+	int ply = 0;
+	int index = 0;
+	int score = 0;
+
+	worker->pgn.length = 0;
+	worker->pgn.column = 0;
+	worker->pgn.text[0] = '\0';
+	HashTable_Clear(&worker->tables[0]);
+	HashTable_Clear(&worker->tables[1]);
+
+	Board_ParseFromFEN((char *)opening->fen, board);
+	startSide = board->side;
+	for(index = 0; index < opening->count; ++index) {
+		PlayMove(board, &worker->pgn, opening->moves[index], ply++, startSide);
+	}
+
+	while(BOOL_TYPE_TRUE) {
+		int side = board->side;
+		int engine = (side == COLOR_TYPE_WHITE) == aWhite ? 0 : 1;
+
+		switch(GameResult(board)) {
+			case GAME_RESULT_WHITE_MATES: *reason = "white mates"; score = 1; break;
+			case GAME_RESULT_BLACK_MATES: *reason = "black mates"; score = -1; break;
+			case GAME_RESULT_STALEMATE: *reason = "stalemate"; break;
+			case GAME_RESULT_FIFTY_MOVES: *reason = "fifty move rule"; break;
+			case GAME_RESULT_REPETITION: *reason = "3-fold repetition"; break;
+			case GAME_RESULT_MATERIAL: *reason = "insufficient material"; break;
+			default: *reason = NULL; break;
+		}
+		if(*reason != NULL) {
+			break;
+		}
+		if(board->hisPly >= SELFPLAY_MAX_PLY) {
+			*reason = "game length";
+			break;
+		}
+
+		EngineOptions = &worker->engines[engine];
+		board->HashTable = &worker->tables[engine];
+		HashTable_NewSearch(board->HashTable);
+
+		memset(info, 0, sizeof(SearchInfo));
+		info->depth = settings->depth;
+		info->nodeLimit = settings->nodes;
+		info->starttime = Misc_GetTimeMs();
+		Time_Allocate(info, settings->baseMs > 0 ? clock[side] : -1, settings->incMs, 0, -1);
+		Search_Independent(board, info, result);
+
+		if(settings->baseMs > 0) {
+			clock[side] -= result->timeMs;
+			if(clock[side] < 0) {
+				*reason = side == COLOR_TYPE_WHITE ? "white loses on time" : "black loses on time";
+				score = side == COLOR_TYPE_WHITE ? -1 : 1;
+				break;
+			}
+			clock[side] += settings->incMs;
+		}
+		PlayMove(board, &worker->pgn, result->bestMove, ply++, startSide);
+	}
+
+	EngineOptions = g_engineOptions;
+	return score;
+}
+
+static int ClaimGame(SelfPlayWorker *worker, SelfPlayOpening *opening, int *game) {
+
+	pthread_mutex_lock(&matchLock);
+	if(decision != 0 || nextGame >= settings->games) {
+		pthread_mutex_unlock(&matchLock);
+		return BOOL_TYPE_FALSE;
+	}
+	*game = nextGame++;
+
+	// the first game of a pair picks the opening, the second replays it
+	if(*game % 2 == 0) {
+		pairOpening.count = 0;
+		if(openingCount > 0) {
+			strcpy(pairOpening.fen, openings[(*game / 2) % openingCount]);
+		} else {
+			strcpy(pairOpening.fen, StartFen);
+			if(g_engineOptions->UseBook == BOOL_TYPE_TRUE) {
+				PlayBookLine(worker->board, &pairOpening);
+			}
+		}
+	}
+	*opening = pairOpening;
+	pthread_mutex_unlock(&matchLock);
+	return BOOL_TYPE_TRUE;
+}
+
+static void RecordGame(SelfPlayWorker *worker, const SelfPlayOpening *opening, const int game, const int aWhite,
+	const int score, const char *reason) {
+
+	const char *result = score > 0 ? "1-0" : score < 0 ? "0-1" : "1/2-1/2";
+	double lower = log(settings->beta / (1.0 - settings->alpha));
+	double upper = log((1.0 - settings->beta) / settings->alpha);
+	double llr = 0.0;
+
+	pthread_mutex_lock(&matchLock);
+	if(score == 0) {
+		draws++;
+	} else if((score > 0) == aWhite) {
+		wins++;
+	} else {
+		losses++;
+	}
+	llr = Sprt_Llr();
+	if(decision == 0 && llr >= upper) {
+		decision = 1;
+	} else if(decision == 0 && llr <= lower) {
+		decision = -1;
+	}
+
+	printf("Game %d: %s-%s %s {%s} | A W %ld D %ld L %ld | elo %+.1f | LLR %.2f [%.2f, %.2f]%s\n", game + 1,
+		aWhite ? "A" : "B", aWhite ? "B" : "A", result, reason, wins, draws, losses, EloEstimate(), llr, lower, upper,
+		decision > 0 ? " H1 accepted" : decision < 0 ? " H0 accepted" : "");
+	WritePgn(opening, &worker->pgn, game, aWhite, result, reason);
+	pthread_mutex_unlock(&matchLock);
+}
+
+static void *SelfPlayThread(void *arg) {
+
+	SelfPlayWorker *worker = (SelfPlayWorker *)arg;
+	SelfPlayOpening opening;
+	const char *reason = NULL;
+	int game = 0;
+	int aWhite = BOOL_TYPE_TRUE;
+	int score = 0;
+
+	while(ClaimGame(worker, &opening, &game)) {
+		aWhite = game % 2 == 0;
+		score = PlayGame(worker, &opening, aWhite, &reason);
+		RecordGame(worker, &opening, game, aWhite, score, reason);
+	}
+	PROFILE_FLUSH();
+	return NULL;
+}
+
+int SelfPlay_Run(const SelfPlayOptions *options) {
+
+	SelfPlayWorker *workers = NULL;
+	time_t now = time(NULL);
+	int workerCount = options->concurrency;
+	int started = 0;
+	int index = 0;
+
+	settings = options;
+	openingCount = 0;
+	if(options->openingsPath != NULL && LoadOpenings(options->openingsPath) <= 0) {
+		printf("selfplay: no openings in %s\n", options->openingsPath);
+		free(openings);
+		openings = NULL;
+		return 0;
+	}
+	if(options->pgnPath != NULL) {
+		pgnFile = fopen(options->pgnPath, "a");
+		if(pgnFile == NULL) {
+			printf("selfplay: cannot write %s\n", options->pgnPath);
+		}
+	}
+	workers = (SelfPlayWorker *) calloc(workerCount, sizeof(SelfPlayWorker));
+	if(workers == NULL) {
+		printf("selfplay: allocation failed\n");
+		free(openings);
+		openings = NULL;
+		return 0;
+	}
+
+	strftime(matchDate, sizeof(matchDate), "%Y.%m.%d", localtime(&now));
+	nextGame = 0;
+	wins = draws = losses = 0;
+	decision = 0;
+
+	printf("selfplay: %d game(s), %d at once, ", options->games, workerCount);
+	if(options->baseMs > 0) {
+		printf("tc %g+%g", options->baseMs / 1000.0, options->incMs / 1000.0);
+	} else if(options->nodes > 0) {
+		printf("%ld nodes", options->nodes);
+	} else {
+		printf("depth %d", options->depth);
+	}
+	printf(", hash %dMB, openings %s, SPRT elo0 %g elo1 %g alpha %g beta %g\n", options->hashMB,
+		openingCount > 0 ? options->openingsPath : g_engineOptions->UseBook == BOOL_TYPE_TRUE ? "book" : "none (initial position)",
+		options->elo0, options->elo1, options->alpha, options->beta);
+
+	int start = Misc_GetTimeMs();
+
+	for(index = 0; index < workerCount; ++index) {
+		SelfPlayWorker *worker = &workers[index];
+		Board_Init(worker->board);
+		HashTable_Init(&worker->tables[0], options->hashMB);
+		HashTable_Init(&worker->tables[1], options->hashMB);
+		worker->engines[0] = options->engines[0];
+		worker->engines[1] = options->engines[1];
+		worker->pgn.text = (char *) malloc(SELFPLAY_MOVETEXT_SIZE);
+		if(worker->pgn.text == NULL || pthread_create(&worker->handle, NULL, SelfPlayThread, worker) != 0) {
+			free(worker->pgn.text);
+			HashTable_Free(&worker->tables[0]);
+			HashTable_Free(&worker->tables[1]);
+			Board_Free(worker->board);
+			break;
+		}
+		started++;
+	}
+	if(started == 0) {
+		printf("selfplay: no worker thread could be started\n");
+	}
+
+	for(index = 0; index < started; ++index) {
+		pthread_join(workers[index].handle, NULL);
+		free(workers[index].pgn.text);
+		HashTable_Free(&workers[index].tables[0]);
+		HashTable_Free(&workers[index].tables[1]);
+		Board_Free(workers[index].board);
+	}
+
+	printf("selfplay result=%s games=%ld wins=%ld draws=%ld losses=%ld elo=%+.1f llr=%.2f time=%d\n",
+		decision > 0 ? "H1" : decision < 0 ? "H0" : "undecided", wins + draws + losses, wins, draws, losses,
+		EloEstimate(), Sprt_Llr(), Misc_GetTimeMs() - start);
+
+	if(pgnFile != NULL) {
+		fclose(pgnFile);
+		pgnFile = NULL;
+	}
+	free(workers);
+	free(openings);
+	openings = NULL;
+	settings = NULL;
+	return decision;
+}
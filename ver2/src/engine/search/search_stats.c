@@ -0,0 +1,215 @@
+/**
+ * @file search_stats.c
+ * @brief Search statistics: per-search and per-depth breakdowns
+ *
+ * The counters themselves (SearchStats) live in every thread's
+ * SearchTables and are bumped without any sharing. This module keeps
+ * what the main thread reports from them:
+ * - A cumulative snapshot after every completed iteration, from which
+ *   the per-depth figures are the differences
+ * - The final totals of the last search, helpers included
+ *
+ * Output goes to "info string" lines or the console (Stats_Print), and
+ * optionally to a CSV or JSON-lines file appended after every search.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "types_definitions.h"
+
+#define STATS_PATH_SIZE 512
+
+static SearchStats depthTotals[CHESS_MAX_SEARCH_DEPTH + 1];
+static int depths[CHESS_MAX_SEARCH_DEPTH + 1];
+static int iterations = 0;
+static SearchStats lastTotal;
+static int lastElapsed = 0;
+static int searches = 0;
+static char dumpPath[STATS_PATH_SIZE] = "";
+
+void Stats_Clear(SearchStats *stats) {
+	memset(stats, 0, sizeof(SearchStats));
+}
+
+void Stats_Add(SearchStats *total, const SearchStats *stats) {
+	total->nodes += stats->nodes;
+	total->qNodes += stats->qNodes;
+	total->ttProbes += stats->ttProbes;
+	total->ttHits += stats->ttHits;
+	total->ttCuts += stats->ttCuts;
+	total->ttNewWrites += stats->ttNewWrites;
+	total->ttOverWrites += stats->ttOverWrites;
+	total->failHighs += stats->failHighs;
+	total->failHighFirst += stats->failHighFirst;
+	total->nullTries += stats->nullTries;
+	total->nullCuts += stats->nullCuts;
+}
+
+// counters of one iteration: its snapshot minus the previous one
+static void IterationStats(const int iteration, SearchStats *stats) {
+
+	*stats = depthTotals[iteration];
+	if(iteration == 0) {
+		return;
+	}
+	stats->nodes -= depthTotals[iteration - 1].nodes;
+	stats->qNodes -= depthTotals[iteration - 1].qNodes;
+	stats->ttProbes -= depthTotals[iteration - 1].ttProbes;
+	stats->ttHits -= depthTotals[iteration - 1].ttHits;
+	stats->ttCuts -= depthTotals[iteration - 1].ttCuts;
+	stats->ttNewWrites -= depthTotals[iteration - 1].ttNewWrites;
+	stats->ttOverWrites -= depthTotals[iteration - 1].ttOverWrites;
+	stats->failHighs -= depthTotals[iteration - 1].failHighs;
+	stats->failHighFirst -= depthTotals[iteration - 1].failHighFirst;
+	stats->nullTries -= depthTotals[iteration - 1].nullTries;
+	stats->nullCuts -= depthTotals[iteration - 1].nullCuts;
+}
+
+static double Percent(const long part, const long whole) {
+	return whole > 0 ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+// nodes of an iteration over those of the one before (0 for the first)
+static double BranchingFactor(const int iteration) {
+
+	SearchStats current;
+	SearchStats previous;
+
+	if(iteration == 0) {
+		return 0.0;
+	}
+	IterationStats(iteration, &current);
+	IterationStats(iteration - 1, &previous);
+	return previous.nodes > 0 ? (double)current.nodes / (double)previous.nodes : 0.0;
+}
+
+void Stats_BeginSearch() {
+	iterations = 0;
+	Stats_Clear(&lastTotal);
+	lastElapsed = 0;
+}
+
+void Stats_RecordIteration(const int depth, const SearchStats *total) {
+
+	if(iterations > CHESS_MAX_SEARCH_DEPTH) {
+		return;
+	}
+	depthTotals[iterations] = *total;
+	depths[iterations] = depth;
+	iterations++;
+}
+
+static void PrintRates(const char *prefix, const SearchStats *stats) {
+	printf("%snodes %ld qnodes %.1f%% tthit %.1f%% ttcut %.1f%% fhf %.1f%% nullcut %.1f%%",
+		prefix, stats->nodes, Percent(stats->qNodes, stats->nodes),
+		Percent(stats->ttHits, stats->ttProbes), Percent(stats->ttCuts, stats->ttProbes),
+		Percent(stats->failHighFirst, stats->failHighs), Percent(stats->nullCuts, stats->nullTries));
+}
+
+void Stats_Print(const int uci, const int perDepth) {
+
+	const char *prefix = uci == BOOL_TYPE_TRUE ? "info string stats " : "Stats: ";
+	SearchStats stats;
+	int iteration = 0;
+	char depthPrefix[64];
+
+	if(searches == 0) {
+		printf("%sno search yet\n", prefix);
+		return;
+	}
+
+	PrintRates(prefix, &lastTotal);
+	printf(" ttnew %ld ttreplace %ld bf %.2f time %d\n", lastTotal.ttNewWrites, lastTotal.ttOverWrites,
+		iterations > 0 ? BranchingFactor(iterations - 1) : 0.0, lastElapsed);
+
+	if(perDepth == BOOL_TYPE_TRUE) {
+		for(iteration = 0; iteration < iterations; ++iteration) {
+			IterationStats(iteration, &stats);
+			sprintf(depthPrefix, "%sdepth %d ", prefix, depths[iteration]);
+			PrintRates(depthPrefix, &stats);
+			printf(" bf %.2f\n", BranchingFactor(iteration));
+		}
+	}
+}
+
+static void WriteCsvRow(FILE *file, const char *depth, const SearchStats *stats, const double bf) {
+	fprintf(file, "%d,%s,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%.3f\n",
+		searches, depth, stats->nodes, stats->qNodes, stats->ttProbes, stats->ttHits, stats->ttCuts,
+		stats->ttNewWrites, stats->ttOverWrites, stats->failHighs, stats->failHighFirst,
+		stats->nullTries, stats->nullCuts, bf);
+}
+
+static void WriteJsonCounters(FILE *file, const SearchStats *stats) {
+	fprintf(file, "\"nodes\":%ld,\"qnodes\":%ld,\"ttprobes\":%ld,\"tthits\":%ld,\"ttcuts\":%ld,"
+		"\"ttnew\":%ld,\"ttreplace\":%ld,\"failhighs\":%ld,\"failhighfirst\":%ld,\"nulltries\":%ld,\"nullcuts\":%ld",
+		stats->nodes, stats->qNodes, stats->ttProbes, stats->ttHits, stats->ttCuts,
+		stats->ttNewWrites, stats->ttOverWrites, stats->failHighs, stats->failHighFirst,
+		stats->nullTries, stats->nullCuts);
+}
+
+static void DumpSearch() {
+
+	FILE *file = NULL;
+	SearchStats stats;
+	size_t length = strlen(dumpPath);
+	int csv = length > 4 && strcmp(dumpPath + length - 4, ".csv") == 0;
+	int iteration = 0;
+	char depth[16];
+
+	file = fopen(dumpPath, "a");
+	if(file == NULL) {
+		printf("Could not open stats file %s\n", dumpPath);
+		dumpPath[0] = '\0';
+		return;
+	}
+
+	if(csv) {
+		// a new file starts with the column names
+		fseek(file, 0, SEEK_END);
+		if(ftell(file) == 0) {
+			fprintf(file, "search,depth,nodes,qnodes,ttprobes,tthits,ttcuts,ttnew,ttreplace,"
+				"failhighs,failhighfirst,nulltries,nullcuts,bf\n");
+		}
+		for(iteration = 0; iteration < iterations; ++iteration) {
+			IterationStats(iteration, &stats);
+			sprintf(depth, "%d", depths[iteration]);
+			WriteCsvRow(file, depth, &stats, BranchingFactor(iteration));
+		}
+		WriteCsvRow(file, "all", &lastTotal, iterations > 0 ? BranchingFactor(iterations - 1) : 0.0);
+	} else {
+		fprintf(file, "{\"search\":%d,\"time\":%d,", searches, lastElapsed);
+		WriteJsonCounters(file, &lastTotal);
+		fprintf(file, ",\"iterations\":[");
+		for(iteration = 0; iteration < iterations; ++iteration) {
+			IterationStats(iteration, &stats);
+			fprintf(file, "%s{\"depth\":%d,", iteration > 0 ? "," : "", depths[iteration]);
+			WriteJsonCounters(file, &stats);
+			fprintf(file, ",\"bf\":%.3f}", BranchingFactor(iteration));
+		}
+		fprintf(file, "]}\n");
+	}
+	fclose(file);
+}
+
+void Stats_EndSearch(const SearchStats *total, const int elapsed) {
+
+	lastTotal = *total;
+	lastElapsed = elapsed;
+	searches++;
+	if(dumpPath[0] != '\0') {
+		DumpSearch();
+	}
+}
+
+void Stats_SetDumpFile(const char *path) {
+
+	if(path == NULL || path[0] == '\0' || strcmp(path, "<empty>") == 0) {
+		dumpPath[0] = '\0';
+		return;
+	}
+	strncpy(dumpPath, path, STATS_PATH_SIZE - 1);
+	dumpPath[STATS_PATH_SIZE - 1] = '\0';
+}
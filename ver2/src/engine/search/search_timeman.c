@@ -0,0 +1,120 @@
+/**
+ * @file search_timeman.c
+ * @brief Per-move time budget for the iterative deepening loop
+ *
+ * Splits the clock into two limits:
+ * - Soft limit: no new iteration is started past it; scaled after every
+ *   iteration by how long the best move has stayed the same and by how
+ *   far the score fell since the previous iteration
+ * - Hard limit: the running iteration is aborted (info->stoptime)
+ *
+ * MoveOverhead is kept back from every budget for GUI and transport lag.
+ * The clock itself is only read every N nodes, where N is recalibrated
+ * from the measured speed so CheckUp runs about once per millisecond.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "types_definitions.h"
+
+#define TIME_DEFAULT_MOVESTOGO 30 // Moves assumed left in sudden death
+#define TIME_HARD_FACTOR 4 // Hard limit in soft limits, before the cap below
+#define TIME_HARD_SHARE 80 // Percent of the remaining clock one move may use
+#define TIME_DROP_CAP 100 // Score drop in centipawns past which the soft limit grows no more
+#define TIME_CHECK_MIN 256 // Fewest nodes between two clock checks
+#define TIME_CHECK_MAX 65536 // Most nodes between two clock checks
+#define TIME_HELPER_CHECK 2048 // Nodes between stop checks in helper threads
+
+// soft limit percent by iterations the best move has survived: a new best
+// move asks for more time, one stable for five iterations for less
+static const int StabilityScale[6] = { 250, 160, 125, 100, 90, 80 };
+
+void Time_Allocate(SearchInfo *info, const int time, const int inc, const int movestogo, const int movetime) {
+
+	int overhead = EngineOptions->MoveOverhead;
+	int available = 0;
+	int moves = movestogo > 0 ? movestogo : TIME_DEFAULT_MOVESTOGO;
+	TimeManager *tm = &info->tm;
+
+	info->timeset = BOOL_TYPE_FALSE;
+	tm->start = info->starttime;
+	tm->softTime = -1;
+	tm->hardTime = -1;
+	tm->lastBestMove = NOMOVE;
+	tm->stability = 0;
+	tm->lastScore = -CHESS_INFINITE;
+
+	if(movetime > 0) {
+		tm->hardTime = movetime - overhead;
+		if(tm->hardTime < 1) tm->hardTime = 1;
+		tm->softTime = tm->hardTime;
+	} else if(time >= 0) {
+		available = time - overhead;
+		if(available < 1) available = 1;
+		tm->softTime = available / moves + inc * 3 / 4;
+		tm->hardTime = tm->softTime * TIME_HARD_FACTOR;
+		if(tm->hardTime > available * TIME_HARD_SHARE / 100) {
+			tm->hardTime = available * TIME_HARD_SHARE / 100;
+		}
+		if(tm->hardTime < 1) tm->hardTime = 1;
+		if(tm->softTime > tm->hardTime) tm->softTime = tm->hardTime;
+	} else {
+		return;
+	}
+
+	info->timeset = BOOL_TYPE_TRUE;
+	info->stoptime = tm->start + tm->hardTime;
+}
+
+void Time_PonderHit(SearchInfo *info) {
+
+	TimeManager *tm = &info->tm;
+
+	if(info->timeset == BOOL_TYPE_TRUE) {
+		tm->start = Misc_GetTimeMs();
+		info->stoptime = tm->start + tm->hardTime;
+	}
+}
+
+int Time_StopIterating(SearchInfo *info, const int bestMove, const int score) {
+
+	TimeManager *tm = &info->tm;
+	int drop = tm->lastScore > -CHESS_INFINITE ? tm->lastScore - score : 0;
+	int scale = 0;
+	int limit = 0;
+
+	if(bestMove == tm->lastBestMove) {
+		tm->stability++;
+	} else {
+		tm->stability = 0;
+	}
+	tm->lastBestMove = bestMove;
+	tm->lastScore = score;
+
+	if(info->timeset == BOOL_TYPE_FALSE) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	if(drop < 0) drop = 0;
+	if(drop > TIME_DROP_CAP) drop = TIME_DROP_CAP;
+	scale = StabilityScale[tm->stability < 5 ? tm->stability : 5] + drop;
+
+	limit = (int)((long)tm->softTime * scale / 100);
+	if(limit > tm->hardTime) limit = tm->hardTime;
+	return Misc_GetTimeMs() - tm->start >= limit ? BOOL_TYPE_TRUE : BOOL_TYPE_FALSE;
+}
+
+long Time_CheckInterval(const SearchInfo *info, const int now) {
+
+	long interval = TIME_HELPER_CHECK;
+	int elapsed = now - info->starttime;
+
+	if(info->threadId == 0) {
+		interval = elapsed > 0 ? info->nodes / elapsed : TIME_CHECK_MIN;
+		if(interval < TIME_CHECK_MIN) interval = TIME_CHECK_MIN;
+		if(interval > TIME_CHECK_MAX) interval = TIME_CHECK_MAX;
+	}
+	return interval;
+}
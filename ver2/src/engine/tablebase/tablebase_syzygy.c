@@ -0,0 +1,1420 @@
+/**
+ * @file tablebase_syzygy.c
+ * @brief Syzygy endgame tablebase probing (WDL and DTZ)
+ *
+ * Reads the .rtbw (win/draw/loss) and .rtbz (distance to zeroing) files
+ * of the Syzygy format:
+ * - Tb_Init looks for every table of up to TB_MAX_PIECES men in the
+ *   SyzygyPath directories and registers it under the material key of
+ *   both colourings; nothing is read yet
+ * - A table is memory mapped (Misc_MapFile) and its headers parsed on
+ *   its first probe, under a lock, so unused tables cost no memory
+ * - A probe turns the position into the table index (board symmetry,
+ *   king pair and binomial group encoding) and decodes the one block
+ *   holding it: canonical Huffman symbols expanded by recursive pairing
+ * - Tables assume the side to move has no capture that changes the
+ *   result and hold no en passant rights, so Tb_ProbeWdl resolves
+ *   captures first; Tb_ProbeDtz adds a one-ply search when the DTZ
+ *   table is stored for the other side to move
+ * - Tb_RootFilter ranks the root moves by DTZ and the fifty move counter
+ *   and leaves only the best ones to the search
+ * - Tb_Init probes positions whose result is known from chess alone
+ *   (3 to 5 men); the tables stay in use only when at least one of them
+ *   is covered and every covered one decoded right, otherwise they are
+ *   disabled altogether (search probes and root filter alike)
+ *
+ * All scores are from the side to move's point of view and assume the
+ * fifty move rule: cursed wins and blessed losses are draws over the
+ * board.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "pthread.h"
+#include "types_definitions.h"
+
+#define TB_WDL 0
+#define TB_DTZ 1
+
+#define TB_HASH_SIZE (1 << 13)        // Slots for material keys, two per table
+#define TB_PATH_MAX 1024
+
+#ifdef _WIN32
+#define TB_PATH_SEPARATOR ';'
+#else
+#define TB_PATH_SEPARATOR ':'
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TB_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define TB_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define TB_LOAD(p) (*(volatile int *)(p))
+#define TB_STORE(p,v) (*(volatile int *)(p) = (v))
+#endif
+
+// pairs data flags
+#define TB_FLAG_STM 1
+#define TB_FLAG_MAPPED 2
+#define TB_FLAG_WIN_PLIES 4
+#define TB_FLAG_LOSS_PLIES 8
+#define TB_FLAG_WIDE 16
+#define TB_FLAG_SINGLE_VALUE 128
+
+// table header flags
+#define TB_HEADER_SPLIT 1
+#define TB_HEADER_PAWNS 2
+
+#define TB_KING 6
+
+enum { PROBE_CHANGE_STM = -1, PROBE_FAIL = 0, PROBE_OK = 1, PROBE_ZEROING = 2 };
+
+/**
+ * Decoding data of one table side and pawn file
+ * - pieces/groupLen/groupIdx: piece order and index groups of the encoding
+ * - base64/symlen: canonical Huffman bases and pair expansion lengths (owned)
+ * - lowestSym/btree/sparseIndex/blockLength/data: point into the mapping
+ */
+typedef struct {
+	int flags;
+	int minSymLen;
+	int maxSymLen;
+	int base64Size;
+	int symCount;
+	int numBlocks;
+	U64 blockLengthSize;
+	U64 sizeofBlock;
+	U64 span;
+	U64 sparseIndexSize;
+	U64 *base64;
+	unsigned char *symlen;
+	const unsigned char *lowestSym;
+	const unsigned char *btree;
+	const unsigned char *sparseIndex;
+	const unsigned char *blockLength;
+	const unsigned char *data;
+	int pieces[TB_MAX_PIECES];
+	int groupLen[TB_MAX_PIECES + 1];
+	U64 groupIdx[TB_MAX_PIECES + 1];
+	unsigned short mapIdx[4];
+} TbPairs;
+
+/**
+ * One WDL or DTZ file
+ * - name: material code, e.g. "KRPvKR" (White is the left side)
+ * - key/key2: material key of the name and of the colours swapped
+ * - ready: set once the file was mapped (or found unusable), base NULL then
+ */
+typedef struct {
+	char name[TB_MAX_PIECES + 2];
+	int type;
+	U64 key;
+	U64 key2;
+	int pieceCount;
+	int hasPawns;
+	int hasUniquePieces;
+	int pawnCount[2];
+	int ready;
+	const unsigned char *base;
+	size_t size;
+	const unsigned char *map;
+	TbPairs pairs[2][4];
+} TbTable;
+
+typedef struct {
+	U64 key;
+	int index;
+} TbSlot;
+
+int g_tbMaxPieces = 0;
+
+static TbTable *tables = NULL;        // WDL table 2 * i, its DTZ table 2 * i + 1
+static int tableCount = 0;
+static int tableCapacity = 0;
+static TbSlot slots[TB_HASH_SIZE];
+static char tbPath[TB_PATH_MAX];
+static pthread_mutex_t tbMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int MapB1H1H7[64];
+static int MapA1D1D4[64];
+static int MapKK[10][64];
+static U64 Binomial[6][64];
+static int MapPawns[64];
+static int LeadPawnIdx[6][64];
+static int LeadPawnsSize[6][4];
+
+static const char PieceChars[] = " PNBRQK";
+
+static unsigned Read16LE(const unsigned char *data) {
+	return data[0] | (data[1] << 8);
+}
+
+static U64 Read32LE(const unsigned char *data) {
+	return (U64)data[0] | ((U64)data[1] << 8) | ((U64)data[2] << 16) | ((U64)data[3] << 24);
+}
+
+static U64 Read32BE(const unsigned char *data) {
+	return ((U64)data[0] << 24) | ((U64)data[1] << 16) | ((U64)data[2] << 8) | (U64)data[3];
+}
+
+static U64 Read64BE(const unsigned char *data) {
+	return (Read32BE(data) << 32) | Read32BE(data + 4);
+}
+
+static int OffA1H8(const int sq) {
+	return (sq >> 3) - (sq & 7);
+}
+
+static int FlipFile(const int sq) {
+	return sq ^ 7;
+}
+
+static int EdgeDistance(const int file) {
+	return file < 7 - file ? file : 7 - file;
+}
+
+/* ---------------------------------------------------------------------------
+ * Encoding tables
+ * ---------------------------------------------------------------------------
+ */
+
+static void InitEncoding() {
+
+	int sq = 0;
+	int sq2 = 0;
+	int code = 0;
+	int index = 0;
+	int n = 0;
+	int k = 0;
+	int file = 0;
+	int rank = 0;
+	int leadCount = 0;
+	int available = 47;
+	int diagonal[4];
+	int diagonalCount = 0;
+	int bothIdx[64];
+	int bothSq[64];
+	int bothCount = 0;
+
+	for(sq = 0; sq < 64; ++sq) {
+		if(OffA1H8(sq) < 0) {
+			MapB1H1H7[sq] = code++;
+		}
+	}
+
+	// a1-d1-d4 triangle, diagonal squares last
+	code = 0;
+	for(sq = 0; sq <= 27; ++sq) {
+		if(OffA1H8(sq) < 0 && (sq & 7) <= 3) {
+			MapA1D1D4[sq] = code++;
+		} else if(OffA1H8(sq) == 0 && (sq & 7) <= 3) {
+			diagonal[diagonalCount++] = sq;
+		}
+	}
+	for(index = 0; index < diagonalCount; ++index) {
+		MapA1D1D4[diagonal[index]] = code++;
+	}
+
+	// the 462 legal king pairs with the first king in the triangle; a first
+	// king on the diagonal keeps the second one on or below it
+	code = 0;
+	for(index = 0; index < 10; ++index) {
+		for(sq = 0; sq <= 27; ++sq) {
+			if(MapA1D1D4[sq] != index || (index == 0 && sq != 1)) {
+				continue;
+			}
+			for(sq2 = 0; sq2 < 64; ++sq2) {
+				if(abs((sq >> 3) - (sq2 >> 3)) <= 1 && abs((sq & 7) - (sq2 & 7)) <= 1) {
+					continue;
+				} else if(OffA1H8(sq) == 0 && OffA1H8(sq2) > 0) {
+					continue;
+				} else if(OffA1H8(sq) == 0 && OffA1H8(sq2) == 0) {
+					bothIdx[bothCount] = index;
+					bothSq[bothCount++] = sq2;
+				} else {
+					MapKK[index][sq2] = code++;
+				}
+			}
+		}
+	}
+	for(index = 0; index < bothCount; ++index) {
+		MapKK[bothIdx[index]][bothSq[index]] = code++;
+	}
+
+	memset(Binomial, 0, sizeof(Binomial));
+	Binomial[0][0] = 1;
+	for(n = 1; n < 64; ++n) {
+		for(k = 0; k < 6 && k <= n; ++k) {
+			Binomial[k][n] = (k > 0 ? Binomial[k - 1][n - 1] : 0) + (k < n ? Binomial[k][n - 1] : 0);
+		}
+	}
+
+	// a2-h7 ranked so the leading pawn (highest value) is the one nearest
+	// the edge, then lowest rank; indices restart on every file
+	for(leadCount = 1; leadCount <= 5; ++leadCount) {
+		for(file = 0; file < 4; ++file) {
+			index = 0;
+			for(rank = 1; rank <= 6; ++rank) {
+				sq = rank * 8 + file;
+				if(leadCount == 1) {
+					MapPawns[sq] = available--;
+					MapPawns[FlipFile(sq)] = available--;
+				}
+				LeadPawnIdx[leadCount][sq] = index;
+				index += (int)Binomial[leadCount - 1][MapPawns[sq]];
+			}
+			LeadPawnsSize[leadCount][file] = index;
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------
+ * Table registry
+ * ---------------------------------------------------------------------------
+ */
+
+// four bits per piece count: white pawn..queen, then black pawn..queen
+static U64 CountsKey(const int counts[2][6]) {
+
+	U64 key = 0ULL;
+	int colour = 0;
+	int type = 0;
+
+	for(colour = 0; colour < 2; ++colour) {
+		for(type = 1; type < TB_KING; ++type) {
+			key |= (U64)counts[colour][type] << (4 * (colour * 5 + type - 1));
+		}
+	}
+	return key;
+}
+
+static U64 BoardKey(const ChessBoard *board) {
+
+	int counts[2][6];
+	int type = 0;
+
+	for(type = 1; type < TB_KING; ++type) {
+		counts[COLOR_TYPE_WHITE][type] = board->pieceCount[type];
+		counts[COLOR_TYPE_BLACK][type] = board->pieceCount[type + 6];
+	}
+	return CountsKey(counts);
+}
+
+static int FindSlot(const U64 key) {
+
+	int slot = (int)((key ^ (key >> 23) ^ (key >> 41)) & (TB_HASH_SIZE - 1));
+
+	while(slots[slot].index >= 0 && slots[slot].key != key) {
+		slot = (slot + 1) & (TB_HASH_SIZE - 1);
+	}
+	return slot;
+}
+
+static int FileExists(const char *name, const char *extension) {
+
+	char path[TB_PATH_MAX + 32];
+	const char *dir = tbPath;
+	FILE *file = NULL;
+
+	while(*dir) {
+		const char *end = strchr(dir, TB_PATH_SEPARATOR);
+		int length = end != NULL ? (int)(end - dir) : (int)strlen(dir);
+		snprintf(path, sizeof(path), "%.*s/%s%s", length, dir, name, extension);
+		file = fopen(path, "rb");
+		if(file != NULL) {
+			fclose(file);
+			return BOOL_TYPE_TRUE;
+		}
+		dir += end != NULL ? length + 1 : length;
+	}
+	return BOOL_TYPE_FALSE;
+}
+
+// registers the WDL table for the list of piece types (two kings) when its
+// file exists, together with a DTZ table mapped if it is ever needed
+static void AddTable(const int *types, const int count) {
+
+	int counts[2][6];
+	int index = 0;
+	int colour = 0;
+	int type = 0;
+	char name[TB_MAX_PIECES + 2];
+	int length = 0;
+	TbTable *wdl = NULL;
+
+	memset(counts, 0, sizeof(counts));
+	for(index = 0; index < count; ++index) {
+		if(index > 0 && types[index] == TB_KING) {
+			name[length++] = 'v';
+			colour = 1;
+		}
+		name[length++] = PieceChars[types[index]];
+		counts[colour][types[index]]++;
+	}
+	name[length] = '\0';
+
+	if(!FileExists(name, ".rtbw")) {
+		return;
+	}
+
+	if(tableCount == tableCapacity) {
+		int capacity = tableCapacity > 0 ? tableCapacity * 2 : 256;
+		TbTable *grown = (TbTable *) realloc(tables, 2 * capacity * sizeof(TbTable));
+		if(grown == NULL) {
+			return;
+		}
+		tables = grown;
+		tableCapacity = capacity;
+	}
+
+	wdl = &tables[2 * tableCount];
+	memset(wdl, 0, 2 * sizeof(TbTable));
+	strcpy(wdl->name, name);
+	wdl->type = TB_WDL;
+	wdl->pieceCount = count;
+	for(colour = 0; colour < 2; ++colour) {
+		for(type = 1; type < TB_KING; ++type) {
+			if(counts[colour][type] == 1) {
+				wdl->hasUniquePieces = BOOL_TYPE_TRUE;
+			}
+		}
+	}
+	wdl->hasPawns = counts[0][1] + counts[1][1] > 0;
+	// the side with fewer pawns leads, it compresses better
+	colour = counts[1][1] == 0 || (counts[0][1] > 0 && counts[1][1] >= counts[0][1]) ? 0 : 1;
+	wdl->pawnCount[0] = counts[colour][1];
+	wdl->pawnCount[1] = counts[colour ^ 1][1];
+	wdl->key = CountsKey(counts);
+	for(type = 1; type < TB_KING; ++type) {
+		int swap = counts[0][type];
+		counts[0][type] = counts[1][type];
+		counts[1][type] = swap;
+	}
+	wdl->key2 = CountsKey(counts);
+
+	wdl[1] = wdl[0];
+	wdl[1].type = TB_DTZ;
+
+	for(index = 0; index < 2; ++index) {
+		int slot = FindSlot(index == 0 ? wdl->key : wdl->key2);
+		slots[slot].key = index == 0 ? wdl->key : wdl->key2;
+		slots[slot].index = tableCount;
+	}
+	tableCount++;
+	if(count > g_tbMaxPieces) {
+		g_tbMaxPieces = count;
+	}
+}
+
+// every 3 to 7 men material split, strongest side first
+static void AddAllTables() {
+
+	int p1 = 0, p2 = 0, p3 = 0, p4 = 0, p5 = 0;
+
+	for(p1 = 1; p1 < TB_KING; ++p1) {
+		AddTable((const int[]){ TB_KING, p1, TB_KING }, 3);
+		for(p2 = 1; p2 <= p1; ++p2) {
+			AddTable((const int[]){ TB_KING, p1, p2, TB_KING }, 4);
+			AddTable((const int[]){ TB_KING, p1, TB_KING, p2 }, 4);
+			for(p3 = 1; p3 < TB_KING; ++p3) {
+				AddTable((const int[]){ TB_KING, p1, p2, TB_KING, p3 }, 5);
+			}
+			for(p3 = 1; p3 <= p2; ++p3) {
+				AddTable((const int[]){ TB_KING, p1, p2, p3, TB_KING }, 5);
+				for(p4 = 1; p4 <= p3; ++p4) {
+					AddTable((const int[]){ TB_KING, p1, p2, p3, p4, TB_KING }, 6);
+					for(p5 = 1; p5 <= p4; ++p5) {
+						AddTable((const int[]){ TB_KING, p1, p2, p3, p4, p5, TB_KING }, 7);
+					}
+					for(p5 = 1; p5 < TB_KING; ++p5) {
+						AddTable((const int[]){ TB_KING, p1, p2, p3, p4, TB_KING, p5 }, 7);
+					}
+				}
+				for(p4 = 1; p4 < TB_KING; ++p4) {
+					AddTable((const int[]){ TB_KING, p1, p2, p3, TB_KING, p4 }, 6);
+					for(p5 = 1; p5 <= p4; ++p5) {
+						AddTable((const int[]){ TB_KING, p1, p2, p3, TB_KING, p4, p5 }, 7);
+					}
+				}
+			}
+			for(p3 = 1; p3 <= p1; ++p3) {
+				for(p4 = 1; p4 <= (p1 == p3 ? p2 : p3); ++p4) {
+					AddTable((const int[]){ TB_KING, p1, p2, TB_KING, p3, p4 }, 6);
+				}
+			}
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------
+ * Header parsing
+ * ---------------------------------------------------------------------------
+ */
+
+static void SetGroups(const TbTable *table, TbPairs *d, const int order[2], const int file) {
+
+	int n = 0;
+	int index = 0;
+	int k = 0;
+	int firstLen = table->hasPawns ? 0 : table->hasUniquePieces ? 3 : 2;
+	int pp = table->hasPawns && table->pawnCount[1];
+	int next = pp ? 2 : 1;
+	int freeSquares = 0;
+	U64 idx = 1;
+
+	d->groupLen[n] = 1;
+	// the leading group is the kings plus a unique piece, or the lead pawns;
+	// every other group gathers the pieces of one kind
+	for(index = 1; index < table->pieceCount; ++index) {
+		if(--firstLen > 0 || d->pieces[index] == d->pieces[index - 1]) {
+			d->groupLen[n]++;
+		} else {
+			d->groupLen[++n] = 1;
+		}
+	}
+	d->groupLen[++n] = 0;
+
+	freeSquares = 64 - d->groupLen[0] - (pp ? d->groupLen[1] : 0);
+	for(k = 0; next < n || k == order[0] || k == order[1]; ++k) {
+		if(k == order[0]) {
+			d->groupIdx[0] = idx;
+			idx *= table->hasPawns ? (U64)LeadPawnsSize[d->groupLen[0]][file] : table->hasUniquePieces ? 31332 : 462;
+		} else if(k == order[1]) {
+			d->groupIdx[1] = idx;
+			idx *= Binomial[d->groupLen[1]][48 - d->groupLen[0]];
+		} else {
+			d->groupIdx[next] = idx;
+			idx *= Binomial[d->groupLen[next]][freeSquares];
+			freeSquares -= d->groupLen[next++];
+		}
+	}
+	d->groupIdx[n] = idx;
+}
+
+static int Left(const TbPairs *d, const int sym) {
+	const unsigned char *lr = d->btree + 3 * sym;
+	return ((lr[1] & 0xF) << 8) | lr[0];
+}
+
+static int Right(const TbPairs *d, const int sym) {
+	const unsigned char *lr = d->btree + 3 * sym;
+	return (lr[2] << 4) | (lr[1] >> 4);
+}
+
+// number of values a symbol expands to, minus one
+static int SetSymLen(TbPairs *d, const int sym, unsigned char *visited) {
+
+	int left = 0;
+	int right = Right(d, sym);
+
+	visited[sym] = 1;
+	if(right == 0xFFF) {
+		return 0;
+	}
+	left = Left(d, sym);
+	if(!visited[left]) {
+		d->symlen[left] = (unsigned char)SetSymLen(d, left, visited);
+	}
+	if(!visited[right]) {
+		d->symlen[right] = (unsigned char)SetSymLen(d, right, visited);
+	}
+	return d->symlen[left] + d->symlen[right] + 1;
+}
+
+static const unsigned char *SetSizes(TbPairs *d, const unsigned char *data) {
+
+	int index = 0;
+	int padding = 0;
+	U64 tbSize = 0;
+	unsigned char *visited = NULL;
+
+	d->flags = *data++;
+	if(d->flags & TB_FLAG_SINGLE_VALUE) {
+		d->numBlocks = 0;
+		d->blockLengthSize = 0;
+		d->span = 0;
+		d->sparseIndexSize = 0;
+		d->minSymLen = *data++;
+		return data;
+	}
+
+	for(index = 0; d->groupLen[index] != 0; ++index) ;
+	tbSize = d->groupIdx[index];
+	d->sizeofBlock = 1ULL << *data++;
+	d->span = 1ULL << *data++;
+	d->sparseIndexSize = (tbSize + d->span - 1) / d->span;
+	padding = *data++;
+	d->numBlocks = (int)Read32LE(data);
+	data += 4;
+	d->blockLengthSize = (U64)d->numBlocks + padding;
+	d->maxSymLen = *data++;
+	d->minSymLen = *data++;
+	d->lowestSym = data;
+	d->base64Size = d->maxSymLen - d->minSymLen + 1;
+
+	// canonical Huffman: longer codes have lower values, so base64[len]
+	// is the smallest 64-bit left-aligned code of each length
+	d->base64 = (U64 *) calloc(d->base64Size, sizeof(U64));
+	if(d->base64 == NULL) {
+		return NULL;
+	}
+	for(index = d->base64Size - 2; index >= 0; --index) {
+		d->base64[index] = (d->base64[index + 1] + Read16LE(d->lowestSym + 2 * index)
+			- Read16LE(d->lowestSym + 2 * (index + 1))) / 2;
+	}
+	for(index = 0; index < d->base64Size; ++index) {
+		d->base64[index] <<= 64 - index - d->minSymLen;
+	}
+	data += d->base64Size * 2;
+
+	d->symCount = (int)Read16LE(data);
+	data += 2;
+	d->btree = data;
+	d->symlen = (unsigned char *) calloc(d->symCount, 1);
+	visited = (unsigned char *) calloc(d->symCount, 1);
+	if(d->symlen == NULL || visited == NULL) {
+		free(visited);
+		return NULL;
+	}
+	for(index = 0; index < d->symCount; ++index) {
+		if(!visited[index]) {
+			d->symlen[index] = (unsigned char)SetSymLen(d, index, visited);
+		}
+	}
+	free(visited);
+	return data + d->symCount * 3 + (d->symCount & 1);
+}
+
+static const unsigned char *SetDtzMap(TbTable *table, const unsigned char *data, const int maxFile) {
+
+	int file = 0;
+	int index = 0;
+
+	table->map = data;
+	for(file = 0; file <= maxFile; ++file) {
+		TbPairs *d = &table->pairs[0][file];
+		if(!(d->flags & TB_FLAG_MAPPED)) {
+			continue;
+		}
+		if(d->flags & TB_FLAG_WIDE) {
+			data += (data - table->base) & 1;
+			for(index = 0; index < 4; ++index) {
+				d->mapIdx[index] = (unsigned short)((data - table->map) / 2 + 1);
+				data += 2 * Read16LE(data) + 2;
+			}
+		} else {
+			for(index = 0; index < 4; ++index) {
+				d->mapIdx[index] = (unsigned short)(data - table->map + 1);
+				data += *data + 1;
+			}
+		}
+	}
+	return data + ((data - table->base) & 1);
+}
+
+static int SetupTable(TbTable *table, const unsigned char *data) {
+
+	int sides = table->type == TB_WDL && table->key != table->key2 ? 2 : 1;
+	int maxFile = table->hasPawns ? 3 : 0;
+	int pp = table->hasPawns && table->pawnCount[1];
+	int order[2][2];
+	int file = 0;
+	int side = 0;
+	int k = 0;
+
+	if(((*data & TB_HEADER_PAWNS) != 0) != (table->hasPawns != 0)
+		|| ((*data & TB_HEADER_SPLIT) != 0) != (table->key != table->key2)) {
+		return BOOL_TYPE_FALSE;
+	}
+	data++;
+
+	for(file = 0; file <= maxFile; ++file) {
+		order[0][0] = *data & 0xF;
+		order[0][1] = pp ? *(data + 1) & 0xF : 0xF;
+		order[1][0] = *data >> 4;
+		order[1][1] = pp ? *(data + 1) >> 4 : 0xF;
+		data += 1 + pp;
+		for(k = 0; k < table->pieceCount; ++k, ++data) {
+			for(side = 0; side < sides; ++side) {
+				table->pairs[side][file].pieces[k] = side ? *data >> 4 : *data & 0xF;
+			}
+		}
+		for(side = 0; side < sides; ++side) {
+			SetGroups(table, &table->pairs[side][file], order[side], file);
+		}
+	}
+
+	data += (data - table->base) & 1;
+	for(file = 0; file <= maxFile; ++file) {
+		for(side = 0; side < sides; ++side) {
+			data = SetSizes(&table->pairs[side][file], data);
+			if(data == NULL) {
+				return BOOL_TYPE_FALSE;
+			}
+		}
+	}
+
+	if(table->type == TB_DTZ) {
+		data = SetDtzMap(table, data, maxFile);
+	}
+
+	for(file = 0; file <= maxFile; ++file) {
+		for(side = 0; side < sides; ++side) {
+			table->pairs[side][file].sparseIndex = data;
+			data += table->pairs[side][file].sparseIndexSize * 6;
+		}
+	}
+	for(file = 0; file <= maxFile; ++file) {
+		for(side = 0; side < sides; ++side) {
+			table->pairs[side][file].blockLength = data;
+			data += table->pairs[side][file].blockLengthSize * 2;
+		}
+	}
+	for(file = 0; file <= maxFile; ++file) {
+		for(side = 0; side < sides; ++side) {
+			data = table->base + (((data - table->base) + 0x3F) & ~0x3F);
+			table->pairs[side][file].data = data;
+			data += (U64)table->pairs[side][file].numBlocks * table->pairs[side][file].sizeofBlock;
+		}
+	}
+	return (size_t)(data - table->base) <= table->size;
+}
+
+static void FreePairs(TbTable *table) {
+
+	int side = 0;
+	int file = 0;
+
+	for(side = 0; side < 2; ++side) {
+		for(file = 0; file < 4; ++file) {
+			free(table->pairs[side][file].base64);
+			free(table->pairs[side][file].symlen);
+			table->pairs[side][file].base64 = NULL;
+			table->pairs[side][file].symlen = NULL;
+		}
+	}
+}
+
+static void MapTable(TbTable *table) {
+
+	static const unsigned char Magics[2][4] = { { 0x71, 0xE8, 0x23, 0x5D }, { 0xD7, 0x66, 0x0C, 0xA5 } };
+	char path[TB_PATH_MAX + 32];
+	const char *extension = table->type == TB_WDL ? ".rtbw" : ".rtbz";
+	const char *dir = tbPath;
+	const unsigned char *data = NULL;
+	size_t size = 0;
+
+	while(*dir && data == NULL) {
+		const char *end = strchr(dir, TB_PATH_SEPARATOR);
+		int length = end != NULL ? (int)(end - dir) : (int)strlen(dir);
+		snprintf(path, sizeof(path), "%.*s/%s%s", length, dir, table->name, extension);
+		data = (const unsigned char *) Misc_MapFile(path, &size);
+		if(data != NULL && (size % 64 != 16 || memcmp(data, Magics[table->type], 4) != 0)) {
+			printf("info string Corrupted tablebase file %s\n", path);
+			Misc_UnmapFile(data, size);
+			data = NULL;
+		}
+		dir += end != NULL ? length + 1 : length;
+	}
+	if(data == NULL) {
+		return;
+	}
+
+	table->base = data;
+	table->size = size;
+	if(!SetupTable(table, data + 4)) {
+		printf("info string Corrupted tablebase file %s\n", path);
+		FreePairs(table);
+		Misc_UnmapFile(data, size);
+		table->base = NULL;
+		table->size = 0;
+	}
+}
+
+// first probe of a table maps it; a missing or broken file stays unusable
+static int TableReady(TbTable *table) {
+
+	if(!TB_LOAD(&table->ready)) {
+		pthread_mutex_lock(&tbMutex);
+		if(!table->ready) {
+			MapTable(table);
+			TB_STORE(&table->ready, 1);
+		}
+		pthread_mutex_unlock(&tbMutex);
+	}
+	return table->base != NULL;
+}
+
+/* ---------------------------------------------------------------------------
+ * Probing
+ * ---------------------------------------------------------------------------
+ */
+
+// value number idx of the table: find its block through the sparse index,
+// walk the Huffman symbols to the one covering it, then expand the pairs
+static int DecompressPairs(const TbPairs *d, const U64 idx) {
+
+	U64 k = 0;
+	U64 block = 0;
+	int offset = 0;
+	const unsigned char *ptr = NULL;
+	U64 buf64 = 0;
+	int buf64Size = 64;
+	int sym = 0;
+	int len = 0;
+
+	if(d->flags & TB_FLAG_SINGLE_VALUE) {
+		return d->minSymLen;
+	}
+
+	k = idx / d->span;
+	block = Read32LE(d->sparseIndex + 6 * k);
+	offset = (int)Read16LE(d->sparseIndex + 6 * k + 4);
+	offset += (int)(idx % d->span) - (int)(d->span / 2);
+
+	while(offset < 0) {
+		offset += (int)Read16LE(d->blockLength + 2 * (--block)) + 1;
+	}
+	while(offset > (int)Read16LE(d->blockLength + 2 * block)) {
+		offset -= (int)Read16LE(d->blockLength + 2 * block) + 1;
+		block++;
+	}
+
+	ptr = d->data + block * d->sizeofBlock;
+	buf64 = Read64BE(ptr);
+	ptr += 8;
+
+	while(BOOL_TYPE_TRUE) {
+		len = 0;
+		while(buf64 < d->base64[len]) {
+			++len;
+		}
+		sym = (int)((buf64 - d->base64[len]) >> (64 - len - d->minSymLen));
+		sym += (int)Read16LE(d->lowestSym + 2 * len);
+		if(offset < d->symlen[sym] + 1) {
+			break;
+		}
+		offset -= d->symlen[sym] + 1;
+		len += d->minSymLen;
+		buf64 <<= len;
+		buf64Size -= len;
+		if(buf64Size <= 32) {
+			buf64Size += 32;
+			buf64 |= Read32BE(ptr) << (64 - buf64Size);
+			ptr += 4;
+		}
+	}
+
+	while(d->symlen[sym]) {
+		int left = Left(d, sym);
+		if(offset < d->symlen[left] + 1) {
+			sym = left;
+		} else {
+			offset -= d->symlen[left] + 1;
+			sym = Right(d, sym);
+		}
+	}
+	return Left(d, sym);
+}
+
+static int MapScore(const TbTable *table, const int file, int value, const int wdl) {
+
+	static const int WdlMap[5] = { 1, 3, 0, 2, 0 };
+	const TbPairs *d = &table->pairs[0][file];
+
+	if(table->type == TB_WDL) {
+		return value - 2;
+	}
+
+	if(d->flags & TB_FLAG_MAPPED) {
+		if(d->flags & TB_FLAG_WIDE) {
+			value = (int)Read16LE(table->map + 2 * (d->mapIdx[WdlMap[wdl + 2]] + value));
+		} else {
+			value = table->map[d->mapIdx[WdlMap[wdl + 2]] + value];
+		}
+	}
+
+	// stored in moves unless the table says plies
+	if((wdl == TB_WDL_WIN && !(d->flags & TB_FLAG_WIN_PLIES))
+		|| (wdl == TB_WDL_LOSS && !(d->flags & TB_FLAG_LOSS_PLIES))
+		|| wdl == TB_WDL_CURSED_WIN || wdl == TB_WDL_BLESSED_LOSS) {
+		value *= 2;
+	}
+	return value + 1;
+}
+
+static int TbPiece(const int piece) {
+	return piece <= PIECE_TYPE_WHITE_KING ? piece : piece + 2;
+}
+
+static int DoProbeTable(const ChessBoard *board, TbTable *table, const U64 key, const int wdl, int *result) {
+
+	int squares[TB_MAX_PIECES];
+	int pieces[TB_MAX_PIECES];
+	int size = 0;
+	int leadCount = 0;
+	int tbFile = 0;
+	int index = 0;
+	int index2 = 0;
+	int next = 0;
+	int swap = 0;
+	int *groupSq = NULL;
+	int remainingPawns = BOOL_TYPE_FALSE;
+	U64 idx = 0;
+	U64 b = 0ULL;
+	U64 leadPawns = 0ULL;
+	const TbPairs *d = NULL;
+
+	// tables are stored with the stronger side as White; a symmetric
+	// table only holds White to move
+	int symmetricBlackToMove = table->key == table->key2 && board->side == COLOR_TYPE_BLACK;
+	int blackStronger = key != table->key;
+	int flip = symmetricBlackToMove || blackStronger;
+	int flipColour = flip * 8;
+	int flipSquares = flip * 56;
+	int stm = flip ^ board->side;
+
+	// pawn tables are split by the file of the leading pawn: the one
+	// nearest the edge, then lowest rank
+	if(table->hasPawns) {
+		int pawn = table->pairs[0][0].pieces[0] ^ flipColour;
+		leadPawns = b = board->pieceBB[pawn < 8 ? PIECE_TYPE_WHITE_PAWN : PIECE_TYPE_BLACK_PAWN];
+		while(b) {
+			squares[size++] = BITBOARD_POP(&b) ^ flipSquares;
+		}
+		leadCount = size;
+		for(index = 1; index < leadCount; ++index) {
+			if(MapPawns[squares[index]] > MapPawns[squares[index2]]) {
+				index2 = index;
+			}
+		}
+		swap = squares[0];
+		squares[0] = squares[index2];
+		squares[index2] = swap;
+		tbFile = EdgeDistance(squares[0] & 7);
+	}
+
+	if(table->type == TB_DTZ && (table->pairs[0][tbFile].flags & TB_FLAG_STM) != stm
+		&& (table->key != table->key2 || table->hasPawns)) {
+		*result = PROBE_CHANGE_STM;
+		return 0;
+	}
+
+	b = board->occupied[COLOR_TYPE_BOTH] ^ leadPawns;
+	while(b) {
+		int sq = BITBOARD_POP(&b);
+		squares[size] = sq ^ flipSquares;
+		pieces[size++] = TbPiece(board->pieces[SQUARE_64_TO_120(sq)]) ^ flipColour;
+	}
+
+	d = &table->pairs[table->type == TB_WDL ? stm : 0][tbFile];
+
+	// same piece order as the table
+	for(index = leadCount; index < size - 1; ++index) {
+		for(index2 = index + 1; index2 < size; ++index2) {
+			if(d->pieces[index] == pieces[index2]) {
+				swap = pieces[index]; pieces[index] = pieces[index2]; pieces[index2] = swap;
+				swap = squares[index]; squares[index] = squares[index2]; squares[index2] = swap;
+				break;
+			}
+		}
+	}
+
+	// lead piece into the a1-d1-d4 triangle (pawns: files a-d)
+	if((squares[0] & 7) > 3) {
+		for(index = 0; index < size; ++index) {
+			squares[index] = FlipFile(squares[index]);
+		}
+	}
+
+	if(table->hasPawns) {
+		idx = LeadPawnIdx[leadCount][squares[0]];
+		// ascending MapPawns, insertion sort keeps it stable
+		for(index = 2; index < leadCount; ++index) {
+			int sq = squares[index];
+			for(index2 = index; index2 > 1 && MapPawns[squares[index2 - 1]] > MapPawns[sq]; --index2) {
+				squares[index2] = squares[index2 - 1];
+			}
+			squares[index2] = sq;
+		}
+		for(index = 1; index < leadCount; ++index) {
+			idx += Binomial[index][MapPawns[squares[index]]];
+		}
+	} else {
+		if((squares[0] >> 3) > 3) {
+			for(index = 0; index < size; ++index) {
+				squares[index] ^= 56;
+			}
+		}
+		// first leading piece off the a1-h8 diagonal goes below it
+		for(index = 0; index < d->groupLen[0]; ++index) {
+			if(!OffA1H8(squares[index])) {
+				continue;
+			}
+			if(OffA1H8(squares[index]) > 0) {
+				for(index2 = index; index2 < size; ++index2) {
+					squares[index2] = ((squares[index2] >> 3) | (squares[index2] << 3)) & 63;
+				}
+			}
+			break;
+		}
+
+		if(table->hasUniquePieces) {
+			int adjust1 = squares[1] > squares[0];
+			int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+			if(OffA1H8(squares[0])) {
+				idx = ((U64)MapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+			} else if(OffA1H8(squares[1])) {
+				idx = ((U64)6 * 63 + (squares[0] >> 3) * 28 + MapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+			} else if(OffA1H8(squares[2])) {
+				idx = 6 * 63 * 62 + 4 * 28 * 62 + (squares[0] >> 3) * 7 * 28 + ((squares[1] >> 3) - adjust1) * 28
+					+ MapB1H1H7[squares[2]];
+			} else {
+				idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + (squares[0] >> 3) * 7 * 6
+					+ ((squares[1] >> 3) - adjust1) * 6 + ((squares[2] >> 3) - adjust2);
+			}
+		} else {
+			idx = MapKK[MapA1D1D4[squares[0]]][squares[1]];
+		}
+	}
+
+	// remaining groups: ascending squares, each skipping the squares of
+	// the groups before it
+	idx *= d->groupIdx[0];
+	groupSq = squares + d->groupLen[0];
+	remainingPawns = table->hasPawns && table->pawnCount[1];
+	while(d->groupLen[++next]) {
+		U64 n = 0;
+		for(index = 1; index < d->groupLen[next]; ++index) {
+			int sq = groupSq[index];
+			for(index2 = index; index2 > 0 && groupSq[index2 - 1] > sq; --index2) {
+				groupSq[index2] = groupSq[index2 - 1];
+			}
+			groupSq[index2] = sq;
+		}
+		for(index = 0; index < d->groupLen[next]; ++index) {
+			int adjust = 0;
+			for(index2 = 0; squares + index2 < groupSq; ++index2) {
+				adjust += groupSq[index] > squares[index2];
+			}
+			n += Binomial[index + 1][groupSq[index] - adjust - 8 * remainingPawns];
+		}
+		remainingPawns = BOOL_TYPE_FALSE;
+		idx += n * d->groupIdx[next];
+		groupSq += d->groupLen[next];
+	}
+
+	return MapScore(table, tbFile, DecompressPairs(d, idx), wdl);
+}
+
+static int ProbeTable(const ChessBoard *board, const int type, const int wdl, int *result) {
+
+	U64 key = 0ULL;
+	TbTable *table = NULL;
+	int slot = 0;
+
+	if(BITBOARD_COUNT(board->occupied[COLOR_TYPE_BOTH]) == 2) {
+		return 0;
+	}
+
+	key = BoardKey(board);
+	slot = FindSlot(key);
+	if(slots[slot].index < 0) {
+		*result = PROBE_FAIL;
+		return 0;
+	}
+	table = &tables[2 * slots[slot].index + type];
+	if(!TableReady(table)) {
+		*result = PROBE_FAIL;
+		return 0;
+	}
+	return DoProbeTable(board, table, key, wdl, result);
+}
+
+static int IsZeroing(const ChessBoard *board, const int move) {
+	return (move & MFLAGCAP) || g_piecePawn[board->pieces[MOVE_GET_FROM_SQUARE(move)]];
+}
+
+static int IsMated(ChessBoard *board) {
+
+	MoveList list[1];
+
+	if(!Attack_IsSquareAttacked(board->KingSq[board->side], board->side ^ 1, board)) {
+		return BOOL_TYPE_FALSE;
+	}
+	Move_GenerateLegal(board, list);
+	return list->count == 0;
+}
+
+// WDL with the captures (and, for DTZ, pawn moves) searched out first:
+// they may beat the stored value, which also ignores en passant
+static int SearchWdl(ChessBoard *board, const int checkZeroing, int *result) {
+
+	MoveList list[1];
+	int index = 0;
+	int move = NOMOVE;
+	int value = TB_WDL_LOSS;
+	int bestValue = TB_WDL_LOSS;
+	int moveCount = 0;
+	int noMoreMoves = BOOL_TYPE_FALSE;
+
+	Move_GenerateLegal(board, list);
+	for(index = 0; index < list->count; ++index) {
+		move = list->moves[index].move;
+		if(!(move & MFLAGCAP) && (!checkZeroing || !g_piecePawn[board->pieces[MOVE_GET_FROM_SQUARE(move)]])) {
+			continue;
+		}
+		moveCount++;
+		Move_MakeLegal(board, move);
+		value = -SearchWdl(board, BOOL_TYPE_FALSE, result);
+		Move_Take(board);
+		if(*result == PROBE_FAIL) {
+			return TB_WDL_DRAW;
+		}
+		if(value > bestValue) {
+			bestValue = value;
+			if(value >= TB_WDL_WIN) {
+				*result = PROBE_ZEROING;
+				return value;
+			}
+		}
+	}
+
+	// every legal move was searched: the table value could be wrong (en
+	// passant) or describe a stalemate that is not there
+	noMoreMoves = moveCount > 0 && moveCount == list->count;
+	if(noMoreMoves) {
+		value = bestValue;
+	} else {
+		value = ProbeTable(board, TB_WDL, TB_WDL_DRAW, result);
+		if(*result == PROBE_FAIL) {
+			return TB_WDL_DRAW;
+		}
+	}
+
+	if(bestValue >= value) {
+		*result = bestValue > TB_WDL_DRAW || noMoreMoves ? PROBE_ZEROING : PROBE_OK;
+		return bestValue;
+	}
+	*result = PROBE_OK;
+	return value;
+}
+
+static int DtzBeforeZeroing(const int wdl) {
+	return wdl == TB_WDL_WIN ? 1 : wdl == TB_WDL_CURSED_WIN ? 101 : wdl == TB_WDL_BLESSED_LOSS ? -101 : wdl == TB_WDL_LOSS ? -1 : 0;
+}
+
+static int Sign(const int value) {
+	return (value > 0) - (value < 0);
+}
+
+static int ProbeDtz(ChessBoard *board, int *result) {
+
+	MoveList list[1];
+	int wdl = 0;
+	int dtz = 0;
+	int minDtz = 0xFFFF;
+	int index = 0;
+
+	*result = PROBE_OK;
+	wdl = SearchWdl(board, BOOL_TYPE_TRUE, result);
+	if(*result == PROBE_FAIL || wdl == TB_WDL_DRAW) {
+		return 0;
+	}
+	// the best move zeroes the counter; the stored value is a don't care
+	if(*result == PROBE_ZEROING) {
+		return DtzBeforeZeroing(wdl);
+	}
+
+	dtz = ProbeTable(board, TB_DTZ, wdl, result);
+	if(*result == PROBE_FAIL) {
+		return 0;
+	}
+	if(*result != PROBE_CHANGE_STM) {
+		return (dtz + 100 * (wdl == TB_WDL_BLESSED_LOSS || wdl == TB_WDL_CURSED_WIN)) * Sign(wdl);
+	}
+
+	// stored for the other side: the best reply with a dtz of the right sign
+	Move_GenerateLegal(board, list);
+	for(index = 0; index < list->count; ++index) {
+		int move = list->moves[index].move;
+		int zeroing = IsZeroing(board, move);
+
+		Move_MakeLegal(board, move);
+		dtz = zeroing ? -DtzBeforeZeroing(SearchWdl(board, BOOL_TYPE_FALSE, result)) : -ProbeDtz(board, result);
+		if(dtz == 1 && IsMated(board)) {
+			minDtz = 1;
+		}
+		if(!zeroing) {
+			dtz += Sign(dtz);
+		}
+		if(dtz < minDtz && Sign(dtz) == Sign(wdl)) {
+			minDtz = dtz;
+		}
+		Move_Take(board);
+		if(*result == PROBE_FAIL) {
+			return 0;
+		}
+	}
+	return minDtz == 0xFFFF ? -1 : minDtz;
+}
+
+// the position occurred before since the last capture or pawn move
+static int Repeated(const ChessBoard *board) {
+
+	int index = 0;
+	int stop = board->hisPly - board->fiftyMove;
+
+	if(stop < 0) stop = 0;
+	for(index = board->hisPly - 2; index >= stop; index -= 2) {
+		if(board->history[index].posKey == board->posKey) {
+			return BOOL_TYPE_TRUE;
+		}
+	}
+	return BOOL_TYPE_FALSE;
+}
+
+// any position since the last capture or pawn move occurred twice
+static int HasRepeated(const ChessBoard *board) {
+
+	int index = 0;
+	int index2 = 0;
+	int stop = board->hisPly - board->fiftyMove;
+
+	if(stop < 0) stop = 0;
+	for(index = board->hisPly; index >= stop; --index) {
+		U64 key = index == board->hisPly ? board->posKey : board->history[index].posKey;
+		for(index2 = index - 2; index2 >= stop; index2 -= 2) {
+			if(board->history[index2].posKey == key) {
+				return BOOL_TYPE_TRUE;
+			}
+		}
+	}
+	return BOOL_TYPE_FALSE;
+}
+
+/* ---------------------------------------------------------------------------
+ * Self-check
+ * ---------------------------------------------------------------------------
+ */
+
+#define TB_CHECK_ANY 1000 // DTZ not compared
+
+/**
+ * Position with a result known without the tables; dtz is given where the
+ * distance is short and certain. Stalemates and quiet draws are read from
+ * the table itself, not resolved by the capture search
+ */
+typedef struct {
+	const char *fen;
+	int wdl;
+	int dtz;
+} TbCheck;
+
+static const TbCheck tbChecks[] = {
+	{ "7k/8/6K1/8/8/8/8/Q7 w - - 0 1", TB_WDL_WIN, 1 },             // KQvK, Qa8 or Qg7 mates
+	{ "7k/8/6K1/8/8/8/8/Q7 b - - 0 1", TB_WDL_LOSS, -2 },           // KQvK, mated after Kg8
+	{ "k7/2Q5/1K6/8/8/8/8/8 b - - 0 1", TB_WDL_DRAW, 0 },           // KQvK, stalemate
+	{ "8/8/8/3k4/8/8/8/K6q w - - 0 1", TB_WDL_LOSS, TB_CHECK_ANY }, // KvKQ
+	{ "7k/8/6K1/8/8/8/8/R7 w - - 0 1", TB_WDL_WIN, 1 },             // KRvK, Ra8 mates
+	{ "8/8/8/4k3/8/8/8/R3K3 w - - 0 1", TB_WDL_WIN, TB_CHECK_ANY }, // KRvK
+	{ "8/3KP3/8/8/8/8/8/k7 w - - 0 1", TB_WDL_WIN, 1 },             // KPvK, e8=Q
+	{ "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", TB_WDL_DRAW, 0 },          // KPvK, stalemate
+	{ "k7/8/K7/P7/8/8/8/8 w - - 0 1", TB_WDL_DRAW, 0 },             // KPvK, rook pawn
+	{ "k7/8/K7/P7/8/8/8/8 b - - 0 1", TB_WDL_DRAW, 0 },
+	{ "8/8/8/4k3/8/8/8/KNN5 w - - 0 1", TB_WDL_DRAW, 0 },           // KNNvK
+	{ "8/8/8/4k3/8/8/8/KBN5 w - - 0 1", TB_WDL_WIN, TB_CHECK_ANY }, // KBNvK
+	{ "n7/8/8/4k3/8/8/8/KQQ5 w - - 0 1", TB_WDL_WIN, TB_CHECK_ANY } // KQQvKN
+};
+
+// tables stored in moves rather than plies may report one ply more
+static int DtzMatches(const int dtz, const int expected) {
+	return expected == TB_CHECK_ANY
+		|| (Sign(dtz) == Sign(expected) && abs(dtz) - abs(expected) >= 0 && abs(dtz) - abs(expected) <= 1);
+}
+
+static void SelfCheck() {
+
+	ChessBoard board[1];
+	const TbCheck *check = NULL;
+	char fen[96];
+	int index = 0;
+	int success = BOOL_TYPE_FALSE;
+	int wdl = 0;
+	int dtz = 0;
+	int probed = 0;
+	int failed = 0;
+
+	Board_Init(board);
+	for(index = 0; index < (int)(sizeof(tbChecks) / sizeof(tbChecks[0])); ++index) {
+		check = &tbChecks[index];
+		snprintf(fen, sizeof(fen), "%s", check->fen);
+		Board_ParseFromFEN(fen, board);
+		wdl = Tb_ProbeWdl(board, &success);
+		if(!success) {
+			continue;
+		}
+		dtz = Tb_ProbeDtz(board, &success);
+		probed++;
+		if(wdl != check->wdl || (success && !DtzMatches(dtz, check->dtz))) {
+			printf("info string Syzygy check failed: %s gives wdl %d dtz %d, expected wdl %d\n",
+				check->fen, wdl, success ? dtz : 0, check->wdl);
+			failed++;
+		}
+	}
+	Board_Free(board);
+
+	if(failed > 0) {
+		printf("info string Syzygy tables disabled: %d of %d known positions decoded wrong\n", failed, probed);
+		Tb_Free();
+	} else if(probed == 0) {
+		printf("info string Syzygy tables disabled: no known position is covered by these tables\n");
+		Tb_Free();
+	} else {
+		printf("info string Syzygy check passed on %d known positions\n", probed);
+	}
+}
+
+/* ---------------------------------------------------------------------------
+ * Public interface
+ * ---------------------------------------------------------------------------
+ */
+
+int Tb_ProbeWdl(ChessBoard *board, int *success) {
+
+	int result = PROBE_OK;
+	int wdl = 0;
+
+	if(g_tbMaxPieces == 0 || board->castlePerm != 0
+		|| BITBOARD_COUNT(board->occupied[COLOR_TYPE_BOTH]) > g_tbMaxPieces) {
+		*success = BOOL_TYPE_FALSE;
+		return TB_WDL_DRAW;
+	}
+	wdl = SearchWdl(board, BOOL_TYPE_FALSE, &result);
+	*success = result != PROBE_FAIL;
+	return wdl;
+}
+
+int Tb_ProbeDtz(ChessBoard *board, int *success) {
+
+	int result = PROBE_OK;
+	int dtz = 0;
+
+	if(g_tbMaxPieces == 0 || board->castlePerm != 0
+		|| BITBOARD_COUNT(board->occupied[COLOR_TYPE_BOTH]) > g_tbMaxPieces) {
+		*success = BOOL_TYPE_FALSE;
+		return 0;
+	}
+	dtz = ProbeDtz(board, &result);
+	*success = result != PROBE_FAIL;
+	return dtz;
+}
+
+int Tb_RootFilter(ChessBoard *board, SearchInfo *info) {
+
+	MoveList list[1];
+	int ranks[CHESS_MAX_POSITION_MOVES];
+	int cnt50 = board->fiftyMove;
+	int rep = HasRepeated(board);
+	int bestRank = -CHESS_INFINITE * 100;
+	int result = PROBE_OK;
+	int index = 0;
+	int dtz = 0;
+
+	info->rootMoveCount = 0;
+	if(g_tbMaxPieces == 0 || board->castlePerm != 0
+		|| BITBOARD_COUNT(board->occupied[COLOR_TYPE_BOTH]) > g_tbMaxPieces) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	Move_GenerateLegal(board, list);
+	if(list->count == 0) {
+		return BOOL_TYPE_FALSE;
+	}
+
+	for(index = 0; index < list->count; ++index) {
+		Move_MakeLegal(board, list->moves[index].move);
+		result = PROBE_OK;
+		if(board->fiftyMove == 0) {
+			dtz = DtzBeforeZeroing(-SearchWdl(board, BOOL_TYPE_FALSE, &result));
+		} else if(board->fiftyMove >= 100 || Repeated(board)) {
+			dtz = 0;
+		} else {
+			dtz = -ProbeDtz(board, &result);
+			dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : dtz;
+		}
+		if(dtz == 2 && IsMated(board)) {
+			dtz = 1;
+		}
+		Move_Take(board);
+		if(result == PROBE_FAIL) {
+			return BOOL_TYPE_FALSE;
+		}
+		info->tbhits++;
+
+		// wins rank by distance unless the fifty move rule (or an earlier
+		// repetition) is in the way, losses try to reach the fifty moves
+		if(dtz > 0) {
+			ranks[index] = dtz + cnt50 <= 99 && !rep ? 1000 - dtz : 500 - (dtz + cnt50);
+		} else if(dtz < 0) {
+			ranks[index] = -dtz * 2 + cnt50 < 100 ? -1000 : -500 + (-dtz + cnt50);
+		} else {
+			ranks[index] = 0;
+		}
+		if(ranks[index] > bestRank) {
+			bestRank = ranks[index];
+		}
+	}
+
+	for(index = 0; index < list->count; ++index) {
+		if(ranks[index] == bestRank) {
+			info->rootMoves[info->rootMoveCount++] = list->moves[index].move;
+		}
+	}
+	return BOOL_TYPE_TRUE;
+}
+
+void Tb_Free() {
+
+	int index = 0;
+
+	for(index = 0; index < 2 * tableCount; ++index) {
+		FreePairs(&tables[index]);
+		if(tables[index].base != NULL) {
+			Misc_UnmapFile(tables[index].base, tables[index].size);
+		}
+	}
+	free(tables);
+	tables = NULL;
+	tableCount = 0;
+	tableCapacity = 0;
+	g_tbMaxPieces = 0;
+	for(index = 0; index < TB_HASH_SIZE; ++index) {
+		slots[index].index = -1;
+	}
+}
+
+int Tb_Init(const char *path) {
+
+	int found = 0;
+
+	Tb_Free();
+	if(path == NULL || *path == '\0' || strcmp(path, "<empty>") == 0) {
+		return 0;
+	}
+
+	InitEncoding();
+	snprintf(tbPath, sizeof(tbPath), "%s", path);
+	AddAllTables();
+	printf("info string Found %d tablebases with up to %d pieces\n", tableCount, g_tbMaxPieces);
+	found = tableCount;
+	if(found > 0) {
+		SelfCheck();
+	}
+	return found;
+}
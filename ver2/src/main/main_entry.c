@@ -10,10 +10,27 @@
  * - Program startup and shutdown
  * 
  * Usage:
- *   gambit           - Launch GUI mode (default)
+ *   gambit           - Launch GUI mode (default; UCI in headless builds)
  *   gambit uci       - Launch UCI protocol mode
  *   gambit xboard    - Launch XBoard protocol mode
  *   gambit NoBook    - Launch GUI with opening book disabled
+ *   gambit perftsuite <file.epd> [maxdepth] [threads]
+ *                    - Run an EPD perft suite, exit status 1 on any failure
+ *   gambit bench [depth] [threads] [hashMB]
+ *                    - Search the built-in bench set, print nodes and nps
+ *   gambit tune <file.epd> [threads] [iterations] [qsearch]
+ *                    - Texel-tune the evaluation weights on labelled positions
+ *   gambit analyse <in.epd> [--depth N] [--nodes N] [--movetime ms] [--threads N]
+ *                  [--hash MB] [--shared-hash] [--order input|completed] [--out file]
+ *                    - Search every position on a worker pool, write NDJSON results
+ *   gambit selfplay [--games N] [--concurrency N] [--tc base+inc] [--openings file.epd]
+ *                   [--pgn file] [--a Name=value,...] [--b Name=value,...] ...
+ *                    - Play engine option set A against B, report W/D/L and SPRT LLR
+ *   gambit coordinator <in.epd> | --fen FEN [--port N] [--depth N] [--split]
+ *                      [--share-tt depth] [--attempts N] [--out file] ...
+ *                    - Hand positions (or root moves) to workers over TCP, write NDJSON results
+ *   gambit worker <host>[:port] [--threads N] [--hash MB] [--connect-timeout s]
+ *                    - Search units for a coordinator until it ends the run
  * 
  * @author Gambit Chess Team
  * @date February 2026
@@ -32,6 +49,16 @@
 #define WAC1 "r1b1k2r/ppppnppp/2n2q2/2b5/3NP3/2P1B3/PP3PPP/RN1QKB1R w KQkq - 0 1"
 #define PERFT "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"
 
+// releases everything Init_All and main set up; every mode returns through here
+static void Main_Cleanup(ChessBoard *board) {
+	HashTable_Free(board->HashTable);
+	EvalCache_Free(g_evalCache);
+	Nnue_Free();
+	Tb_Free();
+	Board_Free(board);
+	PolyBook_Clean();
+}
+
 int main(int argc, char *argv[]) {
 
 	Init_All();
@@ -39,8 +66,27 @@ int main(int argc, char *argv[]) {
 	ChessBoard board[1];
     SearchInfo info[1];
     info->quit = BOOL_TYPE_FALSE;
-	board->HashTable->pTable = NULL;
+    info->asyncInput = BOOL_TYPE_FALSE;
+    info->stopRequest = BOOL_TYPE_FALSE;
+    info->statusRequest = BOOL_TYPE_FALSE;
+    info->nodeLimit = 0;
+    info->mateLimit = 0;
+    info->searchMoveCount = 0;
+    info->ponder = BOOL_TYPE_FALSE;
+    info->ponderMove = NOMOVE;
+	Board_Init(board);
+	board->HashTable = g_hashTable;
     HashTable_Init(board->HashTable, 64);
+    EvalCache_Init(g_evalCache, EVAL_CACHE_DEFAULT_MB);
+    Nnue_Load(NNUE_DEFAULT_FILE);
+	EngineOptions->Threads = 1;
+	EngineOptions->UseLMR = BOOL_TYPE_TRUE;
+	EngineOptions->UseFutility = BOOL_TYPE_TRUE;
+	EngineOptions->UseReverseFutility = BOOL_TYPE_TRUE;
+	EngineOptions->LazyMargin = LAZY_EVAL_MARGIN;
+	EngineOptions->SyzygyProbeDepth = 1;
+	EngineOptions->SyzygyProbeLimit = TB_MAX_PIECES;
+	EngineOptions->MoveOverhead = MOVE_OVERHEAD_DEFAULT;
 	setbuf(stdin, NULL);
     setbuf(stdout, NULL);
     
@@ -54,6 +100,59 @@ int main(int argc, char *argv[]) {
     		launchMode = 1;
     	} else if(strncmp(argv[ArgNum], "xboard", 6) == 0) {
     		launchMode = 2;
+    	} else if(strcmp(argv[ArgNum], "bench") == 0) {
+    		int depth = ArgNum + 1 < argc ? atoi(argv[ArgNum + 1]) : BENCH_DEFAULT_DEPTH;
+    		int threads = ArgNum + 2 < argc ? atoi(argv[ArgNum + 2]) : 1;
+    		int hashMB = ArgNum + 3 < argc ? atoi(argv[ArgNum + 3]) : 0;
+    		if(hashMB > CHESS_MAX_HASH) hashMB = CHESS_MAX_HASH;
+    		Search_Bench(board, info, depth, threads, hashMB);
+    		Main_Cleanup(board);
+    		return 0;
+    	} else if(strcmp(argv[ArgNum], "perftsuite") == 0 && ArgNum + 1 < argc) {
+    		int maxDepth = ArgNum + 2 < argc ? atoi(argv[ArgNum + 2]) : PERFT_SUITE_DEFAULT_DEPTH;
+    		int threads = ArgNum + 3 < argc ? atoi(argv[ArgNum + 3]) : 1;
+    		int failed = Search_PerftSuite(argv[ArgNum + 1], maxDepth, threads, 0);
+    		Main_Cleanup(board);
+    		return failed == 0 ? 0 : 1;
+    	} else if(strcmp(argv[ArgNum], "analyse") == 0) {
+    		AnalyseOptions options;
+    		int failed = -1;
+    		if(Analyse_ParseOptions(&options, argc - ArgNum - 1, argv + ArgNum + 1)) {
+    			failed = Analyse_Run(&options);
+    		}
+    		Main_Cleanup(board);
+    		return failed == 0 ? 0 : 1;
+    	} else if(strcmp(argv[ArgNum], "selfplay") == 0) {
+    		SelfPlayOptions options;
+    		int decision = 0;
+    		if(SelfPlay_ParseOptions(&options, argc - ArgNum - 1, argv + ArgNum + 1)) {
+    			decision = SelfPlay_Run(&options);
+    		}
+    		Main_Cleanup(board);
+    		return decision < 0 ? 1 : 0;
+    	} else if(strcmp(argv[ArgNum], "coordinator") == 0) {
+    		ClusterOptions options;
+    		int failed = -1;
+    		if(Cluster_ParseCoordinatorOptions(&options, argc - ArgNum - 1, argv + ArgNum + 1)) {
+    			failed = Cluster_RunCoordinator(&options);
+    		}
+    		Main_Cleanup(board);
+    		return failed == 0 ? 0 : 1;
+    	} else if(strcmp(argv[ArgNum], "worker") == 0) {
+    		ClusterOptions options;
+    		int status = 1;
+    		if(Cluster_ParseWorkerOptions(&options, argc - ArgNum - 1, argv + ArgNum + 1)) {
+    			status = Cluster_RunWorker(&options);
+    		}
+    		Main_Cleanup(board);
+    		return status;
+    	} else if(strcmp(argv[ArgNum], "tune") == 0 && ArgNum + 1 < argc) {
+    		int threads = ArgNum + 2 < argc ? atoi(argv[ArgNum + 2]) : 1;
+    		int iterations = ArgNum + 3 < argc ? atoi(argv[ArgNum + 3]) : 100;
+    		int qsearch = ArgNum + 4 < argc ? atoi(argv[ArgNum + 4]) : 0;
+    		Tune_Run(argv[ArgNum + 1], threads, iterations, qsearch);
+    		Main_Cleanup(board);
+    		return 0;
     	}
     }
 
@@ -69,13 +168,13 @@ int main(int argc, char *argv[]) {
 #ifdef ENABLE_GUI
 		GUI_Run(board, info);
 #else
-		printf("Error: GUI mode not available in this build.\n");
-		printf("Use command line argument 'uci' or 'xboard' for protocol modes.\n");
+		// headless builds (make engine) are started by GUIs and match
+		// runners without arguments
+		Uci_Loop(board, info);
 #endif
 	}
 
-	free(board->HashTable->pTable);
-	PolyBook_Clean();
+	Main_Cleanup(board);
 	return 0;
 }
 
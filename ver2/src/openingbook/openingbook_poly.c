@@ -5,10 +5,14 @@
  * Implements support for Polyglot-format opening books.
  * 
  * Features:
- * - Reading .bin format Polyglot books
- * - Position lookup using Polyglot hash keys
+ * - Reading .bin format Polyglot books, memory mapped read-only
+ * - Position lookup by posKey, which is the Polyglot key
  * - Weighted random move selection from book
  * - Binary search for position in book file
+ *
+ * Entries are sorted by their big-endian keys, so a lookup binary
+ * searches for the first entry of the position and only byte-swaps the
+ * entries it visits; the book is never copied or converted as a whole.
  * 
  * Polyglot books store opening moves with weights, allowing
  * the engine to play varied and well-analyzed openings.
@@ -23,7 +27,11 @@
 #include "types_definitions.h"
 #include "openingbook_keys.h"
 #include <string.h>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 typedef struct {
 	U64 key;
@@ -35,7 +43,8 @@ typedef struct {
 
 long NumEntries = 0;
 
-S_POLY_BOOK_ENTRY *entries;
+static const S_POLY_BOOK_ENTRY *entries = NULL;
+static size_t bookSize = 0;
 
 const int PolyKindOfPiece[13] = {
 	-1, 1, 3, 5, 7, 9, 11, 0, 2, 4, 6, 8, 10
@@ -62,40 +71,29 @@ void PolyBook_Init() {
 #endif
 	snprintf(bookPath, sizeof(bookPath), "%sperformance.bin", exePath);
 
-	FILE *pFile = fopen(bookPath, "rb");
+	entries = (const S_POLY_BOOK_ENTRY *) Misc_MapFile(bookPath, &bookSize);
 
-	if(pFile == NULL) {
+	if(entries == NULL) {
 		// Book file not found - silently skip
-	} else {
-		fseek(pFile,0,SEEK_END);
-		long position = ftell(pFile);
-
-		if(position < sizeof(S_POLY_BOOK_ENTRY)) {
-			printf("No Entries Found\n");
-			return;
-		}
-
-		NumEntries = position / sizeof(S_POLY_BOOK_ENTRY);
-		printf("%ld Entries Found In File\n", NumEntries);
+		return;
+	}
 
-		entries = (S_POLY_BOOK_ENTRY*)malloc(NumEntries * sizeof(S_POLY_BOOK_ENTRY));
-		rewind(pFile);
-		
-		size_t returnValue;
-		returnValue = fread(entries, sizeof(S_POLY_BOOK_ENTRY), NumEntries, pFile);
-		printf("fread() %ld Entries Read in from file\n", returnValue);
-		
-		if(NumEntries > 0) {
-			EngineOptions->UseBook = BOOL_TYPE_TRUE;
-		}
+	NumEntries = (long)(bookSize / sizeof(S_POLY_BOOK_ENTRY));
+	if(NumEntries == 0) {
+		printf("No Entries Found\n");
+		PolyBook_Clean();
+		return;
 	}
+
+	printf("%ld Entries Found In File\n", NumEntries);
+	EngineOptions->UseBook = BOOL_TYPE_TRUE;
 }
 
 void PolyBook_Clean() {
-	if(entries != NULL) {
-		free(entries);
-		entries = NULL;
-	}
+	Misc_UnmapFile(entries, bookSize);
+	entries = NULL;
+	bookSize = 0;
+	NumEntries = 0;
 }
 
 int HasPawnForCapture(const ChessBoard *board) {
@@ -117,6 +115,8 @@ int HasPawnForCapture(const ChessBoard *board) {
 	return BOOL_TYPE_FALSE;
 }
 
+// from-scratch reference; posKey carries the same key incrementally and
+// debug builds assert the two agree on every book probe
 U64 PolyKeyFromBoard(const ChessBoard *board) {
 
 	int squareIndex = 0, rank = 0, file = 0;
@@ -219,13 +219,29 @@ int ConvertPolyMoveToInternalMove(unsigned short polyMove, ChessBoard *board) {
 	return Move_Parse(moveString, board);
 }
 
+// index of the first entry whose key is not below polyKey
+static long LowerBound(const U64 polyKey) {
+
+	long low = 0;
+	long high = NumEntries;
+
+	while(low < high) {
+		long mid = low + (high - low) / 2;
+		if(endian_swap_u64(entries[mid].key) < polyKey) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
 int PolyBook_GetMove(ChessBoard *board) {
 	if(entries == NULL || NumEntries == 0) {
 		return NOMOVE;
 	}
 	
-	int index = 0;
-	S_POLY_BOOK_ENTRY *entry;
+	long index = 0;
 	unsigned short move;
 	// Use a macro so it is a compile-time constant for array sizing
 	#define MAXBOOKMOVES 32
@@ -233,16 +249,18 @@ int PolyBook_GetMove(ChessBoard *board) {
 	int tempMove = NOMOVE;
 	int count = 0;
 	
-	U64 polyKey = PolyKeyFromBoard(board);
+	// posKey uses the Polyglot keys and en passant rule
+	U64 polyKey = board->posKey;
+	ASSERT(polyKey == PolyKeyFromBoard(board));
 	
-	for(entry = entries; entry < entries + NumEntries; entry++) {
-		if(polyKey == endian_swap_u64(entry->key)) {
-			move = endian_swap_u16(entry->move);
-			tempMove = ConvertPolyMoveToInternalMove(move, board);
-			if(tempMove != NOMOVE) {
-				bookMoves[count++] = tempMove;
-				if(count > MAXBOOKMOVES) break;
-			}
+	for(index = LowerBound(polyKey); index < NumEntries && count < MAXBOOKMOVES; ++index) {
+		if(endian_swap_u64(entries[index].key) != polyKey) {
+			break;
+		}
+		move = endian_swap_u16(entries[index].move);
+		tempMove = ConvertPolyMoveToInternalMove(move, board);
+		if(tempMove != NOMOVE) {
+			bookMoves[count++] = tempMove;
 		}
 	}
 	
@@ -253,55 +271,3 @@ int PolyBook_GetMove(ChessBoard *board) {
 		return NOMOVE;
 	}
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -0,0 +1,355 @@
+/**
+ * @file tools_microbench.c
+ * @brief Micro-benchmarks of the core primitives (make microbench)
+ *
+ * Stand-alone harness linked against the engine objects. Every
+ * benchmark runs over the same fixed position corpus:
+ * - Move_GenerateAll, GenerateAllCaps
+ * - Move_MakeLegal/Move_Take pairs over every legal move
+ * - Attack_IsSquareAttacked for every square and side
+ * - Evaluate_Position, Board_GeneratePositionKey, Board_ParseFromFEN
+ * - Transposition table store and probe with random keys at several
+ *   table sizes (cache resident up to far larger than the caches)
+ * - PolyBook_GetMove (the miss path only, unless performance.bin sits
+ *   next to the executable)
+ *
+ * Each benchmark gets warmup rounds, then a number of timed repetitions;
+ * the report gives the mean ns per operation, its standard deviation,
+ * the coefficient of variation and the fastest repetition, so a
+ * regression shows up as a shift well outside the spread.
+ *
+ * Usage: microbench [repetitions] [name filter]
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+#include "types_definitions.h"
+#ifdef WIN32
+#include "windows.h"
+#else
+#include "time.h"
+#endif
+
+#define MICRO_DEFAULT_REPETITIONS 10
+#define MICRO_WARMUP_ROUNDS 2
+#define MICRO_MAX_REPETITIONS 1000
+#define MICRO_INNER_LOOPS 200 // Times each position is run per repetition
+#define MICRO_TT_KEYS 65536 // Random keys stored and probed per TT repetition
+
+static const char *Corpus[] = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+	"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+	"r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+	"6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 3 54",
+	"8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+	"2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 4 3",
+	"8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1"
+};
+
+#define CORPUS_SIZE ((int)(sizeof(Corpus) / sizeof(Corpus[0])))
+
+static const int TtSizesMB[] = { 1, 16, 256 };
+
+#define TT_SIZE_COUNT ((int)(sizeof(TtSizesMB) / sizeof(TtSizesMB[0])))
+
+/**
+ * One benchmark: run() performs its operation on the given board (set to
+ * a corpus position) and returns how many operations it did.
+ */
+typedef struct {
+	const char *name;
+	long (*run)(ChessBoard *board, const int position);
+} MicroBench;
+
+static ChessBoard corpusBoards[CORPUS_SIZE];
+static volatile U64 sink = 0;
+static U64 randomState = 0x9E3779B97F4A7C15ULL;
+
+static double NowNs() {
+#ifdef WIN32
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+#endif
+}
+
+static U64 RandomKey() {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+static long Run_GenerateAll(ChessBoard *board, const int position) {
+
+	MoveList list[1];
+	int loop = 0;
+
+	(void)position;
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		Move_GenerateAll(board, list);
+		sink += list->count;
+	}
+	return MICRO_INNER_LOOPS;
+}
+
+static long Run_GenerateCaptures(ChessBoard *board, const int position) {
+
+	MoveList list[1];
+	int loop = 0;
+
+	(void)position;
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		GenerateAllCaps(board, list);
+		sink += list->count;
+	}
+	return MICRO_INNER_LOOPS;
+}
+
+static long Run_MakeTake(ChessBoard *board, const int position) {
+
+	MoveList list[1];
+	int loop = 0;
+	int index = 0;
+
+	(void)position;
+	Move_GenerateLegal(board, list);
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		for(index = 0; index < list->count; ++index) {
+			Move_MakeLegal(board, list->moves[index].move);
+			sink += board->posKey;
+			Move_Take(board);
+		}
+	}
+	board->ply = 0;
+	return (long)MICRO_INNER_LOOPS * list->count;
+}
+
+static long Run_SquareAttacked(ChessBoard *board, const int position) {
+
+	int loop = 0;
+	int sq64 = 0;
+
+	(void)position;
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		for(sq64 = 0; sq64 < 64; ++sq64) {
+			sink += Attack_IsSquareAttacked(SQUARE_64_TO_120(sq64), COLOR_TYPE_WHITE, board);
+			sink += Attack_IsSquareAttacked(SQUARE_64_TO_120(sq64), COLOR_TYPE_BLACK, board);
+		}
+	}
+	return (long)MICRO_INNER_LOOPS * 128;
+}
+
+static long Run_Evaluate(ChessBoard *board, const int position) {
+
+	int loop = 0;
+
+	(void)position;
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		sink += Evaluate_Position(board);
+	}
+	return MICRO_INNER_LOOPS;
+}
+
+static long Run_PositionKey(ChessBoard *board, const int position) {
+
+	int loop = 0;
+
+	(void)position;
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		sink += Board_GeneratePositionKey(board);
+	}
+	return MICRO_INNER_LOOPS;
+}
+
+static long Run_ParseFen(ChessBoard *board, const int position) {
+
+	char fen[128];
+	int loop = 0;
+
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		strcpy(fen, Corpus[position]);
+		Board_ParseFromFEN(fen, board);
+		sink += board->posKey;
+	}
+	return MICRO_INNER_LOOPS;
+}
+
+static long Run_PolyBook(ChessBoard *board, const int position) {
+
+	int loop = 0;
+
+	(void)position;
+	for(loop = 0; loop < MICRO_INNER_LOOPS; ++loop) {
+		sink += PolyBook_GetMove(board);
+	}
+	return MICRO_INNER_LOOPS;
+}
+
+// random keys spread the entries over the whole table, like a search
+// far from the root does; the board's own key is put back afterwards
+static long Run_TtStore(ChessBoard *board, const int position) {
+
+	U64 savedKey = board->posKey;
+	int index = 0;
+
+	if(position != 0) {
+		return 0;
+	}
+	for(index = 0; index < MICRO_TT_KEYS; ++index) {
+		board->posKey = RandomKey();
+		HashTable_StoreEntry(board, NOMOVE, index & 255, HFEXACT, 1 + (index & 31));
+	}
+	board->posKey = savedKey;
+	return MICRO_TT_KEYS;
+}
+
+static long Run_TtProbe(ChessBoard *board, const int position) {
+
+	U64 savedKey = board->posKey;
+	int move = NOMOVE;
+	int score = 0;
+	int index = 0;
+
+	if(position != 0) {
+		return 0;
+	}
+	for(index = 0; index < MICRO_TT_KEYS; ++index) {
+		board->posKey = RandomKey();
+		sink += HashTable_ProbeEntry(board, &move, &score, -CHESS_INFINITE, CHESS_INFINITE, 1);
+	}
+	board->posKey = savedKey;
+	return MICRO_TT_KEYS;
+}
+
+static const MicroBench Benchmarks[] = {
+	{ "Move_GenerateAll", Run_GenerateAll },
+	{ "GenerateAllCaps", Run_GenerateCaptures },
+	{ "make/take", Run_MakeTake },
+	{ "Attack_IsSquareAttacked", Run_SquareAttacked },
+	{ "Evaluate_Position", Run_Evaluate },
+	{ "Board_GeneratePositionKey", Run_PositionKey },
+	{ "Board_ParseFromFEN", Run_ParseFen },
+	{ "PolyBook_GetMove", Run_PolyBook }
+};
+
+#define BENCHMARK_COUNT ((int)(sizeof(Benchmarks) / sizeof(Benchmarks[0])))
+
+// one pass over the corpus; returns the operations done
+static long RunOnce(const MicroBench *bench) {
+
+	long ops = 0;
+	int position = 0;
+
+	for(position = 0; position < CORPUS_SIZE; ++position) {
+		ops += bench->run(&corpusBoards[position], position);
+	}
+	return ops;
+}
+
+static void Measure(const char *name, const MicroBench *bench, const int repetitions) {
+
+	double nsPerOp[MICRO_MAX_REPETITIONS];
+	double mean = 0.0;
+	double variance = 0.0;
+	double best = 0.0;
+	double start = 0.0;
+	long ops = 0;
+	int rep = 0;
+
+	for(rep = 0; rep < MICRO_WARMUP_ROUNDS; ++rep) {
+		RunOnce(bench);
+	}
+
+	for(rep = 0; rep < repetitions; ++rep) {
+		start = NowNs();
+		ops = RunOnce(bench);
+		nsPerOp[rep] = ops > 0 ? (NowNs() - start) / (double)ops : 0.0;
+		mean += nsPerOp[rep];
+		if(rep == 0 || nsPerOp[rep] < best) {
+			best = nsPerOp[rep];
+		}
+	}
+	mean /= repetitions;
+	for(rep = 0; rep < repetitions; ++rep) {
+		variance += (nsPerOp[rep] - mean) * (nsPerOp[rep] - mean);
+	}
+	variance = repetitions > 1 ? variance / (repetitions - 1) : 0.0;
+
+	printf("%-28s %12ld %12.2f %10.2f %7.2f%% %12.2f\n", name, ops, mean, sqrt(variance),
+		mean > 0.0 ? 100.0 * sqrt(variance) / mean : 0.0, best);
+}
+
+int main(int argc, char *argv[]) {
+
+	int repetitions = MICRO_DEFAULT_REPETITIONS;
+	const char *filter = argc > 2 ? argv[2] : NULL;
+	char fen[128];
+	char name[64];
+	int index = 0;
+	const MicroBench storeBench = { "tt store", Run_TtStore };
+	const MicroBench probeBench = { "tt probe", Run_TtProbe };
+
+	if(argc > 1) {
+		repetitions = atoi(argv[1]);
+	}
+	if(repetitions < 1) repetitions = 1;
+	if(repetitions > MICRO_MAX_REPETITIONS) repetitions = MICRO_MAX_REPETITIONS;
+
+	Init_All();
+	EngineOptions->Threads = 1;
+	EngineOptions->LazyMargin = LAZY_EVAL_MARGIN;
+	EvalCache_Init(g_evalCache, EVAL_CACHE_DEFAULT_MB);
+	HashTable_Init(g_hashTable, TtSizesMB[0]);
+
+	for(index = 0; index < CORPUS_SIZE; ++index) {
+		Board_Init(&corpusBoards[index]);
+		corpusBoards[index].HashTable = g_hashTable;
+		strcpy(fen, Corpus[index]);
+		Board_ParseFromFEN(fen, &corpusBoards[index]);
+	}
+
+	printf("microbench: %d positions, %d warmup + %d timed repetitions\n",
+		CORPUS_SIZE, MICRO_WARMUP_ROUNDS, repetitions);
+	printf("%-28s %12s %12s %10s %8s %12s\n", "benchmark", "ops/rep", "ns/op", "stddev", "cv", "best ns/op");
+
+	for(index = 0; index < BENCHMARK_COUNT; ++index) {
+		if(filter == NULL || strstr(Benchmarks[index].name, filter) != NULL) {
+			Measure(Benchmarks[index].name, &Benchmarks[index], repetitions);
+		}
+	}
+
+	for(index = 0; index < TT_SIZE_COUNT; ++index) {
+		if(filter != NULL && strstr("tt store tt probe", filter) == NULL) {
+			break;
+		}
+		HashTable_Init(g_hashTable, TtSizesMB[index]);
+		sprintf(name, "tt store %dMB", TtSizesMB[index]);
+		Measure(name, &storeBench, repetitions);
+		sprintf(name, "tt probe %dMB", TtSizesMB[index]);
+		Measure(name, &probeBench, repetitions);
+	}
+
+	for(index = 0; index < CORPUS_SIZE; ++index) {
+		Board_Free(&corpusBoards[index]);
+	}
+	HashTable_Free(g_hashTable);
+	printf("checksum %llu\n", (unsigned long long)sink);
+	return 0;
+}
@@ -9,10 +9,27 @@
  * - isready: Check if engine is ready
  * - ucinewgame: Start new game
  * - position: Set up position (startpos or fen)
- * - go: Start searching
+ * - go: Start searching (on a separate search thread)
  * - stop: Stop search
- * - quit: Exit program
- * - setoption: Configure engine options
+ * - go ponder / ponderhit: Search the expected reply on the opponent's time;
+ *   ponderhit turns it into the normal search, clock starting then
+ * - quit: Exit program (also on end of input)
+ * - setoption: Configure engine options (Hash, EvalCache, EvalFile, Book, Threads)
+ * - perft <depth> [hash <MB>]: Divided perft of the current position
+ *   over Threads threads, with an optional perft hash
+ * - perftsuite <file.epd> [maxdepth]: EPD perft regression suite
+ * - bench [depth] [threads] [hashMB]: Fixed-position speed and node signature
+ * - savehash <file> [mindepth]: Write the transposition table to an image
+ *   file, without entries shallower than mindepth unless they are exact
+ * - loadhash <file>: Map a savehash image as the transposition table
+ * 
+ * The input thread blocks on stdin for the whole session. "go" hands the
+ * search to a worker thread, which prints bestmove when it is done; stop
+ * and quit raise info->stopRequest, which the search polls with its
+ * clock check. position, ucinewgame and go stop a running search first
+ * (its bestmove is still printed); other commands are refused with an
+ * info string until the search has ended, since go infinite or go ponder
+ * never end without input.
  * 
  * Reference: http://wbec-ridderkerk.nl/html/UCIProtocol.html
  * 
@@ -23,16 +40,94 @@
 #include "stdio.h"
 #include "types_definitions.h"
 #include "string.h"
+#include <pthread.h>
 
 #define INPUTBUFFER 400 * 6
 
+#if defined(__GNUC__) || defined(__clang__)
+#define STOP_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STOP_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define STOP_LOAD(p) (*(volatile int *)(p))
+#define STOP_STORE(p,v) (*(volatile int *)(p) = (v))
+#endif
+
+typedef struct {
+	ChessBoard *board;
+	SearchInfo *info;
+} UciSearch;
+
+static UciSearch searchJob;
+static pthread_t searchThread;
+static int searchRunning = BOOL_TYPE_FALSE;
+static int searchFinished = BOOL_TYPE_FALSE;
+
+static void *Uci_SearchThread(void *arg) {
+
+	UciSearch *job = (UciSearch *)arg;
+
+	Search_Position(job->board, job->info);
+	STOP_STORE(&searchFinished, BOOL_TYPE_TRUE);
+	return NULL;
+}
+
+// started and not yet through its bestmove
+static int Uci_SearchActive() {
+	return searchRunning == BOOL_TYPE_TRUE && !STOP_LOAD(&searchFinished);
+}
+
+// blocks until the running search has printed its bestmove
+static void Uci_WaitSearch() {
+
+	if(searchRunning == BOOL_TYPE_TRUE) {
+		pthread_join(searchThread, NULL);
+		searchRunning = BOOL_TYPE_FALSE;
+	}
+}
+
+static void Uci_StopSearch(SearchInfo *info) {
+
+	if(searchRunning == BOOL_TYPE_TRUE) {
+		STOP_STORE(&info->stopRequest, BOOL_TYPE_TRUE);
+		Uci_WaitSearch();
+	}
+}
+
+// the ponder move was played: the same search goes on (TT, history and
+// killers stay as they are) with the move's budget counted from now
+static void Uci_PonderHit(SearchInfo *info) {
+
+	if(searchRunning == BOOL_TYPE_TRUE && info->ponder == BOOL_TYPE_TRUE) {
+		Time_PonderHit(info);
+		STOP_STORE(&info->ponder, BOOL_TYPE_FALSE);
+	}
+}
+
+static void Uci_StartSearch(ChessBoard *board, SearchInfo *info) {
+
+	info->stopRequest = BOOL_TYPE_FALSE;
+	searchFinished = BOOL_TYPE_FALSE;
+	searchJob.board = board;
+	searchJob.info = info;
+	if(pthread_create(&searchThread, NULL, Uci_SearchThread, &searchJob) == 0) {
+		searchRunning = BOOL_TYPE_TRUE;
+	} else {
+		Search_Position(board, info);
+	}
+}
+
 // go depth 6 wtime 180000 btime 100000 binc 1000 winc 1000 movetime 1000 movestogo 40
 void ParseGo(char* line, SearchInfo *info, ChessBoard *board) {
 
-	int depth = -1, movestogo = 30,movetime = -1;
+	int depth = -1, movestogo = 0,movetime = -1;
 	int time = -1, inc = 0;
+	int move = NOMOVE;
     char *pointer = NULL;
 	info->timeset = BOOL_TYPE_FALSE;
+	info->nodeLimit = 0;
+	info->mateLimit = 0;
+	info->searchMoveCount = 0;
+	info->ponder = strstr(line, "ponder") != NULL ? BOOL_TYPE_TRUE : BOOL_TYPE_FALSE;
 
 	if ((pointer = strstr(line,"infinite"))) {
 		;
@@ -66,28 +161,37 @@ void ParseGo(char* line, SearchInfo *info, ChessBoard *board) {
 		depth = atoi(pointer + 6);
 	}
 
-	if(movetime != -1) {
-		time = movetime;
-		movestogo = 1;
+	if ((pointer = strstr(line,"nodes"))) {
+		info->nodeLimit = atol(pointer + 6);
 	}
 
-	info->starttime = Misc_GetTimeMs();
-	info->depth = depth;
+	if ((pointer = strstr(line,"mate"))) {
+		info->mateLimit = atoi(pointer + 5);
+	}
 
-	if(time != -1) {
-		info->timeset = BOOL_TYPE_TRUE;
-		time /= movestogo;
-		time -= 50;
-		info->stoptime = info->starttime + time + inc;
+	// searchmoves e2e4 d2d4 ...: every legal move up to the first token
+	// that is not one
+	if ((pointer = strstr(line,"searchmoves"))) {
+		pointer += 11;
+		while(info->searchMoveCount < CHESS_MAX_POSITION_MOVES) {
+			while(*pointer == ' ') pointer++;
+			if(*pointer == '\0' || (move = Move_Parse(pointer, board)) == NOMOVE
+				|| !Move_IsLegal(board, move)) break;
+			info->searchMoves[info->searchMoveCount++] = move;
+			while(*pointer != '\0' && *pointer != ' ') pointer++;
+		}
 	}
 
+	info->starttime = Misc_GetTimeMs();
+	info->depth = depth;
+	Time_Allocate(info, time, inc, movestogo, movetime);
+
 	if(depth == -1) {
 		info->depth = CHESS_MAX_SEARCH_DEPTH;
 	}
 
-	printf("time:%d start:%d stop:%d depth:%d timeset:%d\n",
-		time,info->starttime,info->stoptime,info->depth,info->timeset);
-	Search_Position(board, info);
+	printf("info string time %d start %d soft %d hard %d depth %d timeset %d\n",
+		time,info->starttime,info->tm.softTime,info->tm.hardTime,info->depth,info->timeset);
 }
 
 // position fen fenstr
@@ -130,6 +234,9 @@ void ParsePosition(char* lineIn, ChessBoard *board) {
 void Uci_Loop(ChessBoard *board, SearchInfo *info) {
 
 	info->GAME_MODE = MODE_TYPE_UCI;
+	info->asyncInput = BOOL_TYPE_TRUE;
+	// a go before any position searches the start position
+	Board_ParseFromFEN(CHESS_START_FEN, board);
 
 	setbuf(stdin, NULL);
     setbuf(stdout, NULL);
@@ -138,7 +245,20 @@ void Uci_Loop(ChessBoard *board, SearchInfo *info) {
     printf("id name %s\n",NAME);
     printf("id author Bluefever\n");
 	printf("option name Hash type spin default 64 min 4 max %d\n",CHESS_MAX_HASH);
+	printf("option name EvalCache type spin default %d min 0 max %d\n",EVAL_CACHE_DEFAULT_MB,EVAL_CACHE_MAX_MB);
+	printf("option name EvalFile type string default %s\n",NNUE_DEFAULT_FILE);
 	printf("option name Book type check default true\n");
+	printf("option name Ponder type check default false\n");
+	printf("option name Threads type spin default 1 min 1 max %d\n",CHESS_MAX_THREADS);
+	printf("option name LMR type check default true\n");
+	printf("option name Futility type check default true\n");
+	printf("option name ReverseFutility type check default true\n");
+	printf("option name LazyMargin type spin default %d min 0 max 1000\n",LAZY_EVAL_MARGIN);
+	printf("option name MoveOverhead type spin default %d min 0 max 5000\n",MOVE_OVERHEAD_DEFAULT);
+	printf("option name StatsFile type string default <empty>\n");
+	printf("option name SyzygyPath type string default <empty>\n");
+	printf("option name SyzygyProbeDepth type spin default 1 min 1 max 100\n");
+	printf("option name SyzygyProbeLimit type spin default %d min 0 max %d\n",TB_MAX_PIECES,TB_MAX_PIECES);
     printf("uciok\n");
 	
 	int MB = 64;
@@ -146,25 +266,93 @@ void Uci_Loop(ChessBoard *board, SearchInfo *info) {
 	while (BOOL_TYPE_TRUE) {
 		memset(&line[0], 0, sizeof(line));
         fflush(stdout);
-        if (!fgets(line, INPUTBUFFER, stdin))
-        continue;
+        if (!fgets(line, INPUTBUFFER, stdin)) {
+            Uci_StopSearch(info);
+            info->quit = BOOL_TYPE_TRUE;
+            break;
+        }
 
         if (line[0] == '\n')
         continue;
 
+        // answered while a search runs
         if (!strncmp(line, "isready", 7)) {
             printf("readyok\n");
             continue;
-        } else if (!strncmp(line, "position", 8)) {
+        } else if (!strncmp(line, "stop", 4)) {
+            Uci_StopSearch(info);
+            continue;
+        } else if (!strncmp(line, "ponderhit", 9)) {
+            Uci_PonderHit(info);
+            continue;
+        } else if (!strncmp(line, "quit", 4)) {
+            Uci_StopSearch(info);
+            info->quit = BOOL_TYPE_TRUE;
+            break;
+        }
+
+        // a new position or search replaces the running one; anything else
+        // would wait for a search that may never end on its own
+        if (!strncmp(line, "position", 8) || !strncmp(line, "ucinewgame", 10) || !strncmp(line, "go", 2)) {
+            Uci_StopSearch(info);
+        } else if (Uci_SearchActive()) {
+            line[strcspn(line, "\r\n")] = '\0';
+            printf("info string %s ignored while searching\n", line);
+            continue;
+        }
+        Uci_WaitSearch();
+
+        if (!strncmp(line, "position", 8)) {
             ParsePosition(line, board);
         } else if (!strncmp(line, "ucinewgame", 10)) {
             ParsePosition("position startpos\n", board);
         } else if (!strncmp(line, "go", 2)) {
             printf("Seen Go..\n");
             ParseGo(line, info, board);
-        } else if (!strncmp(line, "quit", 4)) {
-            info->quit = BOOL_TYPE_TRUE;
-            break;
+            Uci_StartSearch(board, info);
+        } else if (!strncmp(line, "stats", 5)) {
+            Stats_Print(BOOL_TYPE_TRUE, BOOL_TYPE_TRUE);
+        } else if (!strncmp(line, "bench", 5)) {
+            int depth = BENCH_DEFAULT_DEPTH;
+            int threads = EngineOptions->Threads;
+            int hashMB = 0;
+            sscanf(line, "%*s %d %d %d", &depth, &threads, &hashMB);
+            if(hashMB > 0) {
+                if(hashMB < 4) hashMB = 4;
+                if(hashMB > CHESS_MAX_HASH) hashMB = CHESS_MAX_HASH;
+                MB = hashMB;
+            }
+            Search_Bench(board, info, depth, threads, hashMB);
+        } else if (!strncmp(line, "perftsuite ", 11)) {
+            char path[INPUTBUFFER];
+            int maxDepth = PERFT_SUITE_DEFAULT_DEPTH;
+            if(sscanf(line, "%*s %s %d", path, &maxDepth) >= 1) {
+                Search_PerftSuite(path, maxDepth, EngineOptions->Threads, 0);
+            }
+        } else if (!strncmp(line, "perft", 5)) {
+            int depth = 1;
+            int hashMB = 0;
+            char *ptr = strstr(line, "hash");
+            sscanf(line, "%*s %d", &depth);
+            if(ptr != NULL) sscanf(ptr, "%*s %d", &hashMB);
+            Search_PerftTest(depth, board, EngineOptions->Threads, hashMB);
+        } else if (!strncmp(line, "savehash ", 9)) {
+            char path[INPUTBUFFER];
+            int minDepth = 0;
+            if(sscanf(line, "%*s %s %d", path, &minDepth) >= 1) {
+                long long saved = HashTable_Save(board->HashTable, path, minDepth);
+                if(saved < 0) {
+                    printf("info string savehash: could not write %s\n", path);
+                } else {
+                    printf("info string savehash: %lld entries written to %s\n", saved, path);
+                }
+            }
+        } else if (!strncmp(line, "loadhash ", 9)) {
+            char path[INPUTBUFFER];
+            if(sscanf(line, "%*s %s", path) == 1 && HashTable_Load(board->HashTable, path) == BOOL_TYPE_TRUE) {
+                printf("info string loadhash: %s mapped, Hash is %d MB\n", path,
+                    (int)(((size_t)board->HashTable->numBuckets * sizeof(HashBucket)) >> 20));
+            }
         } else if (!strncmp(line, "uci", 3)) {
             printf("id name %s\n",NAME);
             printf("id author Bluefever\n");
@@ -178,6 +366,76 @@ void Uci_Loop(ChessBoard *board, SearchInfo *info) {
 			if(MB > CHESS_MAX_HASH) MB = CHESS_MAX_HASH;
 			printf("Set Hash to %d MB\n",MB);
 			HashTable_Init(board->HashTable, MB);
+		} else if (!strncmp(line, "setoption name EvalCache value ", 31)) {
+			int cacheMB = EVAL_CACHE_DEFAULT_MB;
+			sscanf(line,"%*s %*s %*s %*s %d",&cacheMB);
+			if(cacheMB < 0) cacheMB = 0;
+			if(cacheMB > EVAL_CACHE_MAX_MB) cacheMB = EVAL_CACHE_MAX_MB;
+			printf("Set EvalCache to %d MB\n",cacheMB);
+			EvalCache_Init(g_evalCache, cacheMB);
+		} else if (!strncmp(line, "setoption name EvalFile value ", 30)) {
+			char *path = line + 30;
+			path[strcspn(path, "\r\n")] = '\0';
+			if(Nnue_Load(path) == BOOL_TYPE_TRUE) {
+				printf("Set EvalFile to %s\n",path);
+			} else {
+				printf("Set EvalFile to %s (not loaded, using classical evaluation)\n",path);
+			}
+			// cached and tracked values belong to the previous evaluator;
+			// the next search root rebuilds the accumulator
+			EvalCache_Clear(g_evalCache);
+			board->accumulator = NULL;
+		} else if (!strncmp(line, "setoption name Threads value ", 29)) {
+			int threads = 1;
+			sscanf(line,"%*s %*s %*s %*s %d",&threads);
+			if(threads < 1) threads = 1;
+			if(threads > CHESS_MAX_THREADS) threads = CHESS_MAX_THREADS;
+			printf("Set Threads to %d\n",threads);
+			EngineOptions->Threads = threads;
+		} else if (!strncmp(line, "setoption name LMR value ", 25)) {
+			EngineOptions->UseLMR = strstr(line, "true") != NULL ? BOOL_TYPE_TRUE : BOOL_TYPE_FALSE;
+		} else if (!strncmp(line, "setoption name Futility value ", 30)) {
+			EngineOptions->UseFutility = strstr(line, "true") != NULL ? BOOL_TYPE_TRUE : BOOL_TYPE_FALSE;
+		} else if (!strncmp(line, "setoption name ReverseFutility value ", 37)) {
+			EngineOptions->UseReverseFutility = strstr(line, "true") != NULL ? BOOL_TYPE_TRUE : BOOL_TYPE_FALSE;
+		} else if (!strncmp(line, "setoption name LazyMargin value ", 32)) {
+			int margin = LAZY_EVAL_MARGIN;
+			sscanf(line,"%*s %*s %*s %*s %d",&margin);
+			if(margin < 0) margin = 0;
+			if(margin > 1000) margin = 1000;
+			printf("Set LazyMargin to %d\n",margin);
+			EngineOptions->LazyMargin = margin;
+		} else if (!strncmp(line, "setoption name MoveOverhead value ", 34)) {
+			int overhead = MOVE_OVERHEAD_DEFAULT;
+			sscanf(line,"%*s %*s %*s %*s %d",&overhead);
+			if(overhead < 0) overhead = 0;
+			if(overhead > 5000) overhead = 5000;
+			printf("Set MoveOverhead to %d\n",overhead);
+			EngineOptions->MoveOverhead = overhead;
+		} else if (!strncmp(line, "setoption name StatsFile value ", 31)) {
+			char *path = line + 31;
+			path[strcspn(path, "\r\n")] = '\0';
+			Stats_SetDumpFile(path);
+			printf("Set StatsFile to %s\n",path);
+		} else if (!strncmp(line, "setoption name SyzygyPath value ", 32)) {
+			char *path = line + 32;
+			path[strcspn(path, "\r\n")] = '\0';
+			Tb_Init(path);
+			printf("Set SyzygyPath to %s\n",path);
+		} else if (!strncmp(line, "setoption name SyzygyProbeDepth value ", 38)) {
+			int probeDepth = 1;
+			sscanf(line,"%*s %*s %*s %*s %d",&probeDepth);
+			if(probeDepth < 1) probeDepth = 1;
+			if(probeDepth > 100) probeDepth = 100;
+			printf("Set SyzygyProbeDepth to %d\n",probeDepth);
+			EngineOptions->SyzygyProbeDepth = probeDepth;
+		} else if (!strncmp(line, "setoption name SyzygyProbeLimit value ", 38)) {
+			int probeLimit = TB_MAX_PIECES;
+			sscanf(line,"%*s %*s %*s %*s %d",&probeLimit);
+			if(probeLimit < 0) probeLimit = 0;
+			if(probeLimit > TB_MAX_PIECES) probeLimit = TB_MAX_PIECES;
+			printf("Set SyzygyProbeLimit to %d\n",probeLimit);
+			EngineOptions->SyzygyProbeLimit = probeLimit;
 		} else if (!strncmp(line, "setoption name Book value ", 26)) {			
 			char *ptrTrue = NULL;
 			ptrTrue = strstr(line, "true");
@@ -12,8 +12,23 @@
  * - new, force, go, usermove
  * - time, otim, level
  * - quit, post, nopost
+ * - hard, easy: Pondering on / off
+ * - memory: Total hash size, the evaluation cache included
+ * - cores: Search threads
+ * - analyze, exit, .: Analysis mode and its status line
+ * - undo: Take back the last move
  * - And more standard XBoard protocol commands
  * 
+ * Pondering: after its move the engine searches the position after the
+ * expected reply (the second PV move) until the GUI sends anything. The
+ * input is left unread for the loop, and the real search then starts
+ * from a transposition table that already covers the reply.
+ * 
+ * Analysis: an infinite ponder search on a thread of its own, as UCI
+ * does, so the loop keeps reading commands. "." only asks the search
+ * for a stat01 line; any other command stops it, and the analysis
+ * restarts from the new position once the command is handled.
+ * 
  * Also includes draw detection:
  * - Fifty-move rule
  * - Threefold repetition
@@ -27,6 +42,23 @@
 #include "stdio.h"
 #include "types_definitions.h"
 #include "string.h"
+#include <pthread.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STOP_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define STOP_STORE(p,v) (*(volatile int *)(p) = (v))
+#endif
+
+typedef struct {
+	ChessBoard *board;
+	SearchInfo *info;
+} XBoardSearch;
+
+static XBoardSearch analysisJob;
+static pthread_t analysisThread;
+static int analysisRunning = BOOL_TYPE_FALSE;
+static int analysisBook = BOOL_TYPE_FALSE;
 
 int ThreeFoldRep(const ChessBoard *board) {
 
@@ -54,54 +86,118 @@ int DrawMaterial(const ChessBoard *board) {
     return BOOL_TYPE_TRUE;
 }
 
-int checkresult(ChessBoard *board) {
+int GameResult(ChessBoard *board) {
 	ASSERT(Board_Check(board));
 
-    if (board->fiftyMove > 100) {
-     printf("1/2-1/2 {fifty move rule (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
-    }
+	if (board->fiftyMove > 100) return GAME_RESULT_FIFTY_MOVES;
+	if (ThreeFoldRep(board) >= 2) return GAME_RESULT_REPETITION;
+	if (DrawMaterial(board) == BOOL_TYPE_TRUE) return GAME_RESULT_MATERIAL;
 
-    if (ThreeFoldRep(board) >= 2) {
-     printf("1/2-1/2 {3-fold repetition (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
-    }
+	MoveList list[1];
+	Move_GenerateLegal(board,list);
 
-	if (DrawMaterial(board) == BOOL_TYPE_TRUE) {
-     printf("1/2-1/2 {insufficient material (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
-    }
+	if(list->count != 0) return GAME_RESULT_NONE;
 
-	MoveList list[1];
-    Move_GenerateAll(board,list);
-
-    int MoveNum = 0;
-	int found = 0;
-	for(MoveNum = 0; MoveNum < list->count; ++MoveNum) {
-
-        if ( !Move_Make(board,list->moves[MoveNum].move))  {
-            continue;
-        }
-        found++;
-		Move_Take(board);
-		break;
-    }
+	if(Attack_IsSquareAttacked(board->KingSq[board->side],board->side^1,board) == BOOL_TYPE_FALSE) {
+		return GAME_RESULT_STALEMATE;
+	}
+	return board->side == COLOR_TYPE_WHITE ? GAME_RESULT_BLACK_MATES : GAME_RESULT_WHITE_MATES;
+}
+
+int checkresult(ChessBoard *board) {
 
-	if(found != 0) return BOOL_TYPE_FALSE;
+	switch(GameResult(board)) {
+		case GAME_RESULT_FIFTY_MOVES:
+			printf("1/2-1/2 {fifty move rule (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
+		case GAME_RESULT_REPETITION:
+			printf("1/2-1/2 {3-fold repetition (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
+		case GAME_RESULT_MATERIAL:
+			printf("1/2-1/2 {insufficient material (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
+		case GAME_RESULT_BLACK_MATES:
+			printf("0-1 {black mates (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
+		case GAME_RESULT_WHITE_MATES:
+			printf("1-0 {white mates (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
+		case GAME_RESULT_STALEMATE:
+			printf("\n1/2-1/2 {stalemate (claimed by Gambit)}\n"); return BOOL_TYPE_TRUE;
+		default:
+			return BOOL_TYPE_FALSE;
+	}
+}
 
-	int InCheck = Attack_IsSquareAttacked(board->KingSq[board->side],board->side^1,board);
+// thinks on the opponent's time until input arrives
+static void XBoard_Ponder(ChessBoard *board, SearchInfo *info) {
 
-	if(InCheck == BOOL_TYPE_TRUE)	{
-	    if(board->side == COLOR_TYPE_WHITE) {
-	      printf("0-1 {black mates (claimed by Gambit)}\n");return BOOL_TYPE_TRUE;
-        } else {
-	      printf("1-0 {white mates (claimed by Gambit)}\n");return BOOL_TYPE_TRUE;
-        }
-    } else {
-      printf("\n1/2-1/2 {stalemate (claimed by Gambit)}\n");return BOOL_TYPE_TRUE;
-    }
-	return BOOL_TYPE_FALSE;
+	int move = info->ponderMove;
+	int depth = info->depth;
+	int timeset = info->timeset;
+
+	info->ponderMove = NOMOVE;
+	if(move == NOMOVE || !Move_IsLegal(board, move) || InputWaiting()) {
+		return;
+	}
+
+	Move_MakeLegal(board, move);
+	board->ply = 0;
+	info->ponder = BOOL_TYPE_TRUE;
+	info->timeset = BOOL_TYPE_FALSE;
+	info->depth = CHESS_MAX_SEARCH_DEPTH;
+	info->starttime = Misc_GetTimeMs();
+	Search_Position(board, info);
+	info->ponder = BOOL_TYPE_FALSE;
+	info->timeset = timeset;
+	info->depth = depth;
+	Move_Take(board);
+	board->ply = 0;
+}
+
+static void *XBoard_AnalysisThread(void *arg) {
+
+	XBoardSearch *job = (XBoardSearch *)arg;
+
+	Search_Position(job->board, job->info);
+	return NULL;
+}
+
+// a book move would end the analysis at once, so the book is off until
+// the analysis stops
+static void XBoard_StartAnalysis(ChessBoard *board, SearchInfo *info) {
+
+	info->asyncInput = BOOL_TYPE_TRUE;
+	info->stopRequest = BOOL_TYPE_FALSE;
+	info->statusRequest = BOOL_TYPE_FALSE;
+	info->ponder = BOOL_TYPE_TRUE;
+	info->timeset = BOOL_TYPE_FALSE;
+	info->depth = CHESS_MAX_SEARCH_DEPTH;
+	info->starttime = Misc_GetTimeMs();
+	analysisBook = EngineOptions->UseBook;
+	EngineOptions->UseBook = BOOL_TYPE_FALSE;
+
+	analysisJob.board = board;
+	analysisJob.info = info;
+	if(pthread_create(&analysisThread, NULL, XBoard_AnalysisThread, &analysisJob) == 0) {
+		analysisRunning = BOOL_TYPE_TRUE;
+	} else {
+		info->asyncInput = BOOL_TYPE_FALSE;
+		info->ponder = BOOL_TYPE_FALSE;
+		EngineOptions->UseBook = analysisBook;
+	}
+}
+
+static void XBoard_StopAnalysis(SearchInfo *info) {
+
+	if(analysisRunning == BOOL_TYPE_TRUE) {
+		STOP_STORE(&info->stopRequest, BOOL_TYPE_TRUE);
+		pthread_join(analysisThread, NULL);
+		analysisRunning = BOOL_TYPE_FALSE;
+		info->asyncInput = BOOL_TYPE_FALSE;
+		info->ponder = BOOL_TYPE_FALSE;
+		info->ponderMove = NOMOVE;
+		EngineOptions->UseBook = analysisBook;
+	}
 }
 
 void PrintOptions() {
-	printf("feature ping=1 setboard=1 colors=0 usermove=1 memory=1\n");
+	printf("feature ping=1 setboard=1 colors=0 usermove=1 memory=1 smp=1 analyze=1\n");
 	printf("feature done=1\n");
 }
 
@@ -118,10 +214,14 @@ void XBoard_Loop(ChessBoard *board, SearchInfo *info) {
 	int engineSide = COLOR_TYPE_BOTH;
 	int timeLeft;
 	int sec;
-	int mps;
+	int mps = 0;
 	int move = NOMOVE;
 	char inBuf[80], command[80];
 	int MB;
+	int cores;
+	int ponder = BOOL_TYPE_FALSE;
+	int analyze = BOOL_TYPE_FALSE;
+	int analysisStale = BOOL_TYPE_FALSE;
 
 	engineSide = COLOR_TYPE_BLACK;
 	Board_ParseFromFEN(CHESS_START_FEN, board);
@@ -132,23 +232,21 @@ void XBoard_Loop(ChessBoard *board, SearchInfo *info) {
 
 		fflush(stdout);
 
-		if(board->side == engineSide && checkresult(board) == BOOL_TYPE_FALSE) {
+		// the board belongs to a running analysis until it is stopped
+		if(analysisRunning == BOOL_TYPE_FALSE && board->side == engineSide && checkresult(board) == BOOL_TYPE_FALSE) {
 			info->starttime = Misc_GetTimeMs();
 			info->depth = depth;
 
-			if(time != -1) {
-				info->timeset = BOOL_TYPE_TRUE;
-				time /= movestogo[board->side];
-				time -= 50;
-				info->stoptime = info->starttime + time + inc;
-			}
+			// level and st give seconds, time gives centiseconds (kept in ms)
+			Time_Allocate(info, time, inc * 1000, mps != 0 ? movestogo[board->side] : 0,
+				movetime > 0 ? movetime * 1000 : -1);
 
 			if(depth == -1 || depth > CHESS_MAX_SEARCH_DEPTH) {
 				info->depth = CHESS_MAX_SEARCH_DEPTH;
 			}
 
-			printf("time:%d start:%d stop:%d depth:%d timeset:%d movestogo:%d mps:%d\n",
-				time,info->starttime,info->stoptime,info->depth,info->timeset, movestogo[board->side], mps);
+			printf("time:%d start:%d soft:%d hard:%d depth:%d timeset:%d movestogo:%d mps:%d\n",
+				time,info->starttime,info->tm.softTime,info->tm.hardTime,info->depth,info->timeset, movestogo[board->side], mps);
 				Search_Position(board, info);
 
 			if(mps != 0) {
@@ -162,20 +260,69 @@ void XBoard_Loop(ChessBoard *board, SearchInfo *info) {
 
 		fflush(stdout);
 
+		if(analysisRunning == BOOL_TYPE_FALSE && ponder == BOOL_TYPE_TRUE && engineSide == (board->side ^ 1)) {
+			XBoard_Ponder(board, info);
+		}
+
+		if(analyze == BOOL_TYPE_TRUE && analysisStale == BOOL_TYPE_TRUE) {
+			analysisStale = BOOL_TYPE_FALSE;
+			XBoard_StartAnalysis(board, info);
+		}
+
 		memset(&inBuf[0], 0, sizeof(inBuf));
 		fflush(stdout);
-		if (!fgets(inBuf, 80, stdin))
-		continue;
+		if (!fgets(inBuf, 80, stdin)) {
+			XBoard_StopAnalysis(info);
+			info->quit = BOOL_TYPE_TRUE;
+			break;
+		}
 
 		sscanf(inBuf, "%s", command);
 
 		printf("command seen:%s\n",inBuf);
 
+		if(!strcmp(command, ".")) {
+			if(analysisRunning == BOOL_TYPE_TRUE) {
+				STOP_STORE(&info->statusRequest, BOOL_TYPE_TRUE);
+			}
+			continue;
+		}
+
+		// anything else may change the position or the options, so the
+		// analysis stops and is started again afterwards
+		if(analysisRunning == BOOL_TYPE_TRUE) {
+			XBoard_StopAnalysis(info);
+			analysisStale = BOOL_TYPE_TRUE;
+		}
+
+		if(!strcmp(command, "analyze")) {
+			engineSide = COLOR_TYPE_BOTH;
+			analyze = BOOL_TYPE_TRUE;
+			analysisStale = BOOL_TYPE_TRUE;
+			continue;
+		}
+
+		if(!strcmp(command, "exit")) {
+			analyze = BOOL_TYPE_FALSE;
+			analysisStale = BOOL_TYPE_FALSE;
+			continue;
+		}
+
 		if(!strcmp(command, "quit")) {
 			info->quit = BOOL_TYPE_TRUE;
 			break;
 		}
 
+		if(!strcmp(command, "hard")) {
+			ponder = BOOL_TYPE_TRUE;
+			continue;
+		}
+
+		if(!strcmp(command, "easy")) {
+			ponder = BOOL_TYPE_FALSE;
+			continue;
+		}
+
 		if(!strcmp(command, "force")) {
 			engineSide = COLOR_TYPE_BOTH;
 			continue;
@@ -205,8 +352,13 @@ void XBoard_Loop(ChessBoard *board, SearchInfo *info) {
 			continue;
 		}
 		
+		// the total for all hash tables: the transposition table gets
+		// what the evaluation cache leaves
 		if(!strcmp(command, "memory")) {			
-			sscanf(inBuf, "memory %d", &MB);		
+			sscanf(inBuf, "memory %d", &MB);
+			if(g_evalCache->entries != NULL) {
+				MB -= (int)(((g_evalCache->mask + 1) * sizeof(U64)) >> 20);
+			}
 		    if(MB < 4) MB = 4;
 			if(MB > CHESS_MAX_HASH) MB = CHESS_MAX_HASH;
 			printf("Set Hash to %d MB\n",MB);
@@ -214,6 +366,15 @@ void XBoard_Loop(ChessBoard *board, SearchInfo *info) {
 			continue;
 		}
 
+		if(!strcmp(command, "cores")) {
+			sscanf(inBuf, "cores %d", &cores);
+			if(cores < 1) cores = 1;
+			if(cores > CHESS_MAX_THREADS) cores = CHESS_MAX_THREADS;
+			printf("Set Threads to %d\n",cores);
+			EngineOptions->Threads = cores;
+			continue;
+		}
+
 		if(!strcmp(command, "level")) {
 			sec = 0;
 			movetime = -1;
@@ -241,13 +402,21 @@ void XBoard_Loop(ChessBoard *board, SearchInfo *info) {
 
 		if(!strcmp(command, "new")) {
 			HashTable_Clear(board->HashTable);
-			engineSide = COLOR_TYPE_BLACK;
+			engineSide = analyze == BOOL_TYPE_TRUE ? COLOR_TYPE_BOTH : COLOR_TYPE_BLACK;
 			Board_ParseFromFEN(CHESS_START_FEN, board);
 			depth = -1;
 			time = -1;
 			continue;
 		}
 
+		if(!strcmp(command, "undo")) {
+			if(board->hisPly > 0) {
+				Move_Take(board);
+				board->ply = 0;
+			}
+			continue;
+		}
+
 		if(!strcmp(command, "setboard")){
 			engineSide = COLOR_TYPE_BOTH;
 			Board_ParseFromFEN(inBuf+9, board);
@@ -296,10 +465,7 @@ void Console_Loop(ChessBoard *board, SearchInfo *info) {
 			info->starttime = Misc_GetTimeMs();
 			info->depth = depth;
 
-			if(movetime != 0) {
-				info->timeset = BOOL_TYPE_TRUE;
-				info->stoptime = info->starttime + movetime;
-			}
+			Time_Allocate(info, -1, 0, 0, movetime);
 
 			Search_Position(board, info);
 		}
@@ -328,6 +494,8 @@ void Console_Loop(ChessBoard *board, SearchInfo *info) {
 			printf("time x - set thinking time to x seconds (depth still applies if set)\n");
 			printf("view - show current depth and movetime settings\n");
 			printf("setboard x - set position to fen x\n");
+			printf("stats - show statistics of the last search, per depth\n");
+			printf("statsfile x - append search statistics to file x (.csv or JSON lines)\n");
 			printf("** note ** - to reset time and depth, set to 0\n");
 			printf("enter moves using b7b8q notation\n\n\n");
 			continue;
@@ -339,6 +507,19 @@ void Console_Loop(ChessBoard *board, SearchInfo *info) {
 			continue;
 		}
 
+		if(!strcmp(command, "stats")) {
+			Stats_Print(BOOL_TYPE_FALSE, BOOL_TYPE_TRUE);
+			continue;
+		}
+
+		if(!strcmp(command, "statsfile")) {
+			char path[80] = "";
+			sscanf(inBuf, "%*s %79s", path);
+			Stats_SetDumpFile(path);
+			printf("Stats file: %s\n", path[0] != '\0' ? path : "off");
+			continue;
+		}
+
 		if(!strcmp(command, "eval")) {
 			Board_Print(board);
 			printf("Eval:%d",Evaluate_Position(board));
@@ -13,6 +13,13 @@
  * - Promotion dialog
  * - Game over messages
  * - Game mode selection (Human vs Human, Human vs Computer, Computer vs Computer)
+ * - Engine moves searched on a background thread, with the time limit
+ *   taken from the game clocks, so rendering and timers stay live
+ * - Fonts opened once; piece glyphs and text kept as textures, so a string
+ *   is rendered again only when it changes (e.g. a clock's second ticks)
+ * - Frames drawn only when something visible changed
+ * - Legal moves generated once per position and shared by highlighting,
+ *   move validation, promotion and game-over detection
  * 
  * Features:
  * - Drag-and-drop piece movement
@@ -31,6 +38,13 @@
 #include <SDL2/SDL_ttf.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STOP_STORE(p,v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#define STOP_STORE(p,v) (*(volatile int *)(p) = (v))
+#endif
 
 const char* GetPieceSymbol(int piece) {
     switch(piece) {
@@ -50,6 +64,115 @@ const char* GetPieceSymbol(int piece) {
     }
 }
 
+static const char* TextFontFiles[] = {
+    "C:/Windows/Fonts/arial.ttf",
+    "C:/Windows/Fonts/calibri.ttf",
+    "arial.ttf",
+    "/System/Library/Fonts/Arial.ttf",
+    NULL
+};
+
+static const char* GlyphFontFiles[] = {
+    "C:/Windows/Fonts/seguisym.ttf",
+    "C:/Windows/Fonts/arial.ttf",
+    NULL
+};
+
+// Point size of each GUI_FONT_*
+static const int FontSizes[GUI_FONT_COUNT] = { 14, 16, 18, 24, 36, 60, CAPTURED_PIECE_SIZE - 5, 50 };
+
+static TTF_Font* OpenFirstFont(const char** files, int size) {
+    for (int i = 0; files[i] != NULL; i++) {
+        TTF_Font* font = TTF_OpenFont(files[i], size);
+        if (font) return font;
+    }
+    return NULL;
+}
+
+static Uint32 PackColor(SDL_Color color) {
+    return ((Uint32)color.r << 24) | ((Uint32)color.g << 16) | ((Uint32)color.b << 8) | color.a;
+}
+
+// Cache entry holding the texture of a string, rendered into the least
+// recently drawn slot on a miss; NULL if the font is missing or the string empty
+static TextCacheEntry* GetCachedText(GUI* gui, int font, SDL_Color color, const char* text) {
+    char key[TEXT_CACHE_MAX_LEN];
+    Uint32 packed = PackColor(color);
+    TextCacheEntry* victim = &gui->textCache[0];
+    
+    snprintf(key, sizeof(key), "%s", text);
+    if (!gui->fonts[font] || key[0] == '\0') return NULL;
+    
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        TextCacheEntry* entry = &gui->textCache[i];
+        if (entry->texture && entry->font == font && entry->color == packed && strcmp(entry->text, key) == 0) {
+            entry->lastUsed = gui->frame;
+            return entry;
+        }
+        // Prefer a free slot, else the one drawn longest ago
+        if (victim->texture && (!entry->texture || entry->lastUsed < victim->lastUsed)) {
+            victim = entry;
+        }
+    }
+    
+    SDL_Surface* surface = TTF_RenderText_Solid(gui->fonts[font], key, color);
+    if (!surface) return NULL;
+    if (victim->texture) {
+        SDL_DestroyTexture(victim->texture);
+    }
+    victim->texture = SDL_CreateTextureFromSurface(gui->renderer, surface);
+    victim->font = font;
+    victim->color = packed;
+    strcpy(victim->text, key);
+    victim->w = surface->w;
+    victim->h = surface->h;
+    victim->lastUsed = gui->frame;
+    SDL_FreeSurface(surface);
+    
+    return victim->texture ? victim : NULL;
+}
+
+void GUI_DrawText(GUI* gui, int font, SDL_Color color, const char* text, int x, int y, int centerWidth) {
+    TextCacheEntry* entry = GetCachedText(gui, font, color, text);
+    if (!entry) return;
+    
+    // Centre horizontally in a box of centerWidth starting at x
+    if (centerWidth > 0) {
+        x += (centerWidth - entry->w) / 2;
+    }
+    SDL_Rect rect = {x, y, entry->w, entry->h};
+    SDL_RenderCopy(gui->renderer, entry->texture, NULL, &rect);
+}
+
+// Glyph of a piece in one of the glyph fonts, rendered on first use
+static SDL_Texture* GetPieceGlyph(GUI* gui, SDL_Texture** glyphs, int font, int piece) {
+    // Safety check for piece bounds
+    if (piece == EMPTY || piece == OFFBOARD || piece < 0 || piece >= 13) {
+        return NULL;
+    }
+    
+    if (!glyphs[piece] && gui->fonts[font]) {
+        // White pieces light, black pieces dark
+        SDL_Color color = (piece >= PIECE_TYPE_WHITE_PAWN && piece <= PIECE_TYPE_WHITE_KING)
+                        ? (SDL_Color){255, 255, 255, 255} : (SDL_Color){50, 50, 50, 255};
+        SDL_Surface* surface = TTF_RenderUTF8_Blended(gui->fonts[font], GetPieceSymbol(piece), color);
+        if (surface) {
+            glyphs[piece] = SDL_CreateTextureFromSurface(gui->renderer, surface);
+            SDL_FreeSurface(surface);
+        }
+    }
+    return glyphs[piece];
+}
+
+// Draws a glyph centred in a size x size box at (x, y)
+static void DrawGlyph(GUI* gui, SDL_Texture* glyph, int x, int y, int size) {
+    int w, h;
+    if (!glyph || SDL_QueryTexture(glyph, NULL, NULL, &w, &h) != 0) return;
+    
+    SDL_Rect rect = {x + (size - w) / 2, y + (size - h) / 2, w, h};
+    SDL_RenderCopy(gui->renderer, glyph, NULL, &rect);
+}
+
 int GUI_Init(GUI* gui) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
@@ -106,6 +229,11 @@ int GUI_Init(GUI* gui) {
         gui->possibleMoves[i] = NO_SQ;
     }
     
+    // Initialize legal move cache
+    gui->legalMovesValid = 0;
+    gui->legalMovesKey = 0;
+    gui->legalMoves->count = 0;
+    
     // Initialize pawn promotion
     gui->promotionPending = 0;
     gui->promotionFromSq = NO_SQ;
@@ -114,7 +242,35 @@ int GUI_Init(GUI* gui) {
     // Initialize piece textures array to NULL
     for (int i = 0; i < 13; i++) {
         gui->pieceTextures[i] = NULL;
+        gui->capturedTextures[i] = NULL;
+        gui->promotionTextures[i] = NULL;
+    }
+    
+    // Open every font once; text and glyphs are rendered into textures
+    for (int i = 0; i < GUI_FONT_COUNT; i++) {
+        gui->fonts[i] = OpenFirstFont(i < GUI_FONT_PIECE ? TextFontFiles : GlyphFontFiles, FontSizes[i]);
+        if (!gui->fonts[i]) {
+            printf("WARNING: Could not load a %d pt font; some text will be missing\n", FontSizes[i]);
+        }
+    }
+    memset(gui->textCache, 0, sizeof(gui->textCache));
+    gui->frame = 0;
+    
+    // The first frame is always drawn
+    gui->needsRedraw = 1;
+    gui->drawnWhiteSec = -1;
+    gui->drawnBlackSec = -1;
+    gui->drawnThinkTenths = -1;
+    
+    // Initialize engine search state
+    gui->engineThinking = 0;
+    gui->engineStartTime = 0;
+    gui->engineInfo = NULL;
+    gui->engineEventType = SDL_RegisterEvents(1);
+    if (gui->engineEventType == (Uint32)-1) {
+        gui->engineEventType = SDL_USEREVENT;
     }
+    Board_Init(gui->engineBoard);
 
     return 1;
 }
@@ -122,12 +278,38 @@ int GUI_Init(GUI* gui) {
 void CleanupGUI(GUI* gui) {
     if (!gui) return;  // Safety check for null pointer
     
+    // The engine thread searches engineBoard, so it must end first
+    GUI_StopEngine(gui);
+    Board_Free(gui->engineBoard);
+    
     // Clean up piece textures if they exist
     for (int i = 0; i < 13; i++) {
         if (gui->pieceTextures[i]) {
             SDL_DestroyTexture(gui->pieceTextures[i]);
             gui->pieceTextures[i] = NULL;
         }
+        if (gui->capturedTextures[i]) {
+            SDL_DestroyTexture(gui->capturedTextures[i]);
+            gui->capturedTextures[i] = NULL;
+        }
+        if (gui->promotionTextures[i]) {
+            SDL_DestroyTexture(gui->promotionTextures[i]);
+            gui->promotionTextures[i] = NULL;
+        }
+    }
+    
+    // Clean up cached text and fonts
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        if (gui->textCache[i].texture) {
+            SDL_DestroyTexture(gui->textCache[i].texture);
+            gui->textCache[i].texture = NULL;
+        }
+    }
+    for (int i = 0; i < GUI_FONT_COUNT; i++) {
+        if (gui->fonts[i]) {
+            TTF_CloseFont(gui->fonts[i]);
+            gui->fonts[i] = NULL;
+        }
     }
     
     if (gui->renderer) {
@@ -151,102 +333,42 @@ void RenderGameOverMessage(GUI* gui) {
     SDL_Rect overlay = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
     SDL_RenderFillRect(gui->renderer, &overlay);
     
-    // Load font (using a default system font)
-    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 36);
-    if (!font) {
-        // Fallback to any available font
-        font = TTF_OpenFont("C:/Windows/Fonts/calibri.ttf", 36);
-    }
-    if (!font) {
-        // Try common cross-platform fonts
-        font = TTF_OpenFont("arial.ttf", 36);
-    }
-    if (!font) {
-        // Last resort - try system default
-        font = TTF_OpenFont("/System/Library/Fonts/Arial.ttf", 36);
-    }
-    if (!font) {
-        // If no fonts work, just display a simple rectangle with error logging
-        printf("WARNING: Could not load any fonts for game over message\n");
+    SDL_Color textColor = {255, 255, 255, 255}; // White text
+    TextCacheEntry* text = GetCachedText(gui, GUI_FONT_MESSAGE, textColor, gui->gameOverMessage);
+    if (!text) {
+        // If no fonts work, just display a simple rectangle
         SDL_SetRenderDrawColor(gui->renderer, 255, 255, 255, 255);
         SDL_Rect messageBox = {200, 300, 400, 100};
         SDL_RenderFillRect(gui->renderer, &messageBox);
         return;
     }
     
-    // Create text surface
-    SDL_Color textColor = {255, 255, 255, 255}; // White text
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, gui->gameOverMessage, textColor);
-    if (textSurface) {
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(gui->renderer, textSurface);
-        if (textTexture) {
-            int textWidth = textSurface->w;
-            int textHeight = textSurface->h;
-            
-            // Center the text
-            SDL_Rect textRect = {
-                (WINDOW_WIDTH - textWidth) / 2,
-                (WINDOW_HEIGHT - textHeight) / 2,
-                textWidth,
-                textHeight
-            };
-            
-            SDL_RenderCopy(gui->renderer, textTexture, NULL, &textRect);
-            SDL_DestroyTexture(textTexture);
-        }
-        SDL_FreeSurface(textSurface);
-    }
-    
-    TTF_CloseFont(font);
+    // Center the text
+    SDL_Rect textRect = {
+        (WINDOW_WIDTH - text->w) / 2,
+        (WINDOW_HEIGHT - text->h) / 2,
+        text->w,
+        text->h
+    };
+    SDL_RenderCopy(gui->renderer, text->texture, NULL, &textRect);
 }
 
 void RenderGameMode(GUI* gui) {
-    // Load font for mode display
-    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 18);
-    if (!font) {
-        font = TTF_OpenFont("C:/Windows/Fonts/calibri.ttf", 18);
-    }
-    if (!font) {
-        font = TTF_OpenFont("arial.ttf", 18);
-    }
-    if (!font) {
-        font = TTF_OpenFont("/System/Library/Fonts/Arial.ttf", 18);
-    }
-    if (!font) {
-        printf("WARNING: Could not load fonts for game mode display\n");
-        return; // Skip if no font available
+    // Create mode text, with the thinking time while the engine searches
+    char modeText[64];
+    if (gui->engineThinking) {
+        int elapsed = Misc_GetTimeMs() - gui->engineStartTime;
+        snprintf(modeText, sizeof(modeText), "Mode: Player vs Engine - Engine thinking %d.%ds",
+                 elapsed / 1000, (elapsed % 1000) / 100);
+    } else {
+        snprintf(modeText, sizeof(modeText), "%s",
+                 (gui->gameMode == MODE_PVE) ? "Mode: Player vs Engine" : "Mode: Player vs Player");
     }
-    
-    // Create mode text
-    const char* modeText = (gui->gameMode == MODE_PVE) ? "Mode: Player vs Engine" : "Mode: Player vs Player";
     SDL_Color textColor = {255, 255, 255, 255}; // White text
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, modeText, textColor);
-    
-    if (textSurface) {
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(gui->renderer, textSurface);
-        if (textTexture) {
-            SDL_Rect textRect = {10, BOARD_SIZE + 10, textSurface->w, textSurface->h};
-            SDL_RenderCopy(gui->renderer, textTexture, NULL, &textRect);
-            SDL_DestroyTexture(textTexture);
-        }
-        SDL_FreeSurface(textSurface);
-    }
+    GUI_DrawText(gui, GUI_FONT_STATUS, textColor, modeText, 10, BOARD_SIZE + 10, 0);
     
     // Add controls text
-    const char* controlsText = "Controls: N=New Game, M=Switch Mode, H=Help";
-    SDL_Surface* controlsSurface = TTF_RenderText_Solid(font, controlsText, textColor);
-    
-    if (controlsSurface) {
-        SDL_Texture* controlsTexture = SDL_CreateTextureFromSurface(gui->renderer, controlsSurface);
-        if (controlsTexture) {
-            SDL_Rect controlsRect = {10, BOARD_SIZE + 35, controlsSurface->w, controlsSurface->h};
-            SDL_RenderCopy(gui->renderer, controlsTexture, NULL, &controlsRect);
-            SDL_DestroyTexture(controlsTexture);
-        }
-        SDL_FreeSurface(controlsSurface);
-    }
-    
-    TTF_CloseFont(font);
+    GUI_DrawText(gui, GUI_FONT_STATUS, textColor, "Controls: N=New Game, M=Switch Mode, H=Help", 10, BOARD_SIZE + 35, 0);
 }
 
 void SetGameOver(GUI* gui, ChessBoard* board) {
@@ -295,18 +417,56 @@ void SetGameOver(GUI* gui, ChessBoard* board) {
     }
 }
 
-int IsPawnPromotion(ChessBoard* board, int fromSq, int toSq) {
-    int piece = board->pieces[fromSq];
+// Legal moves of the shown position, generated only when it changed
+static const MoveList* GetLegalMoves(GUI* gui, ChessBoard* board) {
+    if (!gui->legalMovesValid || gui->legalMovesKey != board->posKey) {
+        Move_GenerateLegal(board, gui->legalMoves);
+        gui->legalMovesKey = board->posKey;
+        gui->legalMovesValid = 1;
+    }
+    return gui->legalMoves;
+}
+
+// Plays a move on the shown board; its legal moves are generated again
+static int MakeGuiMove(GUI* gui, ChessBoard* board, int move) {
+    gui->legalMovesValid = 0;
+    return Move_Make(board, move);
+}
+
+// The legal move fromSq-toSq, promoting to the piece letter promotion
+// ('q', 'r', 'b', 'n'; '\0' for none); NOMOVE if there is none
+static int FindLegalMove(GUI* gui, ChessBoard* board, int fromSq, int toSq, char promotion) {
+    const MoveList* list = GetLegalMoves(gui, board);
     
-    // Check if it's a pawn
-    if (!g_piecePawn[piece]) return 0;
+    for (int i = 0; i < list->count; i++) {
+        int move = list->moves[i].move;
+        int promoted = MOVE_GET_PROMOTED(move);
+        if (MOVE_GET_FROM_SQUARE(move) == fromSq && MOVE_GET_TO_SQUARE(move) == toSq
+            && (promoted == EMPTY ? promotion == '\0' : tolower(PceChar[promoted]) == promotion)) {
+            return move;
+        }
+    }
+    return NOMOVE;
+}
+
+// GameResult, with mate and stalemate read from the cached legal moves
+static int GetGameResult(GUI* gui, ChessBoard* board) {
+    if (board->fiftyMove > 100) return GAME_RESULT_FIFTY_MOVES;
+    if (ThreeFoldRep(board) >= 2) return GAME_RESULT_REPETITION;
+    if (DrawMaterial(board) == BOOL_TYPE_TRUE) return GAME_RESULT_MATERIAL;
     
-    // Check if moving to promotion rank
-    int toRank = g_ranksBoard[toSq];
-    if (piece == PIECE_TYPE_WHITE_PAWN && toRank == RANK_TYPE_8) return 1; // White pawn to 8th rank
-    if (piece == PIECE_TYPE_BLACK_PAWN && toRank == RANK_TYPE_1) return 1; // Black pawn to 1st rank
+    if (GetLegalMoves(gui, board)->count != 0) return GAME_RESULT_NONE;
     
-    return 0;
+    if (!Attack_IsSquareAttacked(board->KingSq[board->side], board->side ^ 1, board)) {
+        return GAME_RESULT_STALEMATE;
+    }
+    return board->side == COLOR_TYPE_WHITE ? GAME_RESULT_BLACK_MATES : GAME_RESULT_WHITE_MATES;
+}
+
+int IsPawnPromotion(GUI* gui, ChessBoard* board, int fromSq, int toSq) {
+    // A legal move between the squares promotes (every promotion choice is
+    // legal when one is)
+    return FindLegalMove(gui, board, fromSq, toSq, 'q') != NOMOVE;
 }
 
 char GetPromotionChoice() {
@@ -337,21 +497,8 @@ void RenderPromotionDialog(GUI* gui, ChessBoard* board) {
     SDL_RenderDrawRect(gui->renderer, &dialogBg);
     
     // Title
-    TTF_Font* titleFont = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 24);
-    if (titleFont) {
-        SDL_Color white = {255, 255, 255, 255};
-        SDL_Surface* titleSurf = TTF_RenderText_Solid(titleFont, "Choose Promotion Piece", white);
-        if (titleSurf) {
-            SDL_Texture* titleTex = SDL_CreateTextureFromSurface(gui->renderer, titleSurf);
-            if (titleTex) {
-                SDL_Rect titleRect = {dialogX + (dialogW - titleSurf->w) / 2, dialogY + 15, titleSurf->w, titleSurf->h};
-                SDL_RenderCopy(gui->renderer, titleTex, NULL, &titleRect);
-                SDL_DestroyTexture(titleTex);
-            }
-            SDL_FreeSurface(titleSurf);
-        }
-        TTF_CloseFont(titleFont);
-    }
+    SDL_Color white = {255, 255, 255, 255};
+    GUI_DrawText(gui, GUI_FONT_TIMER, white, "Choose Promotion Piece", dialogX, dialogY + 15, dialogW);
     
     // Determine which color pieces to show
     int isWhite = (board->side == COLOR_TYPE_BLACK); // After move, side switches, so we check opposite
@@ -370,9 +517,6 @@ void RenderPromotionDialog(GUI* gui, ChessBoard* board) {
     }
     
     // Draw piece boxes and pieces
-    TTF_Font* pieceFont = TTF_OpenFont("C:/Windows/Fonts/seguisym.ttf", 50);
-    if (!pieceFont) pieceFont = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 50);
-    
     for (int i = 0; i < 4; i++) {
         int x = startX + i * (pieceSize + spacing);
         
@@ -385,46 +529,14 @@ void RenderPromotionDialog(GUI* gui, ChessBoard* board) {
         SDL_RenderDrawRect(gui->renderer, &box);
         
         // Draw piece symbol
-        if (pieceFont) {
-            const char* symbol = GetPieceSymbol(pieces[i]);
-            SDL_Color color = isWhite ? (SDL_Color){255, 255, 255, 255} : (SDL_Color){50, 50, 50, 255};
-            SDL_Surface* pieceSurf = TTF_RenderUTF8_Blended(pieceFont, symbol, color);
-            if (pieceSurf) {
-                SDL_Texture* pieceTex = SDL_CreateTextureFromSurface(gui->renderer, pieceSurf);
-                if (pieceTex) {
-                    int offsetX = (pieceSize - pieceSurf->w) / 2;
-                    int offsetY = (pieceSize - pieceSurf->h) / 2;
-                    SDL_Rect pieceRect = {x + offsetX, startY + offsetY, pieceSurf->w, pieceSurf->h};
-                    SDL_RenderCopy(gui->renderer, pieceTex, NULL, &pieceRect);
-                    SDL_DestroyTexture(pieceTex);
-                }
-                SDL_FreeSurface(pieceSurf);
-            }
-        }
+        DrawGlyph(gui, GetPieceGlyph(gui, gui->promotionTextures, GUI_FONT_PROMOTION, pieces[i]), x, startY, pieceSize);
     }
     
-    if (pieceFont) TTF_CloseFont(pieceFont);
-    
     // Draw labels
-    TTF_Font* labelFont = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 14);
-    if (labelFont) {
-        const char* labels[4] = {"Queen", "Rook", "Bishop", "Knight"};
-        SDL_Color white = {255, 255, 255, 255};
-        
-        for (int i = 0; i < 4; i++) {
-            int x = startX + i * (pieceSize + spacing);
-            SDL_Surface* labelSurf = TTF_RenderText_Solid(labelFont, labels[i], white);
-            if (labelSurf) {
-                SDL_Texture* labelTex = SDL_CreateTextureFromSurface(gui->renderer, labelSurf);
-                if (labelTex) {
-                    SDL_Rect labelRect = {x + (pieceSize - labelSurf->w) / 2, startY + pieceSize + 10, labelSurf->w, labelSurf->h};
-                    SDL_RenderCopy(gui->renderer, labelTex, NULL, &labelRect);
-                    SDL_DestroyTexture(labelTex);
-                }
-                SDL_FreeSurface(labelSurf);
-            }
-        }
-        TTF_CloseFont(labelFont);
+    const char* labels[4] = {"Queen", "Rook", "Bishop", "Knight"};
+    for (int i = 0; i < 4; i++) {
+        int x = startX + i * (pieceSize + spacing);
+        GUI_DrawText(gui, GUI_FONT_HISTORY, white, labels[i], x, startY + pieceSize + 10, pieceSize);
     }
 }
 
@@ -487,111 +599,25 @@ void GetSquareCoords(int square, int* x, int* y) {
 }
 
 void GUI_DrawPiece(GUI* gui, int piece, int x, int y) {
-    // Safety check for piece bounds
-    if (piece == EMPTY || piece == OFFBOARD || piece < 0 || piece >= 13) {
-        return;
-    }
-    
-    // Load font for chess symbols
-    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/seguisym.ttf", 60);
-    if (!font) {
-        font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 60);
-    }
-    if (!font) return;
-    
-    // Get the Unicode chess symbol
-    const char* symbol = GetPieceSymbol(piece);
-    if (!symbol || symbol[0] == '\0') {
-        TTF_CloseFont(font);
-        return;
-    }
-    
-    // Set color based on piece type
-    SDL_Color color;
-    if (piece >= PIECE_TYPE_WHITE_PAWN && piece <= PIECE_TYPE_WHITE_KING) {
-        // White pieces
-        color.r = 255;
-        color.g = 255;
-        color.b = 255;
-        color.a = 255;
-    } else {
-        // Black pieces
-        color.r = 50;
-        color.g = 50;
-        color.b = 50;
-        color.a = 255;
-    }
-    
-    // Render the chess symbol
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, symbol, color);
-    if (surface) {
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(gui->renderer, surface);
-        if (texture) {
-            // Center the symbol in the square
-            int offsetX = (SQUARE_SIZE - surface->w) / 2;
-            int offsetY = (SQUARE_SIZE - surface->h) / 2;
-            SDL_Rect rect = {x + offsetX, y + offsetY, surface->w, surface->h};
-            SDL_RenderCopy(gui->renderer, texture, NULL, &rect);
-            SDL_DestroyTexture(texture);
-        }
-        SDL_FreeSurface(surface);
-    }
-    
-    TTF_CloseFont(font);
+    // Center the symbol in the square
+    DrawGlyph(gui, GetPieceGlyph(gui, gui->pieceTextures, GUI_FONT_PIECE, piece), x, y, SQUARE_SIZE);
 }
 
 void DrawCapturedPiece(GUI* gui, int piece, int x, int y, int size) {
-    // Safety check for piece bounds
-    if (piece == EMPTY || piece == OFFBOARD || piece < 0 || piece >= 13) {
-        return;
-    }
-    
-    // Load font for chess symbols (smaller size for captured pieces)
-    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/seguisym.ttf", size - 5);
-    if (!font) {
-        font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", size - 5);
-    }
-    if (!font) return;
-    
-    // Get the Unicode chess symbol
-    const char* symbol = GetPieceSymbol(piece);
-    if (!symbol || symbol[0] == '\0') {
-        TTF_CloseFont(font);
-        return;
-    }
-    
-    // Set color based on piece type
-    SDL_Color color;
-    if (piece >= PIECE_TYPE_WHITE_PAWN && piece <= PIECE_TYPE_WHITE_KING) {
-        // White pieces
-        color.r = 255;
-        color.g = 255;
-        color.b = 255;
-        color.a = 255;
-    } else {
-        // Black pieces
-        color.r = 50;
-        color.g = 50;
-        color.b = 50;
-        color.a = 255;
-    }
-    
-    // Render the chess symbol
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, symbol, color);
-    if (surface) {
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(gui->renderer, surface);
-        if (texture) {
-            // Center the symbol in the capture box
-            int offsetX = (size - surface->w) / 2;
-            int offsetY = (size - surface->h) / 2;
-            SDL_Rect rect = {x + offsetX, y + offsetY, surface->w, surface->h};
-            SDL_RenderCopy(gui->renderer, texture, NULL, &rect);
-            SDL_DestroyTexture(texture);
+    // Center the symbol in the capture box
+    DrawGlyph(gui, GetPieceGlyph(gui, gui->capturedTextures, GUI_FONT_CAPTURED, piece), x, y, size);
+}
+
+// Captured pieces of one colour, in capture order, read back from the game history
+static int CollectCapturedPieces(const ChessBoard* board, int color, int* pieces) {
+    int count = 0;
+    for (int ply = 0; ply < board->hisPly && count < 16; ply++) {
+        int captured = MOVE_GET_CAPTURED(board->history[ply].move);
+        if (captured != EMPTY && g_pieceCol[captured] == color) {
+            pieces[count++] = captured;
         }
-        SDL_FreeSurface(surface);
     }
-    
-    TTF_CloseFont(font);
+    return count;
 }
 
 void RenderCapturedPieces(GUI* gui, ChessBoard* board) {
@@ -606,50 +632,27 @@ void RenderCapturedPieces(GUI* gui, ChessBoard* board) {
     SDL_SetRenderDrawColor(gui->renderer, 100, 100, 100, 255);
     SDL_RenderDrawLine(gui->renderer, panelX, 0, panelX, BOARD_SIZE);
     
-    // Load font for labels
-    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 16);
-    if (!font) {
-        font = TTF_OpenFont("C:/Windows/Fonts/calibri.ttf", 16);
-    }
-    
     // Render "Captured Pieces" title
-    if (font) {
-        SDL_Color textColor = {255, 255, 255, 255};
-        SDL_Surface* titleSurface = TTF_RenderText_Solid(font, "Captured", textColor);
-        if (titleSurface) {
-            SDL_Texture* titleTexture = SDL_CreateTextureFromSurface(gui->renderer, titleSurface);
-            if (titleTexture) {
-                SDL_Rect titleRect = {panelX + (CAPTURED_PANEL_WIDTH - titleSurface->w) / 2, 5, titleSurface->w, titleSurface->h};
-                SDL_RenderCopy(gui->renderer, titleTexture, NULL, &titleRect);
-                SDL_DestroyTexture(titleTexture);
-            }
-            SDL_FreeSurface(titleSurface);
-        }
-    }
+    SDL_Color titleColor = {255, 255, 255, 255};
+    GUI_DrawText(gui, GUI_FONT_LABEL, titleColor, "Captured", panelX, 5, CAPTURED_PANEL_WIDTH);
     
+    int capturedBlack[16];
+    int capturedWhite[16];
+    int capturedBlackCount = CollectCapturedPieces(board, COLOR_TYPE_BLACK, capturedBlack);
+    int capturedWhiteCount = CollectCapturedPieces(board, COLOR_TYPE_WHITE, capturedWhite);
+
     int startY = CAPTURED_SECTION_Y_START + 30;
     int columnWidth = CAPTURED_PANEL_WIDTH / 2;
     int blackColumnX = panelX + 10;
     int whiteColumnX = panelX + columnWidth + 5;
     
     // Render COLOR_TYPE_BLACK pieces label and pieces (left column)
-    if (font) {
-        SDL_Color textColor = {200, 200, 200, 255};
-        SDL_Surface* labelSurface = TTF_RenderText_Solid(font, "Black", textColor);
-        if (labelSurface) {
-            SDL_Texture* labelTexture = SDL_CreateTextureFromSurface(gui->renderer, labelSurface);
-            if (labelTexture) {
-                SDL_Rect labelRect = {blackColumnX, startY, labelSurface->w, labelSurface->h};
-                SDL_RenderCopy(gui->renderer, labelTexture, NULL, &labelRect);
-                SDL_DestroyTexture(labelTexture);
-            }
-            SDL_FreeSurface(labelSurface);
-        }
-    }
+    SDL_Color textColor = {200, 200, 200, 255};
+    GUI_DrawText(gui, GUI_FONT_LABEL, textColor, "Black", blackColumnX, startY, 0);
     
     int blackY = startY + 25;
-    for (int i = 0; i < board->capturedBlackCount; i++) {
-        int piece = board->capturedBlack[i];
+    for (int i = 0; i < capturedBlackCount; i++) {
+        int piece = capturedBlack[i];
         if (piece != EMPTY && piece >= PIECE_TYPE_BLACK_PAWN && piece <= PIECE_TYPE_BLACK_KING) {
             DrawCapturedPiece(gui, piece, blackColumnX, blackY, CAPTURED_PIECE_SIZE);
             blackY += CAPTURED_PIECE_SIZE + CAPTURED_PIECE_PADDING;
@@ -659,23 +662,11 @@ void RenderCapturedPieces(GUI* gui, ChessBoard* board) {
     }
     
     // Render COLOR_TYPE_WHITE pieces label and pieces (right column)
-    if (font) {
-        SDL_Color textColor = {200, 200, 200, 255};
-        SDL_Surface* labelSurface = TTF_RenderText_Solid(font, "White", textColor);
-        if (labelSurface) {
-            SDL_Texture* labelTexture = SDL_CreateTextureFromSurface(gui->renderer, labelSurface);
-            if (labelTexture) {
-                SDL_Rect labelRect = {whiteColumnX, startY, labelSurface->w, labelSurface->h};
-                SDL_RenderCopy(gui->renderer, labelTexture, NULL, &labelRect);
-                SDL_DestroyTexture(labelTexture);
-            }
-            SDL_FreeSurface(labelSurface);
-        }
-    }
+    GUI_DrawText(gui, GUI_FONT_LABEL, textColor, "White", whiteColumnX, startY, 0);
     
     int whiteY = startY + 25;
-    for (int i = 0; i < board->capturedWhiteCount; i++) {
-        int piece = board->capturedWhite[i];
+    for (int i = 0; i < capturedWhiteCount; i++) {
+        int piece = capturedWhite[i];
         if (piece != EMPTY && piece >= PIECE_TYPE_WHITE_PAWN && piece <= PIECE_TYPE_WHITE_KING) {
             DrawCapturedPiece(gui, piece, whiteColumnX, whiteY, CAPTURED_PIECE_SIZE);
             whiteY += CAPTURED_PIECE_SIZE + CAPTURED_PIECE_PADDING;
@@ -683,10 +674,7 @@ void RenderCapturedPieces(GUI* gui, ChessBoard* board) {
             if (whiteY + CAPTURED_PIECE_SIZE > BOARD_SIZE - 10) break;
         }
     }
-    
-    if (font) {
-        TTF_CloseFont(font);
-    }
+
 }
 
 void AddMoveToHistory(GUI* gui, const char* moveStr) {
@@ -722,6 +710,7 @@ void UpdateTimer(GUI* gui, ChessBoard* board) {
             gui->gameOver = 1;
             strcpy(gui->gameOverMessage, "TIME OUT! Black Wins!");
             gui->timerActive = 0;
+            gui->needsRedraw = 1;
         }
     } else {
         gui->blackTimeMs -= elapsed;
@@ -730,21 +719,13 @@ void UpdateTimer(GUI* gui, ChessBoard* board) {
             gui->gameOver = 1;
             strcpy(gui->gameOverMessage, "TIME OUT! White Wins!");
             gui->timerActive = 0;
+            gui->needsRedraw = 1;
         }
     }
 }
 
 void RenderTimers(GUI* gui, ChessBoard* board) {
-    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 24);
-    if (!font) {
-        font = TTF_OpenFont("C:/Windows/Fonts/calibri.ttf", 24);
-    }
-    if (!font) return;
-    
-    TTF_Font* labelFont = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 16);
-    if (!labelFont) {
-        labelFont = TTF_OpenFont("C:/Windows/Fonts/calibri.ttf", 16);
-    }
+    if (!gui->fonts[GUI_FONT_TIMER]) return;
     
     // Calculate positions - bottom right corner, side by side within status area
     int timerY = BOARD_SIZE + 8;
@@ -783,60 +764,13 @@ void RenderTimers(GUI* gui, ChessBoard* board) {
     
     // Render White timer
     SDL_Color whiteColor = {255, 255, 255, 255};
-    if (labelFont) {
-        SDL_Surface* labelSurface = TTF_RenderText_Solid(labelFont, "White", whiteColor);
-        if (labelSurface) {
-            SDL_Texture* labelTexture = SDL_CreateTextureFromSurface(gui->renderer, labelSurface);
-            if (labelTexture) {
-                SDL_Rect labelRect = {whiteTimerX, timerY, labelSurface->w, labelSurface->h};
-                SDL_RenderCopy(gui->renderer, labelTexture, NULL, &labelRect);
-                SDL_DestroyTexture(labelTexture);
-            }
-            SDL_FreeSurface(labelSurface);
-        }
-    }
-    
-    SDL_Surface* whiteSurface = TTF_RenderText_Solid(font, whiteTimeStr, whiteColor);
-    if (whiteSurface) {
-        SDL_Texture* whiteTexture = SDL_CreateTextureFromSurface(gui->renderer, whiteSurface);
-        if (whiteTexture) {
-            SDL_Rect whiteRect = {whiteTimerX, timerY + 20, whiteSurface->w, whiteSurface->h};
-            SDL_RenderCopy(gui->renderer, whiteTexture, NULL, &whiteRect);
-            SDL_DestroyTexture(whiteTexture);
-        }
-        SDL_FreeSurface(whiteSurface);
-    }
+    GUI_DrawText(gui, GUI_FONT_LABEL, whiteColor, "White", whiteTimerX, timerY, 0);
+    GUI_DrawText(gui, GUI_FONT_TIMER, whiteColor, whiteTimeStr, whiteTimerX, timerY + 20, 0);
     
     // Render Black timer
     SDL_Color blackColor = {200, 200, 200, 255};
-    if (labelFont) {
-        SDL_Surface* labelSurface = TTF_RenderText_Solid(labelFont, "Black", blackColor);
-        if (labelSurface) {
-            SDL_Texture* labelTexture = SDL_CreateTextureFromSurface(gui->renderer, labelSurface);
-            if (labelTexture) {
-                SDL_Rect labelRect = {blackTimerX, timerY, labelSurface->w, labelSurface->h};
-                SDL_RenderCopy(gui->renderer, labelTexture, NULL, &labelRect);
-                SDL_DestroyTexture(labelTexture);
-            }
-            SDL_FreeSurface(labelSurface);
-        }
-    }
-    
-    SDL_Surface* blackSurface = TTF_RenderText_Solid(font, blackTimeStr, blackColor);
-    if (blackSurface) {
-        SDL_Texture* blackTexture = SDL_CreateTextureFromSurface(gui->renderer, blackSurface);
-        if (blackTexture) {
-            SDL_Rect blackRect = {blackTimerX, timerY + 20, blackSurface->w, blackSurface->h};
-            SDL_RenderCopy(gui->renderer, blackTexture, NULL, &blackRect);
-            SDL_DestroyTexture(blackTexture);
-        }
-        SDL_FreeSurface(blackSurface);
-    }
-    
-    TTF_CloseFont(font);
-    if (labelFont) {
-        TTF_CloseFont(labelFont);
-    }
+    GUI_DrawText(gui, GUI_FONT_LABEL, blackColor, "Black", blackTimerX, timerY, 0);
+    GUI_DrawText(gui, GUI_FONT_TIMER, blackColor, blackTimeStr, blackTimerX, timerY + 20, 0);
 }
 
 void RenderMoveHistory(GUI* gui, ChessBoard* board) {
@@ -851,25 +785,11 @@ void RenderMoveHistory(GUI* gui, ChessBoard* board) {
     SDL_SetRenderDrawColor(gui->renderer, 100, 100, 100, 255);
     SDL_RenderDrawLine(gui->renderer, panelX, 0, panelX, BOARD_SIZE);
     
-    // Load font for moves
-    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/arial.ttf", 14);
-    if (!font) {
-        font = TTF_OpenFont("C:/Windows/Fonts/calibri.ttf", 14);
-    }
-    if (!font) return;
+    if (!gui->fonts[GUI_FONT_HISTORY]) return;
     
     // Render title
     SDL_Color titleColor = {255, 255, 255, 255};
-    SDL_Surface* titleSurface = TTF_RenderText_Solid(font, "Move History", titleColor);
-    if (titleSurface) {
-        SDL_Texture* titleTexture = SDL_CreateTextureFromSurface(gui->renderer, titleSurface);
-        if (titleTexture) {
-            SDL_Rect titleRect = {panelX + 10, 10, titleSurface->w, titleSurface->h};
-            SDL_RenderCopy(gui->renderer, titleTexture, NULL, &titleRect);
-            SDL_DestroyTexture(titleTexture);
-        }
-        SDL_FreeSurface(titleSurface);
-    }
+    GUI_DrawText(gui, GUI_FONT_HISTORY, titleColor, "Move History", panelX + 10, 10, 0);
     
     // Render moves in pairs (White | Black)
     int startY = 40;
@@ -894,24 +814,31 @@ void RenderMoveHistory(GUI* gui, ChessBoard* board) {
                         moveNum, gui->moveHistory[i]);
             }
             
-            SDL_Surface* moveSurface = TTF_RenderText_Solid(font, displayText, textColor);
-            if (moveSurface) {
-                SDL_Texture* moveTexture = SDL_CreateTextureFromSurface(gui->renderer, moveSurface);
-                if (moveTexture) {
-                    int yPos = startY + ((i / 2) - startIndex / 2) * lineHeight;
-                    SDL_Rect moveRect = {panelX + 10, yPos, moveSurface->w, moveSurface->h};
-                    SDL_RenderCopy(gui->renderer, moveTexture, NULL, &moveRect);
-                    SDL_DestroyTexture(moveTexture);
-                }
-                SDL_FreeSurface(moveSurface);
-            }
+            int yPos = startY + ((i / 2) - startIndex / 2) * lineHeight;
+            GUI_DrawText(gui, GUI_FONT_HISTORY, textColor, displayText, panelX + 10, yPos, 0);
         }
     }
-    
-    TTF_CloseFont(font);
+}
+
+int GUI_NeedsRedraw(GUI* gui) {
+    int thinkTenths = gui->engineThinking ? (Misc_GetTimeMs() - gui->engineStartTime) / 100 : -1;
+    
+    // Input or a move changed the state, a clock shows another second or
+    // the thinking time another tenth
+    return gui->needsRedraw
+        || gui->whiteTimeMs / 1000 != gui->drawnWhiteSec
+        || gui->blackTimeMs / 1000 != gui->drawnBlackSec
+        || thinkTenths != gui->drawnThinkTenths;
 }
 
 void GUI_RenderBoard(GUI* gui, ChessBoard* board) {
+    // Remember what this frame shows, for GUI_NeedsRedraw
+    gui->frame++;
+    gui->needsRedraw = 0;
+    gui->drawnWhiteSec = gui->whiteTimeMs / 1000;
+    gui->drawnBlackSec = gui->blackTimeMs / 1000;
+    gui->drawnThinkTenths = gui->engineThinking ? (Misc_GetTimeMs() - gui->engineStartTime) / 100 : -1;
+    
     SDL_SetRenderDrawColor(gui->renderer, 50, 50, 50, 255);
     SDL_RenderClear(gui->renderer);
     
@@ -1012,26 +939,121 @@ void GUI_RenderBoard(GUI* gui, ChessBoard* board) {
 void CalculatePossibleMoves(GUI* gui, ChessBoard* board, int fromSquare) {
     gui->possibleMovesCount = 0;
     
-    // Generate all legal moves
-    MoveList list[1];
-    Move_GenerateAll(board, list);
+    // Legal moves of this position, generated once for all clicks
+    const MoveList* list = GetLegalMoves(gui, board);
     
     // Filter moves that start from the selected square
     for (int i = 0; i < list->count; i++) {
         int move = list->moves[i].move;
         
-        // Check if move is legal by trying it
-        if (Move_Make(board, move)) {
-            int from = MOVE_GET_FROM_SQUARE(move);
-            int to = MOVE_GET_TO_SQUARE(move);
-            
-            Move_Take(board); // Undo the move
-            
-            // If this move starts from our selected square, add destination to possible moves
-            if (from == fromSquare) {
-                gui->possibleMoves[gui->possibleMovesCount++] = to;
-            }
+        // If this move starts from our selected square, add destination to possible moves
+        if (MOVE_GET_FROM_SQUARE(move) == fromSquare) {
+            gui->possibleMoves[gui->possibleMovesCount++] = MOVE_GET_TO_SQUARE(move);
+        }
+    }
+}
+
+// Runs on the engine thread: searches the copy of the position and posts
+// the move to the event loop, which plays it (NOMOVE if there is none)
+static void* GUI_EngineThread(void* arg) {
+    GUI* gui = (GUI*)arg;
+    SDL_Event event;
+    
+    int move = Search_GetBestMove(gui->engineBoard, gui->engineInfo);
+    
+    SDL_zero(event);
+    event.type = gui->engineEventType;
+    event.user.code = move;
+    SDL_PushEvent(&event);
+    return NULL;
+}
+
+void GUI_StartEngine(GUI* gui, ChessBoard* board, SearchInfo* info) {
+    if (gui->engineThinking || gui->gameOver) return;
+    
+    // The engine searches its own copy; the event loop keeps drawing this one
+    Board_Copy(gui->engineBoard, board);
+    gui->engineInfo = info;
+    
+    // Time limit from the engine's clock, as a UCI "go wtime/btime winc/binc"
+    // would give it; input reaches the search only through stopRequest
+    int engineTimeMs = (board->side == COLOR_TYPE_WHITE) ? gui->whiteTimeMs : gui->blackTimeMs;
+    info->quit = BOOL_TYPE_FALSE;
+    info->stopped = BOOL_TYPE_FALSE;
+    info->stopRequest = BOOL_TYPE_FALSE;
+    info->statusRequest = BOOL_TYPE_FALSE;
+    info->asyncInput = BOOL_TYPE_TRUE;
+    info->GAME_MODE = MODE_TYPE_CONSOLE;
+    info->POST_THINKING = BOOL_TYPE_FALSE;
+    info->ponder = BOOL_TYPE_FALSE;
+    info->nodeLimit = 0;
+    info->mateLimit = 0;
+    info->searchMoveCount = 0;
+    info->starttime = Misc_GetTimeMs();
+    info->depth = CHESS_MAX_SEARCH_DEPTH - 1;
+    Time_Allocate(info, engineTimeMs, gui->incrementMs, 0, -1);
+    
+    gui->engineStartTime = info->starttime;
+    if (pthread_create(&gui->engineThread, NULL, GUI_EngineThread, gui) != 0) {
+        printf("✗ Could not start the engine thread!\n");
+        return;
+    }
+    gui->engineThinking = 1;
+    printf("Engine thinking (soft %d ms, hard %d ms)...\n", info->tm.softTime, info->tm.hardTime);
+}
+
+void GUI_StopEngine(GUI* gui) {
+    if (!gui->engineThinking) return;
+    
+    STOP_STORE(&gui->engineInfo->stopRequest, BOOL_TYPE_TRUE);
+    pthread_join(gui->engineThread, NULL);
+    gui->engineThinking = 0;
+    
+    // The stopped search still posted its move; it belongs to the old game
+    SDL_FlushEvent(gui->engineEventType);
+    printf("Engine search cancelled\n");
+}
+
+void GUI_HandleEngineMove(GUI* gui, ChessBoard* board, int move) {
+    if (!gui->engineThinking) return;
+    
+    pthread_join(gui->engineThread, NULL);
+    gui->engineThinking = 0;
+    
+    // The engine's flag fell while it was thinking
+    if (gui->gameOver) return;
+    
+    if (move == NOMOVE || !Move_IsLegal(board, move)) {
+        printf("✗ Engine couldn't find a move!\n");
+        if (GetGameResult(gui, board) != GAME_RESULT_NONE) {
+            SetGameOver(gui, board);
+            printf("*** GAME OVER ***\n");
         }
+        return;
+    }
+    
+    printf("Engine found move: %s\n", PrMove(move));
+    
+    // Add engine move to history
+    char engineMoveStr[10];
+    snprintf(engineMoveStr, sizeof(engineMoveStr), "%s", PrMove(move));
+    AddMoveToHistory(gui, engineMoveStr);
+    
+    MakeGuiMove(gui, board, move);
+    printf("✓ Engine played: %s\n", PrMove(move));
+    
+    // Add increment to engine's time
+    if (board->side == COLOR_TYPE_WHITE) {
+        gui->blackTimeMs += gui->incrementMs;
+    } else {
+        gui->whiteTimeMs += gui->incrementMs;
+    }
+    gui->lastMoveTime = Misc_GetTimeMs();
+    
+    // Check for checkmate/stalemate after engine move
+    if (GetGameResult(gui, board) != GAME_RESULT_NONE) {
+        SetGameOver(gui, board);
+        printf("*** GAME OVER ***\n");
     }
 }
 
@@ -1051,8 +1073,8 @@ void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x,
             
             printf("Pawn promotion move: %s\n", moveStr);
             
-            int move = Move_Parse(moveStr, board);
-            if (move != NOMOVE && Move_Make(board, move)) {
+            int move = FindLegalMove(gui, board, gui->promotionFromSq, gui->promotionToSq, choice);
+            if (move != NOMOVE && MakeGuiMove(gui, board, move)) {
                 gui->promotionPending = 0;
                 gui->promotionFromSq = NO_SQ;
                 gui->promotionToSq = NO_SQ;
@@ -1075,56 +1097,26 @@ void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x,
                 gui->lastMoveTime = Misc_GetTimeMs();
                 
                 // Check for game over
-                if (checkresult(board) == BOOL_TYPE_TRUE) {
+                if (GetGameResult(gui, board) != GAME_RESULT_NONE) {
                     SetGameOver(gui, board);
                     return;
                 }
                 
                 // Engine move in PvE mode
                 if (gui->gameMode == MODE_PVE) {
-                    MoveList list[1];
-                    Move_GenerateAll(board, list);
-                    
-                    int engineMove = NOMOVE;
-                    int bestScore = -999999;
-                    
-                    if (list->count > 0) {
-                        for (int i = 0; i < list->count; i++) {
-                            int move = list->moves[i].move;
-                            if (Move_Make(board, move)) {
-                                int score = -Evaluate_Position(board);
-                                Move_Take(board);
-                                if (score > bestScore) {
-                                    bestScore = score;
-                                    engineMove = move;
-                                }
-                            }
-                        }
-                    }
-                    
-                    if (engineMove != NOMOVE) {
-                        char engineMoveStr[10];
-                        snprintf(engineMoveStr, sizeof(engineMoveStr), "%s", PrMove(engineMove));
-                        AddMoveToHistory(gui, engineMoveStr);
-                        Move_Make(board, engineMove);
-                        
-                        if (board->side == COLOR_TYPE_WHITE) {
-                            gui->blackTimeMs += gui->incrementMs;
-                        } else {
-                            gui->whiteTimeMs += gui->incrementMs;
-                        }
-                        gui->lastMoveTime = Misc_GetTimeMs();
-                        
-                        if (checkresult(board) == BOOL_TYPE_TRUE) {
-                            SetGameOver(gui, board);
-                        }
-                    }
+                    GUI_StartEngine(gui, board, info);
                 }
             }
         }
         return;
     }
     
+    // The position belongs to the engine until it has moved
+    if (gui->engineThinking) {
+        printf("Engine is thinking...\n");
+        return;
+    }
+    
     // Don't process clicks if game is over
     if (gui->gameOver) {
         printf("Game is over! No more moves allowed.\n");
@@ -1132,13 +1124,13 @@ void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x,
     }
     
     // Check for checkmate/stalemate at the start of each turn
-    printf("DEBUG: Checking game status with checkresult()...\n");
-    if (checkresult(board) == BOOL_TYPE_TRUE) {
+    printf("DEBUG: Checking game status...\n");
+    if (GetGameResult(gui, board) != GAME_RESULT_NONE) {
         SetGameOver(gui, board);
         printf("*** GAME OVER - No legal moves available ***\n");
         return;
     }
-    printf("DEBUG: checkresult() returned BOOL_TYPE_FALSE - game continues\n");
+    printf("DEBUG: Game continues\n");
     
     int clickedSquare = SquareFromCoords(x, y);
     
@@ -1181,7 +1173,7 @@ void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x,
             char moveStr[8];
             
             // Check if this is a pawn promotion
-            if (IsPawnPromotion(board, gui->selectedSquare, clickedSquare)) {
+            if (IsPawnPromotion(gui, board, gui->selectedSquare, clickedSquare)) {
                 // Set up promotion dialog
                 gui->promotionPending = 1;
                 gui->promotionFromSq = gui->selectedSquare;
@@ -1200,11 +1192,11 @@ void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x,
             printf("Attempting move: %s (from %s to %s)\n", moveStr, PrSq(gui->selectedSquare), PrSq(clickedSquare));
             printf("Side before move: %s (%d)\n", board->side == COLOR_TYPE_WHITE ? "COLOR_TYPE_WHITE" : "COLOR_TYPE_BLACK", board->side);
             
-            int move = Move_Parse(moveStr, board);
+            int move = FindLegalMove(gui, board, gui->selectedSquare, clickedSquare, '\0');
             if (move != NOMOVE) {
                 printf("✓ Valid move found (moveInt=%d), making move...\n", move);
                 printf("DEBUG: Before Move_Make - side=%d (%s)\n", board->side, board->side == COLOR_TYPE_WHITE ? "COLOR_TYPE_WHITE" : "COLOR_TYPE_BLACK");
-                int makeMovResult = Move_Make(board, move);
+                int makeMovResult = MakeGuiMove(gui, board, move);
                 printf("DEBUG: Move_Make returned: %d\n", makeMovResult);
                 printf("DEBUG: After Move_Make - side=%d (%s)\n", board->side, board->side == COLOR_TYPE_WHITE ? "COLOR_TYPE_WHITE" : "COLOR_TYPE_BLACK");
                 
@@ -1239,87 +1231,19 @@ void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x,
                     }
                     
                     // Check for checkmate/stalemate after user move
-                    printf("DEBUG: About to call checkresult after move...\n");
-                    if (checkresult(board) == BOOL_TYPE_TRUE) {
-                        printf("DEBUG: checkresult returned BOOL_TYPE_TRUE - calling SetGameOver\n");
+                    printf("DEBUG: Checking game status after move...\n");
+                    if (GetGameResult(gui, board) != GAME_RESULT_NONE) {
+                        printf("DEBUG: Game over - calling SetGameOver\n");
                         SetGameOver(gui, board);
                         printf("*** GAME OVER ***\n");
                         return; // Game has ended
                     }
-                    printf("DEBUG: checkresult returned BOOL_TYPE_FALSE after move\n");
+                    printf("DEBUG: Game continues after move\n");
                     
-                    // Only let engine move in PvE mode
+                    // Only let engine move in PvE mode; it answers through
+                    // an engine event once its search is done
                     if (gui->gameMode == MODE_PVE) {
-                        // Engine vs Player mode - let engine make a move
-                        if (board->side == COLOR_TYPE_WHITE || board->side == COLOR_TYPE_BLACK) {
-                            // Generate all legal moves
-                            MoveList list[1];
-                            Move_GenerateAll(board, list);
-                            
-                            // Pick the best move using simple evaluation (instant)
-                            int engineMove = NOMOVE;
-                            int bestScore = -999999;
-                            
-                            if (list->count > 0) {
-                                for (int i = 0; i < list->count; i++) {
-                                    int move = list->moves[i].move;
-                                    
-                                    // Try the move
-                                    if (Move_Make(board, move)) {
-                                        // Simple evaluation: just count material
-                                        int score = -Evaluate_Position(board);
-                                        
-                                        // Unmake the move
-                                        Move_Take(board);
-                                        
-                                        // Keep track of best move
-                                        if (score > bestScore) {
-                                            bestScore = score;
-                                            engineMove = move;
-                                        }
-                                    }
-                                }
-                            }
-                            
-                            // Make the engine's move if it found one
-                            if (engineMove != NOMOVE) {
-                                printf("Engine found move: %s\n", PrMove(engineMove));
-                                
-                                // Add engine move to history
-                                char engineMoveStr[10];
-                                snprintf(engineMoveStr, sizeof(engineMoveStr), "%s", PrMove(engineMove));
-                                AddMoveToHistory(gui, engineMoveStr);
-                                
-                                Move_Make(board, engineMove);
-                                printf("✓ Engine played: %s\n", PrMove(engineMove));
-                                printf("Side after engine move: %s (%d)\n", board->side == COLOR_TYPE_WHITE ? "COLOR_TYPE_WHITE" : "COLOR_TYPE_BLACK", board->side);
-                                
-                                // Add increment to engine's time
-                                if (board->side == COLOR_TYPE_WHITE) {
-                                    // Black (engine) just moved
-                                    gui->blackTimeMs += gui->incrementMs;
-                                } else {
-                                    // White (engine) just moved
-                                    gui->whiteTimeMs += gui->incrementMs;
-                                }
-                                gui->lastMoveTime = Misc_GetTimeMs();
-                                
-                                // Check for checkmate/stalemate after engine move
-                                if (checkresult(board) == BOOL_TYPE_TRUE) {
-                                    SetGameOver(gui, board);
-                                    printf("*** GAME OVER ***\n");
-                                    return; // Game has ended
-                                }
-                            } else {
-                                printf("✗ Engine couldn't find a move!\n");
-                                // If engine can't find a move, check game state
-                                if (checkresult(board) == BOOL_TYPE_TRUE) {
-                                    SetGameOver(gui, board);
-                                    printf("*** GAME OVER ***\n");
-                                    return; // Game has ended
-                                }
-                            }
-                        }
+                        GUI_StartEngine(gui, board, info);
                     } else {
                         // Player vs Player mode - just switch turns, no engine move
                         printf("PvP Mode: It's now %s's turn\n", board->side == COLOR_TYPE_WHITE ? "COLOR_TYPE_WHITE" : "COLOR_TYPE_BLACK");
@@ -1329,7 +1253,7 @@ void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x,
                     gui->selectedSquare = NO_SQ;
                     
                     // If the user can't make any legal moves, check for checkmate/stalemate
-                    if (checkresult(board) == BOOL_TYPE_TRUE) {
+                    if (GetGameResult(gui, board) != GAME_RESULT_NONE) {
                         SetGameOver(gui, board);
                         printf("*** GAME OVER ***\n");
                         return; // Game has ended
@@ -1357,6 +1281,7 @@ void GUI_Run(ChessBoard* board, SearchInfo* info) {
     
     // Initialize board to starting position
     Board_ParseFromFEN(CHESS_START_FEN, board);
+    gui.legalMovesValid = 0;
     
     // Initialize search info
     info->depth = 6;
@@ -1383,6 +1308,9 @@ void GUI_Run(ChessBoard* board, SearchInfo* info) {
                 if (e.button.button == SDL_BUTTON_LEFT) {
                     GUI_HandleMouseClick(&gui, board, info, e.button.x, e.button.y);
                 }
+            } else if (e.type == gui.engineEventType) {
+                // The engine thread finished its search
+                GUI_HandleEngineMove(&gui, board, e.user.code);
             } else if (e.type == SDL_MOUSEWHEEL) {
                 // Scroll move history
                 if (e.wheel.y > 0) {
@@ -1395,8 +1323,10 @@ void GUI_Run(ChessBoard* board, SearchInfo* info) {
                 }
             } else if (e.type == SDL_KEYDOWN) {
                 if (e.key.keysym.sym == SDLK_n) {
-                    // New game
+                    // New game; a search of the old one is cancelled first
+                    GUI_StopEngine(&gui);
                     Board_ParseFromFEN(CHESS_START_FEN, board);
+                    gui.legalMovesValid = 0;
                     gui.selectedSquare = NO_SQ;
                     gui.gameOver = 0;
                     strcpy(gui.gameOverMessage, "");
@@ -1435,12 +1365,24 @@ void GUI_Run(ChessBoard* board, SearchInfo* info) {
                     printf("================\n\n");
                 }
             }
+            
+            // Anything but pointer motion may change what is shown (window
+            // events include exposure, which needs a repaint)
+            if (e.type != SDL_MOUSEMOTION) {
+                gui.needsRedraw = 1;
+            }
         }
         
-        // Update timer
+        // Update timer; the clocks run while the engine thinks
         UpdateTimer(&gui, board);
+        if (gui.gameOver) {
+            GUI_StopEngine(&gui);
+        }
         
-        GUI_RenderBoard(&gui, board);
+        // Draw only frames that differ from the last one
+        if (GUI_NeedsRedraw(&gui)) {
+            GUI_RenderBoard(&gui, board);
+        }
         SDL_Delay(16); // ~60 FPS
     }
     
@@ -4,6 +4,7 @@
 #include "types_definitions.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>  // Add explicit TTF include
+#include <pthread.h>
 
 #define BOARD_SIZE 640
 #define SQUARE_SIZE 80
@@ -42,10 +43,49 @@
 #define MODE_PVE 0  // Player vs Engine
 #define MODE_PVP 1  // Player vs Player
 
+// Fonts, opened once by GUI_Init
+enum {
+    GUI_FONT_HISTORY,    // 14 pt: move history, promotion labels
+    GUI_FONT_LABEL,      // 16 pt: panel and timer labels
+    GUI_FONT_STATUS,     // 18 pt: mode and controls line
+    GUI_FONT_TIMER,      // 24 pt: clocks, promotion title
+    GUI_FONT_MESSAGE,    // 36 pt: game over message
+    GUI_FONT_PIECE,      // Board piece glyphs
+    GUI_FONT_CAPTURED,   // Captured piece glyphs
+    GUI_FONT_PROMOTION,  // Promotion dialog glyphs
+    GUI_FONT_COUNT
+};
+
+// Text texture cache: strings drawn in recent frames keep their texture, the
+// least recently drawn one is replaced when a new string needs a slot
+#define TEXT_CACHE_SIZE 64
+#define TEXT_CACHE_MAX_LEN 64  // Longer strings are cut to fit
+
+typedef struct {
+    SDL_Texture* texture;      // NULL for a free slot
+    int font;                  // GUI_FONT_* it was rendered with
+    Uint32 color;              // RGBA, packed
+    char text[TEXT_CACHE_MAX_LEN];
+    int w;
+    int h;
+    Uint32 lastUsed;           // Frame that last drew it
+} TextCacheEntry;
+
 typedef struct {
     SDL_Window* window;
     SDL_Renderer* renderer;
-    SDL_Texture* pieceTextures[13];
+    SDL_Texture* pieceTextures[13];       // Board glyphs, rendered on first use
+    SDL_Texture* capturedTextures[13];    // Captured panel glyphs
+    SDL_Texture* promotionTextures[13];   // Promotion dialog glyphs
+    TTF_Font* fonts[GUI_FONT_COUNT];      // NULL if no font file was found
+    TextCacheEntry textCache[TEXT_CACHE_SIZE];
+    Uint32 frame;                         // Frames rendered so far
+    
+    // Redraw tracking: a frame is rendered only if something visible changed
+    int needsRedraw;           // Set by input, moves and engine events
+    int drawnWhiteSec;         // Clock seconds shown by the last frame
+    int drawnBlackSec;
+    int drawnThinkTenths;      // Thinking time shown by the last frame (-1 idle)
     int selectedSquare;
     int isRunning;
     int gameOver;  // 0 = game active, 1 = game over
@@ -73,6 +113,20 @@ typedef struct {
     int promotionPending;      // 1 if waiting for promotion choice
     int promotionFromSq;       // Source square for promotion
     int promotionToSq;         // Target square for promotion
+    
+    // Engine search (PvE), run on a background thread
+    pthread_t engineThread;    // Search thread, valid while engineThinking
+    int engineThinking;        // 1 while the engine searches
+    int engineStartTime;       // When the engine started thinking
+    Uint32 engineEventType;    // SDL user event that carries the engine's move
+    ChessBoard engineBoard[1]; // Copy of the position the engine searches
+    SearchInfo* engineInfo;    // Limits and stop flag of the search
+    
+    // Legal moves of the shown position, generated once and shared by move
+    // highlighting, move validation, promotion and game-over detection
+    MoveList legalMoves[1];
+    U64 legalMovesKey;         // posKey they were generated for
+    int legalMovesValid;       // Cleared by every move and new game
 } GUI;
 
 // Function declarations
@@ -86,9 +140,14 @@ void AddMoveToHistory(GUI* gui, const char* moveStr);
 void UpdateTimer(GUI* gui, ChessBoard* board);
 void ResetTimers(GUI* gui);
 void GUI_HandleMouseClick(GUI* gui, ChessBoard* board, SearchInfo* info, int x, int y);
+void GUI_StartEngine(GUI* gui, ChessBoard* board, SearchInfo* info);
+void GUI_StopEngine(GUI* gui);
+void GUI_HandleEngineMove(GUI* gui, ChessBoard* board, int move);
 int SquareFromCoords(int x, int y);
 void GetSquareCoords(int square, int* x, int* y);
 void GUI_DrawPiece(GUI* gui, int piece, int x, int y);
+void GUI_DrawText(GUI* gui, int font, SDL_Color color, const char* text, int x, int y, int centerWidth);
+int GUI_NeedsRedraw(GUI* gui);
 void DrawCapturedPiece(GUI* gui, int piece, int x, int y, int size);
 void GUI_Run(ChessBoard* board, SearchInfo* info);
 const char* GetPieceSymbol(int piece);
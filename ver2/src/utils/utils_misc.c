@@ -3,9 +3,12 @@
  * @brief Miscellaneous utility functions
  * 
  * Contains various utility functions:
- * - Time measurement (Misc_GetTimeMs)
+ * - Monotonic time measurement (Misc_GetTimeMs)
  * - Input checking for GUI communication (InputWaiting)
  * - User input handling during search (Misc_ReadInput)
+ * - Short waits (Misc_Sleep)
+ * - CPU feature check for the POPCNT/BMI/BMI2 build variants
+ * - Read-only memory mapping of data files (networks, tuning sets)
  * 
  * These platform-specific functions handle timing and I/O
  * for communication with GUIs and managing search time limits.
@@ -15,6 +18,7 @@
  */
 
 #include "stdio.h"
+#include "stdlib.h"
 #include "types_definitions.h"
 
 #ifdef WIN32
@@ -22,19 +26,31 @@
 #include <io.h>  // Add for read function
 #else
 #include "sys/time.h"
+#include "time.h"
 #include "sys/select.h"
 #include "unistd.h"
 #include "string.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
+// monotonic, so a wall-clock adjustment can't stretch or cut a search;
+// counted from the first call to stay well inside an int
 int Misc_GetTimeMs() {
+  static long long base = -1;
+  long long now = 0;
 #ifdef WIN32
-  return GetTickCount();
+  now = (long long)GetTickCount64();
 #else
-  struct timeval t;
-  gettimeofday(&t, NULL);
-  return t.tv_sec*1000 + t.tv_usec/1000;
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  now = (long long)t.tv_sec * 1000 + t.tv_nsec / 1000000;
 #endif
+  if(base < 0) {
+    base = now;
+  }
+  return (int)(now - base);
 }
 
 
@@ -78,11 +94,23 @@ void Misc_ReadInput(SearchInfo *info) {
   int             bytes;
   char            input[256] = "", *endc;
 
+    // a ponder search ends on any input, left for the protocol loop
+    if (info->ponder == BOOL_TYPE_TRUE) {
+		if (InputWaiting()) {
+		  info->stopped = BOOL_TYPE_TRUE;
+		}
+		return;
+    }
+
     if (InputWaiting()) {
-		info->stopped = BOOL_TYPE_TRUE;
 		do {
-		  bytes=read(fileno(stdin),input,256);
+		  bytes=read(fileno(stdin),input,255);
 		} while (bytes<0);
+		// end of input is not a command, e.g. "gambit bench < /dev/null"
+		if (bytes == 0) {
+		  return;
+		}
+		info->stopped = BOOL_TYPE_TRUE;
 		endc = strchr(input,'\n');
 		if (endc) *endc=0;
 
@@ -94,3 +122,94 @@ void Misc_ReadInput(SearchInfo *info) {
 		return;
     }
 }
+
+void Misc_Sleep(const int ms) {
+#ifdef WIN32
+  Sleep(ms);
+#else
+  usleep(ms * 1000);
+#endif
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+	&& (defined(USE_POPCNT) || defined(USE_BMI) || defined(USE_PEXT))
+static void RequireCpuFeature(const int supported, const char *feature) {
+	if(!supported) {
+		printf("This build of Gambit needs a CPU with %s. Use the portable build (make ARCH=portable).\n", feature);
+		exit(1);
+	}
+}
+#endif
+
+void Misc_CheckCpuFeatures() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+#ifdef USE_POPCNT
+	RequireCpuFeature(__builtin_cpu_supports("popcnt"), "POPCNT");
+#endif
+#ifdef USE_BMI
+	RequireCpuFeature(__builtin_cpu_supports("bmi"), "BMI1");
+#endif
+#ifdef USE_PEXT
+	RequireCpuFeature(__builtin_cpu_supports("bmi2"), "BMI2");
+#endif
+#endif
+}
+
+const void *Misc_MapFile(const char *path, size_t *size) {
+
+	void *memory = NULL;
+
+	*size = 0;
+#ifdef WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	HANDLE mapping = NULL;
+	LARGE_INTEGER length;
+
+	if(file == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+	if(GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping != NULL) {
+			memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);
+			if(memory != NULL) {
+				*size = (size_t)length.QuadPart;
+			}
+		}
+	}
+	CloseHandle(file);
+#else
+	struct stat status;
+	int file = open(path, O_RDONLY);
+
+	if(file < 0) {
+		return NULL;
+	}
+	if(fstat(file, &status) == 0 && status.st_size > 0) {
+		memory = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+		if(memory == MAP_FAILED) {
+			memory = NULL;
+		} else {
+			*size = (size_t)status.st_size;
+		}
+	}
+	close(file);
+#endif
+
+	return memory;
+}
+
+void Misc_UnmapFile(const void *memory, const size_t size) {
+
+	if(memory == NULL) {
+		return;
+	}
+#ifdef WIN32
+	(void)size;
+	UnmapViewOfFile(memory);
+#else
+	munmap((void *)memory, size);
+#endif
+}
@@ -0,0 +1,81 @@
+/**
+ * @file utils_profile.c
+ * @brief Totals and report of the PROFILE build's hot-path counters
+ *
+ * Every thread counts into its own g_profileCounters (see PROFILE_BEGIN
+ * in types_definitions.h), so profiling adds no shared-memory traffic to
+ * the search. A thread adds its counters to the totals here once, when
+ * its search ends (Profile_Flush); Profile_Report prints them:
+ * - Calls per point
+ * - Total ticks (cycles with RDTSC, else nanoseconds) and ticks per call
+ * - Time relative to the most expensive point; points nest (Quiescence
+ *   contains most of the others), so these shares don't add up to 100%
+ *
+ * Without PROFILE this file is empty.
+ *
+ * @author Gambit Chess Team
+ * @date October 2026
+ */
+
+#include "stdio.h"
+#include "types_definitions.h"
+
+#ifdef PROFILE
+#include <pthread.h>
+
+PROFILE_THREAD_LOCAL ProfileCounter g_profileCounters[PROFILE_POINT_COUNT];
+
+static const char *PointNames[PROFILE_POINT_COUNT] = {
+	"Move_GenerateAll/Legal",
+	"GenerateAllCaps/LegalCaptures",
+	"Move_GenerateQuiets/LegalQuiets",
+	"Move_Make/MakeLegal",
+	"Move_Take",
+	"Attack_IsSquareAttacked",
+	"Evaluate_Position",
+	"HashTable_ProbeEntry",
+	"Quiescence"
+};
+
+static U64 totalCalls[PROFILE_POINT_COUNT];
+static U64 totalTicks[PROFILE_POINT_COUNT];
+static pthread_mutex_t totalsLock = PTHREAD_MUTEX_INITIALIZER;
+
+void Profile_Flush() {
+
+	int point = 0;
+
+	pthread_mutex_lock(&totalsLock);
+	for(point = 0; point < PROFILE_POINT_COUNT; ++point) {
+		totalCalls[point] += g_profileCounters[point].calls;
+		totalTicks[point] += g_profileCounters[point].ticks;
+		g_profileCounters[point].calls = 0;
+		g_profileCounters[point].ticks = 0;
+	}
+	pthread_mutex_unlock(&totalsLock);
+}
+
+void Profile_Report() {
+
+	int point = 0;
+	U64 allTicks = 0;
+
+	pthread_mutex_lock(&totalsLock);
+	for(point = 0; point < PROFILE_POINT_COUNT; ++point) {
+		if(totalTicks[point] > allTicks) {
+			allTicks = totalTicks[point];
+		}
+	}
+
+	printf("\nProfile (%s, inclusive; %% of the largest point)\n", PROFILE_TICK_UNIT);
+	printf("%-32s %14s %18s %12s %7s\n", "function", "calls", "total", "per call", "share");
+	for(point = 0; point < PROFILE_POINT_COUNT; ++point) {
+		printf("%-32s %14llu %18llu %12.1f %6.1f%%\n", PointNames[point], totalCalls[point], totalTicks[point],
+			totalCalls[point] > 0 ? (double)totalTicks[point] / (double)totalCalls[point] : 0.0,
+			allTicks > 0 ? 100.0 * (double)totalTicks[point] / (double)allTicks : 0.0);
+		totalCalls[point] = 0;
+		totalTicks[point] = 0;
+	}
+	pthread_mutex_unlock(&totalsLock);
+}
+#endif